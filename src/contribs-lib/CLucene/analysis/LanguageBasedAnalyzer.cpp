@@ -19,6 +19,23 @@ CL_NS_USE2(analysis,snowball)
 
 CL_NS_DEF(analysis)
 
+/** The chain built for the language and stem setting it was created with */
+class LanguageBasedAnalyzer::SavedStreams : public TokenStream {
+public:
+	Tokenizer* source;
+	TokenStream* result;
+	TCHAR lang[100];
+	bool stem;
+
+	SavedStreams():source(NULL), result(NULL), stem(false) {}
+	virtual ~SavedStreams(){
+		_CLDELETE(result);
+	}
+
+	void close(){}
+	Token* next(Token* token) {return NULL;}
+};
+
 LanguageBasedAnalyzer::LanguageBasedAnalyzer(const TCHAR* language, bool stem)
 {
   if ( language == NULL )
@@ -36,15 +53,34 @@ void LanguageBasedAnalyzer::setStem(bool stem){
 	this->stem = stem;
 }
 TokenStream* LanguageBasedAnalyzer::tokenStream(const TCHAR* fieldName, Reader* reader) {
+	Tokenizer* source;
+	return createStream(reader, source);
+}
+TokenStream* LanguageBasedAnalyzer::reusableTokenStream(const TCHAR* fieldName, Reader* reader) {
+	SavedStreams* streams = reinterpret_cast<SavedStreams*>(getPreviousTokenStream());
+	if ( streams != NULL && streams->stem == stem && _tcscmp(streams->lang, lang) == 0 ){
+		streams->source->reset(reader);
+		return streams->result;
+	}
+
+	//language or stemming changed since the chain was built, setPreviousTokenStream deletes the old one
+	streams = _CLNEW SavedStreams();
+	streams->result = createStream(reader, streams->source);
+	_tcsncpy(streams->lang, lang, 100);
+	streams->stem = stem;
+	setPreviousTokenStream(streams);
+	return streams->result;
+}
+TokenStream* LanguageBasedAnalyzer::createStream(Reader* reader, Tokenizer*& source) {
 	TokenStream* ret = NULL;
 	if ( _tcscmp(lang, _T("cjk"))==0 ){
-		ret = _CLNEW CL_NS2(analysis,cjk)::CJKTokenizer(reader);
+		ret = source = _CLNEW CL_NS2(analysis,cjk)::CJKTokenizer(reader);
 	}else{
     BufferedReader* bufferedReader = reader->__asBufferedReader();
     if ( bufferedReader == NULL )
-      ret =  _CLNEW StandardTokenizer( _CLNEW FilteredBufferedReader(reader, false), true );
+      ret = source = _CLNEW StandardTokenizer( _CLNEW FilteredBufferedReader(reader, false), true );
     else
-      ret = _CLNEW StandardTokenizer(bufferedReader);
+      ret = source = _CLNEW StandardTokenizer(bufferedReader);
 
 		ret = _CLNEW StandardFilter(ret,true);
 
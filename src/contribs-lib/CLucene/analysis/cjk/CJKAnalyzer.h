@@ -84,6 +84,9 @@ public:
      */
 	CL_NS(analysis)::Token* next(CL_NS(analysis)::Token* token);
 
+	/** Resets the tokenizer to read from a new reader */
+	void reset(CL_NS(util)::Reader* in);
+
 	bool getIgnoreSurrogates(){ return ignoreSurrogates; };
 	void setIgnoreSurrogates(bool ignoreSurrogates){ this->ignoreSurrogates = ignoreSurrogates; };
 };
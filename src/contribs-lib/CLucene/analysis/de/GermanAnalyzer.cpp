@@ -46,6 +46,12 @@ CL_NS_USE2(analysis,standard)
       {
       }
 
+      virtual ~SavedStreams()
+      {
+        // tokenStream is deleted by the filter chain
+        _CLDELETE(filteredTokenStream);
+      }
+
       void close(){}
       Token* next(Token* token) {return NULL;}
   };
@@ -38,12 +38,13 @@ CL_NS_USE2(analysis,de)
       } else if (exclusionSet != NULL && exclusionSet->find(t->termBuffer()) != exclusionSet->end()) { // Check the exclusiontable
         return t;
       } else {
-        TCHAR* s = stemmer->stem(t->termBuffer(), t->termLength());
-        // If not stemmed, dont waste the time creating a new token
-        if (_tcscmp(s, t->termBuffer()) != 0) {
-          t->setText(s);
+        size_t length = t->termLength();
+        size_t stemLength;
+        const TCHAR* s = stemmer->stemNoCopy(t->termBuffer(), length, stemLength);
+        // If not stemmed, dont waste the time copying the term
+        if (stemLength != length || _tcsncmp(s, t->termBuffer(), length) != 0) {
+          t->setText(s, (int32_t)stemLength);
         }
-        _CLDELETE_ARRAY(s);
         return t;
       }
     }
@@ -16,25 +16,30 @@ CL_NS_USE2(analysis,de)
     }
 
     TCHAR* GermanStemmer::stem(const TCHAR* term, size_t length) {
-      if (length < 0) {
+      size_t stemLength;
+      return STRDUP_TtoT(stemNoCopy(term, length, stemLength));
+    }
+
+    const TCHAR* GermanStemmer::stemNoCopy(const TCHAR* term, size_t length, size_t& stemLength) {
+      if (length == (size_t)-1) {
         length = _tcslen(term);
       }
 
-      // Reset the StringBuffer.
-      sb.clear();
+      // Reset the StringBuffer, keeping its memory
+      sb.len = 0;
       sb.append(term, length);
 
-      if (!isStemmable(sb.getBuffer(), sb.length()))
-        return sb.giveBuffer();
-
-      // Stemming starts here...
-      substitute(sb);
-      strip(sb);
-      optimize(sb);
-      resubstitute(sb);
-      removeParticleDenotion(sb);
+      if (isStemmable(sb.getBuffer(), sb.length())) {
+        // Stemming starts here...
+        substitute(sb);
+        strip(sb);
+        optimize(sb);
+        resubstitute(sb);
+        removeParticleDenotion(sb);
+      }
 
-      return sb.giveBuffer();
+      stemLength = sb.length();
+      return sb.getBuffer();
     }
 
     bool GermanStemmer::isStemmable(const TCHAR* term, size_t length) const {
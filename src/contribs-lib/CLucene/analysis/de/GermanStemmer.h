@@ -44,6 +44,14 @@ public:
      */
     TCHAR* stem(const TCHAR* term, size_t length = -1);
 
+    /**
+     * Stems the given term like stem(), but returns the stemmer's own buffer
+     * instead of a copy. The result is only valid until the next call.
+     *
+     * @param stemLength receives the length of the stemmed term
+     */
+    const TCHAR* stemNoCopy(const TCHAR* term, size_t length, size_t& stemLength);
+
 private:
 
     /**
@@ -19,6 +19,25 @@ CL_NS_USE2(analysis,standard)
 
 CL_NS_DEF2(analysis,snowball)
 
+  class SnowballAnalyzer::SavedStreams : public TokenStream {
+  public:
+    StandardTokenizer* tokenStream;
+    TokenStream* filteredTokenStream;
+
+    SavedStreams():tokenStream(NULL), filteredTokenStream(NULL)
+    {
+    }
+
+    virtual ~SavedStreams()
+    {
+      // tokenStream is deleted by the filter chain
+      _CLDELETE(filteredTokenStream);
+    }
+
+    void close(){}
+    Token* next(Token* token) {return NULL;}
+  };
+
   /** Builds the named analyzer with no stop words. */
   SnowballAnalyzer::SnowballAnalyzer(const TCHAR* language) {
     this->language = STRDUP_TtoT(language);
@@ -62,6 +81,30 @@ CL_NS_DEF2(analysis,snowball)
     result = _CLNEW SnowballFilter(result, language, true);
     return result;
   }
+
+  TokenStream* SnowballAnalyzer::reusableTokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader) {
+    SavedStreams* streams = reinterpret_cast<SavedStreams*>(getPreviousTokenStream());
+
+    if (streams == NULL) {
+      streams = _CLNEW SavedStreams();
+      BufferedReader* bufferedReader = reader->__asBufferedReader();
+
+      if ( bufferedReader == NULL )
+        streams->tokenStream = _CLNEW StandardTokenizer( _CLNEW FilteredBufferedReader(reader, false), true );
+      else
+        streams->tokenStream = _CLNEW StandardTokenizer(bufferedReader);
+
+      streams->filteredTokenStream = _CLNEW StandardFilter(streams->tokenStream, true);
+      streams->filteredTokenStream = _CLNEW CL_NS(analysis)::LowerCaseFilter(streams->filteredTokenStream, true);
+      if (stopSet != NULL)
+        streams->filteredTokenStream = _CLNEW CL_NS(analysis)::StopFilter(streams->filteredTokenStream, true, stopSet);
+      streams->filteredTokenStream = _CLNEW SnowballFilter(streams->filteredTokenStream, language, true);
+      setPreviousTokenStream(streams);
+    } else
+      streams->tokenStream->reset(reader);
+
+    return streams->filteredTokenStream;
+  }
   
   
   
@@ -124,12 +167,13 @@ CL_NS_DEF2(analysis,snowball)
 #ifdef _UCS2
 	memcpy(utf8text,stemmed,stemmedLen);
 	utf8text[stemmedLen]=0;
-	lucene_utf8towcs(tchartext,utf8text,LUCENE_MAX_WORD_LEN);
+	int32_t textLen = (int32_t)lucene_utf8towcs(tchartext,utf8text,LUCENE_MAX_WORD_LEN);
 #else
 	for (int i=0;i<stemmedLen+1;i++)
 		tchartext[i]=stemmed[i];
+	int32_t textLen = stemmedLen;
 #endif
-	token->set(tchartext,token->startOffset(), token->endOffset(), token->type());
+	token->setText(tchartext, textLen);
 	return token;
   }
 
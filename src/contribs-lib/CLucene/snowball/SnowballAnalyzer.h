@@ -23,6 +23,8 @@ class CLUCENE_CONTRIBS_EXPORT SnowballAnalyzer: public Analyzer {
   TCHAR* language;
   CLTCSetList* stopSet;
 
+  class SavedStreams;
+
 public:
   /** Builds the named analyzer with no stop words. */
   SnowballAnalyzer(const TCHAR* language=_T("english"));
@@ -37,6 +39,9 @@ public:
       StandardFilter}, a {@link LowerCaseFilter} and a {@link StopFilter}. */
   TokenStream* tokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader);
   TokenStream* tokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader, bool deleteReader);
+
+  /** Returns the same chain as tokenStream(), re-used between calls from the same thread. */
+  TokenStream* reusableTokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader);
 };
 
 CL_NS_END2
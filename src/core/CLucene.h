@@ -36,6 +36,8 @@
 #include "CLucene/store/Directory.h"
 #include "CLucene/store/FSDirectory.h"
 #include "CLucene/store/RAMDirectory.h"
+#include "CLucene/store/RAMDirectoryLoader.h"
+#include "CLucene/store/RateLimiter.h"
 #include "CLucene/queryParser/QueryParser.h"
 #include "CLucene/analysis/standard/StandardAnalyzer.h"
 #include "CLucene/analysis/Analyzers.h"
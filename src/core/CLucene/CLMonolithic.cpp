@@ -25,6 +25,8 @@
 #include "CLucene/document/Field.cpp"
 #include "CLucene/index/CompoundFile.cpp"
 #include "CLucene/index/DirectoryIndexReader.cpp"
+#include "CLucene/index/DocumentCache.cpp"
+#include "CLucene/index/DocValues.cpp"
 #include "CLucene/index/DocumentsWriter.cpp"
 #include "CLucene/index/DocumentsWriterThreadState.cpp"
 #include "CLucene/index/FieldInfos.cpp"
@@ -127,6 +129,7 @@
 #include "CLucene/store/Directory.cpp"
 #include "CLucene/store/RAMDirectory.cpp"
 #include "CLucene/util/BitSet.cpp"
+#include "CLucene/util/PackedInts.cpp"
 #include "CLucene/util/Equators.cpp"
 #include "CLucene/util/FastCharStream.cpp"
 #include "CLucene/util/MD5Digester.cpp"
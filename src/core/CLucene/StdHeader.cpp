@@ -13,6 +13,7 @@
 #include "CLucene/index/TermVector.h"
 #include "CLucene/index/_IndexFileNameFilter.h"
 #include "CLucene/search/FieldSortedHitQueue.h"
+#include "CLucene/search/QueryTimeout.h"
 #include "CLucene/store/LockFactory.h"
 #include "CLucene/util/_StringIntern.h"
 #include "CLucene/util/_ThreadLocal.h"
@@ -38,6 +39,7 @@ void _lucene_shutdown(){
   Similarity::_shutdown();
   CLStringIntern::_shutdown();
   NoLockFactory::_shutdown();
+  QueryTimeout::_shutdown();
   _ThreadLocal::_shutdown();
   IndexFileNameFilter::_shutdown();
   _CLDELETE (TermVectorOffsetInfo_EMPTY_OFFSET_INFO);
@@ -162,6 +162,10 @@ void Token::growBuffer(size_t size){
 		_buffer = (TCHAR*)malloc( size * sizeof(TCHAR) );
 		*_buffer = 0;
 	}else{
+		//grow by at least half again, so that filters which lengthen
+		//terms don't reallocate the buffer over and over
+		if ( size < bufferTextLen + bufferTextLen/2 )
+			size = bufferTextLen + bufferTextLen/2;
 		//use realloc. growBuffer is public, therefore could be called
 		//without a subsequent call to overwriting the memory
 		_buffer = (TCHAR*)realloc( _buffer, size * sizeof(TCHAR) );
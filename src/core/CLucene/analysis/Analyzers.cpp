@@ -367,7 +367,10 @@ Token* ISOLatin1AccentFilter::next(Token* token){
 			return token;
 		}
 
-		StringBuffer output(l*2);
+		// every character is replaced by at most two
+		if ( output.length < (size_t)l*2 )
+			output.resize(l*2);
+		TCHAR* o = output.values;
 		for (int32_t j = 0; j < l; j++) {
 			#ifdef _UCS2
 			TCHAR c = chars[j];
@@ -381,31 +384,31 @@ Token* ISOLatin1AccentFilter::next(Token* token){
 				case 0xC3 : // �
 				case 0xC4 : // �
 				case 0xC5 : // �
-					output.appendChar('A');
+					*o++ = 'A';
 					break;
 				case 0xC6 : // �
-					output.append(_T("AE"));
+					*o++ = 'A'; *o++ = 'E';
 					break;
 				case 0xC7 : // �
-					output.appendChar('C');
+					*o++ = 'C';
 					break;
 				case 0xC8 : // �
 				case 0xC9 : // �
 				case 0xCA : // �
 				case 0xCB : // �
-					output.appendChar('E');
+					*o++ = 'E';
 					break;
 				case 0xCC : // �
 				case 0xCD : // �
 				case 0xCE : // �
 				case 0xCF : // �
-					output.appendChar('I');
+					*o++ = 'I';
 					break;
 				case 0xD0 : // �
-					output.appendChar('D');
+					*o++ = 'D';
 					break;
 				case 0xD1 : // �
-					output.appendChar('N');
+					*o++ = 'N';
 					break;
 				case 0xD2 : // �
 				case 0xD3 : // �
@@ -413,19 +416,19 @@ Token* ISOLatin1AccentFilter::next(Token* token){
 				case 0xD5 : // �
 				case 0xD6 : // �
 				case 0xD8 : // �
-					output.appendChar('O');
+					*o++ = 'O';
 					break;
 				case 0xDE : // �
-					output.append(_T("TH"));
+					*o++ = 'T'; *o++ = 'H';
 					break;
 				case 0xD9 : // �
 				case 0xDA : // �
 				case 0xDB : // �
 				case 0xDC : // �
-					output.appendChar('U');
+					*o++ = 'U';
 					break;
 				case 0xDD : // �
-					output.appendChar('Y');
+					*o++ = 'Y';
 					break;
 				case 0xE0 : // �
 				case 0xE1 : // �
@@ -433,31 +436,31 @@ Token* ISOLatin1AccentFilter::next(Token* token){
 				case 0xE3 : // �
 				case 0xE4 : // �
 				case 0xE5 : // �
-					output.appendChar('a');
+					*o++ = 'a';
 					break;
 				case 0xE6 : // �
-					output.append(_T("ae"));
+					*o++ = 'a'; *o++ = 'e';
 					break;
 				case 0xE7 : // �
-					output.appendChar('c');
+					*o++ = 'c';
 					break;
 				case 0xE8 : // �
 				case 0xE9 : // �
 				case 0xEA : // �
 				case 0xEB : // �
-					output.appendChar('e');
+					*o++ = 'e';
 					break;
 				case 0xEC : // �
 				case 0xED : // �
 				case 0xEE : // �
 				case 0xEF : // �
-					output.appendChar('i');
+					*o++ = 'i';
 					break;
 				case 0xF0 : // �
-					output.appendChar('d');
+					*o++ = 'd';
 					break;
 				case 0xF1 : // �
-					output.appendChar('n');
+					*o++ = 'n';
 					break;
 				case 0xF2 : // �
 				case 0xF3 : // �
@@ -465,42 +468,42 @@ Token* ISOLatin1AccentFilter::next(Token* token){
 				case 0xF5 : // �
 				case 0xF6 : // �
 				case 0xF8 : // �
-					output.appendChar('o');
+					*o++ = 'o';
 					break;
 				case 0xDF : // �
-					output.append(_T("ss"));
+					*o++ = 's'; *o++ = 's';
 					break;
 				case 0xFE : // �
-					output.append(_T("th"));
+					*o++ = 't'; *o++ = 'h';
 					break;
 				case 0xF9 : // �
 				case 0xFA : // �
 				case 0xFB : // �
 				case 0xFC : // �
-					output.appendChar('u');
+					*o++ = 'u';
 					break;
 				case 0xFD : // �
 				case 0xFF : // �
-					output.appendChar('y');
+					*o++ = 'y';
 					break;
 
 				#ifdef _UCS2
 				case 0x152 : // �
-					output.append(_T("OE"));
+					*o++ = 'O'; *o++ = 'E';
 					break;
 				case 0x153 : // �
-					output.append(_T("oe"));
+					*o++ = 'o'; *o++ = 'e';
 					break;
 				case 0x178 : // �
-					output.appendChar('Y');
+					*o++ = 'Y';
 					break;
 				#endif
 				default :
-					output.appendChar(c);
+					*o++ = c;
 					break;
 			}
 		}
-		token->setText(output.getBuffer());
+		token->setText(output.values, (int32_t)(o - output.values));
 		return token;
 	}
 	return NULL;
@@ -7,6 +7,7 @@
 #ifndef _lucene_analysis_Analyzers_
 #define _lucene_analysis_Analyzers_
 
+#include "CLucene/util/Array.h"
 #include "CLucene/util/VoidList.h"
 #include "CLucene/util/VoidMap.h"
 #include "CLucene/util/CLStreams.h"
@@ -328,6 +329,9 @@ public:
  * <p>
  */
 class CLUCENE_EXPORT ISOLatin1AccentFilter: public TokenFilter {
+private:
+	/** Holds the unaccented term, re-used between tokens */
+	CL_NS(util)::ValueArray<TCHAR> output;
 public:
 	ISOLatin1AccentFilter(TokenStream* input, bool deleteTs);
 	
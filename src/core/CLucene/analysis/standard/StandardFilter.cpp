@@ -36,7 +36,7 @@ CL_NS_DEF2(analysis,standard)
     {
       // remove 's
       text[textLength-2]=0;
-	    t->resetTermTextLen();
+	    t->setTermLength(textLength-2);
 
       return t;
 
@@ -47,7 +47,7 @@ CL_NS_DEF2(analysis,standard)
           text[j++]=text[i];
       }
       text[j]=0;
-      t->resetTermTextLen();
+      t->setTermLength(j);
       return t;
 
     } else {
@@ -7,7 +7,6 @@
 #include "CLucene/_ApiHeader.h"
 #include "StandardTokenizer.h"
 #include "CLucene/util/StringBuffer.h"
-#include "CLucene/util/_FastCharStream.h"
 #include "CLucene/util/CLStreams.h"
 
 CL_NS_USE(analysis)
@@ -29,21 +28,62 @@ CL_NS_DEF2(analysis,standard)
   const TCHAR** tokenImage = tokenImageArray;
 
 
+  /* Number of characters of the previous chunk kept at the start of ioBuffer.
+  ** The grammar never steps back more than two characters. */
+  #define MAX_REWIND 16
+
+  /* Character classes used by the grammar. Every character of every document
+  ** is classified, so the classes are precomputed into a table rather than
+  ** calling the _ist* functions each time. The table covers the BMP when the
+  ** internal (locale independent) character functions are used, otherwise only
+  ** ASCII. Characters outside of the table are classified on the fly. */
+  #define CC_SPACE      0x01
+  #define CC_ALPHA      0x02
+  #define CC_DIGIT      0x04
+  #define CC_ALNUM      0x08
+  #define CC_CJK        0x10
+
+  #if defined(LUCENE_USE_INTERNAL_CHAR_FUNCTIONS) && !defined(_ASCII)
+    #define CHAR_CLASS_TABLE_SIZE 0x10000
+  #else
+    #define CHAR_CLASS_TABLE_SIZE 0x80
+  #endif
+
+  static uint8_t classifyChar(const int ch){
+    uint8_t ret = 0;
+    if ( _istspace((TCHAR)ch) ) ret |= CC_SPACE;
+    if ( _istalpha((TCHAR)ch) ) ret |= CC_ALPHA;
+    if ( _istdigit(ch) ) ret |= CC_DIGIT;
+    if ( _istalnum(ch) ) ret |= CC_ALNUM;
+    if ( (ch>=0x3040 && ch<=0x318f) ||
+         (ch>=0x3300 && ch<=0x337f) ||
+         (ch>=0x3400 && ch<=0x3d2d) ||
+         (ch>=0x4e00 && ch<=0x9fff) ||
+         (ch>=0xf900 && ch<=0xfaff) ||
+         (ch>=0xac00 && ch<=0xd7af) ) //korean
+      ret |= CC_CJK;
+    return ret;
+  }
+
+  static struct CharClassTable{
+    uint8_t classes[CHAR_CLASS_TABLE_SIZE];
+    CharClassTable(){
+      for ( int ch=0;ch<CHAR_CLASS_TABLE_SIZE;ch++ )
+        classes[ch] = classifyChar(ch);
+    }
+  } charClassTable;
+
+  #define CHAR_CLASS(c) ( static_cast<unsigned int>(c) < CHAR_CLASS_TABLE_SIZE ? charClassTable.classes[static_cast<unsigned int>(c)] : classifyChar(c) )
+
   /* A bunch of shortcut macros, many of which make assumptions about variable
   ** names.  These macros enhance readability, not just convenience! */
-  #define EOS           (ch==-1 || rd->Eos())
-  #define SPACE         (_istspace((TCHAR)ch) != 0)
-  #define ALPHA         (_istalpha((TCHAR)ch) != 0)
-  #define ALNUM         (_istalnum(ch) != 0)
-  #define DIGIT         (_istdigit(ch) != 0)
+  #define EOS           (ch==-1 || eos)
+  #define SPACE         ((CHAR_CLASS(ch) & CC_SPACE) != 0)
+  #define ALPHA         ((CHAR_CLASS(ch) & CC_ALPHA) != 0)
+  #define ALNUM         ((CHAR_CLASS(ch) & CC_ALNUM) != 0)
+  #define DIGIT         ((CHAR_CLASS(ch) & CC_DIGIT) != 0)
   #define UNDERSCORE    (ch == '_')
-  
-  #define _CJK			(  (ch>=0x3040 && ch<=0x318f) || \
-  						   (ch>=0x3300 && ch<=0x337f) || \
-  						   (ch>=0x3400 && ch<=0x3d2d) || \
-  						   (ch>=0x4e00 && ch<=0x9fff) || \
-  						   (ch>=0xf900 && ch<=0xfaff) || \
-  						   (ch>=0xac00 && ch<=0xd7af) ) //korean
+  #define _CJK          ((CHAR_CLASS(ch) & CC_CJK) != 0)
 
   
   #define DASH          (ch == '-')
@@ -55,8 +95,11 @@ CL_NS_DEF2(analysis,standard)
   #define DECIMAL         DOT
 
 
+  /* The first loop scans the run of matching characters directly in ioBuffer,
+  ** the second one reads the character that ends the run (possibly refilling
+  ** the buffer) exactly as the grammar expects. */
   //freebsd seems to have a problem with defines over multiple lines, so this has to be one long line
-  #define _CONSUME_AS_LONG_AS(conditionFails) while (true) { ch = readChar(); if (ch==-1 || (!(conditionFails) || str.len >= LUCENE_MAX_WORD_LEN)) { break; } str.appendChar(ch);}
+  #define _CONSUME_AS_LONG_AS(conditionFails) while (bufferIndex < dataLen && str.len < LUCENE_MAX_WORD_LEN) { ch = ioBuffer[bufferIndex]; if (!(conditionFails)) { break; } str.appendChar(ch); bufferIndex++; rdPos++; } while (true) { ch = readChar(); if (ch==-1 || (!(conditionFails) || str.len >= LUCENE_MAX_WORD_LEN)) { break; } str.appendChar(ch);}
 
   #define CONSUME_ALPHAS _CONSUME_AS_LONG_AS(ALPHA)
 
@@ -98,30 +141,66 @@ CL_NS_DEF2(analysis,standard)
     ** position when readChar() is first called. */
     rdPos(-1),
     tokenStart(-1),
-    rd(_CLNEW FastCharStream(reader))
+    ioBuffer(_CL_NEWARRAY(TCHAR, MAX_REWIND + LUCENE_IO_BUFFER_SIZE)),
+    bufferIndex(0),
+    dataLen(0),
+    eos(false)
   {
 	  this->reader = reader;
 	  this->deleteReader = deleteReader;
   }
 
   StandardTokenizer::~StandardTokenizer() {
-    _CLDELETE(rd);
+    _CLDELETE_LARRAY(ioBuffer);
     if ( this->deleteReader )
     	_CLDELETE(reader)
   }
 
-  int StandardTokenizer::readChar() {
+  bool StandardTokenizer::refill() {
+    if ( eos )
+      return false;
+
+    // keep the tail of the current chunk, so that it can still be unread
+    const int32_t keep = dataLen < MAX_REWIND ? dataLen : MAX_REWIND;
+    memmove(ioBuffer, ioBuffer + dataLen - keep, keep * sizeof(TCHAR));
+    bufferIndex = dataLen = keep;
+
+    const TCHAR* start;
+    const int32_t len = reader->read(start, 1, LUCENE_IO_BUFFER_SIZE);
+    if ( len <= 0 ){
+      eos = true;
+      return false;
+    }
+    memcpy(ioBuffer + keep, start, len * sizeof(TCHAR));
+    dataLen += len;
+    return true;
+  }
+
+  inline int StandardTokenizer::readChar() {
     /* Increment by 1 because we're speaking in terms of characters, not
     ** necessarily bytes: */
     rdPos++;
-    return rd->GetNext();
+    if ( bufferIndex >= dataLen && !refill() )
+      return -1;
+    return ioBuffer[bufferIndex++];
   }
 
-  void StandardTokenizer::unReadChar() {
-    rd->UnGet();
+  inline void StandardTokenizer::unReadChar() {
+    // like the reader, nothing can be unread once the end of the stream was hit
+    if ( !eos ){
+      if ( bufferIndex == 0 )
+        _CLTHROWA(CL_ERR_IO,"error : No character can be UnGet");
+      bufferIndex--;
+    }
     rdPos--;
   }
 
+  inline int StandardTokenizer::peekChar() {
+    if ( bufferIndex >= dataLen && !refill() )
+      return -1;
+    return ioBuffer[bufferIndex];
+  }
+
   inline Token* StandardTokenizer::setToken(Token* t, StringBuffer* sb, TokenTypes tokenCode) {
     t->setStartOffset(tokenStart);
 	  t->setEndOffset(tokenStart+sb->length());
@@ -132,11 +211,26 @@ CL_NS_DEF2(analysis,standard)
   }
 
   void StandardTokenizer::reset(Reader* _input) {
-	this->input = _input;
-    if (rd->input==NULL) rd->input = _input->__asBufferedReader();
+    this->input = _input;
+
+    // re-point the character stream at the new reader, wrapping it if it isn't buffered
+    BufferedReader* bufferedReader = _input->__asBufferedReader();
+    if ( bufferedReader != reader ){
+      if ( deleteReader )
+        _CLDELETE(reader);
+      if ( bufferedReader == NULL ){
+        reader = _CLNEW FilteredBufferedReader(_input, false);
+        deleteReader = true;
+      }else{
+        reader = bufferedReader;
+        deleteReader = false;
+      }
+    }
     rdPos = -1;
     tokenStart = -1;
-    rd->reset();
+    bufferIndex = 0;
+    dataLen = 0;
+    eos = false;
   }
 
   Token* StandardTokenizer::next(Token* t) {
@@ -231,7 +325,7 @@ CL_NS_DEF2(analysis,standard)
       CONSUME_DIGITS;
       if (!DIGIT && !DECIMAL) {
         unReadChar();
-      } else if (!EOS && DECIMAL && _istdigit(rd->Peek())) {
+      } else if (!EOS && DECIMAL && _istdigit(peekChar())) {
         /* We just read the fractional digit group, but it's also followed by
         ** a decimal symbol and at least one more digit, so this must be a
         ** HOST rather than a real number. */
@@ -306,7 +400,7 @@ CL_NS_DEF2(analysis,standard)
     ** Even though hosts, e-mail addresses, etc., could have a dotted-segment
     ** that begins with a dot or a dash, it's far more common in source text
     ** for a pattern like "abc.--def" to be intended as two tokens. */
-    int ch = rd->Peek();
+    int ch = peekChar();
     if (!(DOT || DASH)) {
       bool prevWasDot;
       bool prevWasDash;
@@ -13,7 +13,6 @@
 CL_CLASS_DEF(analysis,Token)
 CL_CLASS_DEF(util,BufferedReader)
 CL_CLASS_DEF(util,StringBuffer)
-CL_CLASS_DEF(util,FastCharStream)
 
 CL_NS_DEF2(analysis,standard)
 
@@ -39,9 +38,13 @@ CL_NS_DEF2(analysis,standard)
     int32_t tokenStart;
 
     // Advance by one character, incrementing rdPos and returning the character.
-    int readChar();
+    inline int readChar();
     // Retreat by one character, decrementing rdPos.
-    void unReadChar();
+    inline void unReadChar();
+    // Returns the next character without consuming it.
+    inline int peekChar();
+    // Reads the next chunk of the reader into ioBuffer, returns false at end-of-stream.
+    bool refill();
 
     // createToken centralizes token creation for auditing purposes.
 	//Token* createToken(CL_NS(util)::StringBuffer* sb, TokenTypes tokenCode);
@@ -51,7 +54,14 @@ CL_NS_DEF2(analysis,standard)
 
 	CL_NS(util)::BufferedReader* reader;
 	bool deleteReader;
-	CL_NS(util)::FastCharStream* rd;
+
+	// characters are scanned from ioBuffer in chunks rather than pulled from
+	// the reader one at a time. The first characters of the buffer hold the
+	// tail of the previous chunk so that unReadChar works across refills.
+	TCHAR* ioBuffer;
+	int32_t bufferIndex;
+	int32_t dataLen;
+	bool eos;
   public:
 
     // Constructs a tokenizer for this Reader.
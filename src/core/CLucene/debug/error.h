@@ -33,6 +33,8 @@
 #define CL_ERR_MergeAborted 22
 #define CL_ERR_OutOfMemory 23
 #define CL_ERR_FieldReader 24
+#define CL_ERR_TimeExceeded 25 //< A search ran past the deadline of its QueryTimeout, or was cancelled
+#define CL_ERR_CollectionTerminated 26 //< A HitCollector ended the search early
 
 ////////////////////////////////////////////////////////
 //error try/throw/catch definitions
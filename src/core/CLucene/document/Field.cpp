@@ -15,7 +15,8 @@ CL_NS_USE(util)
 CL_NS_DEF(document)
 
 Field::Field(const TCHAR* Name, Reader* reader, int config):
-	lazy(false)
+	lazy(false),
+	ownsValue(true)
 {
 	CND_PRECONDITION(Name != NULL, "Name cannot be NULL");
 	CND_PRECONDITION(reader != NULL, "reader cannot be NULL");
@@ -31,7 +32,8 @@ Field::Field(const TCHAR* Name, Reader* reader, int config):
 
 
 Field::Field(const TCHAR* Name, const TCHAR* Value, int _config, const bool duplicateValue):
-	lazy(false)
+	lazy(false),
+	ownsValue(true)
 {
 	CND_PRECONDITION(Name != NULL, "Name cannot be NULL");
 	CND_PRECONDITION(Value != NULL, "value cannot be NULL");
@@ -59,7 +61,8 @@ Field::Field(const TCHAR* Name, const TCHAR* Value, int _config, const bool dupl
 }
 
 Field::Field(const TCHAR* Name, ValueArray<uint8_t>* Value, int config, bool duplicateValue):
-	lazy(false)
+	lazy(false),
+	ownsValue(true)
 {
 	CND_PRECONDITION(Name != NULL, "Name cannot be NULL");
 	CND_PRECONDITION(Value != NULL, "value cannot be NULL");
@@ -81,7 +84,8 @@ Field::Field(const TCHAR* Name, ValueArray<uint8_t>* Value, int config, bool dup
 }
 
 Field::Field(const TCHAR* Name, int config):
-	lazy(false)
+	lazy(false),
+	ownsValue(true)
 {
 	CND_PRECONDITION(Name != NULL, "Name cannot be NULL");
 
@@ -122,6 +126,9 @@ bool	Field::isStoreOffsetWithTermVector() const { return (config & TERMVECTOR_YE
 bool	Field::isStorePositionWithTermVector() const { return (config & TERMVECTOR_YES) != 0 && (config & TERMVECTOR_WITH_POSITIONS) != 0 && ((config & TERMVECTOR_WITH_POSITIONS) != TERMVECTOR_YES); }
 
 bool Field::getOmitNorms() const { return (config & INDEX_NONORMS) != 0; }
+Field::DocValues Field::getDocValuesType() const {
+	return (DocValues)(config & (DOCVALUES_INT | DOCVALUES_FLOAT | DOCVALUES_STRING));
+}
 void Field::setOmitNorms(const bool omitNorms) {
     if ( omitNorms )
         config |= INDEX_NONORMS;
@@ -140,6 +147,22 @@ void Field::setValue(TCHAR* value, const bool duplicateValue) {
 	valueType = VALUE_STRING;
 }
 
+void Field::setValueReference(const TCHAR* value) {
+	CND_PRECONDITION(value != NULL, "value cannot be NULL");
+	_resetValue();
+	fieldsData = const_cast<TCHAR*>(value);
+	valueType = VALUE_STRING;
+	ownsValue = false;
+}
+
+void Field::setValueReference(const ValueArray<uint8_t>* value) {
+	CND_PRECONDITION(value != NULL, "value cannot be NULL");
+	_resetValue();
+	fieldsData = const_cast<ValueArray<uint8_t>*>(value);
+	valueType = VALUE_BINARY;
+	ownsValue = false;
+}
+
 void Field::setValue(Reader* value) {
 	_resetValue();
 	fieldsData = value;
@@ -197,7 +220,15 @@ void Field::setConfig(const uint32_t x){
 	}else
 		newConfig |= INDEX_NO;
 
-	if ( newConfig & INDEX_NO && newConfig & STORE_NO )
+	//set doc values settings
+	const uint32_t docValues = x & (DOCVALUES_INT | DOCVALUES_FLOAT | DOCVALUES_STRING);
+	if ( docValues != 0 ){
+		if ( docValues != DOCVALUES_INT && docValues != DOCVALUES_FLOAT && docValues != DOCVALUES_STRING )
+			_CLTHROWA(CL_ERR_IllegalArgument,"a field can only have one type of doc values");
+		newConfig |= docValues;
+	}
+
+	if ( newConfig & INDEX_NO && newConfig & STORE_NO && docValues == 0 )
 		_CLTHROWA(CL_ERR_IllegalArgument,"it doesn't make sense to have a field that is neither indexed nor stored");
 
 	//set termvector settings
@@ -295,7 +326,10 @@ TCHAR* Field::toString() {
 
 
 void Field::_resetValue() {
-	if (valueType & VALUE_STRING) {
+	if (!ownsValue) {
+		// the value belongs to the caller
+		ownsValue = true;
+	} else if (valueType & VALUE_STRING) {
 		TCHAR* t = static_cast<TCHAR*>(fieldsData);
 		_CLDELETE_CARRAY(t);
 	} else if (valueType & VALUE_READER) {
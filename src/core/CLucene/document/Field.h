@@ -113,6 +113,24 @@ public:
 		TERMVECTOR_WITH_POSITIONS_OFFSETS = TERMVECTOR_WITH_OFFSETS | TERMVECTOR_WITH_POSITIONS
 	};
 
+	/** Per-document value columns, written at index time and used by the FieldCache
+	* instead of uninverting the field. At most one type can be set on a field.
+	* A doc values field does not need to be indexed or stored.
+	*/
+	enum DocValues{
+		/** Do not write a doc values column (default) */
+		DOCVALUES_NO=0,
+
+		/** Parse the value as an integer and store it in a packed integer column */
+		DOCVALUES_INT=4096,
+
+		/** Parse the value as a float and store it in a float column */
+		DOCVALUES_FLOAT=8192,
+
+		/** Store the value in a deduplicated, sorted string column */
+		DOCVALUES_STRING=16384
+	};
+
 	bool lazy;
 
 	enum ValueType {
@@ -241,6 +259,9 @@ public:
 	/** True if the value of the filed is stored as binary */
 	bool isBinary() const;
 	
+	/** Returns the doc values column type of this field, or DOCVALUES_NO */
+	DocValues getDocValuesType() const;
+
 	/** True if norms are omitted for this indexed field */
 	bool getOmitNorms() const;
 
@@ -290,6 +311,23 @@ public:
 	/** Expert: change the value of this field.  See <a href="#setValue(TCHAR*)">setValue(TCHAR*)</a>. */
 	void setValue(CL_NS(analysis)::TokenStream* value);
 
+	/** <p>Expert: change the value of this field to a string owned by the caller.
+	*  The value is neither copied nor released by the field, so together with a
+	*  re-used Document and Field instances, a document can be added to the index
+	*  without any allocations for its values.</p>
+	*
+	*  <p>The value must stay valid and unchanged until the Document containing this
+	*  Field has been added to the index. After that the buffer can be filled with
+	*  the value for the next document.</p>
+	*
+	* @memory Caller is responsible for releasing value */
+	void setValueReference(const TCHAR* value);
+
+	/** Expert: change the value of this field to binary data owned by the caller.
+	*  See <a href="#setValueReference(const TCHAR*)">setValueReference(const TCHAR*)</a>.
+	* @memory Caller is responsible for releasing value */
+	void setValueReference(const CL_NS(util)::ValueArray<uint8_t>* value);
+
 	virtual const char* getObjectName() const;
 	static const char* getClassName();
 
@@ -305,6 +343,7 @@ protected:
 
 	void* fieldsData;
 	ValueType valueType;
+	bool ownsValue; ///<false if fieldsData belongs to the caller
 
 	const TCHAR* _name;
 	uint32_t config;
@@ -42,6 +42,7 @@ public:
  *  compound file. The visibility is left as "package" *only* because
  *  this helps with testing since JUnit test cases in a different class
  *  can then access package fields of this class.
+ *  Only used when the compound file's stream can not be sliced.
  */
 class CSIndexInput:public CL_NS(store)::BufferedIndexInput {
 private:
@@ -217,6 +218,11 @@ bool CompoundFileReader::openInput(const char * id, CL_NS(store)::IndexInput *&
 		return false;
 	}
 
+	// where the stream can be sliced, sub-files read the compound file directly
+	ret = stream->slice(entry->offset, entry->length);
+	if (ret != NULL)
+		return true;
+
 	if (bufferSize < 1)
 		bufferSize = readBufferSize;
 
@@ -379,12 +385,10 @@ void CompoundFileWriter::close(){
       // Open the files and copy their data into the stream.
       // Remember the locations of each file's data section.
       { //msvc6 for scope fix
-      const int32_t bufferLength = 16384;
-		  uint8_t buffer[bufferLength];
 		  for ( CL_NS(util)::CLLinkedList<WriterFileEntry*>::iterator i=_internal->entries->begin();i!=_internal->entries->end();i++ ){
 			  WriterFileEntry* fe = *i;
 			  fe->dataOffset = os->getFilePointer();
-			  copyFile(fe, os, buffer, bufferLength);
+			  copyFile(fe, os);
 		  }
 	  }
 
@@ -405,7 +409,7 @@ void CompoundFileWriter::close(){
 }
 
 
-void CompoundFileWriter::copyFile(WriterFileEntry* source, IndexOutput* os, uint8_t* buffer, int32_t bufferLength){
+void CompoundFileWriter::copyFile(WriterFileEntry* source, IndexOutput* os){
   IndexInput* is = NULL;
   try {
       int64_t startPtr = os->getFilePointer();
@@ -413,18 +417,18 @@ void CompoundFileWriter::copyFile(WriterFileEntry* source, IndexOutput* os, uint
       is = _internal->directory->openInput(source->file);
       int64_t length = is->length();
       int64_t remainder = length;
-      int32_t chunk = bufferLength;
+      const int32_t chunk = COPY_CHUNK_SIZE;
 
+      // the output may copy straight from file to file
       while(remainder > 0) {
           int32_t len = (int32_t)cl_min((int64_t)chunk, remainder);
-          is->readBytes(buffer, len);
-          os->writeBytes(buffer, len);
+          os->copyBytes(is, len);
           remainder -= len;
 
           if (_internal->checkAbort != NULL)
             // Roughly every 2 MB we will check if
             // it's time to abort
-            _internal->checkAbort->work(80);
+            _internal->checkAbort->work(80.0f * len / 16384);
       }
 
       // Verify that remainder is 0
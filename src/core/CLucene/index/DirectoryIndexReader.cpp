@@ -187,6 +187,7 @@ CL_NS_DEF(index)
       if (_this != newReader) {
         newReader->init(directory, infos, closeDirectory);
         newReader->deletionPolicy = deletionPolicy;
+        newReader->setDocumentCache(_this->getDocumentCache());
       }
 
       return newReader;
@@ -0,0 +1,376 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "_DocValues.h"
+#include "_IndexFileNames.h"
+#include "CLucene/document/Field.h"
+#include "CLucene/document/Document.h"
+#include "CLucene/store/Directory.h"
+#include "CLucene/store/IndexInput.h"
+#include "CLucene/store/IndexOutput.h"
+#include "CLucene/util/PackedInts.h"
+#include <algorithm>
+
+CL_NS_USE(store)
+CL_NS_USE(util)
+CL_NS_USE(document)
+CL_NS_DEF(index)
+
+namespace {
+	union FloatBits{
+		float f;
+		int32_t i;
+	};
+
+	int32_t floatToBits(float_t value){
+		FloatBits bits;
+		bits.f = (float)value;
+		return bits.i;
+	}
+
+	float_t bitsToFloat(int32_t value){
+		FloatBits bits;
+		bits.i = value;
+		return bits.f;
+	}
+
+	std::string docValuesFileName(const char* segment){
+		return std::string(segment) + "." + IndexFileNames::DOC_VALUES_EXTENSION;
+	}
+
+	/** Orders string ids by the string they refer to */
+	class StringIdCompare{
+		const std::vector<TCHAR*>& strings;
+	public:
+		StringIdCompare(const std::vector<TCHAR*>& strings): strings(strings){
+		}
+		bool operator()(int32_t a, int32_t b) const{
+			return _tcscmp(strings[a], strings[b]) < 0;
+		}
+	};
+}
+
+class DocValuesWriter::Column: LUCENE_BASE{
+public:
+	typedef std::map<const TCHAR*, int32_t, Compare::TChar> IdsType;
+
+	int32_t type;
+	std::vector<int32_t> values; // the int value, float bits or string id + 1 of each document
+	std::vector<TCHAR*> strings;   // the unique strings of a string column, by id
+	IdsType ids;
+
+	Column(int32_t type): type(type){
+	}
+	~Column(){
+		for ( size_t i=0;i<strings.size();i++ )
+			_CLDELETE_CARRAY(strings[i]);
+	}
+
+	void set(int32_t doc, int32_t value){
+		if ( (size_t)doc >= values.size() )
+			values.resize(doc+1, 0);
+		values[doc] = value;
+	}
+	int32_t get(int32_t doc) const{
+		return (size_t)doc < values.size() ? values[doc] : 0;
+	}
+};
+
+DocValuesWriter::DocValuesWriter(){
+}
+
+DocValuesWriter::~DocValuesWriter(){
+	reset();
+}
+
+DocValuesWriter::Column* DocValuesWriter::getColumn(const TCHAR* field, int32_t type){
+	ColumnsType::iterator itr = columns.find(field);
+	if ( itr != columns.end() ){
+		if ( itr->second->type != type )
+			_CLTHROWA(CL_ERR_IllegalArgument, "field was already added with another type of doc values");
+		return itr->second;
+	}
+	Column* column = _CLNEW Column(type);
+	columns.insert(ColumnsType::value_type(STRDUP_TtoT(field), column));
+	return column;
+}
+
+void DocValuesWriter::addColumn(const TCHAR* field, int32_t type){
+	getColumn(field, type);
+}
+
+int32_t DocValuesWriter::getType(const TCHAR* field) const{
+	ColumnsType::const_iterator itr = columns.find(field);
+	return itr == columns.end() ? 0 : itr->second->type;
+}
+
+void DocValuesWriter::setInt(const TCHAR* field, int32_t doc, int32_t value){
+	getColumn(field, Field::DOCVALUES_INT)->set(doc, value);
+}
+
+void DocValuesWriter::setFloat(const TCHAR* field, int32_t doc, float_t value){
+	getColumn(field, Field::DOCVALUES_FLOAT)->set(doc, floatToBits(value));
+}
+
+void DocValuesWriter::setString(const TCHAR* field, int32_t doc, const TCHAR* value){
+	Column* column = getColumn(field, Field::DOCVALUES_STRING);
+	Column::IdsType::iterator itr = column->ids.find(value);
+	int32_t id;
+	if ( itr == column->ids.end() ){
+		id = (int32_t)column->strings.size();
+		TCHAR* str = STRDUP_TtoT(value);
+		column->strings.push_back(str);
+		column->ids.insert(Column::IdsType::value_type(str, id));
+	}else
+		id = itr->second;
+	column->set(doc, id + 1);
+}
+
+bool DocValuesWriter::empty() const{
+	return columns.empty();
+}
+
+void DocValuesWriter::write(Directory* directory, const char* segment, int32_t numDocs){
+	IndexOutput* output = directory->createOutput(docValuesFileName(segment).c_str());
+	try{
+		output->writeInt(FORMAT);
+
+		std::vector<int64_t> pointers;
+		for ( ColumnsType::iterator itr = columns.begin(); itr != columns.end(); itr++ ){
+			Column* column = itr->second;
+			pointers.push_back(output->getFilePointer());
+
+			if ( column->type == Field::DOCVALUES_INT ){
+				int32_t minValue = column->get(0), maxValue = minValue;
+				for ( int32_t i=1;i<numDocs;i++ ){
+					const int32_t v = column->get(i);
+					if ( v < minValue ) minValue = v;
+					else if ( v > maxValue ) maxValue = v;
+				}
+				output->writeInt(minValue);
+				PackedInts packed(numDocs, PackedInts::bitsRequired((uint64_t)((int64_t)maxValue - minValue)));
+				for ( int32_t i=0;i<numDocs;i++ )
+					packed.set(i, (uint64_t)((int64_t)column->get(i) - minValue));
+				packed.write(output);
+
+			}else if ( column->type == Field::DOCVALUES_FLOAT ){
+				output->writeVInt(numDocs);
+				for ( int32_t i=0;i<numDocs;i++ )
+					output->writeInt(column->get(i));
+
+			}else{
+				// sort the unique strings and map each id to its ord
+				const int32_t count = (int32_t)column->strings.size();
+				std::vector<int32_t> sorted(count);
+				for ( int32_t i=0;i<count;i++ )
+					sorted[i] = i;
+				std::sort(sorted.begin(), sorted.end(), StringIdCompare(column->strings));
+
+				std::vector<int32_t> ords(count + 1);
+				ords[0] = 0;
+				output->writeVInt(count);
+				for ( int32_t i=0;i<count;i++ ){
+					const TCHAR* str = column->strings[sorted[i]];
+					output->writeString(str, (int32_t)_tcslen(str));
+					ords[sorted[i] + 1] = i + 1;
+				}
+
+				PackedInts packed(numDocs, PackedInts::bitsRequired(count));
+				for ( int32_t i=0;i<numDocs;i++ )
+					packed.set(i, ords[column->get(i)]);
+				packed.write(output);
+			}
+		}
+
+		const int64_t directoryPointer = output->getFilePointer();
+		output->writeVInt((int32_t)columns.size());
+		size_t i = 0;
+		for ( ColumnsType::iterator itr = columns.begin(); itr != columns.end(); itr++ ){
+			output->writeString(itr->first, (int32_t)_tcslen(itr->first));
+			output->writeVInt(itr->second->type);
+			output->writeLong(pointers[i++]);
+		}
+		output->writeLong(directoryPointer);
+	}_CLFINALLY(
+		output->close();
+		_CLDELETE(output);
+	)
+}
+
+void DocValuesWriter::reset(){
+	ColumnsType::iterator itr = columns.begin();
+	while ( itr != columns.end() ){
+		TCHAR* name = const_cast<TCHAR*>(itr->first);
+		_CLDELETE(itr->second);
+		columns.erase(itr++);
+		_CLDELETE_CARRAY(name);
+	}
+}
+
+IndexSortChecker::IndexSortChecker(const TCHAR* field, bool reverse):
+	field(STRDUP_TtoT(field)), reverse(reverse), hasLast(false), lastType(0),
+	lastInt(0), lastFloat(0), lastString(NULL)
+{
+}
+
+IndexSortChecker::~IndexSortChecker(){
+	_CLDELETE_CARRAY(field);
+	_CLDELETE_CARRAY(lastString);
+}
+
+const TCHAR* IndexSortChecker::getField() const{
+	return field;
+}
+
+bool IndexSortChecker::getReverse() const{
+	return reverse;
+}
+
+void IndexSortChecker::add(Document* doc){
+	Field* f = doc->getField(field);
+	int32_t type = lastType;
+	if ( f != NULL ){
+		type = f->getDocValuesType();
+		if ( type == Field::DOCVALUES_NO || f->stringValue() == NULL )
+			_CLTHROWA(CL_ERR_IllegalArgument, "the index sort field must be a doc values field");
+		if ( lastType != 0 && type != lastType )
+			_CLTHROWA(CL_ERR_IllegalArgument, "field was already added with another type of doc values");
+	}
+
+	// a missing value compares like the defaults of the last* members
+	int32_t intValue = 0;
+	float_t floatValue = 0;
+	const TCHAR* stringValue = NULL;
+	int32_t c = 0;
+	if ( type == Field::DOCVALUES_INT ){
+		if ( f != NULL ) intValue = _ttoi(f->stringValue());
+		c = lastInt < intValue ? -1 : (lastInt > intValue ? 1 : 0);
+	}else if ( type == Field::DOCVALUES_FLOAT ){
+		if ( f != NULL ) floatValue = _tcstod(f->stringValue(), NULL);
+		c = lastFloat < floatValue ? -1 : (lastFloat > floatValue ? 1 : 0);
+	}else if ( type == Field::DOCVALUES_STRING ){
+		if ( f != NULL ) stringValue = f->stringValue();
+		if ( lastString == NULL )
+			c = stringValue == NULL ? 0 : -1;
+		else
+			c = stringValue == NULL ? 1 : _tcscmp(lastString, stringValue);
+	}
+	if ( reverse )
+		c = -c;
+	if ( hasLast && c > 0 )
+		_CLTHROWA(CL_ERR_IllegalArgument, "document does not follow the index sort of the writer");
+
+	hasLast = true;
+	lastType = type;
+	lastInt = intValue;
+	lastFloat = floatValue;
+	if ( lastString == NULL || stringValue == NULL || _tcscmp(lastString, stringValue) != 0 ){
+		_CLDELETE_CARRAY(lastString);
+		if ( stringValue != NULL )
+			lastString = STRDUP_TtoT(stringValue);
+	}
+}
+
+
+DocValuesReader::DocValuesReader(Directory* directory, const char* segment, int32_t readBufferSize){
+	input = directory->openInput(docValuesFileName(segment).c_str(), readBufferSize);
+	try{
+		const int32_t format = input->readInt();
+		if ( format != DocValuesWriter::FORMAT )
+			_CLTHROWA(CL_ERR_CorruptIndex, "unknown doc values format");
+
+		input->seek(input->length() - 8);
+		input->seek(input->readLong());
+		const int32_t count = input->readVInt();
+		for ( int32_t i=0;i<count;i++ ){
+			TCHAR* name = input->readString();
+			Entry entry;
+			entry.type = input->readVInt();
+			entry.pointer = input->readLong();
+			entries.insert(EntriesType::value_type(name, entry));
+		}
+	}catch(CLuceneError&){
+		close();
+		throw;
+	}
+}
+
+DocValuesReader::~DocValuesReader(){
+	close();
+}
+
+bool DocValuesReader::exists(Directory* directory, const char* segment){
+	return directory->fileExists(docValuesFileName(segment).c_str());
+}
+
+void DocValuesReader::close(){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	if ( input != NULL ){
+		input->close();
+		_CLDELETE(input);
+	}
+	EntriesType::iterator itr = entries.begin();
+	while ( itr != entries.end() ){
+		TCHAR* name = itr->first;
+		entries.erase(itr++);
+		_CLDELETE_CARRAY(name);
+	}
+}
+
+int32_t DocValuesReader::getType(const TCHAR* field){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	EntriesType::iterator itr = entries.find(const_cast<TCHAR*>(field));
+	return itr == entries.end() ? 0 : itr->second.type;
+}
+
+const DocValuesReader::Entry* DocValuesReader::seek(const TCHAR* field, int32_t type){
+	if ( input == NULL )
+		_CLTHROWA(CL_ERR_AlreadyClosed, "this DocValuesReader is closed");
+	EntriesType::iterator itr = entries.find(const_cast<TCHAR*>(field));
+	if ( itr == entries.end() || itr->second.type != type )
+		return NULL;
+	input->seek(itr->second.pointer);
+	return &itr->second;
+}
+
+bool DocValuesReader::readInts(const TCHAR* field, int32_t* result){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	if ( seek(field, Field::DOCVALUES_INT) == NULL )
+		return false;
+	const int64_t minValue = input->readInt();
+	PackedInts packed(input);
+	const int32_t count = packed.size();
+	for ( int32_t i=0;i<count;i++ )
+		result[i] = (int32_t)(minValue + (int64_t)packed.get(i));
+	return true;
+}
+
+bool DocValuesReader::readFloats(const TCHAR* field, float_t* result){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	if ( seek(field, Field::DOCVALUES_FLOAT) == NULL )
+		return false;
+	const int32_t count = input->readVInt();
+	for ( int32_t i=0;i<count;i++ )
+		result[i] = bitsToFloat(input->readInt());
+	return true;
+}
+
+bool DocValuesReader::readStrings(const TCHAR* field, int32_t* ords, StringArrayWithDeletor& values){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	if ( seek(field, Field::DOCVALUES_STRING) == NULL )
+		return false;
+	const int32_t count = input->readVInt();
+	for ( int32_t i=0;i<count;i++ )
+		values.push_back(input->readString());
+	PackedInts packed(input);
+	const int32_t numDocs = packed.size();
+	for ( int32_t i=0;i<numDocs;i++ )
+		ords[i] = (int32_t)packed.get(i);
+	return true;
+}
+
+CL_NS_END
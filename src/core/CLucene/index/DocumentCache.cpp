@@ -0,0 +1,241 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "DocumentCache.h"
+#include <map>
+
+CL_NS_USE(util)
+CL_NS_DEF(index)
+
+struct DocumentCache::Internal: LUCENE_BASE{
+	typedef std::pair<const void*, int32_t> Key;
+
+	/** One cached document, linked into the LRU list of its partition */
+	struct Entry {
+		Key key;
+		uint8_t* data;
+		int32_t length;
+		Entry* prev;
+		Entry* next;
+	};
+
+	/** An independently locked slice of the cache with its own LRU list */
+	class Partition {
+	public:
+		typedef std::map<Key, Entry*> EntriesType;
+
+		DEFINE_MUTEX(THIS_LOCK)
+		EntriesType entries;
+		Entry* first; // most recently used
+		Entry* last;  // least recently used
+		size_t bytes;
+		int64_t hits;
+		int64_t misses;
+		int64_t evictions;
+
+		Partition():
+			first(NULL), last(NULL), bytes(0), hits(0), misses(0), evictions(0)
+		{
+		}
+		~Partition(){
+			removeAll(NULL);
+		}
+
+		void unlink(Entry* entry){
+			if (entry->prev == NULL)
+				first = entry->next;
+			else
+				entry->prev->next = entry->next;
+			if (entry->next == NULL)
+				last = entry->prev;
+			else
+				entry->next->prev = entry->prev;
+			entry->prev = entry->next = NULL;
+		}
+
+		void addToFront(Entry* entry){
+			entry->prev = NULL;
+			entry->next = first;
+			if (first == NULL)
+				last = entry;
+			else
+				first->prev = entry;
+			first = entry;
+		}
+
+		void remove(EntriesType::iterator itr){
+			Entry* entry = itr->second;
+			entries.erase(itr);
+			unlink(entry);
+			bytes -= entry->length;
+			_CLDELETE_LARRAY(entry->data);
+			delete entry;
+		}
+
+		/** removes all entries of segmentKey, or all entries if segmentKey is NULL */
+		void removeAll(const void* segmentKey){
+			EntriesType::iterator itr;
+			if (segmentKey == NULL)
+				itr = entries.begin();
+			else
+				itr = entries.lower_bound(Key(segmentKey, 0));
+			while (itr != entries.end() && (segmentKey == NULL || itr->first.first == segmentKey)){
+				EntriesType::iterator cur = itr++;
+				remove(cur);
+			}
+		}
+	};
+
+	Partition* partitions;
+	int32_t partitionCount;
+	size_t maxBytes;
+	size_t maxPartitionBytes;
+
+	Partition& partitionFor(const void* segmentKey, int32_t doc){
+		size_t h = (reinterpret_cast<size_t>(segmentKey) >> 4) * 31 + static_cast<size_t>(doc);
+		return partitions[h % partitionCount];
+	}
+};
+
+DocumentCache::DocumentCache(size_t maxBytes, int32_t partitions){
+	if ( partitions < 1 )
+		partitions = 1;
+	_internal = _CLNEW Internal;
+	_internal->partitions = new Internal::Partition[partitions];
+	_internal->partitionCount = partitions;
+	_internal->maxBytes = maxBytes;
+	_internal->maxPartitionBytes = maxBytes / partitions;
+}
+
+DocumentCache::~DocumentCache(){
+	delete [] _internal->partitions;
+	_CLDELETE(_internal);
+}
+
+bool DocumentCache::get(const void* segmentKey, int32_t doc, ValueArray<uint8_t>& buffer, int32_t& length){
+	Internal::Partition& p = _internal->partitionFor(segmentKey, doc);
+	SCOPED_LOCK_MUTEX(p.THIS_LOCK)
+
+	Internal::Partition::EntriesType::iterator itr = p.entries.find(Internal::Key(segmentKey, doc));
+	if (itr == p.entries.end()){
+		p.misses++;
+		return false;
+	}
+	Internal::Entry* entry = itr->second;
+	p.hits++;
+
+	// update LRU order
+	p.unlink(entry);
+	p.addToFront(entry);
+
+	if ( buffer.length < (size_t)entry->length )
+		buffer.resize(entry->length);
+	memcpy(buffer.values, entry->data, entry->length);
+	length = entry->length;
+	return true;
+}
+
+void DocumentCache::put(const void* segmentKey, int32_t doc, const uint8_t* data, int32_t length){
+	// documents that would fill a whole partition on their own are not worth keeping
+	if ( (size_t)length > _internal->maxPartitionBytes )
+		return;
+
+	Internal::Partition& p = _internal->partitionFor(segmentKey, doc);
+	SCOPED_LOCK_MUTEX(p.THIS_LOCK)
+
+	Internal::Key key(segmentKey, doc);
+	if ( p.entries.find(key) != p.entries.end() )
+		return; // another thread was quicker
+
+	while ( p.last != NULL && p.bytes + length > _internal->maxPartitionBytes ){
+		p.remove(p.entries.find(p.last->key));
+		p.evictions++;
+	}
+
+	Internal::Entry* entry = new Internal::Entry;
+	entry->key = key;
+	entry->data = _CL_NEWARRAY(uint8_t, length);
+	memcpy(entry->data, data, length);
+	entry->length = length;
+	p.addToFront(entry);
+	p.entries.insert(Internal::Partition::EntriesType::value_type(key, entry));
+	p.bytes += length;
+}
+
+void DocumentCache::evict(const void* segmentKey){
+	if ( segmentKey == NULL )
+		return;
+	for ( int32_t i=0;i<_internal->partitionCount;i++ ){
+		Internal::Partition& p = _internal->partitions[i];
+		SCOPED_LOCK_MUTEX(p.THIS_LOCK)
+		p.removeAll(segmentKey);
+	}
+}
+
+void DocumentCache::clear(){
+	for ( int32_t i=0;i<_internal->partitionCount;i++ ){
+		Internal::Partition& p = _internal->partitions[i];
+		SCOPED_LOCK_MUTEX(p.THIS_LOCK)
+		p.removeAll(NULL);
+	}
+}
+
+int64_t DocumentCache::getHitCount() const{
+	int64_t ret = 0;
+	for ( int32_t i=0;i<_internal->partitionCount;i++ ){
+		Internal::Partition& p = _internal->partitions[i];
+		SCOPED_LOCK_MUTEX(p.THIS_LOCK)
+		ret += p.hits;
+	}
+	return ret;
+}
+
+int64_t DocumentCache::getMissCount() const{
+	int64_t ret = 0;
+	for ( int32_t i=0;i<_internal->partitionCount;i++ ){
+		Internal::Partition& p = _internal->partitions[i];
+		SCOPED_LOCK_MUTEX(p.THIS_LOCK)
+		ret += p.misses;
+	}
+	return ret;
+}
+
+int64_t DocumentCache::getEvictionCount() const{
+	int64_t ret = 0;
+	for ( int32_t i=0;i<_internal->partitionCount;i++ ){
+		Internal::Partition& p = _internal->partitions[i];
+		SCOPED_LOCK_MUTEX(p.THIS_LOCK)
+		ret += p.evictions;
+	}
+	return ret;
+}
+
+size_t DocumentCache::size() const{
+	size_t ret = 0;
+	for ( int32_t i=0;i<_internal->partitionCount;i++ ){
+		Internal::Partition& p = _internal->partitions[i];
+		SCOPED_LOCK_MUTEX(p.THIS_LOCK)
+		ret += p.entries.size();
+	}
+	return ret;
+}
+
+size_t DocumentCache::getSizeInBytes() const{
+	size_t ret = 0;
+	for ( int32_t i=0;i<_internal->partitionCount;i++ ){
+		Internal::Partition& p = _internal->partitions[i];
+		SCOPED_LOCK_MUTEX(p.THIS_LOCK)
+		ret += p.bytes;
+	}
+	return ret;
+}
+
+size_t DocumentCache::getMaxBytes() const{
+	return _internal->maxBytes;
+}
+
+CL_NS_END
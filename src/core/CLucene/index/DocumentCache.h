@@ -0,0 +1,85 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_index_DocumentCache_
+#define _lucene_index_DocumentCache_
+
+#include "CLucene/util/Array.h"
+
+CL_NS_DEF(index)
+
+/**
+ * A bounded LRU cache of the raw stored fields (the .fdt bytes) of documents.
+ *
+ * Attach a cache to a reader with {@link IndexReader#setDocumentCache}. Every
+ * segment of the reader then serves {@link IndexReader#document} calls that load
+ * all fields (no FieldSelector) from the cache, and only seeks the .fdx and .fdt
+ * files on a miss. The documents are still decoded into fresh Field objects, so
+ * the returned Document is owned by the caller just like before.
+ *
+ * Entries are keyed by segment and document number. Stored fields of a segment
+ * never change, so entries survive {@link IndexReader#reopen} for segments that
+ * are carried over, and are dropped when the segment is closed for good. Deleted
+ * documents are rejected by the reader before the cache is consulted.
+ *
+ * The cache is split into a number of independently locked partitions, so it may
+ * be shared by any number of readers and threads. The cache is reference counted:
+ * readers hold a reference while it is attached to them.
+ */
+class CLUCENE_EXPORT DocumentCache: LUCENE_REFBASE {
+private:
+	struct Internal;
+	Internal* _internal;
+public:
+	/** Default number of partitions the cache is split into */
+	LUCENE_STATIC_CONSTANT(int32_t, DEFAULT_PARTITIONS=16);
+
+	/**
+	* @param maxBytes the maximum number of raw stored bytes kept in the cache.
+	* The least recently used documents are evicted once this is exceeded.
+	* @param partitions the number of independently locked partitions.
+	*/
+	DocumentCache(size_t maxBytes, int32_t partitions=DEFAULT_PARTITIONS);
+	virtual ~DocumentCache();
+
+	/**
+	* Copies the cached bytes of document <code>doc</code> of the segment identified
+	* by <code>segmentKey</code> into <code>buffer</code>. The buffer is grown as
+	* needed, <code>length</code> receives the number of bytes copied.
+	* @return false if the document is not cached
+	*/
+	bool get(const void* segmentKey, int32_t doc, CL_NS(util)::ValueArray<uint8_t>& buffer, int32_t& length);
+
+	/** Adds the raw stored bytes of a document to the cache. */
+	void put(const void* segmentKey, int32_t doc, const uint8_t* data, int32_t length);
+
+	/** Removes all documents of a segment from the cache. */
+	void evict(const void* segmentKey);
+
+	/** Removes all documents from the cache. Does not reset the counters. */
+	void clear();
+
+	/** Returns the number of lookups that were served from the cache */
+	int64_t getHitCount() const;
+
+	/** Returns the number of lookups that had to go to the index */
+	int64_t getMissCount() const;
+
+	/** Returns the number of documents that were evicted to make room */
+	int64_t getEvictionCount() const;
+
+	/** Returns the number of documents currently held */
+	size_t size() const;
+
+	/** Returns the number of raw stored bytes currently held */
+	size_t getSizeInBytes() const;
+
+	/** Returns the maximum number of bytes this cache will hold */
+	size_t getMaxBytes() const;
+};
+
+CL_NS_END
+#endif
@@ -33,6 +33,7 @@
 #include "_TermInfosWriter.h"
 #include "_FieldsWriter.h"
 #include "_DocumentsWriter.h"
+#include "_DocValues.h"
 #include <assert.h>
 #include <algorithm>
 #include <iostream>
@@ -91,6 +92,8 @@ DocumentsWriter::DocumentsWriter(CL_NS(store)::Directory* directory, IndexWriter
   this->writer = writer;
   this->hasNorms = this->bufferIsFull = false;
   fieldInfos = _CLNEW FieldInfos();
+  docValues = _CLNEW DocValuesWriter();
+  indexSort = NULL;
 
 	maxBufferedDeleteTerms = IndexWriter::DEFAULT_MAX_BUFFERED_DELETE_TERMS;
 	ramBufferSize = (int64_t) (IndexWriter::DEFAULT_RAM_BUFFER_SIZE_MB*1024*1024);
@@ -116,6 +119,8 @@ DocumentsWriter::~DocumentsWriter(){
   _CLDELETE_LARRAY(copyByteBuffer);
   _CLLDELETE(_files);
   _CLLDELETE(fieldInfos);
+  _CLLDELETE(docValues);
+  _CLLDELETE(indexSort);
 
   for(size_t i=0;i<threadStates.length;i++) {
     _CLLDELETE(threadStates.values[i]);
@@ -160,6 +165,21 @@ int32_t DocumentsWriter::getMaxBufferedDocs() {
   return maxBufferedDocs;
 }
 
+void DocumentsWriter::setIndexSort(const TCHAR* field, bool reverse) {
+  SCOPED_LOCK_MUTEX(THIS_LOCK)
+  _CLLDELETE(indexSort);
+  if (field != NULL)
+    indexSort = _CLNEW IndexSortChecker(field, reverse);
+}
+
+const TCHAR* DocumentsWriter::getIndexSortField() {
+  return indexSort == NULL ? NULL : indexSort->getField();
+}
+
+bool DocumentsWriter::getIndexSortReverse() {
+  return indexSort != NULL && indexSort->getReverse();
+}
+
 std::string DocumentsWriter::getSegment() {
   return segment;
 }
@@ -362,6 +382,9 @@ void DocumentsWriter::abort(AbortException* ae) {
         }
       }
 
+      // Discard pending doc values:
+      docValues->reset();
+
       // Reset all postings data
       resetPostingsData();
 
@@ -620,6 +643,12 @@ void DocumentsWriter::writeSegment(std::vector<std::string>& flushedFiles) {
     flushedFiles.push_back(segmentFileName(IndexFileNames::NORMS_EXTENSION));
   }
 
+  if (!docValues->empty()) {
+    docValues->write(directory, segmentName.c_str(), numDocsInRAM);
+    docValues->reset();
+    flushedFiles.push_back(segmentFileName(IndexFileNames::DOC_VALUES_EXTENSION));
+  }
+
   if (infoStream != NULL) {
     const int64_t newSegmentSize = segmentSize(segmentName);
 
@@ -31,6 +31,7 @@
 #include "_TermInfosWriter.h"
 #include "_FieldsWriter.h"
 #include "_DocumentsWriter.h"
+#include "_DocValues.h"
 #include <assert.h>
 #include <iostream>
 
@@ -343,6 +344,51 @@ void DocumentsWriter::ThreadState::init(Document* doc, int32_t docID) {
 
     numVectorFields = 0;
   }
+
+  addDocValues(doc);
+}
+
+void DocumentsWriter::ThreadState::addDocValues(Document* doc) {
+  // We hold the parent's lock here, so the values can go straight into the
+  // columns at our docID. Check all fields first, so that a bad field does
+  // not leave part of its document behind.
+  DocValuesWriter* docValues = _parent->docValues;
+  const Document::FieldsType& docFields = *doc->getFields();
+  const int32_t numDocFields = docFields.size();
+  bool hasDocValues = false;
+  for(int32_t i=0;i<numDocFields;i++) {
+    Field* field = docFields[i];
+    const int32_t type = field->getDocValuesType();
+    if (type == 0)
+      continue;
+    if (field->stringValue() == NULL)
+      _CLTHROWA(CL_ERR_IllegalArgument, "doc values require a string field value");
+    const int32_t current = docValues->getType(field->name());
+    if (current != 0 && current != type)
+      _CLTHROWA(CL_ERR_IllegalArgument, "field was already added with another type of doc values");
+    hasDocValues = true;
+  }
+  if (_parent->indexSort != NULL)
+    _parent->indexSort->add(doc);
+  if (!hasDocValues)
+    return;
+
+  for(int32_t i=0;i<numDocFields;i++) {
+    Field* field = docFields[i];
+    switch (field->getDocValuesType()) {
+    case Field::DOCVALUES_INT:
+      docValues->setInt(field->name(), docID, _ttoi(field->stringValue()));
+      break;
+    case Field::DOCVALUES_FLOAT:
+      docValues->setFloat(field->name(), docID, _tcstod(field->stringValue(), NULL));
+      break;
+    case Field::DOCVALUES_STRING:
+      docValues->setString(field->name(), docID, field->stringValue());
+      break;
+    default:
+      break;
+    }
+  }
 }
 
 void DocumentsWriter::ThreadState::doPostingSort(Posting** postings, int32_t numPosting) {
@@ -17,6 +17,7 @@
 #include "_FieldInfos.h"
 #include "_FieldsWriter.h"
 #include "_FieldsReader.h"
+#include "DocumentCache.h"
 #include "CLucene/analysis/AnalysisHeader.h"
 #include <sstream>
 
@@ -124,6 +125,76 @@ bool FieldsReader::doc(int32_t n, Document& doc, const CL_NS(document)::FieldSel
 	int64_t position = indexStream->readLong();
 	fieldsStream->seek(position);
 
+	readFields(doc, fieldSelector);
+	return true;
+}
+
+bool FieldsReader::doc(int32_t n, Document& doc, DocumentCache* cache, const void* cacheKey) {
+  if ( (n + docStoreOffset) * 8L > indexStream->length() )
+      return false;
+
+	int32_t length = 0;
+	if ( !cache->get(cacheKey, n, docBuffer, length) ){
+		rawDocs(&length, n, 1);
+		if ( docBuffer.length < (size_t)length )
+			docBuffer.resize(length);
+		fieldsStream->readBytes(docBuffer.values, length);
+		cache->put(cacheKey, n, docBuffer.values, length);
+	}
+
+	// decode from memory, using the same field readers as a load from disk
+	IndexInput* stream = fieldsStream;
+	DocBuffer buffer(docBuffer.values, length, 0);
+	fieldsStream = &buffer;
+	try{
+		readFields(doc, NULL);
+	}_CLFINALLY( fieldsStream = stream; )
+	return true;
+}
+
+bool FieldsReader::docs(const int32_t* docs, Document** result, size_t count, const FieldSelector* fieldSelector) {
+	bool ret = true;
+	ValueArray<int32_t> lengths(MAX_BATCH_DOCS);
+	IndexInput* stream = fieldsStream;
+	size_t i = 0;
+	try{
+		while ( i < count ){
+			if ( docs[i] < 0 || docs[i] >= _size ){
+				ret = false;
+				i++;
+				continue;
+			}
+
+			// find the run of consecutive documents starting at docs[i]
+			size_t j = i+1;
+			while ( j < count && (int32_t)(j - i) < MAX_BATCH_DOCS && docs[j] == docs[j-1] + 1 && docs[j] < _size )
+				j++;
+			const int32_t run = (int32_t)(j - i);
+
+			rawDocs(lengths.values, docs[i], run);
+			const int64_t start = stream->getFilePointer();
+			int32_t total = 0;
+			for ( int32_t k=0;k<run;k++ )
+				total += lengths[k];
+			if ( docBuffer.length < (size_t)total )
+				docBuffer.resize(total);
+			stream->readBytes(docBuffer.values, total);
+
+			int32_t offset = 0;
+			for ( int32_t k=0;k<run;k++ ){
+				DocBuffer buffer(docBuffer.values + offset, lengths[k], start + offset);
+				fieldsStream = &buffer;
+				readFields(*result[i+k], fieldSelector);
+				fieldsStream = stream;
+				offset += lengths[k];
+			}
+			i = j;
+		}
+	}_CLFINALLY( fieldsStream = stream; )
+	return ret;
+}
+
+void FieldsReader::readFields(Document& doc, const CL_NS(document)::FieldSelector* fieldSelector) {
 	int32_t numFields = fieldsStream->readVInt();
 	for (int32_t i = 0; i < numFields; i++) {
 		const int32_t fieldNumber = fieldsStream->readVInt();
@@ -165,7 +236,6 @@ bool FieldsReader::doc(int32_t n, Document& doc, const CL_NS(document)::FieldSel
 			skipField(binary, compressed);
 		}
 	}
-	return true;
 }
 
 CL_NS(store)::IndexInput* FieldsReader::rawDocs(int32_t* lengths, const int32_t startDocID, const int32_t numDocs) {
@@ -548,6 +618,51 @@ const char* FieldsReader::FieldForMerge::getObjectName() const{
   return getClassName();
 }
 
+FieldsReader::DocBuffer::DocBuffer(const uint8_t* _data, const int32_t length, const int64_t _pointer):
+  data(_data), pointer(_pointer), pos(0), _length(length)
+{
+}
+FieldsReader::DocBuffer::~DocBuffer(){
+}
+void FieldsReader::DocBuffer::close(){
+  data = NULL;
+  _length = 0;
+}
+int64_t FieldsReader::DocBuffer::getFilePointer() const{
+  return pointer + pos;
+}
+int64_t FieldsReader::DocBuffer::length() const{
+  return _length;
+}
+uint8_t FieldsReader::DocBuffer::readByte(){
+  if ( pos >= _length )
+    _CLTHROWA(CL_ERR_IO, "read past EOF");
+  return data[pos++];
+}
+void FieldsReader::DocBuffer::readBytes(uint8_t* b, const int32_t len){
+  if ( len > _length - pos )
+    _CLTHROWA(CL_ERR_IO, "read past EOF");
+  memcpy(b, data+pos, len);
+  pos += len;
+}
+void FieldsReader::DocBuffer::seek(const int64_t _pos){
+  if ( _pos < pointer || _pos > pointer + _length )
+    _CLTHROWA(CL_ERR_IO, "seek past EOF");
+  pos = static_cast<int32_t>(_pos - pointer);
+}
+CL_NS(store)::IndexInput* FieldsReader::DocBuffer::clone() const{
+  return _CLNEW DocBuffer(*this);
+}
+const char* FieldsReader::DocBuffer::getDirectoryType() const{
+  return "DOC";
+}
+const char* FieldsReader::DocBuffer::getClassName(){
+  return "FieldsReader::DocBuffer";
+}
+const char* FieldsReader::DocBuffer::getObjectName() const{
+  return getClassName();
+}
+
 void FieldsReader::uncompress(const CL_NS(util)::ValueArray<uint8_t>& input, CL_NS(util)::ValueArray<uint8_t>& output){
   stringstream out;
   string err;
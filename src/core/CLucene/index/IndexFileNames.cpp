@@ -33,6 +33,7 @@ CL_NS_DEF(index)
 	const char* IndexFileNames::PLAIN_NORMS_EXTENSION = "f";
 	const char* IndexFileNames::SEPARATE_NORMS_EXTENSION = "s";
 	const char* IndexFileNames::GEN_EXTENSION = "gen";
+	const char* IndexFileNames::DOC_VALUES_EXTENSION = "dv";
   
 	const char* IndexFileNames_INDEX_EXTENSIONS_s[] =
 		{
@@ -50,14 +51,15 @@ CL_NS_DEF(index)
 			IndexFileNames::VECTORS_FIELDS_EXTENSION,
 			IndexFileNames::GEN_EXTENSION,
 			IndexFileNames::NORMS_EXTENSION,
-			IndexFileNames::COMPOUND_FILE_STORE_EXTENSION
+			IndexFileNames::COMPOUND_FILE_STORE_EXTENSION,
+			IndexFileNames::DOC_VALUES_EXTENSION
 		};
   
 	CL_NS(util)::ConstValueArray<const char*> IndexFileNames::_INDEX_EXTENSIONS;
   CL_NS(util)::ConstValueArray<const char*>& IndexFileNames::INDEX_EXTENSIONS(){
     if ( _INDEX_EXTENSIONS.length == 0 ){
       _INDEX_EXTENSIONS.values = IndexFileNames_INDEX_EXTENSIONS_s;
-      _INDEX_EXTENSIONS.length = 15;
+      _INDEX_EXTENSIONS.length = 16;
     }
     return _INDEX_EXTENSIONS;
   }
@@ -73,13 +75,14 @@ CL_NS_DEF(index)
 		IndexFileNames::VECTORS_INDEX_EXTENSION,
 		IndexFileNames::VECTORS_DOCUMENTS_EXTENSION,
 		IndexFileNames::VECTORS_FIELDS_EXTENSION,
-		IndexFileNames::NORMS_EXTENSION
+		IndexFileNames::NORMS_EXTENSION,
+		IndexFileNames::DOC_VALUES_EXTENSION
 	};
 	CL_NS(util)::ConstValueArray<const char*> IndexFileNames::_INDEX_EXTENSIONS_IN_COMPOUND_FILE;
   CL_NS(util)::ConstValueArray<const char*>& IndexFileNames::INDEX_EXTENSIONS_IN_COMPOUND_FILE(){
     if ( _INDEX_EXTENSIONS_IN_COMPOUND_FILE.length == 0 ){
       _INDEX_EXTENSIONS_IN_COMPOUND_FILE.values = IndexFileNames_INDEX_EXTENSIONS_IN_COMPOUND_FILE_s;
-      _INDEX_EXTENSIONS_IN_COMPOUND_FILE.length = 11;
+      _INDEX_EXTENSIONS_IN_COMPOUND_FILE.length = 12;
     }
     return _INDEX_EXTENSIONS_IN_COMPOUND_FILE;
   }
@@ -106,13 +109,14 @@ CL_NS_DEF(index)
 		IndexFileNames::PROX_EXTENSION,
 		IndexFileNames::TERMS_EXTENSION,
 		IndexFileNames::TERMS_INDEX_EXTENSION,
-		IndexFileNames::NORMS_EXTENSION
+		IndexFileNames::NORMS_EXTENSION,
+		IndexFileNames::DOC_VALUES_EXTENSION
 	};
 	CL_NS(util)::ConstValueArray<const char*> IndexFileNames::_NON_STORE_INDEX_EXTENSIONS;
   CL_NS(util)::ConstValueArray<const char*>& IndexFileNames::NON_STORE_INDEX_EXTENSIONS(){
     if ( _NON_STORE_INDEX_EXTENSIONS.length == 0 ){
       _NON_STORE_INDEX_EXTENSIONS.values = IndexFileNames_NON_STORE_INDEX_EXTENSIONS_s;
-      _NON_STORE_INDEX_EXTENSIONS.length = 6;
+      _NON_STORE_INDEX_EXTENSIONS.length = 7;
     }
     return _NON_STORE_INDEX_EXTENSIONS;
   }
@@ -17,11 +17,14 @@
 #include "_SegmentInfos.h"
 #include "_SegmentHeader.h"
 #include "MultiReader.h"
+#include "DocumentCache.h"
 #include "Terms.h"
 #include <assert.h>
+#include <algorithm>
 
 CL_NS_USE(util)
 CL_NS_USE(store)
+CL_NS_USE(document)
 CL_NS_DEF(index)
 
 
@@ -61,7 +64,10 @@ CL_NS_DEF(index)
       CloseCallbackCompare> CloseCallbackMap;
     CloseCallbackMap closeCallbacks;
 
-    Internal(Directory* directory, IndexReader* _this)
+    DocumentCache* documentCache;
+
+    Internal(Directory* directory, IndexReader* _this):
+      documentCache(NULL)
     {
       if ( directory != NULL )
         this->directory = _CL_POINTER(directory);
@@ -71,6 +77,7 @@ CL_NS_DEF(index)
       _this->hasChanges = false;
     }
     ~Internal(){
+      _CLDECDELETE(documentCache);
     }
   };
 
@@ -189,6 +196,10 @@ CL_NS_DEF(index)
     _CLTHROWA(CL_ERR_UnsupportedOperation, "This reader does not support this method.");
   }
 
+  void IndexReader::getTermInfosCacheStats(int64_t& hits, int64_t& misses) {
+    hits = misses = 0;
+  }
+
   bool IndexReader::isCurrent() {
     _CLTHROWA(CL_ERR_UnsupportedOperation, "This reader does not support this method.");
   }
@@ -300,6 +311,64 @@ CL_NS_DEF(index)
     return document(n, doc, NULL);
   }
 
+  bool IndexReader::documents(const ArrayBase<int32_t>& docs, ObjectArray<Document>& result,
+      const FieldSelector* fieldSelector){
+    ensureOpen();
+
+    const size_t count = docs.length;
+    const int32_t max = maxDoc();
+    for ( size_t i=0;i<count;i++ ){
+      if ( docs.values[i] < 0 || docs.values[i] >= max )
+        _CLTHROWA(CL_ERR_IndexOutOfBounds, "document number is out of range");
+    }
+    if ( result.values == NULL || result.length != count ){
+      result.deleteValues();
+      result.values = _CL_NEWARRAY(Document*, count);
+      result.length = count;
+    }
+
+    // sort the requests into index order, remembering where each one goes
+    std::vector< std::pair<int32_t, size_t> > order(count);
+    for ( size_t i=0;i<count;i++ )
+      order[i] = std::pair<int32_t, size_t>(docs.values[i], i);
+    std::sort(order.begin(), order.end());
+
+    ValueArray<int32_t> sortedDocs(count);
+    ValueArray<Document*> sortedResult(count);
+    for ( size_t i=0;i<count;i++ ){
+      Document*& doc = result.values[order[i].second];
+      if ( doc == NULL )
+        doc = _CLNEW Document;
+      else
+        doc->clear();
+      sortedDocs[i] = order[i].first;
+      sortedResult[i] = doc;
+    }
+
+    return doDocuments(sortedDocs.values, sortedResult.values, count, fieldSelector);
+  }
+
+  bool IndexReader::doDocuments(const int32_t* docs, Document** result, size_t count,
+      const FieldSelector* fieldSelector){
+    bool ret = true;
+    for ( size_t i=0;i<count;i++ ){
+      if ( !document(docs[i], *result[i], fieldSelector) )
+        ret = false;
+    }
+    return ret;
+  }
+
+  void IndexReader::setDocumentCache(DocumentCache* cache){
+    if ( cache == _internal->documentCache )
+      return;
+    _CLDECDELETE(_internal->documentCache);
+    _internal->documentCache = _CL_POINTER(cache);
+  }
+
+  DocumentCache* IndexReader::getDocumentCache() const{
+    return _internal->documentCache;
+  }
+
   void IndexReader::deleteDoc(const int32_t docNum){
     deleteDocument(docNum);
   }
@@ -449,6 +518,26 @@ bool IndexReader::hasNorms(const TCHAR* field) {
 	return norms(field) != NULL;
 }
 
+int32_t IndexReader::getDocValuesType(const TCHAR* /*field*/){
+  return 0;
+}
+
+const ArrayBase<IndexReader*>* IndexReader::getSequentialSubReaders() const{
+  return NULL;
+}
+
+bool IndexReader::getDocValues(const TCHAR* /*field*/, int32_t* /*result*/){
+  return false;
+}
+
+bool IndexReader::getDocValues(const TCHAR* /*field*/, float_t* /*result*/){
+  return false;
+}
+
+bool IndexReader::getDocValues(const TCHAR* /*field*/, int32_t* /*ords*/, StringArrayWithDeletor& /*values*/){
+  return false;
+}
+
 void IndexReader::unlock(const char* path){
 	FSDirectory* dir = FSDirectory::getDirectory(path);
 	unlock(dir);
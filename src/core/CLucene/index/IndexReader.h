@@ -26,6 +26,7 @@ class TermDocs;
 class TermPositions;
 class IndexDeletionPolicy;
 class TermVectorMapper;
+class DocumentCache;
 
 /** IndexReader is an abstract class, providing an interface for accessing an
  index.  Search of an index is done entirely through this abstract interface,
@@ -98,6 +99,14 @@ protected:
    *  index modifications must implement this method. */
   virtual void acquireWriteLock();
 
+  /**
+  * Implements {@link #documents}. <code>docs</code> holds <code>count</code> document
+  * numbers in ascending order, the stored fields of <code>docs[i]</code> are added to
+  * <code>result[i]</code>. The default implementation loads one document at a time.
+  */
+  virtual bool doDocuments(const int32_t* docs, CL_NS(document)::Document** result, size_t count,
+    const CL_NS(document)::FieldSelector* fieldSelector);
+
 public:
 	//Callback for classes that need to know if IndexReader is closing.
 	typedef void (*CloseCallback)(IndexReader*, void*);
@@ -371,6 +380,15 @@ public:
    *  @see #setTermInfosIndexDivisor */
   int32_t getTermInfosIndexDivisor();
 
+  /** <p>For IndexReader implementations that use
+   *  TermInfosReader to read terms, this returns how many term
+   *  lookups were served from the per segment cache of recently
+   *  used terms (hits), and how many had to search the term
+   *  dictionary (misses), summed over all segments. Other
+   *  readers return 0 for both.</p>
+   */
+  virtual void getTermInfosCacheStats(int64_t& hits, int64_t& misses);
+
   /**
    * Check whether this IndexReader is still using the
    * current (i.e., most recently committed) version of the
@@ -514,6 +532,39 @@ public:
 
 	_CL_DEPRECATED( document(i, document) ) CL_NS(document)::Document* document(const int32_t n);
 
+  /**
+   * Gets the stored fields of a batch of documents. The documents are loaded in
+   * index order, so that each segment's stored fields are read front to back with
+   * neighbouring documents fetched together, rather than seeking around in the order
+   * the caller happens to need them (such as score order).
+   * <p>
+   * On return <code>result[i]</code> holds the document numbered <code>docs[i]</code>.
+   * If <code>result</code> already has the same length as <code>docs</code> its
+   * Document objects are cleared and reused, otherwise its contents are deleted and
+   * it is reallocated.
+   *
+   * @param fieldSelector determines which fields are loaded, may be NULL to load all fields
+   * @return false if any of the documents could not be loaded
+   * @throws CL_ERR_InvalidState if one of the documents is deleted
+   * @throws CL_ERR_IndexOutOfBounds if one of the document numbers is not in [0, maxDoc())
+   * @see #document(int32_t, Document&, const FieldSelector*)
+   */
+  bool documents(const CL_NS(util)::ArrayBase<int32_t>& docs, CL_NS(util)::ObjectArray<CL_NS(document)::Document>& result,
+    const CL_NS(document)::FieldSelector* fieldSelector = NULL);
+
+  /**
+   * Attaches a cache of raw stored fields to this reader and all of its segments.
+   * Only documents that are loaded completely (without a FieldSelector) go through
+   * the cache. The reader keeps a reference to the cache until it is closed or a
+   * different cache is set; pass NULL to detach the current cache. Readers returned
+   * by {@link #reopen()} inherit the cache.
+   * @see DocumentCache
+   */
+  virtual void setDocumentCache(DocumentCache* cache);
+
+  /** Returns the document cache attached to this reader, or NULL if there is none */
+  DocumentCache* getDocumentCache() const;
+
 	/** Returns true if document <i>n</i> has been deleted */
   	virtual bool isDeleted(const int32_t n) = 0;
 
@@ -523,6 +574,45 @@ public:
 	/** Returns true if there are norms stored for this field. */
 	virtual bool hasNorms(const TCHAR* field);
 
+	/**
+	* Returns the type of the doc values column of field (one of the
+	* {@link Field::DocValues} values), or 0 if the field has no doc values
+	* column in this reader.
+	* @see Field::DocValues
+	*/
+	virtual int32_t getDocValuesType(const TCHAR* field);
+
+	/**
+	* Reads the int doc values of field into result, which must hold {@link #maxDoc()}
+	* values. Documents without a value get 0.
+	* @return false if the field has no int doc values in this reader
+	*/
+	virtual bool getDocValues(const TCHAR* field, int32_t* result);
+
+	/**
+	* Reads the float doc values of field into result, which must hold {@link #maxDoc()}
+	* values. Documents without a value get 0.
+	* @return false if the field has no float doc values in this reader
+	*/
+	virtual bool getDocValues(const TCHAR* field, float_t* result);
+
+	/**
+	* Reads the string doc values of field. The distinct values are appended to values
+	* in sorted order, and ords ({@link #maxDoc()} values) receives the ord of each
+	* document: 0 if the document has no value, otherwise n for values[n-1].
+	* @return false if the field has no string doc values in this reader
+	*/
+	virtual bool getDocValues(const TCHAR* field, int32_t* ords, StringArrayWithDeletor& values);
+
+	/**
+	* Expert: returns the readers this reader is composed of, in document order,
+	* or NULL if this reader reads a single segment. The documents of each sub
+	* reader follow directly on those of the previous one. Sub readers may be
+	* composed of other readers themselves.
+	* @memory The array and its readers belong to this reader
+	*/
+	virtual const CL_NS(util)::ArrayBase<IndexReader*>* getSequentialSubReaders() const;
+
 /** Returns an enumeration of all the terms in the index. The
   * enumeration is ordered by Term.compareTo(). Each term is greater
   * than all that precede it in the enumeration. Note that after
@@ -15,6 +15,7 @@
 #include "CLucene/store/_Lock.h"
 #include "CLucene/store/_RAMDirectory.h"
 #include "CLucene/store/FSDirectory.h"
+#include "CLucene/store/RateLimiter.h"
 #include "CLucene/util/Array.h"
 #include "CLucene/util/PriorityQueue.h"
 #include "_DocumentsWriter.h"
@@ -58,8 +59,13 @@ const int32_t IndexWriter::MAX_TERM_LENGTH = DocumentsWriter::MAX_TERM_LENGTH;
 class IndexWriter::Internal{
 public:
   IndexWriter* _this;
+  RateLimiter* mergeRateLimiter; // all merges write through it, so a new rate applies to running merges
   Internal(IndexWriter* _this){
     this->_this = _this;
+    this->mergeRateLimiter = _CLNEW RateLimiter(0);
+  }
+  ~Internal(){
+    _CLDELETE(mergeRateLimiter);
   }
   // Apply buffered delete terms to the segment just flushed from ram
   // apply appropriately so that a delete term is only applied to
@@ -297,6 +303,25 @@ MergePolicy* IndexWriter::getMergePolicy() {
   return mergePolicy;
 }
 
+void IndexWriter::setMaxMergeMBPerSec(double mbPerSec) {
+  ensureOpen();
+  SCOPED_LOCK_MUTEX(THIS_LOCK)
+  _internal->mergeRateLimiter->setMbPerSec(mbPerSec);
+  if (infoStream != NULL)
+    message( string("setMaxMergeMBPerSec ") + Misc::toString((float_t)mbPerSec));
+}
+
+double IndexWriter::getMaxMergeMBPerSec() {
+  ensureOpen();
+  SCOPED_LOCK_MUTEX(THIS_LOCK)
+  return _internal->mergeRateLimiter->getMbPerSec();
+}
+
+RateLimiter* IndexWriter::getMergeRateLimiter() {
+  SCOPED_LOCK_MUTEX(THIS_LOCK)
+  return _internal->mergeRateLimiter;
+}
+
 void IndexWriter::setMergeScheduler(MergeScheduler* mergeScheduler) {
   ensureOpen();
   if (mergeScheduler == NULL)
@@ -337,6 +362,23 @@ int32_t IndexWriter::getMaxFieldLength() {
   return maxFieldLength;
 }
 
+void IndexWriter::setIndexSort(const TCHAR* field, bool reverse) {
+  ensureOpen();
+  docWriter->setIndexSort(field, reverse);
+  if (infoStream != NULL)
+    message( string("setIndexSort ") + (field == NULL ? "none" : (reverse ? "reverse" : "ascending")) );
+}
+
+const TCHAR* IndexWriter::getIndexSortField() {
+  ensureOpen();
+  return docWriter->getIndexSortField();
+}
+
+bool IndexWriter::getIndexSortReverse() {
+  ensureOpen();
+  return docWriter->getIndexSortReverse();
+}
+
 void IndexWriter::setMaxBufferedDocs(int32_t maxBufferedDocs) {
   ensureOpen();
   if (maxBufferedDocs != DISABLE_AUTO_FLUSH && maxBufferedDocs < 2)
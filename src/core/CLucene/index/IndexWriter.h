@@ -14,6 +14,7 @@ CL_CLASS_DEF(store,Lock)
 CL_CLASS_DEF(analysis,Analyzer)
 CL_CLASS_DEF(store,Directory)
 CL_CLASS_DEF(store,LuceneLock)
+CL_CLASS_DEF(store,RateLimiter)
 CL_CLASS_DEF(document,Document)
 
 #include "MergePolicy.h"
@@ -308,6 +309,26 @@ public:
    */
   void setMaxFieldLength(int32_t val);
 
+  /**
+   * Declares that documents are added in the order of the doc values of
+   * field, ascending or (if reverse is true) descending. Documents without
+   * a value sort as 0 or, for string doc values, before all other values.
+   * From then on, adding a document that sorts before the previously added
+   * one throws an IllegalArgument error and the document is not added.
+   * Pass NULL to remove the requirement.
+   * <p>Since merges only combine adjacent segments, the order carries over
+   * to the merged segments. Searches sorted by this field can then stop
+   * after the first matches of each reader, see
+   * {@link IndexSearcher#setEarlyTermination}. The sort should be set before
+   * the first document is added; documents already in the index and
+   * indexes added with {@link #addIndexes} are not checked.</p>
+   */
+  void setIndexSort(const TCHAR* field, bool reverse=false);
+  /** Returns the field set with {@link #setIndexSort}, or NULL */
+  const TCHAR* getIndexSortField();
+  /** @see #setIndexSort */
+  bool getIndexSortReverse();
+
   /** Determines the minimal number of documents required before the buffered
    * in-memory documents are merging and a new Segment is created.
    * Since Documents are merged in a {@link RAMDirectory},
@@ -664,6 +685,25 @@ public:
    */
   void setMergeScheduler(MergeScheduler* mergeScheduler);
 
+  /**
+   * Limits how fast merges write their segments, in MB per second, so that
+   * large merges leave disk bandwidth to flushes and searches, which are never
+   * limited. The rate is shared by all running merges and may be changed while
+   * they run. 0, the default, means no limit.
+   */
+  void setMaxMergeMBPerSec(double mbPerSec);
+
+  /** @see #setMaxMergeMBPerSec */
+  double getMaxMergeMBPerSec();
+
+  /**
+   * Returns the limiter merges write through, which also counts how long merges
+   * were paused. Merges write through it even without a limit, so that a rate
+   * set later applies to the merges already running.
+   * @see #setMaxMergeMBPerSec
+   */
+  CL_NS(store)::RateLimiter* getMergeRateLimiter();
+
   /** Determines the amount of RAM that may be used for
    * buffering added documents before they are flushed as a
    * new Segment.  Generally for faster indexing performance
@@ -110,6 +110,7 @@ IndexReader* MultiReader::reopen() {
 
     if (reopened) {
       MultiReader* mr = _CLNEW MultiReader(&newSubReaders);
+      mr->setDocumentCache(getDocumentCache());
 
       for (size_t i = 0; i < subReaders->length; i++) {
         if (newSubReaders[i] == (*subReaders)[i]) {
@@ -197,6 +198,32 @@ bool MultiReader::document(int32_t n, CL_NS(document)::Document& doc, const Fiel
 	return (*subReaders)[i]->document(n - starts[i],doc, fieldSelector);	  // dispatch to segment reader
 }
 
+bool MultiReader::doDocuments(const int32_t* docs, CL_NS(document)::Document** result, size_t count,
+    const FieldSelector* fieldSelector){
+  ensureOpen();
+  return MultiSegmentReader::doDocuments(docs, result, count, fieldSelector, subReaders, starts);
+}
+
+void MultiReader::setDocumentCache(DocumentCache* cache){
+  IndexReader::setDocumentCache(cache);
+  for (size_t i = 0; i < subReaders->length; i++){
+    if ( (*subReaders)[i] != NULL )
+      (*subReaders)[i]->setDocumentCache(cache);
+  }
+}
+
+void MultiReader::getTermInfosCacheStats(int64_t& hits, int64_t& misses){
+  hits = misses = 0;
+  for (size_t i = 0; i < subReaders->length; i++){
+    if ( (*subReaders)[i] == NULL )
+      continue;
+    int64_t h, m;
+    (*subReaders)[i]->getTermInfosCacheStats(h, m);
+    hits += h;
+    misses += m;
+  }
+}
+
 bool MultiReader::isDeleted(const int32_t n) {
     // Don't call ensureOpen() here (it could affect performance)
 	int32_t i = readerIndex(n);			  // find segment num
@@ -211,6 +238,9 @@ bool MultiReader::hasDeletions() const{
 const ArrayBase<IndexReader*>* MultiReader::getSubReaders() const{
   return subReaders;
 }
+const ArrayBase<IndexReader*>* MultiReader::getSequentialSubReaders() const{
+  return subReaders;
+}
 
 uint8_t* MultiReader::norms(const TCHAR* field){
 	SCOPED_LOCK_MUTEX(THIS_LOCK)
@@ -331,6 +361,26 @@ void MultiReader::doClose() {
 }
 
 
+int32_t MultiReader::getDocValuesType(const TCHAR* field){
+  ensureOpen();
+  return MultiSegmentReader::getDocValuesType(field, subReaders);
+}
+
+bool MultiReader::getDocValues(const TCHAR* field, int32_t* result){
+  ensureOpen();
+  return MultiSegmentReader::getDocValues(field, result, subReaders, starts);
+}
+
+bool MultiReader::getDocValues(const TCHAR* field, float_t* result){
+  ensureOpen();
+  return MultiSegmentReader::getDocValues(field, result, subReaders, starts);
+}
+
+bool MultiReader::getDocValues(const TCHAR* field, int32_t* ords, StringArrayWithDeletor& values){
+  ensureOpen();
+  return MultiSegmentReader::getDocValues(field, ords, values, subReaders, starts);
+}
+
 void MultiReader::getFieldNames(FieldOption fieldNames, StringArrayWithDeletor& retarray){
     ensureOpen();
     return MultiSegmentReader::getFieldNames(fieldNames, retarray, this->subReaders);
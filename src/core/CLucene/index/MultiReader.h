@@ -36,6 +36,8 @@ protected:
 	void doCommit();
 	void doClose();
 	void doDelete(const int32_t n);
+  bool doDocuments(const int32_t* docs, CL_NS(document)::Document** result, size_t count,
+    const CL_NS(document)::FieldSelector* fieldSelector);
 public:
 	/**
 	* <p>Construct a MultiReader aggregating the named set of (sub)readers.
@@ -90,10 +92,18 @@ public:
 	int32_t numDocs();
 	int32_t maxDoc() const;
   bool document(int32_t n, CL_NS(document)::Document& doc, const CL_NS(document)::FieldSelector* fieldSelector);
+
+  /** Sets the cache on this reader and all subreaders */
+  void setDocumentCache(DocumentCache* cache);
+  void getTermInfosCacheStats(int64_t& hits, int64_t& misses);
 	bool isDeleted(const int32_t n);
 	bool hasDeletions() const;
 	uint8_t* norms(const TCHAR* field);
 	void norms(const TCHAR* field, uint8_t* result);
+	int32_t getDocValuesType(const TCHAR* field);
+	bool getDocValues(const TCHAR* field, int32_t* result);
+	bool getDocValues(const TCHAR* field, float_t* result);
+	bool getDocValues(const TCHAR* field, int32_t* ords, StringArrayWithDeletor& values);
 	TermEnum* terms();
 	TermEnum* terms(const Term* term);
 
@@ -119,6 +129,7 @@ public:
   int64_t getVersion();
 
   const CL_NS(util)::ArrayBase<IndexReader*>* getSubReaders() const;
+  const CL_NS(util)::ArrayBase<IndexReader*>* getSequentialSubReaders() const;
 
   static const char* getClassName();
   const char* getObjectName() const;
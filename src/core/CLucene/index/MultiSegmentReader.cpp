@@ -17,6 +17,8 @@
 #include "_SegmentMergeQueue.h"
 #include "MultiReader.h"
 #include "_MultiSegmentReader.h"
+#include "CLucene/document/Field.h"
+#include <algorithm>
 
 CL_NS_USE(document)
 CL_NS_USE(store)
@@ -264,6 +266,47 @@ bool MultiSegmentReader::document(int32_t n, CL_NS(document)::Document& doc, con
 	return (*subReaders)[i]->document(n - starts[i],doc, fieldSelector);	  // dispatch to segment reader
 }
 
+bool MultiSegmentReader::doDocuments(const int32_t* docs, CL_NS(document)::Document** result, size_t count,
+    const FieldSelector* fieldSelector){
+  ensureOpen();
+  return doDocuments(docs, result, count, fieldSelector, subReaders, starts);
+}
+
+bool MultiSegmentReader::doDocuments(const int32_t* docs, CL_NS(document)::Document** result, size_t count,
+    const FieldSelector* fieldSelector, CL_NS(util)::ArrayBase<IndexReader*>* subReaders, int32_t* starts){
+  const int32_t numSubReaders = (int32_t)subReaders->length;
+  const int32_t maxDoc = starts[numSubReaders];
+  for ( size_t i=0;i<count;i++ ){
+    if ( docs[i] < 0 || docs[i] >= maxDoc )
+      _CLTHROWA(CL_ERR_IndexOutOfBounds, "document number is out of range");
+  }
+
+  // dispatch each run of documents that falls into the same subreader
+  CL_NS(util)::ValueArray<int32_t> local(count);
+  bool ret = true;
+  size_t i = 0;
+  while ( i < count ){
+    const int32_t r = readerIndex(docs[i], starts, numSubReaders);
+    size_t j = i;
+    while ( j < count && docs[j] < starts[r+1] ){
+      local[j] = docs[j] - starts[r];
+      j++;
+    }
+    if ( !(*subReaders)[r]->doDocuments(local.values + i, result + i, j - i, fieldSelector) )
+      ret = false;
+    i = j;
+  }
+  return ret;
+}
+
+void MultiSegmentReader::setDocumentCache(DocumentCache* cache){
+  IndexReader::setDocumentCache(cache);
+  for (size_t i = 0; i < subReaders->length; i++){
+    if ( (*subReaders)[i] != NULL )
+      (*subReaders)[i]->setDocumentCache(cache);
+  }
+}
+
 bool MultiSegmentReader::isDeleted(const int32_t n) {
     // Don't call ensureOpen() here (it could affect performance)
 	int32_t i = readerIndex(n);			  // find segment num
@@ -359,6 +402,16 @@ void MultiSegmentReader::setTermInfosIndexDivisor(int32_t indexDivisor) {
     (*subReaders)[i]->setTermInfosIndexDivisor(indexDivisor);
 }
 
+void MultiSegmentReader::getTermInfosCacheStats(int64_t& hits, int64_t& misses) {
+  hits = misses = 0;
+  for (size_t i = 0; i < subReaders->length; i++) {
+    int64_t h, m;
+    (*subReaders)[i]->getTermInfosCacheStats(h, m);
+    hits += h;
+    misses += m;
+  }
+}
+
 int32_t MultiSegmentReader::getTermInfosIndexDivisor() {
   if (subReaders->length > 0)
     return (*subReaders)[0]->getTermInfosIndexDivisor();
@@ -470,6 +523,110 @@ void MultiSegmentReader::getFieldNames(FieldOption fldOption, StringArrayWithDel
       itr++;
     }
 }
+int32_t MultiSegmentReader::getDocValuesType(const TCHAR* field){
+  ensureOpen();
+  return getDocValuesType(field, subReaders);
+}
+
+const ArrayBase<IndexReader*>* MultiSegmentReader::getSequentialSubReaders() const{
+  return subReaders;
+}
+
+bool MultiSegmentReader::getDocValues(const TCHAR* field, int32_t* result){
+  ensureOpen();
+  return getDocValues(field, result, subReaders, starts);
+}
+
+bool MultiSegmentReader::getDocValues(const TCHAR* field, float_t* result){
+  ensureOpen();
+  return getDocValues(field, result, subReaders, starts);
+}
+
+bool MultiSegmentReader::getDocValues(const TCHAR* field, int32_t* ords, StringArrayWithDeletor& values){
+  ensureOpen();
+  return getDocValues(field, ords, values, subReaders, starts);
+}
+
+int32_t MultiSegmentReader::getDocValuesType(const TCHAR* field, CL_NS(util)::ArrayBase<IndexReader*>* subReaders){
+  int32_t type = 0;
+  for (size_t i = 0; i < subReaders->length; i++) {
+    // a subreader without a column has no values for its documents. Its field
+    // infos may still list the field, if another flush of a sparse field had it
+    const int32_t subType = (*subReaders)[i]->getDocValuesType(field);
+    if (subType == 0) {
+      continue;
+    } else if (type == 0) {
+      type = subType;
+    } else if (type != subType) {
+      return 0;
+    }
+  }
+  return type;
+}
+
+bool MultiSegmentReader::getDocValues(const TCHAR* field, int32_t* result, CL_NS(util)::ArrayBase<IndexReader*>* subReaders, const int32_t* starts){
+  if (getDocValuesType(field, subReaders) != Field::DOCVALUES_INT)
+    return false;
+  for (size_t i = 0; i < subReaders->length; i++) {
+    if (!(*subReaders)[i]->getDocValues(field, result + starts[i]))
+      memset(result + starts[i], 0, sizeof(int32_t) * (*subReaders)[i]->maxDoc());
+  }
+  return true;
+}
+
+bool MultiSegmentReader::getDocValues(const TCHAR* field, float_t* result, CL_NS(util)::ArrayBase<IndexReader*>* subReaders, const int32_t* starts){
+  if (getDocValuesType(field, subReaders) != Field::DOCVALUES_FLOAT)
+    return false;
+  for (size_t i = 0; i < subReaders->length; i++) {
+    if (!(*subReaders)[i]->getDocValues(field, result + starts[i]))
+      memset(result + starts[i], 0, sizeof(float_t) * (*subReaders)[i]->maxDoc());
+  }
+  return true;
+}
+
+bool MultiSegmentReader::getDocValues(const TCHAR* field, int32_t* ords, StringArrayWithDeletor& values,
+    CL_NS(util)::ArrayBase<IndexReader*>* subReaders, const int32_t* starts){
+  if (getDocValuesType(field, subReaders) != Field::DOCVALUES_STRING)
+    return false;
+
+  // read the ords and sorted values of each subreader
+  ObjectArray<StringArrayWithDeletor> subValues(subReaders->length);
+  std::vector<const TCHAR*> merged;
+  for (size_t i = 0; i < subReaders->length; i++) {
+    subValues.values[i] = _CLNEW StringArrayWithDeletor;
+    if (!(*subReaders)[i]->getDocValues(field, ords + starts[i], *subValues[i]))
+      memset(ords + starts[i], 0, sizeof(int32_t) * (*subReaders)[i]->maxDoc());
+    merged.insert(merged.end(), subValues[i]->begin(), subValues[i]->end());
+  }
+
+  // build the sorted union of all values
+  std::sort(merged.begin(), merged.end(), Compare::TChar());
+  merged.erase(std::unique(merged.begin(), merged.end(), Equals::TChar()), merged.end());
+
+  // map the ords of each subreader to the merged values. Both are sorted,
+  // so a single pass over the merged values is enough
+  std::vector<int32_t> ordMap;
+  for (size_t i = 0; i < subReaders->length; i++) {
+    StringArrayWithDeletor& sub = *subValues[i];
+    ordMap.resize(sub.size() + 1);
+    ordMap[0] = 0;
+    size_t m = 0;
+    for (size_t j = 0; j < sub.size(); j++) {
+      while (_tcscmp(merged[m], sub[j]) != 0)
+        m++;
+      ordMap[j + 1] = (int32_t)m + 1;
+    }
+    const int32_t maxDoc = (*subReaders)[i]->maxDoc();
+    int32_t* subOrds = ords + starts[i];
+    for (int32_t j = 0; j < maxDoc; j++)
+      subOrds[j] = ordMap[subOrds[j]];
+  }
+
+  for (size_t i = 0; i < merged.size(); i++)
+    values.push_back(STRDUP_TtoT(merged[i]));
+  return true;
+}
+
 const char* MultiSegmentReader::getClassName(){
   return "MultiSegmentReader";
 }
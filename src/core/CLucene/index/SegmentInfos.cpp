@@ -794,6 +794,18 @@ string SegmentInfo::segString(Directory* dir) {
 
     string segmentFileName = getNextSegmentFileName();
 
+    // The new segments file may only point at files which are on stable
+    // storage, or a crash could leave it referring to lost data:
+    vector<string> segmentFiles;
+    for (int32_t i = 0; i < size(); i++) {
+      SegmentInfo* si = info(i);
+      if (si->dir == directory) {
+        const vector<string>& files = si->files();
+        segmentFiles.insert(segmentFiles.end(), files.begin(), files.end());
+      }
+    }
+    directory->sync(segmentFiles);
+
     // Always advance the generation on write:
     if (generation == -1) {
       generation = 1;
@@ -844,6 +856,12 @@ string SegmentInfo::segString(Directory* dir) {
       // used only as one of the retry fallbacks.
     }
 
+    // Only now is the commit durable:
+    vector<string> commitFiles;
+    commitFiles.push_back(segmentFileName);
+    commitFiles.push_back(IndexFileNames::SEGMENTS_GEN);
+    directory->sync(commitFiles);
+
     lastGeneration = generation;
   }
 
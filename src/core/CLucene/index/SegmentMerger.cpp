@@ -17,7 +17,12 @@
 #include "CLucene/index/_IndexFileNames.h"
 #include "_CompoundFile.h"
 #include "_SkipListWriter.h"
+#include "CLucene/store/RateLimiter.h"
+#include "CLucene/store/RateLimitedDirectory.h"
 #include "CLucene/document/FieldSelector.h"
+#include "CLucene/document/Field.h"
+#include "_DocValues.h"
+#include "_MultiSegmentReader.h"
 
 CL_NS_USE(util)
 CL_NS_USE(document)
@@ -36,7 +41,9 @@ void SegmentMerger::init(){
   queue            = NULL;
   fieldInfos       = NULL;
   checkAbort       = NULL;
+  limitedDirectory = NULL;
   skipInterval     = 0;
+  hasDocValues     = false;
 }
 
 SegmentMerger::SegmentMerger(IndexWriter* writer, const char* name, MergePolicy::OneMerge* merge){
@@ -50,8 +57,13 @@ SegmentMerger::SegmentMerger(IndexWriter* writer, const char* name, MergePolicy:
   this->init();
   this->directory		   = writer->getDirectory();
   this->segment        = name;
-  if (merge != NULL)
+  if (merge != NULL) {
     this->checkAbort = _CLNEW CheckAbort(merge, directory);
+
+    // merged segments are written at the rate the writer allows, also if it is
+    // only set while the merge runs
+    this->directory = this->limitedDirectory = _CLNEW RateLimitedDirectory(directory, writer->getMergeRateLimiter());
+  }
   this->termIndexInterval= writer->getTermIndexInterval();
   this->mergedDocs = 0;
   this->maxSkipLevels = 0;
@@ -90,6 +102,7 @@ SegmentMerger::~SegmentMerger(){
 
   _CLDELETE(checkAbort);
   _CLDELETE(skipListWriter);
+  _CLDELETE(limitedDirectory);
 
 }
 
@@ -130,6 +143,7 @@ int32_t SegmentMerger::merge(bool mergeDocStores) {
 
 	mergeTerms();
 	mergeNorms();
+	mergeDocValues();
 
 	if (mergeDocStores && fieldInfos->hasVectors())
 		mergeVectors();
@@ -172,6 +186,10 @@ void SegmentMerger::createCompoundFile(const char* filename, std::vector<std::st
 		}
 	}
 
+  // Doc values file
+  if ( hasDocValues )
+    files->push_back ( segment + "." + IndexFileNames::DOC_VALUES_EXTENSION );
+
   // Vector files
   if ( mergeDocStores && fieldInfos->hasVectors()) {
     for (int32_t i = 0; i < IndexFileNames::VECTOR_EXTENSIONS().length; i++) {
@@ -796,6 +814,78 @@ void SegmentMerger::mergeNorms() {
   );
 }
 
+void SegmentMerger::mergeDocValues() {
+  ValueArray<IndexReader*> subReaders(readers.size());
+  for (size_t i = 0; i < readers.size(); i++)
+    subReaders.values[i] = readers[i];
+
+  DocValuesWriter docValues;
+  ValueArray<int32_t> ints;
+  ValueArray<float_t> floats;
+
+  for (size_t i = 0; i < fieldInfos->size(); i++) {
+    const TCHAR* field = fieldInfos->fieldInfo(i)->name;
+
+    // the quick check avoids listing the fields of every reader for
+    // indexes that don't use doc values at all
+    bool anyColumn = false;
+    for (size_t j = 0; j < readers.size() && !anyColumn; j++)
+      anyColumn = readers[j]->getDocValuesType(field) != 0;
+    if (!anyColumn)
+      continue;
+
+    // readers that disagree on the column type leave the merged segment without
+    // one. Readers without a column add documents without a value
+    const int32_t type = MultiSegmentReader::getDocValuesType(field, &subReaders);
+    if (type == 0)
+      continue;
+    docValues.addColumn(field, type);
+
+    int32_t docNum = 0;
+    for (size_t j = 0; j < readers.size(); j++) {
+      IndexReader* reader = readers[j];
+      const int32_t maxDoc = reader->maxDoc();
+      if (ints.length < (size_t)maxDoc)
+        ints.resize(maxDoc);
+
+      if (type == Field::DOCVALUES_INT) {
+        if (!reader->getDocValues(field, ints.values))
+          memset(ints.values, 0, sizeof(int32_t) * maxDoc);
+        for (int32_t k = 0; k < maxDoc; k++) {
+          if (!reader->isDeleted(k))
+            docValues.setInt(field, docNum++, ints[k]);
+        }
+      } else if (type == Field::DOCVALUES_FLOAT) {
+        if (floats.length < (size_t)maxDoc)
+          floats.resize(maxDoc);
+        if (!reader->getDocValues(field, floats.values))
+          memset(floats.values, 0, sizeof(float_t) * maxDoc);
+        for (int32_t k = 0; k < maxDoc; k++) {
+          if (!reader->isDeleted(k))
+            docValues.setFloat(field, docNum++, floats[k]);
+        }
+      } else {
+        StringArrayWithDeletor values;
+        if (!reader->getDocValues(field, ints.values, values))
+          memset(ints.values, 0, sizeof(int32_t) * maxDoc);
+        for (int32_t k = 0; k < maxDoc; k++) {
+          if (reader->isDeleted(k))
+            continue;
+          if (ints[k] != 0)
+            docValues.setString(field, docNum, values[ints[k] - 1]);
+          docNum++;
+        }
+      }
+      if (checkAbort != NULL)
+        checkAbort->work(maxDoc);
+    }
+  }
+
+  if (!docValues.empty()) {
+    docValues.write(directory, segment.c_str(), mergedDocs);
+    hasDocValues = true;
+  }
+}
 
 SegmentMerger::CheckAbort::CheckAbort(MergePolicy::OneMerge* merge, Directory* dir) {
   this->merge = merge;
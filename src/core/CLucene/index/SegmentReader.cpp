@@ -10,6 +10,8 @@
 #include "_MultiSegmentReader.h"
 #include "_FieldInfos.h"
 #include "_FieldsReader.h"
+#include "DocumentCache.h"
+#include "_DocValues.h"
 #include "IndexReader.h"
 #include "_TermInfosReader.h"
 #include "Terms.h"
@@ -126,6 +128,7 @@ CL_NS_DEF(index)
     this->proxStream       = NULL;
     this->singleNormStream = NULL;
     this->termVectorsReaderOrig = NULL;
+    this->docValues = NULL;
     this->_fieldInfos = NULL;
     this->tis = NULL;
     this->fieldsReader = NULL;
@@ -200,6 +203,9 @@ CL_NS_DEF(index)
       proxStream = cfsDir->openInput( (segment + ".prx").c_str(), readBufferSize);
       openNorms(cfsDir, readBufferSize);
 
+      if (DocValuesReader::exists(cfsDir, segment.c_str()))
+        docValues = _CLNEW DocValuesReader(cfsDir, segment.c_str(), readBufferSize);
+
       if (doOpenStores && _fieldInfos->hasVectors()) { // open term vector files only as needed
         string vectorsSegment;
         if (si->getDocStoreOffset() != -1)
@@ -268,6 +274,7 @@ CL_NS_DEF(index)
       _CLDELETE(deletedDocs);
       _CLDELETE_ARRAY(ones);
       _CLDELETE(termVectorsReaderOrig)
+      _CLDELETE(docValues);
       _CLDECDELETE(cfsReader);
       //termVectorsLocal->unregister(this);
   }
@@ -344,6 +351,11 @@ CL_NS_DEF(index)
           _CLDELETE(termVectorsReaderOrig);
       }
 
+      if (docValues != NULL){
+        docValues->close();
+        _CLDELETE(docValues);
+      }
+
       if (cfsReader != NULL){
         cfsReader->close();
         _CLDECDELETE(cfsReader);
@@ -357,6 +369,11 @@ CL_NS_DEF(index)
       this->decRefNorms();
       _norms.clear();
 
+      // _fieldInfos is only set on the reader that owns the segment core, see reopenSegment
+      DocumentCache* cache = getDocumentCache();
+      if (cache != NULL && _fieldInfos != NULL)
+        cache->evict(_fieldInfos);
+
       // maybe close directory
       DirectoryIndexReader::doClose();
   }
@@ -469,10 +486,45 @@ CL_NS_DEF(index)
           _CLTHROWA( CL_ERR_InvalidState,"attempt to access a deleted document" );
        }
 
-	   //Retrieve the n-th document
+	   //Retrieve the n-th document. Cached documents are keyed by _fieldInfos, which is
+       //shared with reopened clones and lives exactly as long as the segment core
+       DocumentCache* cache = getDocumentCache();
+       if (cache != NULL && fieldSelector == NULL && _fieldInfos != NULL)
+         return fieldsReader->doc(n, doc, cache, _fieldInfos);
        return fieldsReader->doc(n, doc, fieldSelector);
   }
 
+  bool SegmentReader::doDocuments(const int32_t* docs, Document** result, size_t count, const FieldSelector* fieldSelector) {
+      SCOPED_LOCK_MUTEX(THIS_LOCK)
+
+      ensureOpen();
+
+      for (size_t i = 0; i < count; i++){
+        CND_PRECONDITION(docs[i] >= 0, "n is a negative number");
+        if (isDeleted(docs[i])){
+          _CLTHROWA( CL_ERR_InvalidState,"attempt to access a deleted document" );
+        }
+      }
+
+      DocumentCache* cache = getDocumentCache();
+      if (cache != NULL && fieldSelector == NULL && _fieldInfos != NULL){
+        bool ret = true;
+        for (size_t i = 0; i < count; i++){
+          if (!fieldsReader->doc(docs[i], *result[i], cache, _fieldInfos))
+            ret = false;
+        }
+        return ret;
+      }
+      return fieldsReader->docs(docs, result, count, fieldSelector);
+  }
+
+  void SegmentReader::setDocumentCache(DocumentCache* cache){
+      DocumentCache* old = getDocumentCache();
+      if (old != NULL && old != cache && _fieldInfos != NULL)
+        old->evict(_fieldInfos);
+      DirectoryIndexReader::setDocumentCache(cache);
+  }
+
 
   bool SegmentReader::isDeleted(const int32_t n){
   //Func - Checks if the n-th document has been marked deleted
@@ -570,6 +622,16 @@ CL_NS_DEF(index)
     return tis->getIndexDivisor();
   }
 
+  void SegmentReader::getTermInfosCacheStats(int64_t& hits, int64_t& misses) {
+    TermInfoCache* cache = tis == NULL ? NULL : tis->getCache();
+    if ( cache == NULL ){
+      hits = misses = 0;
+    }else{
+      hits = cache->getHitCount();
+      misses = cache->getMissCount();
+    }
+  }
+
 
 void SegmentReader::getFieldNames(FieldOption fldOption, StringArrayWithDeletor& retarray){
   ensureOpen();
@@ -657,6 +719,26 @@ bool SegmentReader::hasNorms(const TCHAR* field){
     }
   }
 
+  int32_t SegmentReader::getDocValuesType(const TCHAR* field){
+    ensureOpen();
+    return docValues == NULL ? 0 : docValues->getType(field);
+  }
+
+  bool SegmentReader::getDocValues(const TCHAR* field, int32_t* result){
+    ensureOpen();
+    return docValues != NULL && docValues->readInts(field, result);
+  }
+
+  bool SegmentReader::getDocValues(const TCHAR* field, float_t* result){
+    ensureOpen();
+    return docValues != NULL && docValues->readFloats(field, result);
+  }
+
+  bool SegmentReader::getDocValues(const TCHAR* field, int32_t* ords, StringArrayWithDeletor& values){
+    ensureOpen();
+    return docValues != NULL && docValues->readStrings(field, ords, values);
+  }
+
   uint8_t* SegmentReader::createFakeNorms(int32_t size) {
     uint8_t* ones = _CL_NEWARRAY(uint8_t,size);
     if ( size > 0 )
@@ -942,6 +1024,7 @@ bool SegmentReader::hasNorms(const TCHAR* field){
       clone->freqStream = freqStream;
       clone->proxStream = proxStream;
       clone->termVectorsReaderOrig = termVectorsReaderOrig;
+      clone->docValues = docValues;
 
       // we have to open a new FieldsReader, because it is not thread-safe
       // and can thus not be shared among multiple SegmentReaders
@@ -1041,6 +1124,7 @@ bool SegmentReader::hasNorms(const TCHAR* field){
     this->freqStream = NULL;
     this->proxStream = NULL;
     this->termVectorsReaderOrig = NULL;
+    this->docValues = NULL;
     this->cfsReader = NULL;
     this->storeCFSReader = NULL;
     _CLDELETE( this->singleNormStream );
@@ -165,7 +165,10 @@ void Term::set(const TCHAR* fld, const TCHAR* txt,const bool internField){
 
 #endif
 
-    //Set Term Field
+    //Set Term Field. An enumeration resets the same term to the same interned
+	//field over and over, which needs no trip to the intern table
+	if ( internField && internF && fld == oldField )
+		return;
 	if ( internField )
 		_field = CLStringIntern::intern(fld);
 	else
@@ -19,14 +19,176 @@
 #include "_TermInfo.h"
 #include "_TermInfosWriter.h"
 #include "_TermInfosReader.h"
+#include <map>
 
 CL_NS_USE(store)
 CL_NS_USE(util)
 CL_NS_DEF(index)
 
+struct TermInfoCache::Internal: LUCENE_BASE{
+	/** One cached term, linked into the LRU list of its partition */
+	struct Entry {
+		Term* term;
+		TermInfo info;
+		Entry* prev;
+		Entry* next;
+	};
+
+	struct TermCompare {
+		bool operator()(const Term* t1, const Term* t2) const{
+			return t1->compareTo(t2) < 0;
+		}
+	};
+
+	/** An independently locked slice of the cache with its own LRU list */
+	class Partition {
+	public:
+		typedef std::map<const Term*, Entry*, TermCompare> EntriesType;
+
+		DEFINE_MUTEX(THIS_LOCK)
+		EntriesType entries;
+		Entry* first; // most recently used
+		Entry* last;  // least recently used
+		int64_t hits;
+		int64_t misses;
+
+		Partition():
+			first(NULL), last(NULL), hits(0), misses(0)
+		{
+		}
+		~Partition(){
+			while ( last != NULL )
+				removeLast();
+		}
+
+		void unlink(Entry* entry){
+			if (entry->prev == NULL)
+				first = entry->next;
+			else
+				entry->prev->next = entry->next;
+			if (entry->next == NULL)
+				last = entry->prev;
+			else
+				entry->next->prev = entry->prev;
+			entry->prev = entry->next = NULL;
+		}
+
+		void addToFront(Entry* entry){
+			entry->prev = NULL;
+			entry->next = first;
+			if (first == NULL)
+				last = entry;
+			else
+				first->prev = entry;
+			first = entry;
+		}
+
+		void removeLast(){
+			Entry* entry = last;
+			entries.erase(entry->term);
+			unlink(entry);
+			_CLDECDELETE(entry->term);
+			delete entry;
+		}
+	};
+
+	Partition* partitions;
+	int32_t partitionCount;
+	size_t maxPartitionSize;
+
+	Partition& partitionFor(const Term* term){
+		// fields are interned, so their address will do
+		size_t h = (reinterpret_cast<size_t>(term->field()) >> 4) * 31 +
+			Misc::thashCode(term->text(), term->textLength());
+		return partitions[h % partitionCount];
+	}
+};
+
+TermInfoCache::TermInfoCache(int32_t maxSize, int32_t partitions){
+	if ( partitions < 1 )
+		partitions = 1;
+	_internal = _CLNEW Internal;
+	_internal->partitions = new Internal::Partition[partitions];
+	_internal->partitionCount = partitions;
+	_internal->maxPartitionSize = maxSize < partitions ? 1 : maxSize / partitions;
+}
+
+TermInfoCache::~TermInfoCache(){
+	delete [] _internal->partitions;
+	_CLDELETE(_internal);
+}
+
+bool TermInfoCache::get(const Term* term, TermInfo* ti){
+	Internal::Partition& p = _internal->partitionFor(term);
+	SCOPED_LOCK_MUTEX(p.THIS_LOCK)
+
+	Internal::Partition::EntriesType::iterator itr = p.entries.find(term);
+	if (itr == p.entries.end()){
+		p.misses++;
+		return false;
+	}
+	Internal::Entry* entry = itr->second;
+	p.hits++;
+
+	// update LRU order
+	p.unlink(entry);
+	p.addToFront(entry);
+
+	ti->set(&entry->info);
+	return true;
+}
+
+void TermInfoCache::put(const Term* term, const TermInfo* ti){
+	Internal::Partition& p = _internal->partitionFor(term);
+	SCOPED_LOCK_MUTEX(p.THIS_LOCK)
+
+	if ( p.entries.find(term) != p.entries.end() )
+		return; // another thread was quicker
+
+	if ( p.entries.size() >= _internal->maxPartitionSize )
+		p.removeLast();
+
+	Internal::Entry* entry = new Internal::Entry;
+	entry->term = _CLNEW Term(term->field(), term->text(), true);
+	entry->info.set(ti);
+	p.addToFront(entry);
+	p.entries.insert(Internal::Partition::EntriesType::value_type(entry->term, entry));
+}
+
+int64_t TermInfoCache::getHitCount() const{
+	int64_t ret = 0;
+	for ( int32_t i=0;i<_internal->partitionCount;i++ ){
+		Internal::Partition& p = _internal->partitions[i];
+		SCOPED_LOCK_MUTEX(p.THIS_LOCK)
+		ret += p.hits;
+	}
+	return ret;
+}
+
+int64_t TermInfoCache::getMissCount() const{
+	int64_t ret = 0;
+	for ( int32_t i=0;i<_internal->partitionCount;i++ ){
+		Internal::Partition& p = _internal->partitions[i];
+		SCOPED_LOCK_MUTEX(p.THIS_LOCK)
+		ret += p.misses;
+	}
+	return ret;
+}
+
+size_t TermInfoCache::size() const{
+	size_t ret = 0;
+	for ( int32_t i=0;i<_internal->partitionCount;i++ ){
+		Internal::Partition& p = _internal->partitions[i];
+		SCOPED_LOCK_MUTEX(p.THIS_LOCK)
+		ret += p.entries.size();
+	}
+	return ret;
+}
+
+
 
   TermInfosReader::TermInfosReader(Directory* dir, const char* seg, FieldInfos* fis, const int32_t readBufferSize):
-      directory (dir),fieldInfos (fis), indexTerms(NULL), indexInfos(NULL), indexPointers(NULL), indexDivisor(1)
+      directory (dir),fieldInfos (fis), termsCache(NULL), indexTerms(NULL), indexInfos(NULL), indexPointers(NULL), indexDivisor(1)
   {
   //Func - Constructor.
   //       Reads the TermInfos file (.tis) and eventually the Term Info Index file (.tii)
@@ -59,6 +221,7 @@ CL_NS_DEF(index)
 		  CND_CONDITION(origEnum != NULL, "No memory could be allocated for orig enumerator");
 		  CND_CONDITION(indexEnum != NULL, "No memory could be allocated for index enumerator");
 
+		  termsCache = _CLNEW TermInfoCache();
 		  success = true;
 	  } _CLFINALLY({
 		  // With lock-less commits, it's entirely possible (and
@@ -150,6 +313,7 @@ CL_NS_DEF(index)
         _CLDELETE(is);
       }
 	  enumerators.setNull();
+	  _CLDELETE(termsCache);
   }
 
   int64_t TermInfosReader::size() const{
@@ -198,6 +362,10 @@ CL_NS_DEF(index)
     return termEnum;
   }
 
+  TermInfoCache* TermInfosReader::getCache() const{
+    return termsCache;
+  }
+
   TermInfo* TermInfosReader::get(const Term* term){
   //Func - Returns a TermInfo for a term
   //Pre  - term holds a valid reference to term
@@ -207,6 +375,22 @@ CL_NS_DEF(index)
 	if (_size == 0)
 		return NULL;
 
+	if ( termsCache != NULL ){
+		TermInfo cached;
+		if ( termsCache->get(term, &cached) )
+			return _CLNEW TermInfo(&cached);
+	}
+
+	TermInfo* ti = seekTerm(term);
+	if ( ti != NULL && termsCache != NULL )
+		termsCache->put(term, ti);
+	return ti;
+  }
+
+  TermInfo* TermInfosReader::seekTerm(const Term* term){
+	if (_size == 0)
+		return NULL;
+
     ensureIndexIsRead();
 
     // optimize sequential access: first try scanning cached enum w/o seeking
@@ -283,7 +467,7 @@ CL_NS_DEF(index)
 	  SegmentTermEnum* enumerator = NULL;
 	  if ( term != NULL ){
 		//Seek enumerator to term; delete the new TermInfo that's returned.
-		TermInfo* ti = get(term);
+		TermInfo* ti = seekTerm(term);
 		_CLLDELETE(ti);
 		enumerator = getEnum();
 	  }else
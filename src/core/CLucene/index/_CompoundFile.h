@@ -108,11 +108,12 @@ class CompoundFileWriter:LUCENE_BASE {
   Internal* _internal;
 
 	/** Copy the contents of the file with specified extension into the
-	*  provided output stream. Use the provided buffer for moving data
-	*  to reduce memory allocation.
+	*  provided output stream, COPY_CHUNK_SIZE bytes at a time.
 	*/
-	void copyFile(WriterFileEntry* source, CL_NS(store)::IndexOutput* os, uint8_t* buffer, int32_t bufferLength);
+	void copyFile(WriterFileEntry* source, CL_NS(store)::IndexOutput* os);
 public:
+	LUCENE_STATIC_CONSTANT(int32_t, COPY_CHUNK_SIZE = 1048576);
+
 	/** Create the compound stream in the specified file. The file name is the
 	*  entire name (no extensions are added).
 	*/
@@ -0,0 +1,139 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_index_DocValues_
+#define _lucene_index_DocValues_
+
+#include "CLucene/util/Equators.h"
+#include <map>
+#include <vector>
+
+CL_CLASS_DEF(store,Directory)
+CL_CLASS_DEF(store,IndexInput)
+CL_CLASS_DEF(util,PackedInts)
+CL_CLASS_DEF(document,Document)
+
+CL_NS_DEF(index)
+
+/**
+* Buffers the doc values columns of a segment and writes them to the
+* segment's <code>.dv</code> file.
+*
+* The file starts with a format int, followed by the data of each column and a
+* directory of all columns. The last 8 bytes hold the position of the directory.
+* <ul>
+* <li>Int columns hold the minimum value followed by the packed difference of each document's value to it</li>
+* <li>Float columns hold the raw bits of each document's value</li>
+* <li>String columns hold the sorted, unique values followed by the packed ord of each document.
+* Ord 0 means the document has no value, ord n refers to the n-th value.</li>
+* </ul>
+* Column types are the values of {@link Field::DocValues}.
+*/
+class DocValuesWriter: LUCENE_BASE{
+	class Column;
+	typedef std::map<const TCHAR*, Column*, CL_NS(util)::Compare::TChar> ColumnsType;
+	ColumnsType columns;
+
+	Column* getColumn(const TCHAR* field, int32_t type);
+public:
+	LUCENE_STATIC_CONSTANT(int32_t, FORMAT = -1);
+
+	DocValuesWriter();
+	~DocValuesWriter();
+
+	/** Adds an empty column for field, unless the field already has one of this type */
+	void addColumn(const TCHAR* field, int32_t type);
+
+	/** Returns the column type of field, or 0 if the field has no column yet */
+	int32_t getType(const TCHAR* field) const;
+
+	/** Sets the value of field for doc. Throws an IllegalArgument error if the field has a column of another type. */
+	void setInt(const TCHAR* field, int32_t doc, int32_t value);
+	void setFloat(const TCHAR* field, int32_t doc, float_t value);
+	void setString(const TCHAR* field, int32_t doc, const TCHAR* value);
+
+	/** True if no values have been set since the last reset */
+	bool empty() const;
+
+	/** Writes all columns for numDocs documents to the .dv file of segment */
+	void write(CL_NS(store)::Directory* directory, const char* segment, int32_t numDocs);
+
+	/** Discards all columns */
+	void reset();
+};
+
+/**
+* Enforces the index sort of an IndexWriter: every added document must sort
+* after (or equal to) the previously added one on the sort field's doc values.
+* Documents without a value sort like they do in the FieldCache: as 0 for
+* int and float columns and before all values for string columns.
+*/
+class IndexSortChecker: LUCENE_BASE{
+	TCHAR* field;
+	bool reverse;
+	bool hasLast;
+	int32_t lastType;   // 0 until a document with a value was added
+	int32_t lastInt;
+	float_t lastFloat;
+	TCHAR* lastString;  // NULL if the last document had no value
+public:
+	IndexSortChecker(const TCHAR* field, bool reverse);
+	~IndexSortChecker();
+
+	const TCHAR* getField() const;
+	bool getReverse() const;
+
+	/** Accepts doc as the last added document. Throws an IllegalArgument error,
+	* leaving the checker unchanged, if doc sorts before the last document or if
+	* the sort field is not a doc values field. */
+	void add(CL_NS(document)::Document* doc);
+};
+
+/**
+* Reads the doc values columns of a segment. Each read decodes a whole column
+* with a single sequential pass over the file.
+*/
+class DocValuesReader: LUCENE_BASE{
+	struct Entry{
+		int32_t type;
+		int64_t pointer;
+	};
+	typedef std::map<TCHAR*, Entry, CL_NS(util)::Compare::TChar> EntriesType;
+
+	CL_NS(store)::IndexInput* input;
+	EntriesType entries;
+	DEFINE_MUTEX(THIS_LOCK)
+
+	const Entry* seek(const TCHAR* field, int32_t type);
+public:
+	DocValuesReader(CL_NS(store)::Directory* directory, const char* segment, int32_t readBufferSize = -1);
+	~DocValuesReader();
+
+	/** Returns true if the segment has a doc values file */
+	static bool exists(CL_NS(store)::Directory* directory, const char* segment);
+
+	/** Returns the column type of field, or 0 if the segment has no column for the field */
+	int32_t getType(const TCHAR* field);
+
+	/** Reads the int column of field into result, which must hold maxDoc values.
+	* Returns false if there is no int column for the field. */
+	bool readInts(const TCHAR* field, int32_t* result);
+
+	/** Reads the float column of field into result, which must hold maxDoc values.
+	* Returns false if there is no float column for the field. */
+	bool readFloats(const TCHAR* field, float_t* result);
+
+	/** Reads the string column of field. The sorted values are appended to values
+	* and ords (maxDoc values) is filled with the ord of each document, where
+	* 0 means no value and n refers to values[n-1].
+	* Returns false if there is no string column for the field. */
+	bool readStrings(const TCHAR* field, int32_t* ords, StringArrayWithDeletor& values);
+
+	void close();
+};
+
+CL_NS_END
+#endif
@@ -28,6 +28,8 @@ class DocumentsWriter;
 class DefaultSkipListWriter;
 class FieldInfos;
 class FieldsWriter;
+class DocValuesWriter;
+class IndexSortChecker;
 class FieldInfos;
 class IndexWriter;
 class TermInfo;
@@ -573,6 +575,9 @@ private:
     /** Initializes shared state for this new document */
     void init(CL_NS(document)::Document* doc, int32_t docID);
 
+    /** Records the doc values of the document being initialized */
+    void addDocValues(CL_NS(document)::Document* doc);
+
     /** Tokenizes the fields of a document into Postings */
     void processDocument(CL_NS(analysis)::Analyzer* analyzer);
 
@@ -735,6 +740,8 @@ private:
   int32_t abortCount;                         // Non-zero while abort is pending or running
 
   CL_NS(util)::ObjectArray<BufferedNorms> norms;   // Holds norms until we flush
+  DocValuesWriter* docValues;                       // Holds doc values columns until we flush
+  IndexSortChecker* indexSort;                      // Non-NULL if added docs must follow an index sort
 
   /** Does the synchronized work to finish/flush the
    * inverted document. */
@@ -788,6 +795,12 @@ public:
 
   int32_t getMaxBufferedDocs();
 
+  /** Requires all further documents to be added in the order of the doc
+   *  values of field. NULL removes the requirement. */
+  void setIndexSort(const TCHAR* field, bool reverse);
+  const TCHAR* getIndexSortField();
+  bool getIndexSortReverse();
+
   /** Get current segment name we are writing. */
   std::string getSegment();
 
@@ -15,6 +15,7 @@ CL_CLASS_DEF(document,FieldSelector)
 CL_CLASS_DEF(index, FieldInfo)
 CL_CLASS_DEF(index, FieldInfos)
 CL_CLASS_DEF(store,IndexInput)
+CL_CLASS_DEF(index, DocumentCache)
 
 CL_NS_DEF(index)
 
@@ -43,6 +44,9 @@ CL_NS_DEF(index)
 		// file.  This will be 0 if we have our own private file.
 		int32_t docStoreOffset;
 
+		// Raw bytes of the last document loaded through a DocumentCache
+		CL_NS(util)::ValueArray<uint8_t> docBuffer;
+
 		DEFINE_MUTEX(THIS_LOCK)
 		CL_NS(util)::ThreadLocal<CL_NS(store)::IndexInput*, CL_NS(util)::Deletor::Object<CL_NS(store)::IndexInput> > fieldsStreamTL;
     static void uncompress(const CL_NS(util)::ValueArray<uint8_t>& input, CL_NS(util)::ValueArray<uint8_t>& output);
@@ -70,6 +74,24 @@ CL_NS_DEF(index)
 		/** Loads the fields from n'th document into doc. returns true on success. */
 		bool doc(int32_t n, CL_NS(document)::Document& doc, const CL_NS(document)::FieldSelector* fieldSelector = NULL);
 
+		/**
+		* Loads all fields of the n'th document into doc, taking the raw bytes from cache
+		* if they are there, and adding them to the cache otherwise. cacheKey identifies
+		* the segment in the cache. returns true on success.
+		*/
+		bool doc(int32_t n, CL_NS(document)::Document& doc, DocumentCache* cache, const void* cacheKey);
+
+		/**
+		* Loads count documents, given in ascending order, into result. Runs of consecutive
+		* documents are read from the .fdt file with a single read into a shared buffer.
+		* returns false if any of the documents does not exist.
+		*/
+		bool docs(const int32_t* docs, CL_NS(document)::Document** result, size_t count,
+			const CL_NS(document)::FieldSelector* fieldSelector = NULL);
+
+		/** The maximum number of consecutive documents read in one go by docs() */
+		LUCENE_STATIC_CONSTANT(int32_t, MAX_BATCH_DOCS=128);
+
 	protected:
 		/** Returns the length in bytes of each raw document in a
 		*  contiguous range of length numDocs starting with
@@ -78,6 +100,9 @@ CL_NS_DEF(index)
 		CL_NS(store)::IndexInput* rawDocs(int32_t* lengths, const int32_t startDocID, const int32_t numDocs);
 
 	private:
+		/** Reads the fields of a document from fieldsStream, which is positioned at the start of the document */
+		void readFields(CL_NS(document)::Document& doc, const CL_NS(document)::FieldSelector* fieldSelector);
+
 		/**
 		* Skip the field.  We still have to read some of the information about the field, but can skip past the actual content.
 		* This will have the most payoff on large fields.
@@ -147,6 +172,35 @@ CL_NS_DEF(index)
 		};
 		friend class LazyField;
     friend class SegmentMerger;
+
+		/**
+		* An IndexInput over raw .fdt bytes held in memory, so the field readers can
+		* decode cached or batch loaded documents. pointer is the position of the
+		* first byte in the .fdt file (lazy fields remember file positions). The
+		* data is not owned.
+		*/
+		class DocBuffer : public CL_NS(store)::IndexInput {
+		private:
+			const uint8_t* data;
+			int64_t pointer;
+			int32_t pos;
+			int32_t _length;
+		public:
+			DocBuffer(const uint8_t* data, const int32_t length, const int64_t pointer);
+			virtual ~DocBuffer();
+
+			void close();
+			int64_t getFilePointer() const;
+			int64_t length() const;
+			uint8_t readByte();
+			void readBytes(uint8_t* b, const int32_t len);
+			void seek(const int64_t _pos);
+			CL_NS(store)::IndexInput* clone() const;
+
+			const char* getDirectoryType() const;
+			const char* getObjectName() const;
+			static const char* getClassName();
+		};
     friend class FieldsWriter;
 
 		// Instances of this class hold field properties and data
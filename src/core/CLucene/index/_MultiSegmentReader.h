@@ -52,6 +52,8 @@ protected:
 	// synchronized
 	void doDelete(const int32_t n);
   DirectoryIndexReader* doReopen(SegmentInfos* infos);
+  bool doDocuments(const int32_t* docs, CL_NS(document)::Document** result, size_t count,
+    const CL_NS(document)::FieldSelector* fieldSelector);
 
   void initialize( CL_NS(util)::ArrayBase<IndexReader*>* subReaders);
 
@@ -90,6 +92,9 @@ public:
 
   bool document(int32_t n, CL_NS(document)::Document& doc, const CL_NS(document)::FieldSelector* fieldSelector);
 
+  /** Sets the cache on this reader and all segment readers */
+  void setDocumentCache(DocumentCache* cache);
+
 	bool isDeleted(const int32_t n);
 	bool hasDeletions() const;
 
@@ -108,8 +113,30 @@ public:
   void getFieldNames (FieldOption fldOption, StringArrayWithDeletor& retarray);
 	static void getFieldNames(FieldOption fldOption, StringArrayWithDeletor& retarray, CL_NS(util)::ArrayBase<IndexReader*>* subReaders);
 
+  int32_t getDocValuesType(const TCHAR* field);
+  bool getDocValues(const TCHAR* field, int32_t* result);
+  bool getDocValues(const TCHAR* field, float_t* result);
+  bool getDocValues(const TCHAR* field, int32_t* ords, StringArrayWithDeletor& values);
+
+  /** Doc values of a set of subreaders. A field has doc values if all subreaders
+  * with a column for it agree on its type. The documents of subreaders without
+  * a column have no value: 0, 0.0 or ord 0. */
+  static int32_t getDocValuesType(const TCHAR* field, CL_NS(util)::ArrayBase<IndexReader*>* subReaders);
+  static bool getDocValues(const TCHAR* field, int32_t* result, CL_NS(util)::ArrayBase<IndexReader*>* subReaders, const int32_t* starts);
+  static bool getDocValues(const TCHAR* field, float_t* result, CL_NS(util)::ArrayBase<IndexReader*>* subReaders, const int32_t* starts);
+  static bool getDocValues(const TCHAR* field, int32_t* ords, StringArrayWithDeletor& values,
+    CL_NS(util)::ArrayBase<IndexReader*>* subReaders, const int32_t* starts);
+
+  /** Loads a batch of documents of a set of subreaders, sorted in ascending order.
+  * @throws CL_ERR_IndexOutOfBounds if a document number is not in the subreaders */
+  static bool doDocuments(const int32_t* docs, CL_NS(document)::Document** result, size_t count,
+    const CL_NS(document)::FieldSelector* fieldSelector, CL_NS(util)::ArrayBase<IndexReader*>* subReaders, int32_t* starts);
+
+  const CL_NS(util)::ArrayBase<IndexReader*>* getSequentialSubReaders() const;
+
   void setTermInfosIndexDivisor(int32_t indexDivisor);
   int32_t getTermInfosIndexDivisor();
+  void getTermInfosCacheStats(int64_t& hits, int64_t& misses);
 
   const CL_NS(util)::ArrayBase<IndexReader*>* getSubReaders() const;
 
@@ -28,6 +28,7 @@
 
 CL_NS_DEF(index)
 class SegmentReader;
+class DocValuesReader;
 
 class SegmentTermDocs:public virtual TermDocs {
 protected:
@@ -242,6 +243,7 @@ class SegmentReader: public DirectoryIndexReader {
   ///Reads the Field Info file
   FieldsReader* fieldsReader;
   TermVectorsReader* termVectorsReaderOrig;
+  DocValuesReader* docValues;
   CL_NS(util)::ThreadLocal<TermVectorsReader*,
   CL_NS(util)::Deletor::Object<TermVectorsReader> >termVectorsLocal;
 
@@ -274,6 +276,10 @@ protected:
 
   DirectoryIndexReader* doReopen(SegmentInfos* infos);
 
+  ///Loads a batch of documents, reading neighbouring documents together
+  bool doDocuments(const int32_t* docs, CL_NS(document)::Document** result, size_t count,
+    const CL_NS(document)::FieldSelector* fieldSelector);
+
 public:
   /**
    * @throws CorruptIndexException if the index is corrupt
@@ -328,6 +334,9 @@ public:
   ///Gets the document identified by n
   bool document(int32_t n, CL_NS(document)::Document& doc, const CL_NS(document)::FieldSelector* fieldSelector);
 
+  ///Sets the document cache, dropping this segment from the previous cache
+  void setDocumentCache(DocumentCache* cache);
+
   ///Checks if the n-th document has been marked deleted
   bool isDeleted(const int32_t n);
 
@@ -349,6 +358,7 @@ public:
   void setTermInfosIndexDivisor(int32_t indexDivisor);
 
   int32_t getTermInfosIndexDivisor();
+  void getTermInfosCacheStats(int64_t& hits, int64_t& misses);
 
   ///Returns the bytes array that holds the norms of a named field.
   ///Returns fake norms if norms aren't available
@@ -357,6 +367,12 @@ public:
   ///Reads the Norms for field from disk
   void norms(const TCHAR* field, uint8_t* bytes);
 
+  ///Reads the doc values columns of the segment
+  int32_t getDocValuesType(const TCHAR* field);
+  bool getDocValues(const TCHAR* field, int32_t* result);
+  bool getDocValues(const TCHAR* field, float_t* result);
+  bool getDocValues(const TCHAR* field, int32_t* ords, StringArrayWithDeletor& values);
+
   ///concatenating segment with ext and x
   std::string SegmentName(const char* ext, const int32_t x=-1);
   ///Creates a filename in buffer by concatenating segment with ext and x
@@ -50,6 +50,9 @@ class SegmentMerger:LUCENE_BASE {
   // to merge the doc stores.
   bool mergeDocStores;
 
+  // Whether the merged segment has a doc values file
+  bool hasDocValues;
+
   /** Maximum number of contiguous documents to bulk-copy
   when merging stored fields */
   static int32_t MAX_RAW_MERGE_DOCS;
@@ -140,6 +143,7 @@ public:
 	
 private:
   CheckAbort* checkAbort;
+  CL_NS(store)::Directory* limitedDirectory; // wraps the writer's directory for merges, which are rate limited
 
 	void addIndexed(IndexReader* reader, FieldInfos* fieldInfos, StringArrayWithDeletor& names, 
 		bool storeTermVectors, bool storePositionWithTermVector,
@@ -191,6 +195,9 @@ private:
 	//Merges the norms for all fields 
 	void mergeNorms();
 
+	//Merges the doc values columns of all fields
+	void mergeDocValues();
+
 	void createCompoundFile(const char* filename, std::vector<std::string>* files=NULL);
 	friend class IndexWriter; //allow IndexWriter to use createCompoundFile
 };
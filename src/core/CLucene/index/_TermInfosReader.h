@@ -18,6 +18,54 @@ CL_CLASS_DEF(store,Directory)
 //#include "TermInfosWriter.h"
 
 CL_NS_DEF(index)
+
+/**
+* A bounded LRU cache of the TermInfos of recently looked up terms of one segment.
+* Queries look up the same term more than once (for docFreq when the weight is
+* created, then again when the postings are opened), and the same hot terms
+* over and over, so this saves the binary search of the term index and the scan of
+* the .tis file.
+*
+* The cache is split into a number of independently locked partitions, so it can
+* be shared by all threads searching the segment.
+*/
+class TermInfoCache: LUCENE_BASE{
+private:
+	struct Internal;
+	Internal* _internal;
+public:
+	/** Default number of terms kept per segment */
+	LUCENE_STATIC_CONSTANT(int32_t, DEFAULT_SIZE=1024);
+	/** Default number of partitions the cache is split into */
+	LUCENE_STATIC_CONSTANT(int32_t, DEFAULT_PARTITIONS=8);
+
+	/**
+	* @param maxSize the maximum number of terms kept. The least recently used
+	* terms of a partition are evicted once it holds maxSize/partitions terms.
+	* @param partitions the number of independently locked partitions.
+	*/
+	TermInfoCache(int32_t maxSize=DEFAULT_SIZE, int32_t partitions=DEFAULT_PARTITIONS);
+	~TermInfoCache();
+
+	/**
+	* Copies the cached TermInfo of term into ti.
+	* @return false if the term is not cached
+	*/
+	bool get(const Term* term, TermInfo* ti);
+
+	/** Adds the TermInfo of a term to the cache. The term is copied. */
+	void put(const Term* term, const TermInfo* ti);
+
+	/** Returns the number of lookups that were served from the cache */
+	int64_t getHitCount() const;
+
+	/** Returns the number of lookups that had to go to the term dictionary */
+	int64_t getMissCount() const;
+
+	/** Returns the number of terms currently held */
+	size_t size() const;
+};
+
 /** This stores a monotonically increasing set of <Term, TermInfo> pairs in a
 * Directory.  Pairs are accessed either by Term or by ordinal position the
 * set.
@@ -32,6 +80,7 @@ CL_NS_DEF(index)
 
 		CL_NS(util)::ThreadLocal<SegmentTermEnum*, 
 			CL_NS(util)::Deletor::Object<SegmentTermEnum> > enumerators;
+		TermInfoCache* termsCache;
 
 		SegmentTermEnum* getEnum();
 		SegmentTermEnum* origEnum;
@@ -101,7 +150,16 @@ CL_NS_DEF(index)
 		
 		/** Returns the TermInfo for a Term in the set, or null. */
 		TermInfo* get(const Term* term);
+
+		/** Returns the cache of looked up terms, or NULL once closed */
+		TermInfoCache* getCache() const;
 	private:
+		/**
+		* Looks up term in the term dictionary. Unlike get(), this
+		* always leaves the enumerator of this thread positioned at or after the term.
+		*/
+		TermInfo* seekTerm(const Term* term);
+
 		/** Reads the term info index file or .tti file. */
 		void ensureIndexIsRead();
 
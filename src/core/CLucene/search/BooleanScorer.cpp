@@ -10,6 +10,7 @@
 
 #include "Scorer.h"
 #include "Similarity.h"
+#include "QueryTimeout.h"
 #include "CLucene/util/StringBuffer.h"
 
 CL_NS_USE(util)
@@ -26,7 +27,8 @@ CL_NS_DEF(search)
     requiredMask(0),
     prohibitedMask(0),
 	coordFactors(NULL),
-    isTakingOwnership(isTakingOwnership)
+    isTakingOwnership(isTakingOwnership),
+    timeout(QueryTimeout::current())
   {
     bucketTable = _CLNEW BucketTable(this);
   }
@@ -260,7 +262,7 @@ CL_NS_DEF(search)
   int32_t BooleanScorer::BucketTable::size() const { return BooleanScorer::BucketTable_SIZE; }
 
   HitCollector* BooleanScorer::BucketTable::newCollector(const int32_t mask) {
-    return _CLNEW Collector(mask, this);
+    return _CLNEW Collector(mask, this, scorer->timeout);
   }
 
 
@@ -271,13 +273,16 @@ CL_NS_DEF(search)
 
 
 
-  BooleanScorer::Collector::Collector(const int32_t msk, BucketTable* bucketTbl):
+  BooleanScorer::Collector::Collector(const int32_t msk, BucketTable* bucketTbl, QueryTimeout* _timeout):
     bucketTable(bucketTbl),
-    mask(msk)
+    mask(msk),
+    timeout(_timeout)
   {
   }
 
   void BooleanScorer::Collector::collect(const int32_t doc, const float_t score){
+    if (timeout != NULL)
+      timeout->check();			  // bounds the scoring of large disjunctions
     BucketTable* table = bucketTable;
     int32_t i = doc & (BooleanScorer::BucketTable_SIZE-1);
     Bucket* bucket = &table->buckets[i];
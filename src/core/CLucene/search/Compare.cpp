@@ -47,6 +47,19 @@ int32_t ScoreDocComparators::IndexOrder::sortType() {
 
 
 
+namespace {
+	/** A string sort value which owns its copy of the term */
+	class OwnedTChar: public CL_NS(util)::Compare::TChar{
+		TCHAR* str;
+	public:
+		OwnedTChar(TCHAR* str): CL_NS(util)::Compare::TChar(str), str(str){
+		}
+		~OwnedTChar(){
+			_CLDELETE_CARRAY(str);
+		}
+	};
+}
+
 ScoreDocComparators::String::String(FieldCache::StringIndex* index, int32_t len)
 {
 	this->length = len;
@@ -56,13 +69,15 @@ ScoreDocComparators::String::String(FieldCache::StringIndex* index, int32_t len)
 int32_t ScoreDocComparators::String::compare (struct ScoreDoc* i, struct ScoreDoc* j) {
 	CND_PRECONDITION(i->doc<length, "i->doc>=length")
 	CND_PRECONDITION(j->doc<length, "j->doc>=length")
-	if (index->order[i->doc] < index->order[j->doc]) return -1;
-	if (index->order[i->doc] > index->order[j->doc]) return 1;
+	const int32_t ordI = index->getOrd(i->doc);
+	const int32_t ordJ = index->getOrd(j->doc);
+	if (ordI < ordJ) return -1;
+	if (ordI > ordJ) return 1;
 	return 0;
 }
 
 CL_NS(util)::Comparable* ScoreDocComparators::String::sortValue (struct ScoreDoc* i) {
-	return _CLNEW CL_NS(util)::Compare::TChar(index->lookup[index->order[i->doc]]);
+	return _CLNEW OwnedTChar(index->getTerm(index->getOrd(i->doc)));
 }
 
 int32_t ScoreDocComparators::String::sortType() {
@@ -7,6 +7,7 @@
 #include "CLucene/_ApiHeader.h"
 #include "_ConjunctionScorer.h"
 #include "Similarity.h"
+#include "QueryTimeout.h"
 #include "CLucene/util/_Arrays.h"
 #include <assert.h>
 #include <algorithm>
@@ -20,7 +21,8 @@ CL_NS_DEF(search)
 		firstTime(true),
 		more(false),
 		coord(0.0),
-		lastDoc(-1)
+		lastDoc(-1),
+		timeout(QueryTimeout::current())
 	{
     this->scorers = _CLNEW CL_NS(util)::ObjectArray<Scorer>(_scorers->size());
     _scorers->toArray(this->scorers->values);
@@ -31,7 +33,8 @@ CL_NS_DEF(search)
 		firstTime(true),
 		more(false),
 		coord(0.0),
-		lastDoc(-1)
+		lastDoc(-1),
+		timeout(QueryTimeout::current())
 	{
     this->scorers = _CLNEW CL_NS(util)::ObjectArray<Scorer>(_scorers->length);
     memcpy(this->scorers->values, _scorers->values, _scorers->length * sizeof(Scorer*));
@@ -63,6 +66,8 @@ CL_NS_DEF(search)
     Scorer* lastScorer = scorers->values[scorers->length-1];
     Scorer* firstScorer;
     while (more && (firstScorer=scorers->values[first])->doc() < (lastDoc=lastScorer->doc())) {
+      if (timeout != NULL)
+        timeout->check();
       more = firstScorer->skipTo(lastDoc);
       lastScorer = firstScorer;
       first = (first == (scorers->length-1)) ? 0 : first+1;
@@ -10,6 +10,7 @@
 #include "ScorerDocQueue.h"
 #include "SearchHeader.h"
 #include "Explanation.h"
+#include "QueryTimeout.h"
 
 #include "CLucene/util/StringBuffer.h"
 
@@ -25,6 +26,7 @@ DisjunctionSumScorer::DisjunctionSumScorer( DisjunctionSumScorer::ScorersType* _
     queueSize(-1),
     currentDoc(-1),
     currentScore(-1.0f),
+    timeout(QueryTimeout::current()),
     nrScorers(0),
     _nrMatchers(-1)
 {
@@ -157,6 +159,8 @@ bool DisjunctionSumScorer::score( HitCollector* hc, const int32_t max )
 bool DisjunctionSumScorer::advanceAfterCurrent()
 {
 	do { // repeat until minimum nr of matchers
+		if ( timeout != NULL )
+			timeout->check();
 		currentDoc = scorerDocQueue->topDoc();
 		currentScore = scorerDocQueue->topScore();
 
@@ -0,0 +1,471 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "FacetCollector.h"
+#include "FieldCache.h"
+#include "CLucene/index/IndexReader.h"
+#include "CLucene/index/Term.h"
+#include "CLucene/index/Terms.h"
+#include "CLucene/document/Field.h"
+#include "CLucene/util/Equators.h"
+#include <algorithm>
+#include <map>
+#include <vector>
+
+CL_NS_USE(index)
+CL_NS_USE(util)
+CL_NS_DEF(search)
+
+FacetResult::FacetResult(Value* values, int32_t valuesLength, int32_t distinctValues):
+	values(values),
+	valuesLength(valuesLength),
+	distinctValues(distinctValues)
+{
+}
+FacetResult::~FacetResult(){
+	for ( int32_t i=0;i<valuesLength;i++ )
+		_CLDELETE_LCARRAY(values[i].value);
+	_CLDELETE_ARRAY(values);
+}
+
+
+/**
+* The values of a field shared by all segments. Global ords are handed out
+* when the count of a segment ord is first merged, so only values that were
+* ever counted get one.
+*/
+class FacetField: LUCENE_BASE{
+	typedef std::map<const TCHAR*, int32_t, Compare::TChar> OrdsType;
+	OrdsType ords;
+public:
+	TCHAR* name;
+	bool multiValued;
+	TCHAR pathDelimiter;
+	std::vector<TCHAR*> values;
+	std::vector<int32_t> parents; // -1 for top level values
+	std::vector<int32_t> counts;
+
+	FacetField(const TCHAR* name, bool multiValued, TCHAR pathDelimiter):
+		name(STRDUP_TtoT(name)),
+		multiValued(multiValued),
+		pathDelimiter(pathDelimiter)
+	{
+	}
+	~FacetField(){
+		_CLDELETE_LCARRAY(name);
+		for ( size_t i=0;i<values.size();i++ )
+			_CLDELETE_LCARRAY(values[i]);
+	}
+
+	/** Returns the global ord of value, or -1 if it has none */
+	int32_t find(const TCHAR* value) const{
+		OrdsType::const_iterator itr = ords.find(value);
+		return itr == ords.end() ? -1 : itr->second;
+	}
+
+	int32_t ordOf(const TCHAR* value, int32_t parent){
+		OrdsType::iterator itr = ords.find(value);
+		if ( itr != ords.end() )
+			return itr->second;
+		const int32_t ord = (int32_t)values.size();
+		TCHAR* v = STRDUP_TtoT(value);
+		values.push_back(v);
+		parents.push_back(parent);
+		counts.push_back(0);
+		ords[v] = ord;
+		return ord;
+	}
+};
+
+/**
+* The counts of a field in one segment. Documents refer to the nodes of the
+* segment by ord: node 0 means no value, nodes 1 to numOrds-1 are the values
+* in term order. For hierarchical fields, the ancestors that are not values
+* themselves follow as extra nodes.
+*/
+class FacetSegmentField: LUCENE_BASE{
+	const FieldCache::StringIndex* index;   // single valued fields, NULL for multi valued ones
+	std::vector<int32_t> docStarts;         // multi valued: the ords of doc are docOrds[docStarts[doc]..docStarts[doc+1]]
+	std::vector<int32_t> docOrds;
+	std::vector<TCHAR*> labels;             // loaded from index when first needed
+	std::vector<int32_t> parents;           // hierarchical fields only, 0 for top level nodes
+	std::vector<int32_t> counts;
+	std::vector<int32_t> lastVisit;         // hierarchical fields only, the visit that last counted each node
+	int32_t visit;                          // numbers the calls to count, so a doc collected again counts again
+	std::vector<int32_t> toGlobal;          // -1 until mapped
+	bool hasCounts;
+
+	static bool hasTerms(IndexReader* reader, const TCHAR* field){
+		Term* term = _CLNEW Term(field, LUCENE_BLANK_STRING);
+		TermEnum* termEnum = reader->terms(term);
+		_CLDECDELETE(term);
+		Term* t = termEnum->term(false);
+		const bool ret = t != NULL && _tcscmp(t->field(), field) == 0;
+		termEnum->close();
+		_CLDELETE(termEnum);
+		return ret;
+	}
+
+	void readTerms(IndexReader* reader, const TCHAR* field){
+		std::vector<int32_t> docs, ords;
+		labels.push_back(NULL);
+
+		Term* term = _CLNEW Term(field, LUCENE_BLANK_STRING);
+		TermEnum* termEnum = reader->terms(term);
+		_CLDECDELETE(term);
+		TermDocs* termDocs = reader->termDocs();
+		try{
+			do{
+				Term* t = termEnum->term(false);
+				if ( t == NULL || _tcscmp(t->field(), field) != 0 )
+					break;
+				const int32_t ord = (int32_t)labels.size();
+				labels.push_back(STRDUP_TtoT(t->text()));
+				termDocs->seek(termEnum);
+				while ( termDocs->next() ){
+					docs.push_back(termDocs->doc());
+					ords.push_back(ord);
+				}
+			}while( termEnum->next() );
+		}_CLFINALLY(
+			termDocs->close();
+			_CLDELETE(termDocs);
+			termEnum->close();
+			_CLDELETE(termEnum);
+		);
+
+		// group the ords by document
+		const int32_t maxDoc = reader->maxDoc();
+		docStarts.assign(maxDoc+1, 0);
+		for ( size_t i=0;i<docs.size();i++ )
+			docStarts[docs[i]+1]++;
+		for ( int32_t i=0;i<maxDoc;i++ )
+			docStarts[i+1] += docStarts[i];
+		std::vector<int32_t> pos(docStarts.begin(), docStarts.end()-1);
+		docOrds.resize(docs.size());
+		for ( size_t i=0;i<docs.size();i++ )
+			docOrds[pos[docs[i]]++] = ords[i];
+	}
+
+	/** Returns the node of the parent path of path, adding it if the segment has no such value */
+	int32_t parentOf(const TCHAR* path, TCHAR delimiter, std::map<const TCHAR*, int32_t, Compare::TChar>& nodes){
+		size_t len = _tcslen(path);
+		while ( len > 0 && path[len] != delimiter )
+			len--;
+		if ( len == 0 )
+			return 0;
+		TCHAR* parent = _CL_NEWARRAY(TCHAR, len+1);
+		_tcsncpy(parent, path, len);
+		parent[len] = 0;
+
+		std::map<const TCHAR*, int32_t, Compare::TChar>::iterator itr = nodes.find(parent);
+		if ( itr != nodes.end() ){
+			_CLDELETE_LCARRAY(parent);
+			return itr->second;
+		}
+		const int32_t node = (int32_t)labels.size();
+		labels.push_back(parent);
+		parents.push_back(0);
+		nodes[parent] = node;
+		const int32_t grandParent = parentOf(parent, delimiter, nodes);
+		parents[node] = grandParent;
+		return node;
+	}
+
+	const TCHAR* label(int32_t node){
+		if ( labels[node] == NULL )
+			labels[node] = index->getTerm(node);
+		return labels[node];
+	}
+
+	void countNode(int32_t node){
+		// ancestors of a node counted in this visit were counted with it as well
+		while ( node > 0 && lastVisit[node] != visit ){
+			lastVisit[node] = visit;
+			counts[node]++;
+			node = parents[node];
+		}
+	}
+
+	void nextVisit(){
+		if ( visit == LUCENE_INT32_MAX_SHOULDBE ){
+			std::fill(lastVisit.begin(), lastVisit.end(), -1);
+			visit = 0;
+		}else{
+			visit++;
+		}
+	}
+
+	int32_t globalOrd(FacetField* field, int32_t node){
+		if ( toGlobal[node] < 0 ){
+			const int32_t parent = parents.empty() || parents[node] == 0 ? -1 : globalOrd(field, parents[node]);
+			toGlobal[node] = field->ordOf(label(node), parent);
+		}
+		return toGlobal[node];
+	}
+public:
+	FacetSegmentField(IndexReader* reader, FacetField* field):
+		index(NULL),
+		visit(0),
+		hasCounts(false)
+	{
+		if ( field->multiValued ){
+			readTerms(reader, field->name);
+		}else if ( reader->getDocValuesType(field->name) == CL_NS(document)::Field::DOCVALUES_STRING ||
+				hasTerms(reader, field->name) ){
+			index = FieldCache::DEFAULT()->getStringIndex(reader, field->name)->stringIndex;
+			labels.resize(index->count, NULL);
+		}else{
+			// no document of the segment has a value
+			labels.push_back(NULL);
+			docStarts.assign(reader->maxDoc()+1, 0);
+		}
+
+		if ( field->pathDelimiter != 0 ){
+			std::map<const TCHAR*, int32_t, Compare::TChar> nodes;
+			const int32_t numOrds = (int32_t)labels.size();
+			for ( int32_t ord=1;ord<numOrds;ord++ )
+				nodes[label(ord)] = ord;
+			parents.resize(numOrds, 0);
+			for ( int32_t ord=1;ord<numOrds;ord++ ){
+				// parentOf may add nodes, so don't hold on to an element of parents
+				const int32_t parent = parentOf(labels[ord], field->pathDelimiter, nodes);
+				parents[ord] = parent;
+			}
+			lastVisit.resize(labels.size(), -1);
+		}
+		counts.resize(labels.size(), 0);
+		toGlobal.resize(labels.size(), -1);
+	}
+	~FacetSegmentField(){
+		for ( size_t i=0;i<labels.size();i++ )
+			_CLDELETE_LCARRAY(labels[i]);
+	}
+
+	void count(int32_t doc){
+		hasCounts = true;
+		if ( index != NULL ){
+			const int32_t ord = index->getOrd(doc);
+			if ( parents.empty() ){
+				counts[ord]++;
+			}else{
+				nextVisit();
+				countNode(ord);
+			}
+		}else if ( parents.empty() ){
+			for ( int32_t i=docStarts[doc];i<docStarts[doc+1];i++ )
+				counts[docOrds[i]]++;
+		}else{
+			nextVisit();
+			for ( int32_t i=docStarts[doc];i<docStarts[doc+1];i++ )
+				countNode(docOrds[i]);
+		}
+	}
+
+	/** Adds the counts to the global counts of field and clears them */
+	void merge(FacetField* field){
+		if ( !hasCounts )
+			return;
+		const int32_t numNodes = (int32_t)counts.size();
+		for ( int32_t node=1;node<numNodes;node++ ){
+			if ( counts[node] == 0 )
+				continue;
+			field->counts[globalOrd(field, node)] += counts[node];
+			counts[node] = 0;
+		}
+		counts[0] = 0;
+		hasCounts = false;
+	}
+
+	void reset(){
+		if ( !hasCounts )
+			return;
+		std::fill(counts.begin(), counts.end(), 0);
+		hasCounts = false;
+	}
+};
+
+class FacetCollector::Internal{
+public:
+	struct Segment{
+		IndexReader* reader;
+		int32_t start;
+		int32_t end;
+		std::vector<FacetSegmentField*> fields; // NULL until the segment has a hit
+	};
+
+	std::vector<Segment> segments;
+	std::vector<FacetField*> fields;
+	size_t current;
+	int32_t totalHits;
+
+	Internal():
+		current(0),
+		totalHits(0)
+	{
+	}
+	~Internal(){
+		for ( size_t i=0;i<segments.size();i++ ){
+			for ( size_t j=0;j<segments[i].fields.size();j++ )
+				_CLDELETE(segments[i].fields[j]);
+		}
+		for ( size_t i=0;i<fields.size();i++ )
+			_CLDELETE(fields[i]);
+	}
+
+	void addReader(IndexReader* reader, int32_t& start){
+		const ArrayBase<IndexReader*>* subReaders = reader->getSequentialSubReaders();
+		if ( subReaders != NULL ){
+			for ( size_t i=0;i<subReaders->length;i++ )
+				addReader((*subReaders)[i], start);
+		}else if ( reader->maxDoc() > 0 ){
+			Segment segment;
+			segment.reader = reader;
+			segment.start = start;
+			segment.end = start + reader->maxDoc();
+			segments.push_back(segment);
+			start = segment.end;
+		}
+	}
+
+	Segment& segmentOf(int32_t doc){
+		Segment* segment = &segments[current];
+		if ( doc >= segment->start && doc < segment->end )
+			return *segment;
+		size_t lo = 0;
+		size_t hi = segments.size() - 1;
+		while ( lo < hi ){
+			const size_t mid = (lo + hi + 1) >> 1;
+			if ( segments[mid].start <= doc )
+				lo = mid;
+			else
+				hi = mid - 1;
+		}
+		current = lo;
+		return segments[lo];
+	}
+
+	FacetField* getField(const TCHAR* name, size_t* pos=NULL){
+		for ( size_t i=0;i<fields.size();i++ ){
+			if ( _tcscmp(fields[i]->name, name) == 0 ){
+				if ( pos != NULL )
+					*pos = i;
+				return fields[i];
+			}
+		}
+		TCHAR buf[LUCENE_MAX_FIELD_LEN+40];
+		_sntprintf(buf, LUCENE_MAX_FIELD_LEN+40, _T("field %s is not a facet field"), name);
+		_CLTHROWT(CL_ERR_IllegalArgument, buf);
+	}
+
+	/** Merges the counts of all segments into the global counts of field */
+	FacetField* mergeField(const TCHAR* name){
+		size_t pos;
+		FacetField* field = getField(name, &pos);
+		for ( size_t i=0;i<segments.size();i++ ){
+			if ( pos < segments[i].fields.size() && segments[i].fields[pos] != NULL )
+				segments[i].fields[pos]->merge(field);
+		}
+		return field;
+	}
+};
+
+/** Orders global ords by descending count, then by value */
+class FacetValueCompare{
+	const FacetField* field;
+public:
+	FacetValueCompare(const FacetField* field): field(field){}
+	bool operator()(int32_t a, int32_t b) const{
+		if ( field->counts[a] != field->counts[b] )
+			return field->counts[a] > field->counts[b];
+		return _tcscmp(field->values[a], field->values[b]) < 0;
+	}
+};
+
+FacetCollector::FacetCollector(IndexReader* reader):
+	_internal(_CLNEW Internal)
+{
+	int32_t start = 0;
+	_internal->addReader(reader, start);
+}
+FacetCollector::~FacetCollector(){
+	_CLDELETE(_internal);
+}
+
+void FacetCollector::addField(const TCHAR* field, bool multiValued, TCHAR pathDelimiter){
+	for ( size_t i=0;i<_internal->fields.size();i++ ){
+		if ( _tcscmp(_internal->fields[i]->name, field) == 0 )
+			_CLTHROWA(CL_ERR_IllegalArgument, "field is already a facet field");
+	}
+	_internal->fields.push_back(_CLNEW FacetField(field, multiValued, pathDelimiter));
+}
+
+void FacetCollector::collect(const int32_t doc, const float_t /*score*/){
+	Internal::Segment& segment = _internal->segmentOf(doc);
+	const size_t numFields = _internal->fields.size();
+	if ( segment.fields.size() < numFields )
+		segment.fields.resize(numFields, NULL);
+
+	const int32_t segmentDoc = doc - segment.start;
+	for ( size_t i=0;i<numFields;i++ ){
+		FacetSegmentField* field = segment.fields[i];
+		if ( field == NULL )
+			field = segment.fields[i] = _CLNEW FacetSegmentField(segment.reader, _internal->fields[i]);
+		field->count(segmentDoc);
+	}
+	_internal->totalHits++;
+}
+
+int32_t FacetCollector::getTotalHits() const{
+	return _internal->totalHits;
+}
+
+FacetResult* FacetCollector::getTopValues(const TCHAR* fieldName, int32_t n, const TCHAR* parent){
+	FacetField* field = _internal->mergeField(fieldName);
+
+	std::vector<int32_t> ords;
+	const int32_t parentOrd = parent == NULL ? -1 : field->find(parent);
+	if ( parent == NULL || parentOrd >= 0 ){
+		const int32_t numOrds = (int32_t)field->values.size();
+		for ( int32_t ord=0;ord<numOrds;ord++ ){
+			if ( field->counts[ord] > 0 && field->parents[ord] == parentOrd )
+				ords.push_back(ord);
+		}
+	}
+
+	const int32_t len = n < (int32_t)ords.size() ? n : (int32_t)ords.size();
+	std::partial_sort(ords.begin(), ords.begin() + len, ords.end(), FacetValueCompare(field));
+	FacetResult::Value* values = _CL_NEWARRAY(FacetResult::Value, len > 0 ? len : 1);
+	for ( int32_t i=0;i<len;i++ ){
+		values[i].value = STRDUP_TtoT(field->values[ords[i]]);
+		values[i].count = field->counts[ords[i]];
+	}
+	return _CLNEW FacetResult(values, len, (int32_t)ords.size());
+}
+
+int32_t FacetCollector::getCount(const TCHAR* fieldName, const TCHAR* value){
+	FacetField* field = _internal->mergeField(fieldName);
+	const int32_t ord = field->find(value);
+	return ord < 0 ? 0 : field->counts[ord];
+}
+
+void FacetCollector::reset(){
+	for ( size_t i=0;i<_internal->segments.size();i++ ){
+		std::vector<FacetSegmentField*>& fields = _internal->segments[i].fields;
+		for ( size_t j=0;j<fields.size();j++ ){
+			if ( fields[j] != NULL )
+				fields[j]->reset();
+		}
+	}
+	for ( size_t i=0;i<_internal->fields.size();i++ ){
+		std::vector<int32_t>& counts = _internal->fields[i]->counts;
+		std::fill(counts.begin(), counts.end(), 0);
+	}
+	_internal->totalHits = 0;
+}
+
+CL_NS_END
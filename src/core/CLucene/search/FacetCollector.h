@@ -0,0 +1,107 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_FacetCollector_
+#define _lucene_search_FacetCollector_
+
+#include "SearchHeader.h"
+
+CL_CLASS_DEF(index,IndexReader)
+
+CL_NS_DEF(search)
+
+/**
+ * The top values of a facet field, as returned by {@link FacetCollector#getTopValues}.
+ */
+class CLUCENE_EXPORT FacetResult: LUCENE_BASE{
+public:
+	struct Value{
+		/** The value, the full path for hierarchical fields */
+		TCHAR* value;
+		/** The number of collected documents with this value (or a value below it) */
+		int32_t count;
+	};
+
+	/** The top values, by descending count and then by value */
+	Value* values;
+	int32_t valuesLength;
+
+	/** The number of distinct values that had a count, of which values holds the top ones */
+	int32_t distinctValues;
+
+	/** @memory Consumes values and their strings */
+	FacetResult(Value* values, int32_t valuesLength, int32_t distinctValues);
+	~FacetResult();
+};
+
+/**
+ * A HitCollector counting the values of one or more fields of all collected
+ * documents, which can be used for drill down navigation next to the hits of
+ * a search. All fields are counted in the same pass over the matching
+ * documents.
+ *
+ * Counting works per segment of the reader: each hit increments a counter
+ * of the ord the document has in the segment. Single valued fields use the
+ * segment's {@link FieldCache::StringIndex} (which is built from string
+ * doc values if the field has them), multi valued fields are read from the
+ * segment's postings once. Segment ords are only mapped to values shared by
+ * all segments when results are requested, and only for ords that were
+ * counted. Segments without hits are never loaded.
+ *
+ * Values of a hierarchical field are paths such as <code>a/b/c</code>. A
+ * document is counted once for its value and once for each ancestor path
+ * (<code>a/b</code> and <code>a</code>), so {@link #getTopValues} can return
+ * the top children of any path.
+ *
+ * The data loaded for each segment is kept, so a collector can be {@link #reset}
+ * and used for more searches on the same reader.
+ *
+ * <pre>
+ * FacetCollector facets(reader);
+ * facets.addField(_T("category"), false, '/');
+ * facets.addField(_T("tag"), true);
+ * searcher._search(query, &facets);
+ * FacetResult* top = facets.getTopValues(_T("category"), 10);
+ * </pre>
+ */
+class CLUCENE_EXPORT FacetCollector: public HitCollector{
+	class Internal;
+	Internal* _internal;
+public:
+	/** Counts the values of documents of reader, which must be the reader that is searched */
+	FacetCollector(CL_NS(index)::IndexReader* reader);
+	virtual ~FacetCollector();
+
+	/** Counts the values of field.
+	 * @param multiValued True to count all terms a document has in field, otherwise only
+	 *   the single value a {@link FieldCache::StringIndex} holds for it is counted.
+	 * @param pathDelimiter The character separating the levels of a hierarchical field,
+	 *   or 0 if the field is not hierarchical.
+	 */
+	void addField(const TCHAR* field, bool multiValued=false, TCHAR pathDelimiter=0);
+
+	void collect(const int32_t doc, const float_t score);
+
+	/** Returns the number of documents collected since the last reset */
+	int32_t getTotalHits() const;
+
+	/** Returns the top values of field that were counted since the last reset.
+	 * @param n The maximum number of values to return
+	 * @param parent For hierarchical fields, the path to return the children of.
+	 *   NULL returns the top level values.
+	 * @memory The caller must delete the result
+	 */
+	FacetResult* getTopValues(const TCHAR* field, int32_t n, const TCHAR* parent=NULL);
+
+	/** Returns the count of a single value of field, 0 if it was not counted */
+	int32_t getCount(const TCHAR* field, const TCHAR* value);
+
+	/** Clears all counts. The per segment data that was loaded is kept. */
+	void reset();
+};
+
+CL_NS_END
+#endif
@@ -32,9 +32,11 @@ FieldCacheAuto::FieldCacheAuto(int32_t len, int32_t type){
 	floatArray=NULL;
 	stringIndex=NULL;
 	stringArray=NULL;
+	stringData=NULL;
 	comparableArray=NULL;
 	sortComparator=NULL;
 	scoreDocComparator=NULL;
+	order=0;
 }
 FieldCacheAuto::~FieldCacheAuto(){
 	if ( contentType == FieldCacheAuto::INT_ARRAY ){
@@ -44,11 +46,12 @@ FieldCacheAuto::~FieldCacheAuto(){
 	}else if ( contentType == FieldCacheAuto::STRING_INDEX ){
 		_CLDELETE(stringIndex);
     }else if ( contentType == FieldCacheAuto::STRING_ARRAY ){
-		if ( ownContents ){
+		if ( ownContents && stringData == NULL ){
 			for ( int32_t i=0;i<contentLen;i++ )
 				_CLDELETE_CARRAY(stringArray[i]);
 		}
 		_CLDELETE_ARRAY(stringArray);
+		_CLDELETE_ARRAY(stringData);
 	}else if ( contentType == FieldCacheAuto::COMPARABLE_ARRAY ){
 		if ( ownContents ){
 			for ( int32_t i=0;i<contentLen;i++ )
@@ -8,6 +8,7 @@
 #define _lucene_search_FieldCache_
 
 //#include "Sort.h"
+#include "CLucene/util/PackedInts.h"
 
 CL_CLASS_DEF(index,IndexReader)
 CL_CLASS_DEF(search,SortComparator)
@@ -28,22 +29,46 @@ public:
    virtual ~FieldCache(){
    }
 
-	/** Expert: Stores term text values and document ordering data. */
+	/** Expert: Stores term text values and document ordering data.
+	 *
+	 * The ord of each document is bit packed with just as many bits as the
+	 * number of terms needs. The term text is kept as UTF-8 in a single block,
+	 * each term followed by a 0 byte, and is addressed by a packed offset per ord.
+	 * Ord 0 is used by documents without a term in the field and sorts first.
+	 */
 	class CLUCENE_EXPORT StringIndex:LUCENE_BASE {
+		CL_NS(util)::PackedInts* ords;
+		uint8_t* termBytes;
+		CL_NS(util)::PackedInts* termOffsets;
 	public:
-		/** All the term values, in natural order. */
-		TCHAR** lookup;
-
-		/** For each document, an index into the lookup array. */
-		int32_t* order;
-
-        int count;
-
-		/** Creates one of these objects 
-            @memory Consumes all memory given.
-        */
-		StringIndex (int32_t* values, TCHAR** lookup, int count);
-        ~StringIndex();
+		/** The number of ords, including ord 0. */
+		int count;
+
+		/** Creates one of these objects
+		    @param ords the ord of each document
+		    @param termBytes the 0 terminated UTF-8 text of all terms, in natural order
+		    @param termOffsets the position in termBytes of the term of each ord
+		    @param count the number of ords, including ord 0
+		    @memory Consumes all memory given.
+		*/
+		StringIndex (CL_NS(util)::PackedInts* ords, uint8_t* termBytes, CL_NS(util)::PackedInts* termOffsets, int count);
+		~StringIndex();
+
+		/** Returns the ord of the term of doc, or 0 if doc has no term. */
+		inline int32_t getOrd(const int32_t doc) const{
+			return (int32_t)ords->get(doc);
+		}
+
+		/** Returns a copy of the term of ord, or NULL for ord 0.
+		    @memory The caller must delete the returned string
+		*/
+		TCHAR* getTerm(const int32_t ord) const;
+
+		/** Returns the UTF-8 text of the term of ord, or NULL for ord 0 */
+		const char* getTermUTF8(const int32_t ord) const;
+
+		/** Returns the number of bytes of heap used by this index */
+		size_t ramBytesUsed() const;
 	};
 
 
@@ -151,6 +176,11 @@ public:
 		SORT_COMPARATOR=6,
 		SCOREDOC_COMPARATOR=7
 	};
+	/** Flags for {@link #order} */
+	enum{
+		ORDER_ASCENDING=1,
+		ORDER_DESCENDING=2
+	};
 
 	FieldCacheAuto(int32_t len, int32_t type);
 	~FieldCacheAuto();
@@ -162,9 +192,11 @@ public:
 	float_t* floatArray; //item 2
 	FieldCache::StringIndex* stringIndex; //item 3
 	TCHAR** stringArray; //item 4
+	TCHAR* stringData; //shared text that the items of stringArray point into, if any
 	CL_NS(util)::Comparable** comparableArray; //item 5
 	SortComparator* sortComparator; //item 6
 	ScoreDocComparator* scoreDocComparator; //item 7
+	uint8_t order; //ORDER_ flags that hold for the values of items 1-3 in document order, 0 if unordered
 
 };
 
@@ -12,6 +12,7 @@
 #include "CLucene/util/_StringIntern.h"
 #include "CLucene/util/Misc.h"
 #include "Sort.h"
+#include "CLucene/document/Field.h"
 
 CL_NS_USE(util)
 CL_NS_USE(index)
@@ -62,18 +63,138 @@ public:
 	}
 };
 
-FieldCache::StringIndex::StringIndex (int32_t* values, TCHAR** lookup, int count) {
-    this->count = count;
-	this->order = values;
-	this->lookup = lookup;
+FieldCache::StringIndex::StringIndex (PackedInts* ords, uint8_t* termBytes, PackedInts* termOffsets, int count):
+	ords(ords),
+	termBytes(termBytes),
+	termOffsets(termOffsets),
+	count(count)
+{
 }
 
 FieldCache::StringIndex::~StringIndex(){
-    _CLDELETE_ARRAY(order);
+	_CLDELETE(ords);
+	_CLDELETE_ARRAY(termBytes);
+	_CLDELETE(termOffsets);
+}
+
+const char* FieldCache::StringIndex::getTermUTF8(const int32_t ord) const{
+	if ( ord == 0 )
+		return NULL;
+	return (const char*)termBytes + termOffsets->get(ord);
+}
 
-    for ( int i=0;i<count;i++ )
-        _CLDELETE_CARRAY(lookup[i]);
-    _CLDELETE_ARRAY(lookup);
+TCHAR* FieldCache::StringIndex::getTerm(const int32_t ord) const{
+	const char* text = getTermUTF8(ord);
+	if ( text == NULL )
+		return NULL;
+	const size_t len = strlen(text);
+	TCHAR* ret = _CL_NEWARRAY(TCHAR, len+1);
+#ifdef _UCS2
+	lucene_utf8towcs(ret, text, len+1);
+#else
+	memcpy(ret, text, len);
+	ret[len] = 0;
+#endif
+	return ret;
+}
+
+size_t FieldCache::StringIndex::ramBytesUsed() const{
+	size_t bytes = ords->ramBytesUsed() + termOffsets->ramBytesUsed();
+	if ( count > 1 )
+		bytes += (size_t)termOffsets->get(count-1) + strlen(getTermUTF8(count-1)) + 1;
+	return bytes;
+}
+
+namespace {
+  /** Collects the terms of a StringIndex, in order, as 0 terminated UTF-8 */
+  class StringIndexTerms{
+    std::string bytes;
+    std::vector<size_t> offsets;
+  public:
+    StringIndexTerms(){
+      offsets.push_back(0); // ord 0 has no term
+    }
+    void add(const TCHAR* text){
+      offsets.push_back(bytes.size());
+#ifdef _UCS2
+      bytes.append(lucene_wcstoutf8string(text, _tcslen(text)));
+#else
+      bytes.append(text);
+#endif
+      bytes.push_back(0);
+    }
+    int32_t count() const{
+      return (int32_t)offsets.size();
+    }
+    /** Creates the index, which consumes ords */
+    FieldCache::StringIndex* toIndex(PackedInts* ords) const{
+      uint8_t* termBytes = _CL_NEWARRAY(uint8_t, bytes.size()+1);
+      memcpy(termBytes, bytes.data(), bytes.size());
+      PackedInts* termOffsets = _CLNEW PackedInts(count(), PackedInts::bitsRequired(bytes.size()));
+      for ( size_t i=1;i<offsets.size();i++ )
+        termOffsets->set((int32_t)i, offsets[i]);
+      return _CLNEW FieldCache::StringIndex(ords, termBytes, termOffsets, count());
+    }
+  };
+
+  /** Collects the terms of a string array, in order, into one block of 0 terminated strings */
+  class StringArrayTerms{
+    std::basic_string<TCHAR> chars;
+    std::vector<size_t> offsets;
+    TCHAR* block;
+  public:
+    StringArrayTerms(): block(NULL){
+    }
+    ~StringArrayTerms(){
+      _CLDELETE_ARRAY(block);
+    }
+    void add(const TCHAR* text){
+      offsets.push_back(chars.size());
+      chars.append(text);
+      chars.push_back(0);
+    }
+    /** Copies the collected terms into the block. Call once all terms were added. */
+    void finish(){
+      if ( block != NULL )
+        return;
+      block = _CL_NEWARRAY(TCHAR, chars.size()+1);
+      memcpy(block, chars.data(), chars.size()*sizeof(TCHAR));
+    }
+    /** Returns the copy of the n-th term in the block */
+    TCHAR* get(size_t n) const{
+      return block + offsets[n];
+    }
+    /** Takes ownership of the block */
+    TCHAR* takeBlock(){
+      finish();
+      TCHAR* ret = block;
+      block = NULL;
+      return ret;
+    }
+  };
+
+  /** Returns the FieldCacheAuto::ORDER_ flags that hold for the first n values */
+  template<typename Values>
+  uint8_t valuesOrder(const Values& values, const int32_t n){
+    uint8_t order = FieldCacheAuto::ORDER_ASCENDING | FieldCacheAuto::ORDER_DESCENDING;
+    for ( int32_t i=1; i<n && order != 0; i++ ){
+      if ( values[i-1] < values[i] )
+        order &= ~FieldCacheAuto::ORDER_DESCENDING;
+      else if ( values[i] < values[i-1] )
+        order &= ~FieldCacheAuto::ORDER_ASCENDING;
+    }
+    return order;
+  }
+
+  /** Indexes the ords of a StringIndex by document */
+  struct StringIndexOrds{
+    const FieldCache::StringIndex* index;
+    StringIndexOrds(const FieldCache::StringIndex* index): index(index){
+    }
+    int32_t operator[](const int32_t doc) const{
+      return index->getOrd(doc);
+    }
+  };
 }
 
 FieldCacheImpl::FieldCacheImpl()
@@ -239,7 +360,8 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
       int32_t retLen = reader->maxDoc();
       int32_t* retArray = _CL_NEWARRAY(int32_t,retLen);
 	    memset(retArray,0,sizeof(int32_t)*retLen);
-      if (retLen > 0) {
+      // doc values columns were written at index time and need no uninverting
+      if (retLen > 0 && !reader->getDocValues(field, retArray)) {
         TermDocs* termDocs = reader->termDocs();
 
 	    Term* term = _CLNEW Term (field, LUCENE_BLANK_STRING, false);
@@ -270,6 +392,7 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
 
       FieldCacheAuto* fa = _CLNEW FieldCacheAuto(retLen,FieldCacheAuto::INT_ARRAY);
       fa->intArray = retArray;
+      fa->order = valuesOrder(retArray, retLen);
 
       store (reader, field, SortField::INT, fa);
 	    CLStringIntern::unintern(field);
@@ -287,7 +410,7 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
 	  int32_t retLen = reader->maxDoc();
       float_t* retArray = _CL_NEWARRAY(float_t,retLen);
 	  memset(retArray,0,sizeof(float_t)*retLen);
-      if (retLen > 0) {
+      if (retLen > 0 && !reader->getDocValues(field, retArray)) {
         TermDocs* termDocs = reader->termDocs();
 
 		Term* term = _CLNEW Term (field, LUCENE_BLANK_STRING, false);
@@ -319,6 +442,7 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
 
 	  FieldCacheAuto* fa = _CLNEW FieldCacheAuto(retLen,FieldCacheAuto::FLOAT_ARRAY);
 	  fa->floatArray = retArray;
+	  fa->order = valuesOrder(retArray, retLen);
 
       store (reader, field, SortField::FLOAT, fa);
 	  CLStringIntern::unintern(field);
@@ -338,7 +462,21 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
 	  int32_t retLen = reader->maxDoc();
       TCHAR** retArray = _CL_NEWARRAY(TCHAR*,retLen+1);
       memset(retArray,0,sizeof(TCHAR*)*(retLen+1));
-      if (retLen > 0) {
+
+      // documents with the same term share a single copy of its text
+      StringArrayTerms terms;
+      ValueArray<int32_t> ords(retLen);
+      StringArrayWithDeletor values;
+      if (retLen > 0 && reader->getDocValues(field, ords.values, values)) {
+        for ( size_t i=0;i<values.size();i++ )
+          terms.add(values[i]);
+        terms.finish();
+        for ( int32_t i=0;i<retLen;i++ ){
+          if ( ords[i] != 0 )
+            retArray[i] = terms.get(ords[i]-1);
+        }
+      } else if (retLen > 0) {
+        ords.deleteValues();
         TermDocs* termDocs = reader->termDocs();
 
 		    Term* term = _CLNEW Term (field, LUCENE_BLANK_STRING, false);
@@ -349,16 +487,30 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
           if (termEnum->term(false) == NULL) {
             _CLTHROWA(CL_ERR_Runtime,"no terms in field "); //todo: extend to + field);
           }
+          // collect the text of all terms first, so that it can live in one block
+          size_t count = 0;
           do {
-            Term* term = termEnum->term(false);
-            if (term->field() != field)
+            Term* t = termEnum->term(false);
+            if (t->field() != field)
 				break;
-            const TCHAR* termval = term->text();
+            terms.add(t->text());
+            count++;
+          } while (termEnum->next());
+          terms.finish();
+
+          termEnum->close();
+          _CLDELETE(termEnum);
+          term = _CLNEW Term (field, LUCENE_BLANK_STRING, false);
+          termEnum = reader->terms (term);
+          _CLDECDELETE(term);
+          for ( size_t n=0; n<count; n++ ) {
+            TCHAR* termval = terms.get(n);
             termDocs->seek (termEnum);
             while (termDocs->next()) {
-              retArray[termDocs->doc()] = STRDUP_TtoT(termval); //todo: any better way of doing this???
+              retArray[termDocs->doc()] = termval;
             }
-          } while (termEnum->next());
+            termEnum->next();
+          }
         } _CLFINALLY(
 		  retArray[retLen]=NULL;
           termDocs->close();
@@ -369,7 +521,7 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
       }
 	    FieldCacheAuto* fa = _CLNEW FieldCacheAuto(retLen,FieldCacheAuto::STRING_ARRAY);
 	    fa->stringArray = retArray;
-	    fa->ownContents=true;
+	    fa->stringData = terms.takeBlock();
       store (reader, field, SortField::STRING, fa);
 	    CLStringIntern::unintern(field);
       return fa;
@@ -382,83 +534,83 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
   FieldCacheAuto* FieldCacheImpl::getStringIndex (IndexReader* reader, const TCHAR* field){
 	  field = CLStringIntern::intern(field);
     FieldCacheAuto* ret = lookup (reader, field, STRING_INDEX);
-    int32_t t = 0;  // current term number
     if (ret == NULL) {
 	    int32_t retLen = reader->maxDoc();
-      int32_t* retArray = _CL_NEWARRAY(int32_t,retLen);
-	    memset(retArray,0,sizeof(int32_t)*retLen);
 
-      TCHAR** mterms = _CL_NEWARRAY(TCHAR*,retLen+2);
-      mterms[0]=NULL;
-      if ( retLen > 0 ) {
+      // ord 0 is the entry for documents that have no terms in this field
+      // should a document with no terms be at top or bottom?
+      // this puts them at the top - if it is changed, FieldDocSortedHitQueue
+      // needs to change as well.
+      StringIndexTerms terms;
+      PackedInts* ords = NULL;
+
+      ValueArray<int32_t> docValues(retLen);
+      StringArrayWithDeletor values;
+      if ( retLen > 0 && reader->getDocValues(field, docValues.values, values) ) {
+        // the column holds at most one value per document
+        for ( size_t i=0;i<values.size();i++ )
+          terms.add(values[i]);
+        ords = _CLNEW PackedInts(retLen, PackedInts::bitsRequired(terms.count()-1));
+        for ( int32_t i=0;i<retLen;i++ )
+          ords->set(i, docValues[i]);
+      } else if ( retLen > 0 ) {
+        docValues.deleteValues();
         TermDocs* termDocs = reader->termDocs();
 
 		    Term* term = _CLNEW Term (field, LUCENE_BLANK_STRING, false);
         TermEnum* termEnum = reader->terms (term);
 		    _CLDECDELETE(term);
 
-
-		    CND_PRECONDITION(t+1 <= retLen, "t out of bounds");
-
-        // an entry for documents that have no terms in this field
-        // should a document with no terms be at top or bottom?
-        // this puts them at the top - if it is changed, FieldDocSortedHitQueue
-        // needs to change as well.
-        mterms[t++] = NULL;
-
         try {
           if (termEnum->term(false) == NULL) {
             _CLTHROWA(CL_ERR_Runtime,"no terms in field"); //todo: make rich message " + field);
           }
+          // the first pass collects the terms, so that the ords can be
+          // packed with the width the number of terms needs
           do {
-            Term* term = termEnum->term(false);
-            if (term->field() != field)
+            Term* t = termEnum->term(false);
+            if (t->field() != field)
 			        break;
 
-            // store term text
             // we expect that there is at most one term per document
-            if (t >= retLen+1)
+            if (terms.count() >= retLen+1)
 			        _CLTHROWA(CL_ERR_Runtime,"there are more terms than documents in field"); //todo: rich error \"" + field + "\"");
-            mterms[t] = STRDUP_TtoT(term->text());
+            terms.add(t->text());
+          } while (termEnum->next());
 
-            termDocs->seek (termEnum);
-            while (termDocs->next()) {
-              retArray[termDocs->doc()] = t;
+          termEnum->close();
+          _CLDELETE(termEnum);
+          term = _CLNEW Term (field, LUCENE_BLANK_STRING, false);
+          termEnum = reader->terms (term);
+          _CLDECDELETE(term);
+          ords = _CLNEW PackedInts(retLen, PackedInts::bitsRequired(terms.count()-1));
+          try {
+            for ( int32_t ord=1; ord<terms.count(); ord++ ){
+              termDocs->seek (termEnum);
+              while (termDocs->next()) {
+                ords->set(termDocs->doc(), ord);
+              }
+              termEnum->next();
             }
-
-            t++;
-          } while (termEnum->next());
-		      CND_PRECONDITION(t<retLen+2,"t out of bounds");
-		      mterms[t] = NULL;
+          } catch(...) {
+            _CLDELETE(ords);
+            throw;
+          }
         } _CLFINALLY(
           termDocs->close();
           _CLDELETE(termDocs);
           termEnum->close();
           _CLDELETE(termEnum);
         );
-
-        if (t == 0) {
-          // if there are no terms, make the term array
-          // have a single NULL entry
-          _CLDELETE_ARRAY(mterms);
-          mterms = _CL_NEWARRAY(TCHAR*,1); //todo: delete old mterms?
-          mterms[0]=NULL;
-          } else if (t < retLen) { //todo: check, was mterms.length
-          // if there are less terms than documents,
-          // trim off the dead array space
-          //const TCHAR** terms = _CL_NEWARRAY(TCHAR,t);
-          //System.arraycopy (mterms, 0, terms, 0, t);
-          //mterms = terms;
-
-          //we simply shorten the length of the array...
-        
-        }
+      } else {
+        ords = _CLNEW PackedInts(0, 0);
       }
-      FieldCache::StringIndex* value = _CLNEW FieldCache::StringIndex (retArray, mterms,t);
-  	  
+      FieldCache::StringIndex* value = terms.toIndex(ords);
+
 	    FieldCacheAuto* fa = _CLNEW FieldCacheAuto(retLen,FieldCacheAuto::STRING_INDEX);
 	    fa->stringIndex = value;
 	    fa->ownContents=true;
+	    fa->order = valuesOrder(StringIndexOrds(value), retLen);
       store (reader, field, STRING_INDEX, fa);
       CLStringIntern::unintern(field);
       return fa;
@@ -471,7 +623,17 @@ FieldCacheImpl::FileEntry::FileEntry (const TCHAR* field, int32_t type) {
   FieldCacheAuto* FieldCacheImpl::getAuto (IndexReader* reader, const TCHAR* field) {
 	  field = CLStringIntern::intern(field);
     FieldCacheAuto* ret = lookup (reader, field, SortField::AUTO);
-    if (ret == NULL) {
+    const int32_t docValuesType = ret == NULL ? reader->getDocValuesType(field) : 0;
+    if (docValuesType != 0) {
+      // the column type decides, no need to look at the terms
+      if ( docValuesType == CL_NS(document)::Field::DOCVALUES_INT )
+        ret = getInts (reader, field);
+      else if ( docValuesType == CL_NS(document)::Field::DOCVALUES_FLOAT )
+        ret = getFloats (reader, field);
+      else
+        ret = getStringIndex (reader, field);
+      store (reader, field, SortField::AUTO, ret);
+    } else if (ret == NULL) {
 	    Term* term = _CLNEW Term (field, LUCENE_BLANK_STRING, false);
       TermEnum* enumerator = reader->terms (term);
 	    _CLDECDELETE(term);
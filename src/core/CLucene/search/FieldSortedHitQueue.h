@@ -181,6 +181,16 @@ public:
    */
 	FieldDoc* fillFields (FieldDoc* doc) const;
 
+	/** Returns true if <code>doc</code> sorts after <code>after</code> */
+	inline bool sortsAfter(FieldDoc* doc, FieldDoc* after){
+		return lessThan(doc, after);
+	}
+	/** Takes the score of a hit into account for normalizing the scores, also if the
+	* hit is not inserted. Collectors that skip non-competitive hits call this. */
+	inline void updateMaxScore(float_t score){
+		if (score > maxscore) maxscore = score;
+	}
+
 	void setFields (SortField** fields){
 		this->fields = fields;
 	}
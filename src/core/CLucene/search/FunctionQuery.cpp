@@ -0,0 +1,389 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "FunctionQuery.h"
+#include "ValueSource.h"
+#include "Explanation.h"
+#include "SearchHeader.h"
+#include "Searchable.h"
+#include "Scorer.h"
+#include "Similarity.h"
+
+#include "CLucene/index/IndexReader.h"
+#include "CLucene/util/Misc.h"
+#include "CLucene/util/StringBuffer.h"
+
+CL_NS_USE(index)
+CL_NS_USE(util)
+CL_NS_DEF(search)
+
+class FunctionQuery::FunctionWeight: public Weight{
+	FunctionQuery* parentQuery;
+	Similarity* similarity;
+	float_t queryWeight;
+	float_t queryNorm;
+public:
+	FunctionWeight(FunctionQuery* parentQuery, Searcher* searcher):
+		parentQuery(parentQuery),
+		similarity(searcher->getSimilarity()),
+		queryWeight(0),
+		queryNorm(0)
+	{
+	}
+	virtual ~FunctionWeight(){}
+
+	Query* getQuery(){
+		return parentQuery;
+	}
+	float_t getValue(){
+		return queryWeight;
+	}
+	float_t sumOfSquaredWeights(){
+		queryWeight = parentQuery->getBoost();
+		return queryWeight * queryWeight;
+	}
+	void normalize(float_t _queryNorm){
+		queryNorm = _queryNorm;
+		queryWeight *= queryNorm;
+	}
+	Scorer* scorer(IndexReader* reader);
+	Explanation* explain(IndexReader* reader, int32_t doc);
+};
+
+class FunctionQuery::FunctionScorer: public Scorer{
+	IndexReader* reader;
+	FunctionValues* values;
+	float_t queryWeight;
+	int32_t id;
+	int32_t maxId;
+public:
+	FunctionScorer(IndexReader* reader, Similarity* similarity, FunctionValues* values, float_t queryWeight):
+		Scorer(similarity),
+		reader(reader),
+		values(values),
+		queryWeight(queryWeight),
+		id(-1),
+		maxId(reader->maxDoc() - 1)
+	{
+	}
+	virtual ~FunctionScorer(){
+		_CLDELETE(values);
+	}
+
+	int32_t doc() const{
+		return id;
+	}
+	bool next(){
+		while (id < maxId) {
+			id++;
+			if (!reader->isDeleted(id))
+				return true;
+		}
+		return false;
+	}
+	bool skipTo(int32_t target){
+		id = target - 1;
+		return next();
+	}
+	float_t score(){
+		return queryWeight * values->floatVal(id);
+	}
+	Explanation* explain(int32_t /*doc*/){
+		// not called... see FunctionWeight::explain()
+		return NULL;
+	}
+	TCHAR* toString(){
+		return stringDuplicate(_T("FunctionScorer"));
+	}
+};
+
+Scorer* FunctionQuery::FunctionWeight::scorer(IndexReader* reader){
+	return _CLNEW FunctionScorer(reader, similarity, parentQuery->source->getValues(reader), queryWeight);
+}
+
+Explanation* FunctionQuery::FunctionWeight::explain(IndexReader* reader, int32_t doc){
+	FunctionValues* values = parentQuery->source->getValues(reader);
+	Explanation* valueExpl = values->explain(doc);
+	_CLDELETE(values);
+
+	StringBuffer buf;
+	buf.append(_T("FunctionQuery("));
+	TCHAR* desc = parentQuery->source->description();
+	buf.append(desc);
+	_CLDELETE_LCARRAY(desc);
+	buf.append(_T("), product of:"));
+
+	Explanation* result = _CLNEW ComplexExplanation(true, valueExpl->getValue() * queryWeight, buf.getBuffer());
+	result->addDetail(valueExpl);
+	result->addDetail(_CLNEW Explanation(parentQuery->getBoost(), _T("boost")));
+	result->addDetail(_CLNEW Explanation(queryNorm, _T("queryNorm")));
+	return result;
+}
+
+FunctionQuery::FunctionQuery(ValueSource* source, bool deleteSource):
+	source(source),
+	deleteSource(deleteSource)
+{
+}
+FunctionQuery::FunctionQuery(const FunctionQuery& clone):
+	Query(clone),
+	source(clone.source->clone()),
+	deleteSource(true)
+{
+}
+FunctionQuery::~FunctionQuery(){
+	if ( deleteSource )
+		_CLDELETE(source);
+}
+
+Weight* FunctionQuery::_createWeight(Searcher* searcher){
+	return _CLNEW FunctionWeight(this, searcher);
+}
+
+ValueSource* FunctionQuery::getValueSource() const{
+	return source;
+}
+
+TCHAR* FunctionQuery::toString(const TCHAR* /*field*/) const{
+	StringBuffer buf;
+	TCHAR* desc = source->description();
+	buf.append(desc);
+	_CLDELETE_LCARRAY(desc);
+	buf.appendBoost(getBoost());
+	return buf.giveBuffer();
+}
+
+Query* FunctionQuery::clone() const{
+	return _CLNEW FunctionQuery(*this);
+}
+
+void FunctionQuery::extractTerms(TermSet* /*termset*/) const{
+}
+
+bool FunctionQuery::equals(Query* o) const{
+	if ( !o->instanceOf(FunctionQuery::getClassName()) )
+		return false;
+	FunctionQuery* other = static_cast<FunctionQuery*>(o);
+	return getBoost() == other->getBoost() && source->equals(other->source);
+}
+
+size_t FunctionQuery::hashCode() const{
+	return source->hashCode() ^ Similarity::floatToByte(getBoost()) ^ 0x5A3E6C21;
+}
+
+const char* FunctionQuery::getClassName(){
+	return "FunctionQuery";
+}
+const char* FunctionQuery::getObjectName() const{
+	return getClassName();
+}
+
+
+class CustomScoreQuery::CustomWeight: public Weight{
+	CustomScoreQuery* parentQuery;
+	Weight* subWeight;
+	Similarity* similarity;
+public:
+	CustomWeight(CustomScoreQuery* parentQuery, Searcher* searcher):
+		parentQuery(parentQuery),
+		subWeight(parentQuery->subQuery->_createWeight(searcher)),
+		similarity(parentQuery->getSimilarity(searcher))
+	{
+	}
+	virtual ~CustomWeight(){
+		_CLDELETE(subWeight);
+	}
+
+	Query* getQuery(){
+		return parentQuery;
+	}
+	float_t getValue(){
+		return parentQuery->getBoost();
+	}
+	// the boost is applied once, by the scorer to the combined score. It is
+	// left out of the sub query's weight and of the query norm
+	float_t sumOfSquaredWeights(){
+		return subWeight->sumOfSquaredWeights();
+	}
+	void normalize(float_t norm){
+		subWeight->normalize(norm);
+	}
+	Scorer* scorer(IndexReader* reader);
+	Explanation* explain(IndexReader* reader, int32_t doc);
+};
+
+class CustomScoreQuery::CustomScorer: public Scorer{
+	const CustomScoreQuery* parentQuery;
+	Scorer* subScorer;
+	FunctionValues* values;
+	float_t boost;
+public:
+	CustomScorer(const CustomScoreQuery* parentQuery, Similarity* similarity, Scorer* subScorer, FunctionValues* values):
+		Scorer(similarity),
+		parentQuery(parentQuery),
+		subScorer(subScorer),
+		values(values),
+		boost(parentQuery->getBoost())
+	{
+	}
+	virtual ~CustomScorer(){
+		_CLDELETE(subScorer);
+		_CLDELETE(values);
+	}
+
+	int32_t doc() const{
+		return subScorer->doc();
+	}
+	bool next(){
+		return subScorer->next();
+	}
+	bool skipTo(int32_t target){
+		return subScorer->skipTo(target);
+	}
+	float_t score(){
+		const int32_t id = subScorer->doc();
+		return boost * parentQuery->customScore(id, subScorer->score(), values->floatVal(id));
+	}
+	Explanation* explain(int32_t /*doc*/){
+		// not called... see CustomWeight::explain()
+		return NULL;
+	}
+	TCHAR* toString(){
+		return stringDuplicate(_T("CustomScorer"));
+	}
+};
+
+Scorer* CustomScoreQuery::CustomWeight::scorer(IndexReader* reader){
+	Scorer* subScorer = subWeight->scorer(reader);
+	if ( subScorer == NULL )
+		return NULL;
+	return _CLNEW CustomScorer(parentQuery, similarity, subScorer, parentQuery->source->getValues(reader));
+}
+
+Explanation* CustomScoreQuery::CustomWeight::explain(IndexReader* reader, int32_t doc){
+	Explanation* subQueryExpl = subWeight->explain(reader, doc);
+	if ( !subQueryExpl->isMatch() )
+		return subQueryExpl;
+
+	FunctionValues* values = parentQuery->source->getValues(reader);
+	Explanation* valueExpl = values->explain(doc);
+	_CLDELETE(values);
+
+	Explanation* customExpl = parentQuery->customExplain(doc, subQueryExpl, valueExpl);
+	const float_t boost = parentQuery->getBoost();
+	if ( boost == 1.0f )
+		return customExpl;
+
+	Explanation* result = _CLNEW ComplexExplanation(true, customExpl->getValue() * boost, _T("custom score, product of:"));
+	result->addDetail(customExpl);
+	result->addDetail(_CLNEW Explanation(boost, _T("boost")));
+	return result;
+}
+
+CustomScoreQuery::CustomScoreQuery(Query* subQuery, ValueSource* source, Combine combine, bool deleteQuery):
+	subQuery(subQuery),
+	source(source),
+	combine(combine),
+	deleteQuery(deleteQuery)
+{
+}
+CustomScoreQuery::CustomScoreQuery(const CustomScoreQuery& clone):
+	Query(clone),
+	subQuery(clone.subQuery->clone()),
+	source(clone.source->clone()),
+	combine(clone.combine),
+	deleteQuery(true)
+{
+}
+CustomScoreQuery::~CustomScoreQuery(){
+	if ( deleteQuery ){
+		_CLDELETE(subQuery);
+		_CLDELETE(source);
+	}
+}
+
+Weight* CustomScoreQuery::_createWeight(Searcher* searcher){
+	return _CLNEW CustomWeight(this, searcher);
+}
+
+Query* CustomScoreQuery::getSubQuery() const{
+	return subQuery;
+}
+ValueSource* CustomScoreQuery::getValueSource() const{
+	return source;
+}
+CustomScoreQuery::Combine CustomScoreQuery::getCombine() const{
+	return combine;
+}
+
+float_t CustomScoreQuery::customScore(int32_t /*doc*/, float_t subQueryScore, float_t value) const{
+	return combine == ADD ? subQueryScore + value : subQueryScore * value;
+}
+
+Explanation* CustomScoreQuery::customExplain(int32_t doc, Explanation* subQueryExpl, Explanation* valueExpl) const{
+	const float_t value = customScore(doc, subQueryExpl->getValue(), valueExpl->getValue());
+	Explanation* result = _CLNEW ComplexExplanation(true, value,
+		combine == ADD ? _T("custom score, sum of:") : _T("custom score, product of:"));
+	result->addDetail(subQueryExpl);
+	result->addDetail(valueExpl);
+	return result;
+}
+
+Query* CustomScoreQuery::rewrite(IndexReader* reader){
+	Query* rewritten = subQuery->rewrite(reader);
+	if ( rewritten == subQuery )
+		return this;                 // the sub query did not rewrite
+
+	CustomScoreQuery* clone = static_cast<CustomScoreQuery*>(this->clone());
+	_CLLDELETE(clone->subQuery);
+	clone->subQuery = rewritten;
+	return clone;
+}
+
+void CustomScoreQuery::extractTerms(TermSet* termset) const{
+	subQuery->extractTerms(termset);
+}
+
+TCHAR* CustomScoreQuery::toString(const TCHAR* field) const{
+	StringBuffer buf;
+	buf.append(_T("custom("));
+	TCHAR* tmp = subQuery->toString(field);
+	buf.append(tmp);
+	_CLDELETE_LCARRAY(tmp);
+	buf.append(combine == ADD ? _T(" + ") : _T(" * "));
+	tmp = source->description();
+	buf.append(tmp);
+	_CLDELETE_LCARRAY(tmp);
+	buf.appendChar(')');
+	buf.appendBoost(getBoost());
+	return buf.giveBuffer();
+}
+
+Query* CustomScoreQuery::clone() const{
+	return _CLNEW CustomScoreQuery(*this);
+}
+
+bool CustomScoreQuery::equals(Query* o) const{
+	if ( !o->instanceOf(getObjectName()) )
+		return false;
+	CustomScoreQuery* other = static_cast<CustomScoreQuery*>(o);
+	return getBoost() == other->getBoost() && combine == other->combine &&
+		subQuery->equals(other->subQuery) && source->equals(other->source);
+}
+
+size_t CustomScoreQuery::hashCode() const{
+	return (subQuery->hashCode() ^ source->hashCode() ^ combine) + Similarity::floatToByte(getBoost());
+}
+
+const char* CustomScoreQuery::getClassName(){
+	return "CustomScoreQuery";
+}
+const char* CustomScoreQuery::getObjectName() const{
+	return getClassName();
+}
+
+CL_NS_END
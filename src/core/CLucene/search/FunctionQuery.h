@@ -0,0 +1,114 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_FunctionQuery_
+#define _lucene_search_FunctionQuery_
+
+#include "Query.h"
+
+CL_CLASS_DEF(search,ValueSource)
+CL_CLASS_DEF(search,Explanation)
+CL_CLASS_DEF(index,IndexReader)
+
+CL_NS_DEF(search)
+
+/**
+ * A query that matches all documents and scores each with the value a
+ * {@link ValueSource} has for it, times the boost and query norm.
+ * Documents with a value of 0 or less are not collected.
+ */
+class CLUCENE_EXPORT FunctionQuery: public Query{
+	ValueSource* source;
+	bool deleteSource;
+protected:
+	FunctionQuery(const FunctionQuery& clone);
+	Weight* _createWeight(Searcher* searcher);
+public:
+	class FunctionWeight;
+	class FunctionScorer;
+
+	/** @param deleteSource If true, source is deleted with this query */
+	FunctionQuery(ValueSource* source, bool deleteSource=true);
+	virtual ~FunctionQuery();
+
+	ValueSource* getValueSource() const;
+
+	TCHAR* toString(const TCHAR* field = NULL) const;
+	Query* clone() const;
+
+	/** Expert: FunctionQuery provides no terms. */
+	void extractTerms(TermSet* termset) const;
+
+	bool equals(Query* other) const;
+	size_t hashCode() const;
+
+	static const char* getClassName();
+	const char* getObjectName() const;
+};
+
+/**
+ * A query that scores the documents matched by another query with a
+ * combination of their score and the value of a {@link ValueSource}, such as
+ * a recency or popularity boost. The score of a document is
+ * <code>customScore(doc, subQueryScore, value)</code> times the boost of this
+ * query. The sub query is normalized as usual, the value is not.
+ *
+ * Subclasses can override {@link #customScore} and {@link #customExplain}
+ * to combine the score and value in other ways.
+ */
+class CLUCENE_EXPORT CustomScoreQuery: public Query{
+public:
+	/** How customScore combines the sub query score with the value */
+	enum Combine{
+		MULTIPLY=1,
+		ADD=2
+	};
+private:
+	Query* subQuery;
+	ValueSource* source;
+	Combine combine;
+	bool deleteQuery;
+protected:
+	CustomScoreQuery(const CustomScoreQuery& clone);
+	Weight* _createWeight(Searcher* searcher);
+public:
+	class CustomWeight;
+	class CustomScorer;
+
+	/**
+	 * @param subQuery The query whose matches are scored
+	 * @param source The source of the value combined with the score of each match
+	 * @param deleteQuery If true, subQuery and source are deleted with this query
+	 */
+	CustomScoreQuery(Query* subQuery, ValueSource* source, Combine combine=MULTIPLY, bool deleteQuery=true);
+	virtual ~CustomScoreQuery();
+
+	Query* getSubQuery() const;
+	ValueSource* getValueSource() const;
+	Combine getCombine() const;
+
+	/** Returns the score of doc, by default the product or sum of subQueryScore and value */
+	virtual float_t customScore(int32_t doc, float_t subQueryScore, float_t value) const;
+
+	/** Explains {@link #customScore}.
+	 * @memory Consumes subQueryExpl and valueExpl. The caller must delete the returned explanation.
+	 */
+	virtual Explanation* customExplain(int32_t doc, Explanation* subQueryExpl, Explanation* valueExpl) const;
+
+	Query* rewrite(CL_NS(index)::IndexReader* reader);
+	void extractTerms(TermSet* termset) const;
+
+	TCHAR* toString(const TCHAR* field = NULL) const;
+	Query* clone() const;
+	bool equals(Query* other) const;
+	size_t hashCode() const;
+
+	static const char* getClassName();
+	const char* getObjectName() const;
+};
+
+CL_NS_END
+#endif
@@ -0,0 +1,269 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "GroupingCollector.h"
+#include "FieldCache.h"
+#include "FieldDoc.h"
+#include "FieldSortedHitQueue.h"
+#include "Sort.h"
+#include "CLucene/index/IndexReader.h"
+#include <map>
+#include <set>
+#include <vector>
+
+CL_NS_USE(index)
+CL_NS_DEF(search)
+
+GroupDocs::GroupDocs(TCHAR* groupValue, ScoreDoc* scoreDocs, int32_t scoreDocsLength, int32_t totalHits, float_t maxScore):
+	groupValue(groupValue),
+	scoreDocs(scoreDocs),
+	scoreDocsLength(scoreDocsLength),
+	totalHits(totalHits),
+	maxScore(maxScore)
+{
+}
+GroupDocs::~GroupDocs(){
+	_CLDELETE_LCARRAY(groupValue);
+	delete[] scoreDocs;
+}
+
+TopGroups::TopGroups(GroupDocs** groups, int32_t groupsLength, int32_t totalHits):
+	groups(groups),
+	groupsLength(groupsLength),
+	totalHits(totalHits)
+{
+}
+TopGroups::~TopGroups(){
+	for ( int32_t i=0;i<groupsLength;i++ )
+		_CLDELETE(groups[i]);
+	_CLDELETE_ARRAY(groups);
+}
+
+
+class FirstPassGroupingCollector::Internal{
+public:
+	struct Group{
+		int32_t ord;
+		FieldDoc* top; // the best document of the group
+	};
+	/** Orders groups by their best documents, best first */
+	class GroupCompare{
+		FieldSortedHitQueue* hq;
+	public:
+		GroupCompare(FieldSortedHitQueue* hq): hq(hq){}
+		bool operator()(const Group* a, const Group* b) const{
+			return hq->sortsAfter(b->top, a->top);
+		}
+	};
+	typedef std::set<Group*, GroupCompare> OrderedType;
+	typedef std::map<int32_t, Group*> GroupsType;
+
+	IndexReader* reader;
+	const FieldCache::StringIndex* index;
+	FieldSortedHitQueue* hq; // only used to compare documents by the group sort
+	OrderedType ordered;
+	GroupsType groups;
+	size_t topNGroups;
+	FieldDoc* spare;
+	int32_t totalHits;
+
+	Internal(IndexReader* reader, const TCHAR* groupField, const Sort* groupSort, int32_t topNGroups):
+		reader(reader),
+		index(FieldCache::DEFAULT()->getStringIndex(reader, groupField)->stringIndex),
+		hq(_CLNEW FieldSortedHitQueue(reader, (groupSort == NULL ? Sort::RELEVANCE() : groupSort)->getSort(), 1)),
+		ordered(GroupCompare(hq)),
+		topNGroups(topNGroups),
+		spare(_CLNEW FieldDoc(0, 0)),
+		totalHits(0)
+	{
+	}
+	~Internal(){
+		for ( OrderedType::iterator itr = ordered.begin(); itr != ordered.end(); ++itr ){
+			_CLDELETE((*itr)->top);
+			delete *itr;
+		}
+		_CLDELETE(spare);
+		_CLDELETE(hq);
+	}
+
+	/** Makes spare the best document of group, which must not be in ordered */
+	void setTop(Group* group){
+		FieldDoc* old = group->top;
+		group->top = spare;
+		spare = old;
+		ordered.insert(group);
+	}
+
+	void collect(const int32_t doc, const float_t score){
+		spare->scoreDoc.doc = doc;
+		spare->scoreDoc.score = score;
+		const bool full = ordered.size() >= topNGroups;
+
+		// a hit that sorts after the best document of the last group can't improve any group
+		if ( full && hq->sortsAfter(spare, (*ordered.rbegin())->top) )
+			return;
+
+		const int32_t ord = index->getOrd(doc);
+		GroupsType::iterator itr = groups.find(ord);
+		if ( itr != groups.end() ){
+			Group* group = itr->second;
+			if ( hq->sortsAfter(spare, group->top) )
+				return;
+			ordered.erase(group);
+			setTop(group);
+		}else if ( !full ){
+			Group* group = new Group;
+			group->ord = ord;
+			group->top = _CLNEW FieldDoc(0, 0);
+			groups[ord] = group;
+			setTop(group);
+		}else{
+			// replace the last group
+			OrderedType::iterator last = --ordered.end();
+			Group* group = *last;
+			ordered.erase(last);
+			groups.erase(group->ord);
+			group->ord = ord;
+			groups[ord] = group;
+			setTop(group);
+		}
+	}
+
+	const Group* get(int32_t n) const{
+		OrderedType::const_iterator itr = ordered.begin();
+		std::advance(itr, n);
+		return *itr;
+	}
+};
+
+FirstPassGroupingCollector::FirstPassGroupingCollector(IndexReader* reader, const TCHAR* groupField,
+		const Sort* groupSort, int32_t topNGroups)
+{
+	if ( topNGroups <= 0 )
+		_CLTHROWA(CL_ERR_IllegalArgument, "topNGroups must be greater than 0");
+	_internal = _CLNEW Internal(reader, groupField, groupSort, topNGroups);
+}
+FirstPassGroupingCollector::~FirstPassGroupingCollector(){
+	_CLDELETE(_internal);
+}
+
+void FirstPassGroupingCollector::collect(const int32_t doc, const float_t score){
+	if ( score > 0.0f ){ // ignore zeroed buckets
+		_internal->totalHits++;
+		_internal->collect(doc, score);
+	}
+}
+
+int32_t FirstPassGroupingCollector::getTotalHits() const{
+	return _internal->totalHits;
+}
+
+int32_t FirstPassGroupingCollector::getGroupCount() const{
+	return (int32_t)_internal->ordered.size();
+}
+
+TCHAR* FirstPassGroupingCollector::getGroupValue(int32_t n) const{
+	if ( n < 0 || n >= getGroupCount() )
+		_CLTHROWA(CL_ERR_IndexOutOfBounds, "group index is out of bounds");
+	return _internal->index->getTerm(_internal->get(n)->ord);
+}
+
+
+class SecondPassGroupingCollector::Internal{
+public:
+	struct Group{
+		int32_t ord;
+		FieldSortedHitQueue* hq;
+		int32_t totalHits;
+		float_t maxScore;
+	};
+	typedef std::map<int32_t, Group*> GroupsType;
+
+	const FieldCache::StringIndex* index;
+	std::vector<Group*> groups; // in the order of the first pass
+	GroupsType groupsByOrd;
+	FieldDoc* spare;
+	int32_t totalHits;
+
+	Internal(FirstPassGroupingCollector* firstPass, const Sort* withinGroupSort, int32_t docsPerGroup):
+		index(firstPass->_internal->index),
+		spare(NULL),
+		totalHits(0)
+	{
+		SortField** sortFields = (withinGroupSort == NULL ? Sort::RELEVANCE() : withinGroupSort)->getSort();
+		const int32_t groupCount = firstPass->getGroupCount();
+		for ( int32_t i=0;i<groupCount;i++ ){
+			Group* group = new Group;
+			group->ord = firstPass->_internal->get(i)->ord;
+			group->hq = _CLNEW FieldSortedHitQueue(firstPass->_internal->reader, sortFields, docsPerGroup);
+			group->totalHits = 0;
+			group->maxScore = 0;
+			groups.push_back(group);
+			groupsByOrd[group->ord] = group;
+		}
+	}
+	~Internal(){
+		for ( size_t i=0;i<groups.size();i++ ){
+			_CLDELETE(groups[i]->hq);
+			delete groups[i];
+		}
+		_CLDELETE(spare);
+	}
+};
+
+SecondPassGroupingCollector::SecondPassGroupingCollector(FirstPassGroupingCollector* firstPass,
+		const Sort* withinGroupSort, int32_t docsPerGroup)
+{
+	if ( docsPerGroup <= 0 )
+		_CLTHROWA(CL_ERR_IllegalArgument, "docsPerGroup must be greater than 0");
+	_internal = _CLNEW Internal(firstPass, withinGroupSort, docsPerGroup);
+}
+SecondPassGroupingCollector::~SecondPassGroupingCollector(){
+	_CLDELETE(_internal);
+}
+
+void SecondPassGroupingCollector::collect(const int32_t doc, const float_t score){
+	if ( score <= 0.0f ) // ignore zeroed buckets
+		return;
+	_internal->totalHits++;
+	Internal::GroupsType::iterator itr = _internal->groupsByOrd.find(_internal->index->getOrd(doc));
+	if ( itr == _internal->groupsByOrd.end() )
+		return;
+
+	Internal::Group* group = itr->second;
+	group->totalHits++;
+	if ( score > group->maxScore )
+		group->maxScore = score;
+
+	FieldDoc* fd = _internal->spare;
+	if ( fd != NULL ){
+		fd->scoreDoc.doc = doc;
+		fd->scoreDoc.score = score;
+	}else
+		fd = _CLNEW FieldDoc(doc, score);
+	_internal->spare = group->hq->insertWithOverflow(fd);
+}
+
+TopGroups* SecondPassGroupingCollector::getTopGroups(){
+	const int32_t groupsLength = (int32_t)_internal->groups.size();
+	GroupDocs** groups = _CL_NEWARRAY(GroupDocs*, groupsLength+1);
+	for ( int32_t i=0;i<groupsLength;i++ ){
+		Internal::Group* group = _internal->groups[i];
+		const int32_t len = (int32_t)group->hq->size();
+		ScoreDoc* scoreDocs = new ScoreDoc[len];
+		for ( int32_t j=len-1;j>=0;j-- ){
+			FieldDoc* fd = group->hq->pop();
+			scoreDocs[j] = fd->scoreDoc;
+			_CLDELETE(fd);
+		}
+		groups[i] = _CLNEW GroupDocs(_internal->index->getTerm(group->ord), scoreDocs, len,
+			group->totalHits, group->maxScore);
+	}
+	return _CLNEW TopGroups(groups, groupsLength, _internal->totalHits);
+}
+
+CL_NS_END
@@ -0,0 +1,134 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_GroupingCollector_
+#define _lucene_search_GroupingCollector_
+
+#include "SearchHeader.h"
+
+CL_CLASS_DEF(index,IndexReader)
+CL_CLASS_DEF(search,Sort)
+
+CL_NS_DEF(search)
+
+/**
+ * The top documents of one group, as returned by {@link SecondPassGroupingCollector#getTopGroups}.
+ */
+class CLUCENE_EXPORT GroupDocs: LUCENE_BASE{
+public:
+	/** The value of the group field, NULL for the group of documents without a value */
+	TCHAR* groupValue;
+
+	/** The top documents of the group, in the order of the within group sort.
+	 * The scores are raw scores. */
+	ScoreDoc* scoreDocs;
+	int32_t scoreDocsLength;
+
+	/** The number of collected documents in the group */
+	int32_t totalHits;
+
+	/** The highest score of a document of the group */
+	float_t maxScore;
+
+	/** @memory Consumes groupValue and scoreDocs */
+	GroupDocs(TCHAR* groupValue, ScoreDoc* scoreDocs, int32_t scoreDocsLength, int32_t totalHits, float_t maxScore);
+	~GroupDocs();
+};
+
+/** The top groups of a search */
+class CLUCENE_EXPORT TopGroups: LUCENE_BASE{
+public:
+	/** The groups, in the order of the group sort */
+	GroupDocs** groups;
+	int32_t groupsLength;
+
+	/** The number of documents collected, in all groups */
+	int32_t totalHits;
+
+	/** @memory Consumes groups */
+	TopGroups(GroupDocs** groups, int32_t groupsLength, int32_t totalHits);
+	~TopGroups();
+};
+
+/**
+ * The first pass of grouping the hits of a search by the value of a field:
+ * collects the top groups, ranked by the sort key of the best document of each
+ * group. Use a {@link SecondPassGroupingCollector} in a second search with the
+ * same query to collect the top documents of each of these groups.
+ *
+ * The group of a document is its ord in the {@link FieldCache::StringIndex}
+ * of the field, so the field must have at most one value per document.
+ * Documents without a value form a group of their own.
+ *
+ * Only the best document of the current top groups is kept, so the memory
+ * needed is proportional to the number of groups requested, not to the number
+ * of hits or of distinct values.
+ *
+ * <pre>
+ * FirstPassGroupingCollector first(reader, _T("family"), NULL, 10);
+ * searcher._search(query, &first);
+ * SecondPassGroupingCollector second(&first, NULL, 3);
+ * searcher._search(query, &second);
+ * TopGroups* groups = second.getTopGroups();
+ * </pre>
+ */
+class CLUCENE_EXPORT FirstPassGroupingCollector: public HitCollector{
+	class Internal;
+	Internal* _internal;
+	friend class SecondPassGroupingCollector;
+public:
+	/**
+	 * @param reader The reader that is searched
+	 * @param groupField The field to group by
+	 * @param groupSort The sort of the groups, by their best documents. NULL sorts by relevance.
+	 * @param topNGroups The number of groups to collect
+	 */
+	FirstPassGroupingCollector(CL_NS(index)::IndexReader* reader, const TCHAR* groupField,
+		const Sort* groupSort, int32_t topNGroups);
+	virtual ~FirstPassGroupingCollector();
+
+	void collect(const int32_t doc, const float_t score);
+
+	/** Returns the number of documents collected */
+	int32_t getTotalHits() const;
+
+	/** Returns the number of top groups found, at most topNGroups */
+	int32_t getGroupCount() const;
+
+	/** Returns the value of the n-th top group, NULL for the group of documents without a value
+	 * @memory The caller must delete the returned string
+	 */
+	TCHAR* getGroupValue(int32_t n) const;
+};
+
+/**
+ * The second pass of grouping: collects the top documents within each of
+ * the top groups found by a {@link FirstPassGroupingCollector}. Documents of
+ * other groups are skipped. Uses memory proportional to the number of groups
+ * times the number of documents per group.
+ */
+class CLUCENE_EXPORT SecondPassGroupingCollector: public HitCollector{
+	class Internal;
+	Internal* _internal;
+public:
+	/**
+	 * @param firstPass The collector of the first pass, which must outlive this collector
+	 * @param withinGroupSort The sort of the documents in each group. NULL sorts by relevance.
+	 * @param docsPerGroup The number of documents to collect for each group
+	 */
+	SecondPassGroupingCollector(FirstPassGroupingCollector* firstPass, const Sort* withinGroupSort, int32_t docsPerGroup);
+	virtual ~SecondPassGroupingCollector();
+
+	void collect(const int32_t doc, const float_t score);
+
+	/** Returns the top documents of each group. Can only be called once.
+	 * @memory The caller must delete the result
+	 */
+	TopGroups* getTopGroups();
+};
+
+CL_NS_END
+#endif
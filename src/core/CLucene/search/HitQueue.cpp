@@ -44,6 +44,10 @@ void HitQueue::downHeap(){
 void HitQueue::adjustTop(){
 	downHeap();
 }
+struct ScoreDoc& HitQueue::updateTop(){
+	downHeap();
+	return heap[1];
+}
 size_t HitQueue::size(){
 	return _size;
 }
@@ -87,22 +91,59 @@ bool HitQueue::insert(struct ScoreDoc& element){
 		return false;
 }
 
-HitQueue::HitQueue(const int32_t maxSize){
-	_size = 0;
-    this->maxSize = maxSize;
-	int32_t heapSize = maxSize + 1;
-	heap = new ScoreDoc[heapSize];
+HitQueue::HitQueue(const int32_t maxSize, bool prePopulate):
+	heap(NULL), _size(0), maxSize(0), capacity(0)
+{
+	reset(maxSize, prePopulate);
 }
 HitQueue::~HitQueue(){
 	delete [] heap;
 }
 
-bool HitQueue::lessThan(struct ScoreDoc& hitA, struct ScoreDoc& hitB){
-	if (hitA.score == hitB.score)
-		return hitA.doc > hitB.doc; 
-	else
-		return hitA.score < hitB.score;
+void HitQueue::reset(const int32_t maxSize, bool prePopulate){
+	if ( capacity < (size_t)maxSize || heap == NULL ){
+		delete [] heap;
+		capacity = maxSize;
+		heap = new ScoreDoc[capacity + 1];
+	}
+	this->maxSize = maxSize;
+	if ( prePopulate ){
+		// all sentinels are equal, so they already form a heap
+		for ( size_t i=1; i<=this->maxSize; i++ ){
+			heap[i].doc = SENTINEL_DOC;
+			heap[i].score = -1.0f;
+		}
+		_size = this->maxSize;
+	}else
+		_size = 0;
 }
 
 
+HitQueuePool::HitQueuePool(){
+}
+HitQueuePool::~HitQueuePool(){
+}
+
+HitQueue* HitQueuePool::get(const int32_t maxSize){
+	if ( maxSize > MAX_POOLED_SIZE )
+		return _CLNEW HitQueue(maxSize, true);
+	Entry* entry = entries.get();
+	if ( entry == NULL ){
+		entry = _CLNEW Entry;
+		entries.set(entry);
+	}else if ( entry->inUse )
+		return _CLNEW HitQueue(maxSize, true);	// a nested search on this thread
+	entry->inUse = true;
+	entry->queue.reset(maxSize, true);
+	return &entry->queue;
+}
+
+void HitQueuePool::release(HitQueue* queue){
+	Entry* entry = entries.get();
+	if ( entry != NULL && queue == &entry->queue )
+		entry->inUse = false;
+	else
+		_CLDELETE(queue);
+}
+
 CL_NS_END
@@ -12,6 +12,8 @@
 #include "Filter.h"
 #include "CLucene/search/SearchHeader.h"
 #include "CLucene/search/IndexSearcher.h"
+#include "FieldDoc.h"
+#include "_FieldDocSortedHitQueue.h"
 
 CL_NS_USE(document)
 CL_NS_USE(util)
@@ -45,7 +47,8 @@ CL_NS_DEF(search)
 
 	Hits::Hits(Searcher* s, Query* q, Filter* f, const Sort* _sort):
 		query(q), searcher(s), filter(f), sort(_sort) , _length(0), first(NULL), last(NULL),
-			numDocs(0), maxDocs(200), nDeletedHits(0), debugCheckedForDeletions(false)
+			numDocs(0), maxDocs(200), nDeletedHits(0), debugCheckedForDeletions(false),
+			scoreNorm(1.0f), afterDoc(-1), afterScore(0), afterFieldDoc(NULL)
 	{
 	//Func - Constructor
 	//Pre  - s contains a valid reference to a searcher s
@@ -64,6 +67,7 @@ CL_NS_DEF(search)
 
 	Hits::~Hits(){
 		_CLLDELETE(hitDocs);
+		_CLLDELETE(afterFieldDoc);
 	}
 
 	// count # deletions, return -1 if unknown.
@@ -115,6 +119,16 @@ CL_NS_DEF(search)
 			_min = hitDocs->size();
 
 		size_t n = _min * 2;				  // double # retrieved
+
+		// without new deletions, the hits retrieved so far are still the top hits
+		// and the search can continue after the last of them
+		if ( hitDocs->size() > 0 && afterDoc >= 0 &&
+			searcher->getObjectName() == IndexSearcher::getClassName() &&
+			countDeletions(searcher) == nDeletions ){
+			getNextDocs(n - hitDocs->size());
+			return;
+		}
+
 		TopDocs* topDocs = NULL;
 		if ( sort==NULL )
 			topDocs = (TopDocs*)((Searchable*)searcher)->_search(query, filter, n);
@@ -125,7 +139,7 @@ CL_NS_DEF(search)
 		ScoreDoc* scoreDocs = topDocs->scoreDocs;
 		size_t scoreDocsLength = topDocs->scoreDocsLength;
 
-		float_t scoreNorm = 1.0f;
+		scoreNorm = 1.0f;
 
 		//Check that scoreDocs is a valid pointer before using it
 		if (scoreDocs != NULL){
@@ -160,6 +174,8 @@ CL_NS_DEF(search)
 			for (size_t i = start; i < end; i++) {
 				hitDocs->push_back(_CLNEW HitDoc(scoreDocs[i].score * scoreNorm, scoreDocs[i].doc));
 			}
+			if ( end > (size_t)start )
+				setAfter(topDocs, end-1);
 
 			nDeletions = nDels2;
 		}
@@ -167,6 +183,35 @@ CL_NS_DEF(search)
 		_CLDELETE(topDocs);
 	}
 
+	void Hits::getNextDocs(const size_t n){
+		TopDocs* topDocs = NULL;
+		if ( sort==NULL ){
+			ScoreDoc after = { afterDoc, afterScore };
+			topDocs = ((Searchable*)searcher)->searchAfter(after, query, filter, n);
+		}else
+			topDocs = (TopDocs*)((Searchable*)searcher)->searchAfter(*afterFieldDoc, query, filter, n, sort);
+
+		_length = topDocs->totalHits + nDeletedHits;
+		for (int32_t i = 0; i < topDocs->scoreDocsLength; i++)
+			hitDocs->push_back(_CLNEW HitDoc(topDocs->scoreDocs[i].score * scoreNorm, topDocs->scoreDocs[i].doc));
+		if ( topDocs->scoreDocsLength > 0 )
+			setAfter(topDocs, topDocs->scoreDocsLength-1);
+
+		_CLDELETE(topDocs);
+	}
+
+	void Hits::setAfter(TopDocs* topDocs, const size_t i){
+		afterDoc = topDocs->scoreDocs[i].doc;
+		afterScore = topDocs->scoreDocs[i].score;
+		if ( sort != NULL ){
+			// keep the FieldDoc with its sort values, TopFieldDocs skips NULL entries
+			TopFieldDocs* fieldDocs = static_cast<TopFieldDocs*>(topDocs);
+			_CLLDELETE(afterFieldDoc);
+			afterFieldDoc = fieldDocs->fieldDocs[i];
+			fieldDocs->fieldDocs[i] = NULL;
+		}
+	}
+
 	HitDoc* Hits::getHitDoc(const size_t n){
 		if (n >= _lengthAtStart){
 		    TCHAR buf[100];
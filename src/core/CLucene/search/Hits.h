@@ -18,6 +18,8 @@ CL_NS_DEF(search)
 	class Filter;
 	class HitDoc;
 	class Sort;
+	class TopDocs;
+	class FieldDoc;
 
 	/** A ranked list of documents, used to hold search results.
 	* <p>
@@ -53,12 +55,22 @@ CL_NS_DEF(search)
 		int32_t nDeletedHits;    // # of already collected hits that were meanwhile deleted.
 
 		bool debugCheckedForDeletions; // for test purposes.
+		float_t scoreNorm;        // normalizes the scores of all retrieved hits
+		int32_t afterDoc;         // the last retrieved hit, from where the next
+		float_t afterScore;       //   page is searched for
+		FieldDoc* afterFieldDoc;  // the last retrieved hit of a sorted search
 
 		/**
 		* Tries to add new documents to hitDocs.
 		* Ensures that the hit numbered <code>_min</code> has been retrieved.
 		*/
 		void getMoreDocs(const size_t _min);
+
+		/** Appends the next <code>n</code> hits after the last retrieved one */
+		void getNextDocs(const size_t n);
+
+		/** Makes hit i of topDocs the one to continue from */
+		void setAfter(TopDocs* topDocs, const size_t i);
 	    
 		/** Returns the score for the n<sup>th</sup> document in this set. */
 		HitDoc* getHitDoc(const size_t n);
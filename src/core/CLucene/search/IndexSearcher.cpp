@@ -19,7 +19,11 @@
 #include "CLucene/index/Term.h"
 #include "CLucene/util/BitSet.h"
 #include "FieldSortedHitQueue.h"
+#include "FieldCache.h"
+#include "Sort.h"
 #include "Explanation.h"
+#include "QueryTimeout.h"
+#include "TimeLimitedCollector.h"
 
 CL_NS_USE(index)
 CL_NS_USE(util)
@@ -27,33 +31,44 @@ CL_NS_USE(document)
 
 CL_NS_DEF(search)
 
+	/**
+	* Collects the top hits by score into a HitQueue which is pre-populated with
+	* sentinels. A hit which does not beat the top of the queue costs one
+	* comparison, one that does replaces the top in place.
+	*/
 	class SimpleTopDocsCollector:public HitCollector{ 
 	private:
-		float_t minScore;
 		const CL_NS(util)::BitSet* bits;
 		HitQueue* hq;
-		size_t nDocs;
-		int32_t* totalHits;
+		ScoreDoc* pqTop; // the least hit in the queue, NULL if the queue holds no hits at all
+		int32_t totalHits;
+		const ScoreDoc* after; // the last hit of the previous page, if any
 	public:
-		SimpleTopDocsCollector(const CL_NS(util)::BitSet* bs, HitQueue* hitQueue, int32_t* totalhits, size_t ndocs, const float_t ms=-1.0f):
-    		minScore(ms),
+		SimpleTopDocsCollector(const CL_NS(util)::BitSet* bs, HitQueue* hitQueue, const ScoreDoc* _after=NULL):
     		bits(bs),
     		hq(hitQueue),
-    		nDocs(ndocs),
-    		totalHits(totalhits)
+    		pqTop(hitQueue->size() > 0 ? &hitQueue->top() : NULL),
+    		totalHits(0),
+    		after(_after)
     	{
     	}
 		~SimpleTopDocsCollector(){}
+		int32_t getTotalHits() const{
+			return totalHits;
+		}
 		void collect(const int32_t doc, const float_t score){
     		if (score > 0.0f &&			  // ignore zeroed buckets
     			(bits==NULL || bits->get(doc))) {	  // skip docs not in bits
-    			++totalHits[0];
-    			if (hq->size() < nDocs || (minScore==-1.0f || score >= minScore)) {
-    				ScoreDoc sd = {doc, score};
-    				hq->insert(sd);	  // update hit queue
-    				if ( minScore != -1.0f )
-    					minScore = hq->top().score; // maintain minScore
-    			}
+    			++totalHits;
+    			if ( after != NULL &&	  // skip hits of earlier pages, same order as HitQueue
+    				(score > after->score || (score == after->score && doc <= after->doc)) )
+    				return;
+    			if ( pqTop == NULL ||
+    				score < pqTop->score || (score == pqTop->score && doc > pqTop->doc) )
+    				return;
+    			pqTop->doc = doc;
+    			pqTop->score = score;
+    			pqTop = &hq->updateTop();
     		}
     	}
 	};
@@ -64,27 +79,221 @@ CL_NS_DEF(search)
 		FieldSortedHitQueue* hq;
 		size_t nDocs;
 		int32_t* totalHits;
+		FieldDoc* spare; // the last hit that did not make it into the queue, for reuse
+		FieldDoc* after; // the last hit of the previous page, if any
 	public:
-		SortedTopDocsCollector(const CL_NS(util)::BitSet* bs, FieldSortedHitQueue* hitQueue, int32_t* totalhits, size_t _nDocs):
+		SortedTopDocsCollector(const CL_NS(util)::BitSet* bs, FieldSortedHitQueue* hitQueue, int32_t* totalhits, size_t _nDocs,
+			FieldDoc* _after=NULL):
     		bits(bs),
     		hq(hitQueue),
     		nDocs(_nDocs),
-    		totalHits(totalhits)
+    		totalHits(totalhits),
+    		spare(NULL),
+    		after(_after)
     	{
     	}
 		~SortedTopDocsCollector(){
+			_CLDELETE(spare);
 		}
 		void collect(const int32_t doc, const float_t score){
     		if (score > 0.0f &&			  // ignore zeroed buckets
     			(bits==NULL || bits->get(doc))) {	  // skip docs not in bits
     			++totalHits[0];
-    			FieldDoc* fd = _CLNEW FieldDoc(doc, score); //todo: see jlucene way... with fields def???
-    			if ( !hq->insert(fd) )	  // update hit queue
-    				_CLDELETE(fd);
+    			FieldDoc* fd;
+    			if ( spare != NULL ){
+    				fd = spare;
+    				fd->scoreDoc.doc = doc;
+    				fd->scoreDoc.score = score;
+    			}else
+    				fd = _CLNEW FieldDoc(doc, score);
+    			if ( after != NULL && !hq->sortsAfter(fd, after) ){
+    				hq->updateMaxScore(score);	  // skip hits of earlier pages
+    				spare = fd;
+    				return;
+    			}
+    			spare = hq->insertWithOverflow(fd);	  // update hit queue
     		}
     	}
 	};
 
+	/** Scores the hits of scorer into collector, checking timeout for each hit if there is one */
+	void scoreHits(Scorer* scorer, HitCollector* collector, QueryTimeout* timeout){
+		if ( timeout == NULL ){
+			scorer->score(collector);
+		}else{
+			TimeLimitedCollector limited(collector, timeout);
+			scorer->score(&limited);
+		}
+	}
+
+	/** Returns the weight of query, or NULL if the rewrite of query ran out of time */
+	Weight* createWeight(Query* query, Searcher* searcher){
+		try{
+			return query->weight(searcher);
+		}catch(CLuceneError& err){
+			if ( err.number() != CL_ERR_TimeExceeded )
+				throw;
+			return NULL;
+		}
+	}
+
+	/** Values of a single field sort, read straight from the FieldCache */
+	struct IntSortValues{
+		typedef int32_t ValueType;
+		const int32_t* values;
+		IntSortValues(const int32_t* values): values(values){}
+		inline int32_t get(const int32_t doc) const{ return values[doc]; }
+	};
+	struct FloatSortValues{
+		typedef float_t ValueType;
+		const float_t* values;
+		FloatSortValues(const float_t* values): values(values){}
+		inline float_t get(const int32_t doc) const{ return values[doc]; }
+	};
+	struct OrdSortValues{
+		typedef int32_t ValueType;
+		const FieldCache::StringIndex* index;
+		OrdSortValues(const FieldCache::StringIndex* index): index(index){}
+		inline int32_t get(const int32_t doc) const{ return index->getOrd(doc); }
+	};
+
+	/**
+	* Collects the top hits of a sort on a single int, float or string field.
+	* Once the queue is full, the value of each hit is compared with the value
+	* of the queue's bottom entry first. Hits which would not make it into the
+	* queue cost one array load and one compare, and are not allocated. A
+	* competitive hit replaces the bottom entry in place.
+	*/
+	template<typename Values, bool reverse>
+	class SingleFieldTopDocsCollector:public HitCollector{
+	private:
+		typedef typename Values::ValueType ValueType;
+		const CL_NS(util)::BitSet* bits;
+		FieldSortedHitQueue* hq;
+		size_t nDocs;
+		int32_t* totalHits;
+		Values values;
+		FieldDoc* bottom;
+		ValueType bottomValue;
+
+		void updateBottom(FieldDoc* top){
+			bottom = top;
+			bottomValue = values.get(bottom->scoreDoc.doc);
+		}
+	public:
+		SingleFieldTopDocsCollector(const CL_NS(util)::BitSet* bs, FieldSortedHitQueue* hitQueue, int32_t* totalhits, size_t _nDocs, const Values& values):
+			bits(bs),
+			hq(hitQueue),
+			nDocs(_nDocs),
+			totalHits(totalhits),
+			values(values),
+			bottom(NULL),
+			bottomValue(0)
+		{
+		}
+		void collect(const int32_t doc, const float_t score){
+			if (score > 0.0f &&			  // ignore zeroed buckets
+				(bits==NULL || bits->get(doc))) {	  // skip docs not in bits
+				++totalHits[0];
+				hq->updateMaxScore(score);
+				if ( bottom != NULL ){
+					// the queue is full: the hit has to sort before the bottom entry.
+					// this must agree with FieldSortedHitQueue::lessThan
+					const ValueType value = values.get(doc);
+					if ( reverse ? value < bottomValue : value > bottomValue )
+						return;
+					if ( value == bottomValue && doc > bottom->scoreDoc.doc )
+						return;
+					bottom->scoreDoc.doc = doc;
+					bottom->scoreDoc.score = score;
+					updateBottom(hq->updateTop());
+				}else{
+					hq->put(_CLNEW FieldDoc(doc, score));
+					if ( hq->size() == nDocs )
+						updateBottom(hq->top());
+				}
+			}
+		}
+	};
+
+	/** Collects the hits of query with a collector specialized for a sort on a single
+	* int, float or string field. Returns false if the sort is not one of these. */
+	template<typename Values>
+	bool collectSingleFieldSort(Scorer* scorer, const CL_NS(util)::BitSet* bits, FieldSortedHitQueue* hq,
+		int32_t* totalHits, size_t nDocs, const Values& values, bool reverse, QueryTimeout* timeout){
+		if ( reverse ){
+			SingleFieldTopDocsCollector<Values, true> hitCol(bits, hq, totalHits, nDocs, values);
+			scoreHits(scorer, &hitCol, timeout);
+		}else{
+			SingleFieldTopDocsCollector<Values, false> hitCol(bits, hq, totalHits, nDocs, values);
+			scoreHits(scorer, &hitCol, timeout);
+		}
+		return true;
+	}
+
+	/** Collects the first nDocs hits in document order. If the documents are in
+	* sort order already, these are the top hits and the rest can be skipped. */
+	void collectFirstHits(Scorer* scorer, const CL_NS(util)::BitSet* bits, FieldSortedHitQueue* hq,
+		int32_t* totalHits, size_t nDocs, QueryTimeout* timeout){
+		while ( hq->size() < nDocs && scorer->next() ){
+			if ( timeout != NULL )
+				timeout->check();
+			const int32_t doc = scorer->doc();
+			if ( bits != NULL && !bits->get(doc) )
+				continue;
+			const float_t score = scorer->score();
+			if ( score > 0.0f ){
+				++totalHits[0];
+				hq->updateMaxScore(score);
+				hq->put(_CLNEW FieldDoc(doc, score));
+			}
+		}
+	}
+
+	bool collectSingleFieldSort(Scorer* scorer, IndexReader* reader, const CL_NS(util)::BitSet* bits,
+		const Sort* sort, FieldSortedHitQueue* hq, int32_t* totalHits, size_t nDocs, bool earlyTermination,
+		QueryTimeout* timeout){
+		SortField** sortFields = sort->getSort();
+		if ( nDocs == 0 || sortFields[0] == NULL || sortFields[1] != NULL || sortFields[0]->getFactory() != NULL )
+			return false;
+		const int32_t type = sortFields[0]->getType();
+		if ( type != SortField::AUTO && type != SortField::INT && type != SortField::FLOAT && type != SortField::STRING )
+			return false;
+
+		// the queue resolved AUTO already, and its comparator holds on to the cached values
+		const SortField* field = hq->getFields()[0];
+		const TCHAR* fieldname = field->getField();
+		const bool reverse = field->getReverse();
+		FieldCacheAuto* fa;
+		switch ( field->getType() ){
+		case SortField::INT:
+			fa = FieldCache::DEFAULT()->getInts(reader, fieldname);
+			break;
+		case SortField::FLOAT:
+			fa = FieldCache::DEFAULT()->getFloats(reader, fieldname);
+			break;
+		case SortField::STRING:
+			fa = FieldCache::DEFAULT()->getStringIndex(reader, fieldname);
+			break;
+		default:
+			return false;
+		}
+
+		if ( earlyTermination &&
+			(fa->order & (reverse ? FieldCacheAuto::ORDER_DESCENDING : FieldCacheAuto::ORDER_ASCENDING)) != 0 ){
+			collectFirstHits(scorer, bits, hq, totalHits, nDocs, timeout);
+			return true;
+		}
+		switch ( fa->contentType ){
+		case FieldCacheAuto::INT_ARRAY:
+			return collectSingleFieldSort(scorer, bits, hq, totalHits, nDocs, IntSortValues(fa->intArray), reverse, timeout);
+		case FieldCacheAuto::FLOAT_ARRAY:
+			return collectSingleFieldSort(scorer, bits, hq, totalHits, nDocs, FloatSortValues(fa->floatArray), reverse, timeout);
+		default:
+			return collectSingleFieldSort(scorer, bits, hq, totalHits, nDocs, OrdSortValues(fa->stringIndex), reverse, timeout);
+		}
+	}
+
 	class SimpleFilteredCollector: public HitCollector{
 	private:
 		CL_NS(util)::BitSet* bits;
@@ -116,6 +325,8 @@ CL_NS_DEF(search)
 
       reader = IndexReader::open(path);
       readerOwner = true;
+      earlyTermination = false;
+      hitQueues = _CLNEW HitQueuePool();
   }
   
   IndexSearcher::IndexSearcher(CL_NS(store)::Directory* directory){
@@ -128,6 +339,8 @@ CL_NS_DEF(search)
 
       reader = IndexReader::open(directory);
       readerOwner = true;
+      earlyTermination = false;
+      hitQueues = _CLNEW HitQueuePool();
   }
 
   IndexSearcher::IndexSearcher(IndexReader* r){
@@ -138,6 +351,8 @@ CL_NS_DEF(search)
 
       reader      = r;
       readerOwner = false;
+      earlyTermination = false;
+      hitQueues = _CLNEW HitQueuePool();
   }
 
   IndexSearcher::~IndexSearcher(){
@@ -146,6 +361,7 @@ CL_NS_DEF(search)
   //Post - The instance has been destroyed
 
 	  close();
+	  _CLDELETE(hitQueues);
   }
 
   void IndexSearcher::close(){
@@ -187,6 +403,12 @@ CL_NS_DEF(search)
 
       return reader->document(i,d);
   }
+  bool IndexSearcher::docs(const CL_NS(util)::ArrayBase<int32_t>& docs, CL_NS(util)::ObjectArray<CL_NS(document)::Document>& result,
+      const CL_NS(document)::FieldSelector* fieldSelector) {
+      CND_PRECONDITION(reader != NULL, "reader is NULL");
+
+      return reader->documents(docs, result, fieldSelector);
+  }
   bool IndexSearcher::doc(int32_t i, CL_NS(document)::Document* d) {
   //Func - Retrieves i-th document found
   //       For use by HitCollector implementations.
@@ -212,14 +434,28 @@ CL_NS_DEF(search)
 
   //todo: find out why we are passing Query* and not Weight*, as Weight is being extracted anyway from Query*
   TopDocs* IndexSearcher::_search(Query* query, Filter* filter, const int32_t nDocs){
-  //Func -
+      return topDocs(query, filter, nDocs, NULL);
+  }
+
+  TopDocs* IndexSearcher::searchAfter(const ScoreDoc& after, Query* query, Filter* filter, const int32_t nDocs){
+      return topDocs(query, filter, nDocs, &after);
+  }
+
+  TopDocs* IndexSearcher::topDocs(Query* query, Filter* filter, const int32_t nDocs, const ScoreDoc* after){
+  //Func - Finds the top nDocs hits, or the top nDocs hits which sort after the hit after
   //Pre  - reader != NULL
   //Post -
 
       CND_PRECONDITION(reader != NULL, "reader is NULL");
       CND_PRECONDITION(query != NULL, "query is NULL");
 
-      Weight* weight = query->weight(this);
+      QueryTimeout* timeout = QueryTimeout::current();
+      Weight* weight = createWeight(query, this);
+      if (weight == NULL) {
+        TopDocs* ret = _CLNEW TopDocs(0, NULL, 0);
+        ret->timedOut = true;
+        return ret;
+      }
       Scorer* scorer = weight->scorer(reader);
       if (scorer == NULL) {
         Query* wq = weight->getQuery();
@@ -230,18 +466,18 @@ CL_NS_DEF(search)
       }
 
       BitSet* bits = filter != NULL ? filter->bits(reader) : NULL;
-      HitQueue* hq = _CLNEW HitQueue(nDocs);
-
-		  //Check hq has been allocated properly
-		  CND_CONDITION(hq != NULL, "Could not allocate memory for HitQueue hq");
-	
-		  int32_t* totalHits = _CL_NEWARRAY(int32_t,1);
-      totalHits[0] = 0;
-
-      SimpleTopDocsCollector hitCol(bits,hq,totalHits,nDocs,0.0f);
-      scorer->score( &hitCol );
+      // there are never more hits than documents, so don't populate a larger queue
+      HitQueue* hq = hitQueues->get(nDocs < reader->maxDoc() ? nDocs : reader->maxDoc());
+
+      SimpleTopDocsCollector hitCol(bits,hq,after);
+      bool timedOut = false;
+      try {
+        scoreHits(scorer, &hitCol, timeout);
+      } _CLCATCH_ERR(CL_ERR_TimeExceeded, _CLDELETE(scorer); hitQueues->release(hq), timedOut = true)
       _CLDELETE(scorer);
 
+      while ( hq->size() > 0 && hq->top().score <= 0.0f )	  // drop the sentinels left
+        hq->pop();
       int32_t scoreDocsLength = hq->size();
 
 		ScoreDoc* scoreDocs = new ScoreDoc[scoreDocsLength];
@@ -249,40 +485,79 @@ CL_NS_DEF(search)
 		for (int32_t i = scoreDocsLength-1; i >= 0; --i)	  // put docs in array
 			scoreDocs[i] = hq->pop();
 
-      int32_t totalHitsInt = totalHits[0];
+      int32_t totalHitsInt = hitCol.getTotalHits();
 
-      _CLDELETE(hq);
+      hitQueues->release(hq);
 		  if ( bits != NULL && filter->shouldDeleteBitSet(bits) )
 				_CLDELETE(bits);
-	    _CLDELETE_ARRAY(totalHits);
 		  Query* wq = weight->getQuery();
 		  if ( query != wq ) //query was re-written
 			  _CLLDELETE(wq);
 		  _CLDELETE(weight);
 
-      return _CLNEW TopDocs(totalHitsInt, scoreDocs, scoreDocsLength);
+      TopDocs* ret = _CLNEW TopDocs(totalHitsInt, scoreDocs, scoreDocsLength);
+      ret->timedOut = timedOut;
+      return ret;
   }
 
   // inherit javadoc
   TopFieldDocs* IndexSearcher::_search(Query* query, Filter* filter, const int32_t nDocs,
          const Sort* sort) {
+      return topFieldDocs(query, filter, nDocs, sort, NULL);
+  }
+
+  TopFieldDocs* IndexSearcher::searchAfter(const FieldDoc& after, Query* query, Filter* filter, const int32_t nDocs,
+         const Sort* sort) {
+      return topFieldDocs(query, filter, nDocs, sort, &after);
+  }
+
+  TopFieldDocs* IndexSearcher::topFieldDocs(Query* query, Filter* filter, const int32_t nDocs,
+         const Sort* sort, const FieldDoc* after) {
              
       CND_PRECONDITION(reader != NULL, "reader is NULL");
       CND_PRECONDITION(query != NULL, "query is NULL");
 
-    Weight* weight = query->weight(this);
+    QueryTimeout* timeout = QueryTimeout::current();
+    Weight* weight = createWeight(query, this);
+    if (weight == NULL){
+		TopFieldDocs* ret = _CLNEW TopFieldDocs(0, NULL, 0, NULL );
+		ret->timedOut = true;
+		return ret;
+	}
     Scorer* scorer = weight->scorer(reader);
     if (scorer == NULL){
+		Query* wq = weight->getQuery();
+		if ( query != wq )
+			_CLLDELETE(wq);
+		_CLLDELETE(weight);
 		return _CLNEW TopFieldDocs(0, NULL, 0, NULL );
 	}
 
     BitSet* bits = filter != NULL ? filter->bits(reader) : NULL;
     FieldSortedHitQueue hq(reader, sort->getSort(), nDocs);
-    int32_t* totalHits = _CL_NEWARRAY(int32_t,1);
-	totalHits[0]=0;
+    int32_t totalHits = 0;
     
-	SortedTopDocsCollector hitCol(bits,&hq,totalHits,nDocs);
-	scorer->score(&hitCol);
+	bool timedOut = false;
+	try{
+		if ( after != NULL ){
+			// the comparators compare by document, so the cursor is its document with
+			// the raw score, which fillFields kept in the value of a relevance sort
+			FieldDoc cursor(after->scoreDoc.doc, after->scoreDoc.score);
+			SortField** fields = hq.getFields();
+			for ( int32_t i=0; after->fields != NULL && fields[i] != NULL && after->fields[i] != NULL; i++ ){
+				if ( fields[i]->getType() == SortField::DOCSCORE &&
+					after->fields[i]->getObjectName() == Compare::Float::getClassName() ){
+					cursor.scoreDoc.score = static_cast<Compare::Float*>(after->fields[i])->getValue();
+					break;
+				}
+			}
+			SortedTopDocsCollector hitCol(bits,&hq,&totalHits,nDocs,&cursor);
+			scoreHits(scorer, &hitCol, timeout);
+		}else if ( !collectSingleFieldSort(scorer, reader, bits, sort, &hq, &totalHits, nDocs, earlyTermination, timeout) ){
+			SortedTopDocsCollector hitCol(bits,&hq,&totalHits,nDocs);
+			scoreHits(scorer, &hitCol, timeout);
+		}
+	}_CLCATCH_ERR(CL_ERR_TimeExceeded, _CLLDELETE(scorer), timedOut = true)
     _CLLDELETE(scorer);
 
 	int32_t hqLen = hq.size();
@@ -298,11 +573,11 @@ CL_NS_DEF(search)
 
     SortField** hqFields = hq.getFields();
 	hq.setFields(NULL); //move ownership of memory over to TopFieldDocs
-    int32_t totalHits0 = totalHits[0];
 	if ( bits != NULL && filter->shouldDeleteBitSet(bits) )
 		_CLLDELETE(bits);
-    _CLDELETE_LARRAY(totalHits);
-    return _CLNEW TopFieldDocs(totalHits0, fieldDocs, hqLen, hqFields );
+    TopFieldDocs* ret = _CLNEW TopFieldDocs(totalHits, fieldDocs, hqLen, hqFields );
+    ret->timedOut = timedOut;
+    return ret;
   }
 
   void IndexSearcher::_search(Query* query, Filter* filter, HitCollector* results){
@@ -326,22 +601,29 @@ CL_NS_DEF(search)
           fc = _CLNEW SimpleFilteredCollector(bits, results);
        }
 
-      Weight* weight = query->weight(this);
-      Scorer* scorer = weight->scorer(reader);
+      QueryTimeout* timeout = QueryTimeout::current();
+      Weight* weight = createWeight(query, this);
+      Scorer* scorer = weight != NULL ? weight->scorer(reader) : NULL;
       if (scorer != NULL) {
-		  if (fc == NULL){
-              scorer->score(results);
-		  }else{
-              scorer->score((HitCollector*)fc);
-		  }
+          try {
+              scoreHits(scorer, fc == NULL ? results : (HitCollector*)fc, timeout);
+          } catch (CLuceneError& err) {
+              // the collector or the timeout ended the search early
+              if (err.number() != CL_ERR_TimeExceeded && err.number() != CL_ERR_CollectionTerminated) {
+                  _CLDELETE(scorer);
+                  throw;
+              }
+          }
           _CLDELETE(scorer); 
       }
 
     _CLLDELETE(fc);
-	Query* wq = weight->getQuery();
-	if (wq != query) // query was rewritten
-		_CLLDELETE(wq);
-	_CLLDELETE(weight);
+	if (weight != NULL) {
+		Query* wq = weight->getQuery();
+		if (wq != query) // query was rewritten
+			_CLLDELETE(wq);
+		_CLLDELETE(weight);
+	}
 	if ( bits != NULL && filter->shouldDeleteBitSet(bits) )
 		_CLLDELETE(bits);
   }
@@ -375,6 +657,14 @@ CL_NS_DEF(search)
 		return reader;
 	}
 
+	void IndexSearcher::setEarlyTermination(bool enabled){
+		earlyTermination = enabled;
+	}
+
+	bool IndexSearcher::getEarlyTermination() const{
+		return earlyTermination;
+	}
+
 	const char* IndexSearcher::getClassName(){
 		return "IndexSearcher";
 	}
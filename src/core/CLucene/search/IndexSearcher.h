@@ -9,6 +9,7 @@
 
 
 #include "Searchable.h"
+#include "CLucene/util/Array.h"
 CL_CLASS_DEF(store,Directory)
 CL_CLASS_DEF(document,Document)
 CL_CLASS_DEF(index,Term)
@@ -19,7 +20,9 @@ CL_CLASS_DEF(search,Filter)
 CL_CLASS_DEF(search,Sort)
 CL_CLASS_DEF(search,HitCollector)
 CL_CLASS_DEF(search,Explanation)
+CL_CLASS_DEF(search,HitQueuePool)
 CL_CLASS_DEF(index,IndexReader)
+CL_CLASS_DEF(document,FieldSelector)
 //#include "CLucene/index/IndexReader.h"
 //#include "CLucene/util/BitSet.h"
 //#include "HitQueue.h"
@@ -30,10 +33,21 @@ CL_NS_DEF(search)
 *
 * <p>Applications usually need only call the inherited {@link search(Query*)}
 * or {@link search(Query*,Filter*)} methods.
+*
+* <p>A search is bounded by the {@link QueryTimeout} that the calling thread made
+* current with a {@link QueryTimeout::Scope}, if any. A search that runs past its
+* deadline, or is cancelled, returns the hits found so far, with
+* {@link TopDocs#timedOut} set; a search with a HitCollector returns normally and
+* the collector keeps its hits.
 */
 class CLUCENE_EXPORT IndexSearcher:public Searcher{
 	CL_NS(index)::IndexReader* reader;
 	bool readerOwner;
+	bool earlyTermination;
+	HitQueuePool* hitQueues;
+
+	TopDocs* topDocs(Query* query, Filter* filter, const int32_t nDocs, const ScoreDoc* after);
+	TopFieldDocs* topFieldDocs(Query* query, Filter* filter, const int32_t nDocs, const Sort* sort, const FieldDoc* after);
 
 public:
 	/** Creates a searcher searching the index in the named directory.
@@ -67,15 +81,38 @@ public:
 	bool doc(int32_t i, CL_NS(document)::Document* document);
 	_CL_DEPRECATED( doc(i, document) ) CL_NS(document)::Document* doc(int32_t i);
 
+	/**
+	* Retrieves a batch of documents, such as the top hits of a search, reading them
+	* in index order. result[i] receives document docs[i].
+	* @see IndexReader#documents
+	*/
+	bool docs(const CL_NS(util)::ArrayBase<int32_t>& docs, CL_NS(util)::ObjectArray<CL_NS(document)::Document>& result,
+		const CL_NS(document)::FieldSelector* fieldSelector = NULL);
+
 	int32_t maxDoc() const;
 
 	TopDocs* _search(Query* query, Filter* filter, const int32_t nDocs);
 	TopFieldDocs* _search(Query* query, Filter* filter, const int32_t nDocs, const Sort* sort);
 
+	TopDocs* searchAfter(const ScoreDoc& after, Query* query, Filter* filter, const int32_t nDocs);
+	TopFieldDocs* searchAfter(const FieldDoc& after, Query* query, Filter* filter, const int32_t nDocs, const Sort* sort);
+
 	void _search(Query* query, Filter* filter, HitCollector* results);
 
 	CL_NS(index)::IndexReader* getReader();
 
+	/**
+	* If enabled, a search sorted by a single int, float or string field stops
+	* after the first <code>nDocs</code> hits when the documents of the reader are
+	* already in the order of the sort, as they are when the index was written
+	* with {@link IndexWriter#setIndexSort} on that field. The top hits are the
+	* same, but the total hit count (and {@link Hits#length}) is then only a lower
+	* bound. Disabled by default.
+	*/
+	void setEarlyTermination(bool enabled);
+	/** @see #setEarlyTermination */
+	bool getEarlyTermination() const;
+
 	Query* rewrite(Query* original);
 	void explain(Query* query, int32_t doc, Explanation* ret);
 
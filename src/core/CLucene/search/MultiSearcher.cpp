@@ -120,13 +120,27 @@ CL_NS_DEF(search)
   }
 
   TopDocs* MultiSearcher::_search(Query* query, Filter* filter, const int32_t nDocs) {
+    return topDocs(query, filter, nDocs, NULL);
+  }
+
+  TopDocs* MultiSearcher::searchAfter(const ScoreDoc& after, Query* query, Filter* filter, const int32_t nDocs) {
+    return topDocs(query, filter, nDocs, &after);
+  }
+
+  TopDocs* MultiSearcher::topDocs(Query* query, Filter* filter, const int32_t nDocs, const ScoreDoc* after) {
     HitQueue* hq = _CLNEW HitQueue(nDocs);
     int32_t totalHits = 0;
 	TopDocs* docs;
 	int32_t j;
 	ScoreDoc* scoreDocs;
     for (int32_t i = 0; i < searchablesLen; i++) {  // search each searcher
-		docs = searchables[i]->_search(query, filter, nDocs);
+		if ( after == NULL )
+			docs = searchables[i]->_search(query, filter, nDocs);
+		else{
+			// the cursor may lie outside of this searchable, that still orders its hits right
+			ScoreDoc subAfter = { after->doc - starts[i], after->score };
+			docs = searchables[i]->searchAfter(subAfter, query, filter, nDocs);
+		}
 		totalHits += docs->totalHits;		  // update totalHits
 		scoreDocs = docs->scoreDocs;
 		for ( j = 0; j <docs->scoreDocsLength; ++j) { // merge scoreDocs int_to hq
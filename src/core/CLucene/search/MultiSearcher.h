@@ -26,6 +26,8 @@ CL_NS_DEF(search)
 		int32_t searchablesLen;
     int32_t* starts;
     int32_t _maxDoc;
+
+    TopDocs* topDocs(Query* query, Filter* filter, const int32_t nDocs, const ScoreDoc* after);
 	protected:
 		int32_t* getStarts();
 		int32_t getLength();
@@ -56,6 +58,9 @@ CL_NS_DEF(search)
       TopDocs* _search(Query* query, Filter* filter, const int32_t nDocs) ;
       
       TopFieldDocs* _search (Query* query, Filter* filter, const int32_t n, const Sort* sort);
+
+      /** Searches each searchable after the cursor, translated to its document numbers */
+      TopDocs* searchAfter(const ScoreDoc& after, Query* query, Filter* filter, const int32_t nDocs);
      
       /** Lower-level search API.
        *
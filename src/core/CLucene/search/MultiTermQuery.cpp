@@ -9,6 +9,7 @@
 #include "BooleanQuery.h"
 #include "FilteredTermEnum.h"
 #include "TermQuery.h"
+#include "QueryTimeout.h"
 #include "CLucene/index/Term.h"
 #include "CLucene/util/StringBuffer.h"
 
@@ -52,16 +53,24 @@ CL_NS_DEF(search)
 	Query* MultiTermQuery::rewrite(IndexReader* reader) {
 		FilteredTermEnum* enumerator = getEnum(reader);
 		BooleanQuery* query = _CLNEW BooleanQuery( true );
+		QueryTimeout* timeout = QueryTimeout::current();
 		try {
-            do {
-                Term* t = enumerator->term(false);
-                if (t != NULL) {
-                    TermQuery* tq = _CLNEW TermQuery(t);	// found a match
-                    tq->setBoost(getBoost() * enumerator->difference()); // set the boost
-                    query->add(tq,true, false, false);		// add to q
-                }
-            } while (enumerator->next());
-        } _CLFINALLY ( enumerator->close(); _CLDELETE(enumerator) );
+            try {
+                do {
+                    if (timeout != NULL)
+                        timeout->check();			// bounds the enumeration of many terms
+                    Term* t = enumerator->term(false);
+                    if (t != NULL) {
+                        TermQuery* tq = _CLNEW TermQuery(t);	// found a match
+                        tq->setBoost(getBoost() * enumerator->difference()); // set the boost
+                        query->add(tq,true, false, false);		// add to q
+                    }
+                } while (enumerator->next());
+            } _CLFINALLY ( enumerator->close(); _CLDELETE(enumerator) );
+        } catch (CLuceneError&) {
+            _CLDELETE(query);
+            throw;
+        }
 
 		//if we only added one clause and the clause is not prohibited then
 		//we can just return the query
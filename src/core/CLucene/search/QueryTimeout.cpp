@@ -0,0 +1,83 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "QueryTimeout.h"
+#include "CLucene/util/Misc.h"
+#include "CLucene/util/_ThreadLocal.h"
+
+CL_NS_USE(util)
+CL_NS_DEF(search)
+
+typedef ThreadLocal<QueryTimeout*, Deletor::Dummy> CurrentTimeoutType;
+//created at static initialisation, before any thread can search, so that
+//current() is only a thread local read. The scorers call it when created.
+static CurrentTimeoutType* QueryTimeout_current = _CLNEW CurrentTimeoutType;
+
+QueryTimeout::QueryTimeout(int64_t timeAllowed, int32_t checkInterval):
+	deadline(0),
+	checkInterval(checkInterval > 0 ? checkInterval : 1),
+	countdown(0),
+	cancelled(false),
+	exceeded(false)
+{
+	restart(timeAllowed);
+}
+QueryTimeout::~QueryTimeout(){
+}
+
+void QueryTimeout::restart(int64_t timeAllowed){
+	deadline = timeAllowed < 0 ? 0 : Misc::currentTimeMillis() + timeAllowed;
+	countdown = checkInterval;
+	cancelled = false;
+	exceeded = false;
+}
+
+void QueryTimeout::cancel(){
+	cancelled = true;
+}
+bool QueryTimeout::isCancelled() const{
+	return cancelled;
+}
+bool QueryTimeout::isExceeded() const{
+	return exceeded;
+}
+
+bool QueryTimeout::shouldExit() const{
+	return cancelled || (deadline != 0 && Misc::currentTimeMillis() >= deadline);
+}
+
+void QueryTimeout::checkNow(){
+	countdown = checkInterval;
+	if ( exceeded || shouldExit() ){
+		exceeded = true;
+		_CLTHROWA(CL_ERR_TimeExceeded, cancelled ? "search was cancelled" : "search timed out");
+	}
+}
+
+QueryTimeout* QueryTimeout::current(){
+	return QueryTimeout_current == NULL ? NULL : QueryTimeout_current->get();
+}
+
+QueryTimeout::Scope::Scope(QueryTimeout* timeout):
+	previous(NULL),
+	installed(timeout != NULL && QueryTimeout_current != NULL)
+{
+	if ( installed ){
+		previous = QueryTimeout_current->get();
+		QueryTimeout_current->set(timeout);
+	}
+}
+QueryTimeout::Scope::~Scope(){
+	if ( installed )
+		QueryTimeout_current->set(previous);
+}
+
+void QueryTimeout::_shutdown(){
+	_CLDELETE(QueryTimeout_current);
+}
+
+CL_NS_END
@@ -0,0 +1,99 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_QueryTimeout_
+#define _lucene_search_QueryTimeout_
+
+CL_NS_DEF(search)
+
+/**
+ * A cooperative deadline and cancellation token for a search.
+ *
+ * Code that may loop for a long time calls {@link #check} once per unit of
+ * work: the {@link TimeLimitedCollector} per collected hit, MultiTermQuery
+ * rewrites per enumerated term and the boolean scorers per candidate document.
+ * A check is a countdown; only every <code>checkInterval</code> calls is the
+ * clock read. Once the deadline has passed or {@link #cancel} was called, check
+ * throws a CLuceneError with the number CL_ERR_TimeExceeded, which
+ * {@link IndexSearcher} catches to return the hits found so far.
+ *
+ * A search uses the token of the thread that runs it, which the caller sets
+ * for the call with a {@link Scope}:
+ * <pre>
+ *   QueryTimeout timeout(100);
+ *   {
+ *     QueryTimeout::Scope scope(&timeout);
+ *     TopDocs* top = searcher.topDocs(&query, NULL, 10);
+ *   }
+ * </pre>
+ * The countdown is not synchronized, so a token serves one search at a time;
+ * concurrent searches each need their own. {@link #cancel} may be called from
+ * any thread.
+ */
+class CLUCENE_EXPORT QueryTimeout: LUCENE_BASE{
+	uint64_t deadline;      // 0 if there is no deadline
+	int32_t checkInterval;
+	int32_t countdown;
+	volatile bool cancelled;
+	bool exceeded;
+
+	void checkNow();
+public:
+	/** The default number of calls to {@link #check} between two reads of the clock */
+	LUCENE_STATIC_CONSTANT(int32_t, DEFAULT_CHECK_INTERVAL=256);
+
+	/**
+	 * @param timeAllowed The time a search may take in milliseconds, counted from now,
+	 * or -1 for no deadline, so that only {@link #cancel} stops it
+	 * @param checkInterval The number of calls to {@link #check} between two reads of the clock
+	 */
+	QueryTimeout(int64_t timeAllowed = -1, int32_t checkInterval = DEFAULT_CHECK_INTERVAL);
+	~QueryTimeout();
+
+	/** Starts the clock again for the next search, and clears the cancelled
+	 * and exceeded states.
+	 * @param timeAllowed As in the constructor
+	 */
+	void restart(int64_t timeAllowed);
+
+	/** Asks the search to stop at its next check */
+	void cancel();
+	bool isCancelled() const;
+
+	/** Returns true once a check has stopped a search, either because the deadline
+	 * had passed or because the search was cancelled */
+	bool isExceeded() const;
+
+	/** Returns true if the deadline has passed or the search was cancelled */
+	bool shouldExit() const;
+
+	/** Throws CL_ERR_TimeExceeded if the search should stop. Cheap enough to be called
+	 * for every document. */
+	inline void check(){
+		if ( --countdown <= 0 )
+			checkNow();
+	}
+
+	/** Expert: returns the token of the search running on this thread, if any.
+	 * Scorers and rewrites look it up once, when they are created. */
+	static QueryTimeout* current();
+
+	/** Makes a token the one of the current thread while in scope, so that
+	 * the searches this thread runs meanwhile are bounded by it */
+	class CLUCENE_EXPORT Scope{
+		QueryTimeout* previous;
+		bool installed;
+	public:
+		/** @param timeout The token, or NULL to leave the current one in place */
+		Scope(QueryTimeout* timeout);
+		~Scope();
+	};
+
+	static CLUCENE_LOCAL void _shutdown();
+};
+
+CL_NS_END
+#endif
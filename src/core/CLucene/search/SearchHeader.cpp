@@ -155,7 +155,8 @@ TopFieldDocs::~TopFieldDocs(){
 TopDocs::TopDocs(const int32_t th, ScoreDoc*sds, int32_t scoreDocsLen):
     totalHits(th),
 	scoreDocs(sds),
-	scoreDocsLength(scoreDocsLen)
+	scoreDocsLength(scoreDocsLen),
+	timedOut(false)
 {
 //Func - Constructor
 //Pre  - sds may or may not be NULL
@@ -228,5 +229,13 @@ TCHAR* Weight::toString(){
 Searchable::~Searchable(){
 }
 
+TopDocs* Searchable::searchAfter(const ScoreDoc& /*after*/, Query* /*query*/, Filter* /*filter*/, const int32_t /*n*/){
+	_CLTHROWA(CL_ERR_UnsupportedOperation, "searchAfter is not supported by this Searchable");
+}
+
+TopFieldDocs* Searchable::searchAfter(const FieldDoc& /*after*/, Query* /*query*/, Filter* /*filter*/, const int32_t /*n*/, const Sort* /*sort*/){
+	_CLTHROWA(CL_ERR_UnsupportedOperation, "searchAfter is not supported by this Searchable");
+}
+
 
 CL_NS_END
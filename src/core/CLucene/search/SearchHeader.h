@@ -54,6 +54,11 @@ CL_NS_DEF(search)
 		ScoreDoc* scoreDocs;
 		int32_t scoreDocsLength;
 
+		/** True if the search was stopped by the {@link QueryTimeout} that the calling
+		 * thread made current with a {@link QueryTimeout::Scope}. The hits are then
+		 * those found until it stopped, and totalHits is a lower bound. */
+		bool timedOut;
+
 		/** Expert: Constructs a TopDocs. TopDocs takes ownership of the ScoreDoc array*/
 		TopDocs(const int32_t th, ScoreDoc* sds, int32_t scoreDocsLength);
 		virtual ~TopDocs();
@@ -29,6 +29,8 @@ CL_NS_DEF(search)
 	class Similarity;
 	class TopFieldDocs;
 	class Sort;
+	class FieldDoc;
+	struct ScoreDoc;
 	
 
    /** The interface for search implementations.
@@ -113,6 +115,28 @@ CL_NS_DEF(search)
       * Searcher#search(Query,Filter,Sort)} instead.
       */
 	  	virtual TopFieldDocs* _search(Query* query, Filter* filter, const int32_t n, const Sort* sort) = 0;
+
+      /** Expert: Finds the next page of hits of a search by score. Returns the top
+      * <code>n</code> hits for <code>query</code> which sort after <code>after</code>,
+      * the last hit of the previous page, so that earlier pages are neither
+      * searched for again nor sorted. The total hit count covers all hits.
+      *
+      * <p><code>after</code> holds the raw score and document number of a hit returned
+      * by this searchable for the same query and filter.
+      *
+      * <p>The default implementation throws an UnsupportedOperation error.
+      */
+      virtual TopDocs* searchAfter(const ScoreDoc& after, Query* query, Filter* filter, const int32_t n);
+
+      /** Expert: Finds the next page of hits of a sorted search, like
+      * {@link #searchAfter(const ScoreDoc&,Query*,Filter*,int32_t)} does for a
+      * search by score. <code>after</code> is the last FieldDoc of the previous page,
+      * with its sort values. Since the sort values of the documents are compared
+      * by document number, the searchable must not have changed in between.
+      *
+      * <p>The default implementation throws an UnsupportedOperation error.
+      */
+      virtual TopFieldDocs* searchAfter(const FieldDoc& after, Query* query, Filter* filter, const int32_t n, const Sort* sort);
    };
 
 
@@ -0,0 +1,58 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "TimeLimitedCollector.h"
+#include "QueryTimeout.h"
+
+CL_NS_DEF(search)
+
+TimeLimitedCollector::TimeLimitedCollector(HitCollector* collector, QueryTimeout* timeout):
+	collector(collector),
+	timeout(timeout)
+{
+}
+TimeLimitedCollector::~TimeLimitedCollector(){
+}
+
+void TimeLimitedCollector::collect(const int32_t doc, const float_t score){
+	timeout->check();
+	collector->collect(doc, score);
+}
+
+bool TimeLimitedCollector::isTimedOut() const{
+	return timeout->isExceeded();
+}
+
+
+CountLimitedCollector::CountLimitedCollector(HitCollector* collector, int32_t maxHits):
+	collector(collector),
+	maxHits(maxHits),
+	count(0)
+{
+	if ( maxHits <= 0 )
+		_CLTHROWA(CL_ERR_IllegalArgument, "maxHits must be greater than 0");
+}
+CountLimitedCollector::~CountLimitedCollector(){
+}
+
+void CountLimitedCollector::collect(const int32_t doc, const float_t score){
+	if ( score <= 0.0f ) // ignore zeroed buckets
+		return;
+	collector->collect(doc, score);
+	if ( ++count >= maxHits )
+		_CLTHROWA(CL_ERR_CollectionTerminated, "collected the maximum number of hits");
+}
+
+int32_t CountLimitedCollector::getCount() const{
+	return count;
+}
+
+bool CountLimitedCollector::isTerminated() const{
+	return count >= maxHits;
+}
+
+CL_NS_END
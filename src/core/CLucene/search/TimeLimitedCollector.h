@@ -0,0 +1,63 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_TimeLimitedCollector_
+#define _lucene_search_TimeLimitedCollector_
+
+#include "SearchHeader.h"
+
+CL_CLASS_DEF(search,QueryTimeout)
+
+CL_NS_DEF(search)
+
+/**
+ * A HitCollector which checks a {@link QueryTimeout} before passing each hit
+ * on to another collector. Once the timeout is exceeded, the search stops with
+ * CL_ERR_TimeExceeded and the wrapped collector keeps the hits collected so far.
+ *
+ * {@link IndexSearcher} wraps its collectors like this when it has a timeout,
+ * and also catches the error.
+ */
+class CLUCENE_EXPORT TimeLimitedCollector: public HitCollector{
+	HitCollector* collector;
+	QueryTimeout* timeout;
+public:
+	/** Neither collector nor timeout is deleted with this collector */
+	TimeLimitedCollector(HitCollector* collector, QueryTimeout* timeout);
+	virtual ~TimeLimitedCollector();
+
+	void collect(const int32_t doc, const float_t score);
+
+	/** Returns true if the timeout stopped the search */
+	bool isTimedOut() const;
+};
+
+/**
+ * A HitCollector which passes the first <code>maxHits</code> hits on to another
+ * collector and then ends the search with CL_ERR_CollectionTerminated, which
+ * {@link IndexSearcher#_search(Query*,Filter*,HitCollector*)} catches. Useful
+ * when any few matches will do, such as to test whether a query matches at all.
+ */
+class CLUCENE_EXPORT CountLimitedCollector: public HitCollector{
+	HitCollector* collector;
+	int32_t maxHits;
+	int32_t count;
+public:
+	/** collector is not deleted with this collector */
+	CountLimitedCollector(HitCollector* collector, int32_t maxHits);
+	virtual ~CountLimitedCollector();
+
+	void collect(const int32_t doc, const float_t score);
+
+	/** Returns the number of hits passed on */
+	int32_t getCount() const;
+
+	/** Returns true if maxHits hits were passed on, so the search ended early */
+	bool isTerminated() const;
+};
+
+CL_NS_END
+#endif
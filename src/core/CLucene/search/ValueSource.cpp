@@ -0,0 +1,397 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "ValueSource.h"
+#include "Explanation.h"
+#include "FieldCache.h"
+#include "Sort.h"
+#include "CLucene/index/IndexReader.h"
+#include "CLucene/index/Term.h"
+#include "CLucene/index/Terms.h"
+#include "CLucene/util/Misc.h"
+#include "CLucene/util/StringBuffer.h"
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+CL_NS_USE(index)
+CL_NS_USE(util)
+CL_NS_DEF(search)
+
+FunctionValues::~FunctionValues(){
+}
+Explanation* FunctionValues::explain(int32_t doc){
+	TCHAR* desc = toString(doc);
+	Explanation* ret = _CLNEW Explanation(floatVal(doc), desc);
+	_CLDELETE_LCARRAY(desc);
+	return ret;
+}
+
+ValueSource::~ValueSource(){
+}
+
+
+/**
+* The values of a field, read from the FieldCache of each segment of a reader.
+* Scorers ask for documents in increasing order, so the segment of the last
+* document is checked first.
+*/
+class FieldCacheValues: public FunctionValues{
+	TCHAR* field;
+	bool ints;
+	std::vector<const int32_t*> intArrays; // NULL for segments without a value
+	std::vector<const float_t*> floatArrays;
+	std::vector<int32_t> starts;           // the first doc of each segment, followed by maxDoc
+	size_t current;
+
+	static bool hasValues(IndexReader* reader, const TCHAR* field){
+		if ( reader->getDocValuesType(field) != 0 )
+			return true;
+		Term* term = _CLNEW Term(field, LUCENE_BLANK_STRING);
+		TermEnum* termEnum = reader->terms(term);
+		_CLDECDELETE(term);
+		Term* t = termEnum->term(false);
+		const bool ret = t != NULL && _tcscmp(t->field(), field) == 0;
+		termEnum->close();
+		_CLDELETE(termEnum);
+		return ret;
+	}
+
+	void addReader(IndexReader* reader){
+		const ArrayBase<IndexReader*>* subReaders = reader->getSequentialSubReaders();
+		if ( subReaders != NULL ){
+			for ( size_t i=0;i<subReaders->length;i++ )
+				addReader((*subReaders)[i]);
+			return;
+		}
+		if ( reader->maxDoc() == 0 )
+			return;
+		const bool values = hasValues(reader, field);
+		if ( ints )
+			intArrays.push_back(values ? FieldCache::DEFAULT()->getInts(reader, field)->intArray : NULL);
+		else
+			floatArrays.push_back(values ? FieldCache::DEFAULT()->getFloats(reader, field)->floatArray : NULL);
+		starts.push_back(starts.back() + reader->maxDoc());
+	}
+public:
+	FieldCacheValues(IndexReader* reader, const TCHAR* field, bool ints):
+		field(STRDUP_TtoT(field)),
+		ints(ints),
+		current(0)
+	{
+		starts.push_back(0);
+		addReader(reader);
+	}
+	~FieldCacheValues(){
+		_CLDELETE_LCARRAY(field);
+	}
+
+	float_t floatVal(int32_t doc){
+		if ( doc < starts[current] || doc >= starts[current+1] ){
+			// the last start <= doc
+			current = std::upper_bound(starts.begin(), starts.end(), doc) - starts.begin() - 1;
+		}
+		doc -= starts[current];
+		if ( ints ){
+			const int32_t* values = intArrays[current];
+			return values == NULL ? 0 : (float_t)values[doc];
+		}
+		const float_t* values = floatArrays[current];
+		return values == NULL ? 0 : values[doc];
+	}
+
+	TCHAR* toString(int32_t doc){
+		StringBuffer buf;
+		buf.append(ints ? _T("int(") : _T("float("));
+		buf.append(field);
+		buf.append(_T(")="));
+		buf.appendFloat(floatVal(doc), 2);
+		return buf.giveBuffer();
+	}
+};
+
+FieldValueSource::FieldValueSource(const TCHAR* field, int32_t type):
+	field(STRDUP_TtoT(field)),
+	type(type)
+{
+	if ( type != SortField::INT && type != SortField::FLOAT )
+		_CLTHROWA(CL_ERR_IllegalArgument, "type must be SortField::INT or SortField::FLOAT");
+}
+FieldValueSource::~FieldValueSource(){
+	_CLDELETE_LCARRAY(field);
+}
+const TCHAR* FieldValueSource::getField() const{
+	return field;
+}
+int32_t FieldValueSource::getType() const{
+	return type;
+}
+FunctionValues* FieldValueSource::getValues(IndexReader* reader){
+	return _CLNEW FieldCacheValues(reader, field, type == SortField::INT);
+}
+TCHAR* FieldValueSource::description() const{
+	StringBuffer buf;
+	buf.append(type == SortField::INT ? _T("int(") : _T("float("));
+	buf.append(field);
+	buf.appendChar(')');
+	return buf.giveBuffer();
+}
+ValueSource* FieldValueSource::clone() const{
+	return _CLNEW FieldValueSource(field, type);
+}
+bool FieldValueSource::equals(const ValueSource* other) const{
+	if ( !other->instanceOf(getClassName()) )
+		return false;
+	const FieldValueSource* o = static_cast<const FieldValueSource*>(other);
+	return type == o->type && _tcscmp(field, o->field) == 0;
+}
+size_t FieldValueSource::hashCode() const{
+	return Misc::thashCode(field) ^ type;
+}
+const char* FieldValueSource::getClassName(){
+	return "FieldValueSource";
+}
+const char* FieldValueSource::getObjectName() const{
+	return getClassName();
+}
+
+
+class ConstValues: public FunctionValues{
+	float_t value;
+public:
+	ConstValues(float_t value): value(value){}
+	float_t floatVal(int32_t /*doc*/){
+		return value;
+	}
+	TCHAR* toString(int32_t /*doc*/){
+		StringBuffer buf;
+		buf.append(_T("const("));
+		buf.appendFloat(value, 2);
+		buf.appendChar(')');
+		return buf.giveBuffer();
+	}
+};
+
+ConstValueSource::ConstValueSource(float_t value):
+	value(value)
+{
+}
+ConstValueSource::~ConstValueSource(){
+}
+FunctionValues* ConstValueSource::getValues(IndexReader* /*reader*/){
+	return _CLNEW ConstValues(value);
+}
+TCHAR* ConstValueSource::description() const{
+	ConstValues values(value);
+	return values.toString(0);
+}
+ValueSource* ConstValueSource::clone() const{
+	return _CLNEW ConstValueSource(value);
+}
+bool ConstValueSource::equals(const ValueSource* other) const{
+	return other->instanceOf(getClassName()) && value == static_cast<const ConstValueSource*>(other)->value;
+}
+size_t ConstValueSource::hashCode() const{
+	return static_cast<size_t>(value * 1000) ^ 0x2C6B4C1D;
+}
+const char* ConstValueSource::getClassName(){
+	return "ConstValueSource";
+}
+const char* ConstValueSource::getObjectName() const{
+	return getClassName();
+}
+
+
+class FloatFunction::Values: public FunctionValues{
+	const FloatFunction* function;
+	FunctionValues* values;
+public:
+	Values(const FloatFunction* function, FunctionValues* values):
+		function(function),
+		values(values)
+	{
+	}
+	~Values(){
+		_CLDELETE(values);
+	}
+	float_t floatVal(int32_t doc){
+		return function->apply(values->floatVal(doc));
+	}
+	TCHAR* toString(int32_t doc){
+		TCHAR* value = values->toString(doc);
+		TCHAR* desc = function->describe(value);
+		_CLDELETE_LCARRAY(value);
+		StringBuffer buf;
+		buf.append(desc);
+		_CLDELETE_LCARRAY(desc);
+		buf.appendChar('=');
+		buf.appendFloat(floatVal(doc), 2);
+		return buf.giveBuffer();
+	}
+};
+
+FloatFunction::FloatFunction(ValueSource* source, bool deleteSource):
+	source(source),
+	deleteSource(deleteSource)
+{
+}
+FloatFunction::FloatFunction(const FloatFunction& clone):
+	ValueSource(clone),
+	source(clone.source->clone()),
+	deleteSource(true)
+{
+}
+FloatFunction::~FloatFunction(){
+	if ( deleteSource )
+		_CLDELETE(source);
+}
+FunctionValues* FloatFunction::getValues(IndexReader* reader){
+	return _CLNEW Values(this, source->getValues(reader));
+}
+TCHAR* FloatFunction::description() const{
+	TCHAR* desc = source->description();
+	TCHAR* ret = describe(desc);
+	_CLDELETE_LCARRAY(desc);
+	return ret;
+}
+bool FloatFunction::equals(const ValueSource* other) const{
+	return other->instanceOf(getObjectName()) &&
+		source->equals(static_cast<const FloatFunction*>(other)->source);
+}
+size_t FloatFunction::hashCode() const{
+	return source->hashCode() ^ Misc::ahashCode(getObjectName());
+}
+
+
+LinearFloatFunction::LinearFloatFunction(ValueSource* source, float_t m, float_t b, bool deleteSource):
+	FloatFunction(source, deleteSource),
+	m(m),
+	b(b)
+{
+}
+LinearFloatFunction::LinearFloatFunction(const LinearFloatFunction& clone):
+	FloatFunction(clone),
+	m(clone.m),
+	b(clone.b)
+{
+}
+LinearFloatFunction::~LinearFloatFunction(){
+}
+float_t LinearFloatFunction::apply(float_t v) const{
+	return m * v + b;
+}
+TCHAR* LinearFloatFunction::describe(const TCHAR* sourceDescription) const{
+	StringBuffer buf;
+	buf.appendFloat(m, 2);
+	buf.append(_T("*"));
+	buf.append(sourceDescription);
+	buf.append(_T("+"));
+	buf.appendFloat(b, 2);
+	return buf.giveBuffer();
+}
+ValueSource* LinearFloatFunction::clone() const{
+	return _CLNEW LinearFloatFunction(*this);
+}
+bool LinearFloatFunction::equals(const ValueSource* other) const{
+	if ( !FloatFunction::equals(other) )
+		return false;
+	const LinearFloatFunction* o = static_cast<const LinearFloatFunction*>(other);
+	return m == o->m && b == o->b;
+}
+size_t LinearFloatFunction::hashCode() const{
+	return FloatFunction::hashCode() ^ static_cast<size_t>(m * 1000 + b);
+}
+const char* LinearFloatFunction::getClassName(){
+	return "LinearFloatFunction";
+}
+const char* LinearFloatFunction::getObjectName() const{
+	return getClassName();
+}
+
+
+ReciprocalFloatFunction::ReciprocalFloatFunction(ValueSource* source, float_t m, float_t a, float_t b, bool deleteSource):
+	FloatFunction(source, deleteSource),
+	m(m),
+	a(a),
+	b(b)
+{
+}
+ReciprocalFloatFunction::ReciprocalFloatFunction(const ReciprocalFloatFunction& clone):
+	FloatFunction(clone),
+	m(clone.m),
+	a(clone.a),
+	b(clone.b)
+{
+}
+ReciprocalFloatFunction::~ReciprocalFloatFunction(){
+}
+float_t ReciprocalFloatFunction::apply(float_t v) const{
+	return a / (m * v + b);
+}
+TCHAR* ReciprocalFloatFunction::describe(const TCHAR* sourceDescription) const{
+	StringBuffer buf;
+	buf.appendFloat(a, 2);
+	buf.append(_T("/("));
+	buf.appendFloat(m, 2);
+	buf.append(_T("*"));
+	buf.append(sourceDescription);
+	buf.append(_T("+"));
+	buf.appendFloat(b, 2);
+	buf.appendChar(')');
+	return buf.giveBuffer();
+}
+ValueSource* ReciprocalFloatFunction::clone() const{
+	return _CLNEW ReciprocalFloatFunction(*this);
+}
+bool ReciprocalFloatFunction::equals(const ValueSource* other) const{
+	if ( !FloatFunction::equals(other) )
+		return false;
+	const ReciprocalFloatFunction* o = static_cast<const ReciprocalFloatFunction*>(other);
+	return m == o->m && a == o->a && b == o->b;
+}
+size_t ReciprocalFloatFunction::hashCode() const{
+	return FloatFunction::hashCode() ^ static_cast<size_t>(m * 1000 + a * 100 + b);
+}
+const char* ReciprocalFloatFunction::getClassName(){
+	return "ReciprocalFloatFunction";
+}
+const char* ReciprocalFloatFunction::getObjectName() const{
+	return getClassName();
+}
+
+
+LogFloatFunction::LogFloatFunction(ValueSource* source, bool deleteSource):
+	FloatFunction(source, deleteSource)
+{
+}
+LogFloatFunction::LogFloatFunction(const LogFloatFunction& clone):
+	FloatFunction(clone)
+{
+}
+LogFloatFunction::~LogFloatFunction(){
+}
+float_t LogFloatFunction::apply(float_t v) const{
+	return v > 0 ? (float_t)log10(1 + v) : 0;
+}
+TCHAR* LogFloatFunction::describe(const TCHAR* sourceDescription) const{
+	StringBuffer buf;
+	buf.append(_T("log("));
+	buf.append(sourceDescription);
+	buf.appendChar(')');
+	return buf.giveBuffer();
+}
+ValueSource* LogFloatFunction::clone() const{
+	return _CLNEW LogFloatFunction(*this);
+}
+const char* LogFloatFunction::getClassName(){
+	return "LogFloatFunction";
+}
+const char* LogFloatFunction::getObjectName() const{
+	return getClassName();
+}
+
+CL_NS_END
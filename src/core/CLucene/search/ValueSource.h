@@ -0,0 +1,211 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_ValueSource_
+#define _lucene_search_ValueSource_
+
+#include "CLucene/util/Equators.h"
+
+CL_CLASS_DEF(index,IndexReader)
+CL_CLASS_DEF(search,Explanation)
+
+CL_NS_DEF(search)
+
+/**
+ * Expert: the values of a {@link ValueSource} for the documents of one reader.
+ */
+class CLUCENE_EXPORT FunctionValues: LUCENE_BASE{
+public:
+	virtual ~FunctionValues();
+
+	/** Returns the value of doc */
+	virtual float_t floatVal(int32_t doc) = 0;
+
+	/** Returns a description of the value of doc, such as <code>float(price)=12.5</code>
+	 * @memory The caller must delete the returned string
+	 */
+	virtual TCHAR* toString(int32_t doc) = 0;
+
+	/** Explains the value of doc. By default a single node with {@link #toString}.
+	 * @memory The caller must delete the returned explanation
+	 */
+	virtual Explanation* explain(int32_t doc);
+};
+
+/**
+ * Expert: a source of a value for each document, which a {@link FunctionQuery}
+ * or a {@link CustomScoreQuery} folds into the score.
+ *
+ * Sources that read field values load them from the {@link FieldCache} of each
+ * segment of a reader, so the values of unchanged segments are reused when
+ * an index is reopened.
+ */
+class CLUCENE_EXPORT ValueSource: public CL_NS(util)::NamedObject{
+public:
+	virtual ~ValueSource();
+
+	/** Returns the values for the documents of reader.
+	 * @memory The caller must delete the returned values
+	 */
+	virtual FunctionValues* getValues(CL_NS(index)::IndexReader* reader) = 0;
+
+	/** Returns a description of this source, such as <code>float(price)</code>
+	 * @memory The caller must delete the returned string
+	 */
+	virtual TCHAR* description() const = 0;
+
+	virtual ValueSource* clone() const = 0;
+	virtual bool equals(const ValueSource* other) const = 0;
+	virtual size_t hashCode() const = 0;
+};
+
+/**
+ * The int or float value each document has in a field, as read by
+ * {@link FieldCache#getInts} or {@link FieldCache#getFloats}. Documents without
+ * a value get 0. The field must hold at most one value per document.
+ */
+class CLUCENE_EXPORT FieldValueSource: public ValueSource{
+	TCHAR* field;
+	int32_t type;
+public:
+	/**
+	 * @param field The field to read
+	 * @param type {@link SortField#INT} or {@link SortField#FLOAT}
+	 */
+	FieldValueSource(const TCHAR* field, int32_t type);
+	virtual ~FieldValueSource();
+
+	const TCHAR* getField() const;
+	int32_t getType() const;
+
+	FunctionValues* getValues(CL_NS(index)::IndexReader* reader);
+	TCHAR* description() const;
+	ValueSource* clone() const;
+	bool equals(const ValueSource* other) const;
+	size_t hashCode() const;
+
+	static const char* getClassName();
+	const char* getObjectName() const;
+};
+
+/** The same value for all documents */
+class CLUCENE_EXPORT ConstValueSource: public ValueSource{
+	float_t value;
+public:
+	ConstValueSource(float_t value);
+	virtual ~ConstValueSource();
+
+	FunctionValues* getValues(CL_NS(index)::IndexReader* reader);
+	TCHAR* description() const;
+	ValueSource* clone() const;
+	bool equals(const ValueSource* other) const;
+	size_t hashCode() const;
+
+	static const char* getClassName();
+	const char* getObjectName() const;
+};
+
+/**
+ * Base of sources that compute the value of a document from the value
+ * another source has for it.
+ */
+class CLUCENE_EXPORT FloatFunction: public ValueSource{
+protected:
+	ValueSource* source;
+	bool deleteSource;
+
+	FloatFunction(ValueSource* source, bool deleteSource);
+	FloatFunction(const FloatFunction& clone);
+
+	/** Returns the value of the function for the value v of source */
+	virtual float_t apply(float_t v) const = 0;
+
+	/** Describes the function applied to the description of source,
+	 * as in <code>log(float(price))</code>
+	 * @memory The caller must delete the returned string
+	 */
+	virtual TCHAR* describe(const TCHAR* sourceDescription) const = 0;
+
+	class Values;
+	friend class Values;
+public:
+	virtual ~FloatFunction();
+
+	FunctionValues* getValues(CL_NS(index)::IndexReader* reader);
+	TCHAR* description() const;
+	bool equals(const ValueSource* other) const;
+	size_t hashCode() const;
+};
+
+/** <code>m*v + b</code>, where v is the value of a source */
+class CLUCENE_EXPORT LinearFloatFunction: public FloatFunction{
+	float_t m;
+	float_t b;
+protected:
+	LinearFloatFunction(const LinearFloatFunction& clone);
+	float_t apply(float_t v) const;
+	TCHAR* describe(const TCHAR* sourceDescription) const;
+public:
+	/** @param deleteSource If true, source is deleted with this function */
+	LinearFloatFunction(ValueSource* source, float_t m, float_t b, bool deleteSource=true);
+	virtual ~LinearFloatFunction();
+
+	ValueSource* clone() const;
+	bool equals(const ValueSource* other) const;
+	size_t hashCode() const;
+
+	static const char* getClassName();
+	const char* getObjectName() const;
+};
+
+/**
+ * <code>a / (m*v + b)</code>, where v is the value of a source. With a
+ * source such as the age of a document, this gives recent documents a
+ * boost of up to <code>a/b</code> that falls off as the age grows.
+ */
+class CLUCENE_EXPORT ReciprocalFloatFunction: public FloatFunction{
+	float_t m;
+	float_t a;
+	float_t b;
+protected:
+	ReciprocalFloatFunction(const ReciprocalFloatFunction& clone);
+	float_t apply(float_t v) const;
+	TCHAR* describe(const TCHAR* sourceDescription) const;
+public:
+	/** @param deleteSource If true, source is deleted with this function */
+	ReciprocalFloatFunction(ValueSource* source, float_t m, float_t a, float_t b, bool deleteSource=true);
+	virtual ~ReciprocalFloatFunction();
+
+	ValueSource* clone() const;
+	bool equals(const ValueSource* other) const;
+	size_t hashCode() const;
+
+	static const char* getClassName();
+	const char* getObjectName() const;
+};
+
+/**
+ * <code>log10(1 + v)</code>, where v is the value of a source, or 0 for
+ * negative values. Dampens values such as popularity counts.
+ */
+class CLUCENE_EXPORT LogFloatFunction: public FloatFunction{
+protected:
+	LogFloatFunction(const LogFloatFunction& clone);
+	float_t apply(float_t v) const;
+	TCHAR* describe(const TCHAR* sourceDescription) const;
+public:
+	/** @param deleteSource If true, source is deleted with this function */
+	LogFloatFunction(ValueSource* source, bool deleteSource=true);
+	virtual ~LogFloatFunction();
+
+	ValueSource* clone() const;
+
+	static const char* getClassName();
+	const char* getObjectName() const;
+};
+
+CL_NS_END
+#endif
@@ -10,6 +10,8 @@
 
 #include "Scorer.h"
 
+CL_CLASS_DEF(search,QueryTimeout)
+
 CL_NS_DEF(search)
 	
 	class BooleanScorer: public Scorer {
@@ -58,8 +60,9 @@ CL_NS_DEF(search)
 		private:
 			BucketTable* bucketTable;
 			int32_t mask;
+			QueryTimeout* timeout;
 		public:
-			Collector(const int32_t mask, BucketTable* bucketTable);
+			Collector(const int32_t mask, BucketTable* bucketTable, QueryTimeout* timeout);
 			
 			void collect(const int32_t doc, const float_t score);
 		};
@@ -75,6 +78,7 @@ CL_NS_DEF(search)
 		
 		int32_t minNrShouldMatch;
 		bool isTakingOwnership;
+		QueryTimeout* timeout; // of the search running on this thread, if any
 		
 	public:
 		LUCENE_STATIC_CONSTANT(int32_t,BucketTable_SIZE=1024);
@@ -9,6 +9,7 @@
 
 #include "Scorer.h"
 #include "CLucene/util/Array.h"
+CL_CLASS_DEF(search,QueryTimeout)
 CL_NS_DEF(search)
 
 /** Scorer for conjunctions, sets of queries, all of which are required. */
@@ -20,6 +21,7 @@ private:
   bool more;
   float_t coord;
   int32_t lastDoc;
+  QueryTimeout* timeout; // of the search running on this thread, if any
 
   Scorer* last();
   bool doNext();
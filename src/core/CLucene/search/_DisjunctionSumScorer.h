@@ -7,6 +7,7 @@
 #ifndef _lucene_search_DisjunctionSumScorer_
 #define _lucene_search_DisjunctionSumScorer_
 
+CL_CLASS_DEF(search,QueryTimeout)
 CL_NS_USE(util)
 CL_NS_DEF(search)
 
@@ -40,6 +41,8 @@ private:
 	int32_t currentDoc;
 	float_t currentScore;
 
+	QueryTimeout* timeout; // of the search running on this thread, if any
+
 	/** Called the first time next() or skipTo() is called to
 	* initialize <code>scorerDocQueue</code>.
 	*/
@@ -7,27 +7,50 @@
 #ifndef _lucene_search_HitQueue_
 #define _lucene_search_HitQueue_
 
+#include "SearchHeader.h"
+#include "CLucene/util/_ThreadLocal.h"
+
 CL_NS_DEF(search)
-struct ScoreDoc;
 
 /**
 * An optimised PriorityQueue which takes ScoreDoc structs. Some by-ref passing
 * and memory related optimisations have been done.
+*
+* The heap is one contiguous array of ScoreDoc values. A queue can be created
+* full of sentinel hits which sort below every collected hit (all of which
+* score above 0). Collecting then never has to grow the queue: a hit that does
+* not beat top() costs one comparison, and a hit that does overwrites top()
+* and calls updateTop(), which is a single downHeap.
 */
 class HitQueue: LUCENE_BASE {
 private:
 	ScoreDoc* heap;
 	size_t _size;
 	size_t maxSize;
+	size_t capacity;	// number of hits the heap array can hold
 
 	void upHeap();
 	void downHeap();
 
 protected:
-	bool lessThan(struct ScoreDoc& hitA, struct ScoreDoc& hitB);
+	inline bool lessThan(const struct ScoreDoc& hitA, const struct ScoreDoc& hitB) const{
+		if (hitA.score == hitB.score)
+			return hitA.doc > hitB.doc; 
+		else
+			return hitA.score < hitB.score;
+	}
 
 public:
+	/** The document number of the sentinel hits */
+	LUCENE_STATIC_CONSTANT(int32_t, SENTINEL_DOC = LUCENE_INT32_MAX_SHOULDBE);
+
 	void adjustTop();
+	/**
+	* Should be called when the top element was changed in place, e.g. by
+	* overwriting it with a better hit. Restores the heap order and returns
+	* the new top element.
+	*/
+	struct ScoreDoc& updateTop();
 	struct ScoreDoc& top();
 	void put(struct ScoreDoc& element);
 	ScoreDoc pop();
@@ -42,9 +65,43 @@ public:
 	* Returns the number of elements currently stored in the PriorityQueue.
 	*/ 
 	size_t size();
-	HitQueue(const int32_t maxSize);
+
+	/**
+	* Creates a queue for maxSize hits.
+	* @param prePopulate fill the queue with maxSize sentinel hits, see {@link #SENTINEL_DOC}
+	*/
+	HitQueue(const int32_t maxSize, bool prePopulate=false);
 	~HitQueue();
 
+	/** Empties the queue and makes it hold maxSize hits. The heap array is only
+	* reallocated if it is too small. */
+	void reset(const int32_t maxSize, bool prePopulate=false);
 };
+
+/**
+* Keeps one HitQueue per thread, so that searches for the top hits do not
+* allocate a queue each time. Queues for more than MAX_POOLED_SIZE hits are
+* not pooled.
+*/
+class HitQueuePool: LUCENE_BASE {
+	class Entry: LUCENE_BASE {
+	public:
+		HitQueue queue;
+		bool inUse;
+		Entry(): queue(0), inUse(false){}
+	};
+	CL_NS(util)::ThreadLocal<Entry*, CL_NS(util)::Deletor::Object<Entry> > entries;
+public:
+	LUCENE_STATIC_CONSTANT(int32_t, MAX_POOLED_SIZE = 1024);
+
+	HitQueuePool();
+	~HitQueuePool();
+
+	/** Returns an empty queue pre-populated with maxSize sentinel hits.
+	* The queue has to be given back with release(). */
+	HitQueue* get(const int32_t maxSize);
+	void release(HitQueue* queue);
+};
+
 CL_NS_END
 #endif
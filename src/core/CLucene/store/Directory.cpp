@@ -53,6 +53,8 @@ bool Directory::deleteFile(const char* name, const bool throwError){
     }
     return ret;
 }
+void Directory::sync(const std::vector<std::string>& /*names*/){
+}
 IndexInput* Directory::openInput(const char* name, int32_t bufferSize){
 	IndexInput* ret;
 	CLuceneError err;
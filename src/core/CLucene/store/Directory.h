@@ -79,6 +79,10 @@ class CLUCENE_EXPORT Directory: LUCENE_REFBASE, public CL_NS(util)::NamedObject
 		//	Returns a stream writing this file.
 		virtual IndexOutput* createOutput(const char* name) = 0;
 
+		// Ensures that the named files, which must be closed, are on stable
+		//	storage, so that they survive a crash. Does nothing by default.
+		virtual void sync(const std::vector<std::string>& names);
+
 		// Construct a {@link Lock}.
 		// @param name the name of the lock file
 		virtual LuceneLock* makeLock(const char* name);
@@ -19,6 +19,9 @@
 #ifdef _CL_HAVE_DIRECT_H
 	#include <direct.h>
 #endif
+#ifdef _CL_HAVE_SYS_UIO_H
+	#include <sys/uio.h>
+#endif
 #include <errno.h>
 
 #include <assert.h>
@@ -66,10 +69,14 @@ CL_NS_USE(util)
 		};
 		SharedHandle* handle;
 		int64_t _pos;
-		FSIndexInput(SharedHandle* handle, int32_t __bufferSize):
+		int64_t _offset; //where this input starts in the file, if it is a slice
+		int64_t _length;
+		FSIndexInput(SharedHandle* handle, int32_t __bufferSize, int64_t offset, int64_t length):
 			BufferedIndexInput(__bufferSize)
 		{
 			this->_pos = 0;
+			this->_offset = offset;
+			this->_length = length;
 			this->handle = handle;
 		};
 	protected:
@@ -80,7 +87,8 @@ CL_NS_USE(util)
 
 		IndexInput* clone() const;
 		void close();
-		int64_t length() const { return handle->_length; }
+		int64_t length() const { return _length; }
+		IndexInput* slice(const int64_t offset, const int64_t length) const;
 
 		const char* getDirectoryType() const{ return FSDirectory::getClassName(); }
     const char* getObjectName() const{ return getClassName(); }
@@ -90,6 +98,8 @@ CL_NS_USE(util)
 		void seekInternal(const int64_t position);
 		// IndexInput methods
 		void readInternal(uint8_t* b, const int32_t len);
+
+		friend class FSDirectory::FSIndexOutput;
 	};
 
 	class FSDirectory::FSIndexOutput: public BufferedIndexOutput {
@@ -98,12 +108,14 @@ CL_NS_USE(util)
 	protected:
 		// output methods:
 		void flushBuffer(const uint8_t* b, const int32_t size);
+		void flushBuffers(const uint8_t* b1, const int32_t len1, const uint8_t* b2, const int32_t len2);
 	public:
-		FSIndexOutput(const char* path, int filemode);
+		FSIndexOutput(const char* path, int filemode, int32_t bufferSize);
 		~FSIndexOutput();
 
 		// output methods:
 		void close();
+		void copyBytes(IndexInput* input, int64_t numBytes);
 
 		// Random-access methods
 		void seek(const int64_t pos);
@@ -133,7 +145,7 @@ CL_NS_USE(util)
 	  		error.set( CL_ERR_IO,"fileStat error" );
 		  else{
 			  handle->_fpos = 0;
-			  ret = _CLNEW FSIndexInput(handle, __bufferSize);
+			  ret = _CLNEW FSIndexInput(handle, __bufferSize, 0, handle->_length);
 			  return true;
 		  }
 	  }else{
@@ -164,7 +176,9 @@ CL_NS_USE(util)
 
 	  SCOPED_LOCK_MUTEX(*other.handle->SHARED_LOCK)
 	  handle = _CL_POINTER(other.handle);
-	  _pos = other.handle->_fpos; //note where we are currently...
+	  _pos = other._pos; //continue where other's buffer ends, the shared handle may have been moved by another clone
+	  _offset = other._offset;
+	  _length = other._length;
   }
 
   FSDirectory::FSIndexInput::SharedHandle::SharedHandle(const char* path){
@@ -199,6 +213,20 @@ CL_NS_USE(util)
   {
     return _CLNEW FSDirectory::FSIndexInput(*this);
   }
+  IndexInput* FSDirectory::FSIndexInput::slice(const int64_t offset, const int64_t length) const
+  {
+    if ( handle == NULL )
+      _CLTHROWA(CL_ERR_NullPointer, "handle is null");
+    if ( offset < 0 || length < 0 || offset + length > _length )
+      _CLTHROWA(CL_ERR_IO, "slice is outside of the file");
+
+    SharedHandle* h;
+    {
+      SCOPED_LOCK_MUTEX(*handle->SHARED_LOCK)
+      h = _CL_POINTER(handle);
+    }
+    return _CLNEW FSDirectory::FSIndexInput(h, bufferSize, _offset + offset, length);
+  }
   void FSDirectory::FSIndexInput::close()  {
 	BufferedIndexInput::close();
 #ifndef _CL_DISABLE_MULTITHREADING
@@ -231,7 +259,7 @@ CL_NS_USE(util)
   }
 
   void FSDirectory::FSIndexInput::seekInternal(const int64_t position)  {
-	CND_PRECONDITION(position>=0 &&position<handle->_length,"Seeking out of range")
+	CND_PRECONDITION(position>=0 &&position<=_length,"Seeking out of range")
 	_pos = position;
   }
 
@@ -239,16 +267,24 @@ CL_NS_USE(util)
 void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
 	CND_PRECONDITION(handle!=NULL,"shared file handle has closed");
 	CND_PRECONDITION(handle->fhandle>=0,"file is not open");
+#ifdef _CL_HAVE_FUNCTION_PREAD
+	// reads at a position leave the shared handle where it is, so clones need no lock
+	do{
+		bufferLength = (int32_t)::pread(handle->fhandle,b,len,_offset+_pos);
+	}while ( bufferLength == -1 && errno == EINTR );
+#else
 	SCOPED_LOCK_MUTEX(*handle->SHARED_LOCK)
 
-	if ( handle->_fpos != _pos ){
-		if ( fileSeek(handle->fhandle,_pos,SEEK_SET) != _pos ){
+	const int64_t fpos = _offset + _pos;
+	if ( handle->_fpos != fpos ){
+		if ( fileSeek(handle->fhandle,fpos,SEEK_SET) != fpos ){
 			_CLTHROWA( CL_ERR_IO, "File IO Seek error");
 		}
-		handle->_fpos = _pos;
+		handle->_fpos = fpos;
 	}
 
 	bufferLength = _read(handle->fhandle,b,len); // 2004.10.31:SF 1037836
+#endif
 	if (bufferLength == 0){
 		_CLTHROWA(CL_ERR_IO, "read past EOF");
 	}
@@ -259,10 +295,14 @@ void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
 		_CLTHROWA(CL_ERR_IO, "read error");
 	}
 	_pos+=bufferLength;
-	handle->_fpos=_pos;
+#ifndef _CL_HAVE_FUNCTION_PREAD
+	handle->_fpos=_offset+_pos;
+#endif
 }
 
-  FSDirectory::FSIndexOutput::FSIndexOutput(const char* path, int filemode){
+  FSDirectory::FSIndexOutput::FSIndexOutput(const char* path, int filemode, int32_t bufferSize):
+    BufferedIndexOutput(bufferSize)
+  {
 	//O_BINARY - Opens file in binary (untranslated) mode
 	//O_CREAT - Creates and opens new file for writing. Has no effect if file specified by filename exists
 	//O_RANDOM - Specifies that caching is optimized for, but not restricted to, random access from disk.
@@ -303,6 +343,66 @@ void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
       if ( size > 0 && _write(fhandle,b,size) != size )
         _CLTHROWA(CL_ERR_IO, "File IO Write error");
   }
+  void FSDirectory::FSIndexOutput::flushBuffers(const uint8_t* b1, const int32_t len1, const uint8_t* b2, const int32_t len2) {
+#if defined(_CL_HAVE_FUNCTION_WRITEV) && defined(_CL_HAVE_SYS_UIO_H)
+	  CND_PRECONDITION(fhandle>=0,"file is not open");
+      struct iovec iov[2];
+      iov[0].iov_base = (void*)b1;
+      iov[0].iov_len = len1;
+      iov[1].iov_base = (void*)b2;
+      iov[1].iov_len = len2;
+      struct iovec* next = len1 > 0 ? iov : iov + 1;
+      int count = len1 > 0 ? 2 : 1;
+      while ( count > 0 ){
+        ssize_t written = ::writev(fhandle, next, count);
+        if ( written < 0 ){
+          if ( errno == EINTR )
+            continue;
+          _CLTHROWA(CL_ERR_IO, "File IO Write error");
+        }
+        // a short write leaves the rest for the next call
+        while ( count > 0 && (size_t)written >= next->iov_len ){
+          written -= next->iov_len;
+          next++;
+          count--;
+        }
+        if ( count > 0 ){
+          next->iov_base = (uint8_t*)next->iov_base + written;
+          next->iov_len -= written;
+        }
+      }
+#else
+      BufferedIndexOutput::flushBuffers(b1, len1, b2, len2);
+#endif
+  }
+  void FSDirectory::FSIndexOutput::copyBytes(IndexInput* input, int64_t numBytes) {
+#ifdef _CL_HAVE_FUNCTION_COPY_FILE_RANGE
+    // between two files the kernel can copy without going through our memory
+    if ( numBytes > 0 && input->instanceOf(FSIndexInput::getClassName()) ){
+      FSIndexInput* in = static_cast<FSIndexInput*>(input);
+      flush();
+      loff_t inPos = in->_offset + in->getFilePointer();
+      loff_t outPos = getFilePointer();
+      int64_t left = numBytes;
+      while ( left > 0 ){
+        ssize_t copied = ::copy_file_range(in->handle->fhandle, &inPos, fhandle, &outPos, (size_t)left, 0);
+        if ( copied <= 0 ){
+          if ( copied < 0 && errno == EINTR )
+            continue;
+          break; // not supported here, e.g. across file systems: copy the rest the usual way
+        }
+        left -= copied;
+      }
+      const int64_t done = numBytes - left;
+      in->seek(in->getFilePointer() + done);
+      seek(getFilePointer() + done);
+      if ( left == 0 )
+        return;
+      numBytes = left;
+    }
+#endif
+    IndexOutput::copyBytes(input, numBytes);
+  }
   void FSDirectory::FSIndexOutput::close() {
     try{
       BufferedIndexOutput::close();
@@ -359,7 +459,8 @@ void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
   FSDirectory::FSDirectory():
    Directory(),
    refCount(0),
-   useMMap(LUCENE_USE_MMAP)
+   useMMap(LUCENE_USE_MMAP),
+   writeBufferSize(DEFAULT_WRITE_BUFFER_SIZE)
   {
     filemode = 0644;
     this->lockFactory = NULL;
@@ -377,6 +478,9 @@ void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
     		lockFactory = _CLNEW FSLockFactory( directory.c_str(), this->filemode );
     		doClearLockID = true;
     	}
+    } else if ( lockFactory->setDefaultLockDir( directory.c_str() ) ) {
+    	// the locks are kept with the index, so they need no prefix
+    	doClearLockID = true;
     }
 
     setLockFactory( lockFactory );
@@ -429,6 +533,12 @@ void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
   int FSDirectory::getFileMode(){
     return this->filemode;
   }
+  void FSDirectory::setWriteBufferSize(int32_t bufferSize){
+    if ( bufferSize <= 0 )
+      _CLTHROWA(CL_ERR_IllegalArgument, "bufferSize must be greater than 0");
+    writeBufferSize = bufferSize;
+  }
+  int32_t FSDirectory::getWriteBufferSize() const{ return writeBufferSize; }
   void FSDirectory::setUseMMap(bool value){ useMMap = value; }
   bool FSDirectory::getUseMMap() const{ return useMMap; }
   const char* FSDirectory::getClassName(){
@@ -629,6 +739,10 @@ void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
 	CND_PRECONDITION(directory[0]!=0,"directory is not open");
     char fl[CL_MAX_DIR];
     priv_getFN(fl, name);
+    {
+      SCOPED_LOCK_MUTEX(staleFiles_LOCK)
+      staleFiles.erase(name);
+    }
 	return _unlink(fl) != -1;
   }
 
@@ -656,6 +770,11 @@ void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
             _CLTHROWA_DEL(CL_ERR_IO, err );
         }
     }
+    {
+      SCOPED_LOCK_MUTEX(staleFiles_LOCK)
+      if ( staleFiles.erase(from) > 0 )
+        staleFiles.insert(to);
+    }
     if ( _rename(old,nu) != 0 ){
        //todo: jlucene has some extra rename code - if the rename fails, it copies
        //the whole file to the new file... might want to implement that if renaming
@@ -682,11 +801,118 @@ void FSDirectory::FSIndexInput::readInternal(uint8_t* b, const int32_t len) {
 		  }
           assert( ! Misc::dir_Exists(fl) );
 	  }
-    return _CLNEW FSIndexOutput( fl, this->filemode );
+    IndexOutput* ret = _CLNEW FSIndexOutput( fl, this->filemode, this->writeBufferSize );
+    SCOPED_LOCK_MUTEX(staleFiles_LOCK)
+    staleFiles.insert(name);
+    return ret;
+  }
+
+  /** Files shared by the threads of FSDirectory::sync */
+  struct FSDirectorySyncFiles{
+    std::vector<std::string> paths;
+    size_t next;
+    std::string failed;
+    DEFINE_MUTEX(THIS_LOCK)
+  };
+
+  static bool FSDirectory_fsync(const char* path){
+#ifdef _fsync
+    int32_t fhandle = _cl_open( path, _O_BINARY | O_RDWR, _S_IREAD | _S_IWRITE );
+    if ( fhandle < 0 )
+      fhandle = _cl_open( path, _O_BINARY | O_RDONLY, _S_IREAD );
+    if ( fhandle < 0 )
+      return false;
+    const bool ret = _fsync(fhandle) == 0;
+    ::_close(fhandle);
+    return ret;
+#else
+    return true;
+#endif
+  }
+
+  _LUCENE_THREAD_FUNC(FSDirectory_syncThread, _files){
+    FSDirectorySyncFiles* files = (FSDirectorySyncFiles*)_files;
+    for (;;){
+      std::string path;
+      {
+        SCOPED_LOCK_MUTEX(files->THIS_LOCK)
+        if ( files->next >= files->paths.size() || !files->failed.empty() )
+          break;
+        path = files->paths[files->next++];
+      }
+      if ( !FSDirectory_fsync(path.c_str()) ){
+        SCOPED_LOCK_MUTEX(files->THIS_LOCK)
+        files->failed = path;
+      }
+    }
+    _LUCENE_THREAD_FUNC_RETURN(0);
+  }
+
+  void FSDirectory::sync(const std::vector<std::string>& names){
+	CND_PRECONDITION(directory[0]!=0,"directory is not open");
+    std::vector<std::string> toSync;
+    FSDirectorySyncFiles files;
+    files.next = 0;
+    {
+      SCOPED_LOCK_MUTEX(staleFiles_LOCK)
+      for ( size_t i=0;i<names.size();i++ ){
+        if ( staleFiles.find(names[i]) != staleFiles.end() )
+          toSync.push_back(names[i]);
+      }
+    }
+    if ( toSync.empty() )
+      return;
+
+    char fl[CL_MAX_DIR];
+    for ( size_t i=0;i<toSync.size();i++ ){
+      priv_getFN(fl, toSync[i].c_str());
+      files.paths.push_back(fl);
+    }
+
+    // most of the time goes to waiting for the disk, so fsync several files at once
+    const size_t threadCount = toSync.size() < (size_t)SYNC_THREADS ? toSync.size() : SYNC_THREADS;
+    if ( threadCount > 1 ){
+      std::vector<_LUCENE_THREADID_TYPE> threads;
+      for ( size_t i=0;i<threadCount;i++ )
+        threads.push_back(_LUCENE_THREAD_CREATE(&FSDirectory_syncThread, &files));
+      for ( size_t i=0;i<threads.size();i++ )
+        _LUCENE_THREAD_JOIN(threads[i]);
+    }else{
+      FSDirectory_syncThread(&files);
+    }
+    if ( !files.failed.empty() ){
+      std::string err = "couldn't sync " + files.failed;
+      _CLTHROWA(CL_ERR_IO, err.c_str());
+    }
+
+    syncDirectory();
+
+    SCOPED_LOCK_MUTEX(staleFiles_LOCK)
+    for ( size_t i=0;i<toSync.size();i++ )
+      staleFiles.erase(toSync[i]);
+  }
+
+  void FSDirectory::syncDirectory(){
+    // makes the names of new files durable. Not all platforms and file systems
+    // can open or fsync a directory, in which case there is nothing to do
+#if defined(_fsync) && !defined(_CL_HAVE_WINDOWS_H)
+    int32_t fhandle = _cl_open( directory.c_str(), O_RDONLY, _S_IREAD );
+    if ( fhandle >= 0 ){
+      _fsync(fhandle);
+      ::_close(fhandle);
+    }
+#endif
   }
 
   string FSDirectory::toString() const{
 	  return string("FSDirectory@") + this->directory;
   }
 
+  string FSDirectory::getLockID(){
+	  char* prefix = getLockPrefix();
+	  string ret(prefix);
+	  _CLDELETE_LCaARRAY(prefix);
+	  return ret;
+  }
+
 CL_NS_END
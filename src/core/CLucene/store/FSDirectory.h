@@ -12,6 +12,7 @@
 #include "IndexOutput.h"
 #include <string>
 #include <vector>
+#include <set>
 
 CL_CLASS_DEF(util,StringBuffer)
 
@@ -47,6 +48,11 @@ CL_CLASS_DEF(util,StringBuffer)
 		static bool disableLocks;
 
     bool useMMap;
+    int32_t writeBufferSize;
+
+    std::set<std::string> staleFiles; // files written and not synced since
+    DEFINE_MUTEX(staleFiles_LOCK)
+    void syncDirectory();
 
 	protected:
 		/// Removes an existing file in the directory.
@@ -114,12 +120,33 @@ CL_CLASS_DEF(util,StringBuffer)
 		/// Creates a new, empty file in the directory with the given name.
 		///	Returns a stream writing this file.
     virtual IndexOutput* createOutput(const char* name);
+
+    /// The number of files {@link #sync} fsyncs at the same time
+    LUCENE_STATIC_CONSTANT(int32_t, SYNC_THREADS=4);
+
+    /**
+    * Fsyncs those of the named files that were written through this directory
+    * since they were last synced, several at a time, and then the directory
+    * itself, so that new file names survive a crash too. Files which were
+    * already synced cost nothing.
+    */
+    virtual void sync(const std::vector<std::string>& names);
   
     ///Decrease the ref-count to the directory by one. If
     ///the object is no longer needed, then the object is
     ///removed from the directory pool.
     void close();
 
+    /// The default size of the buffer of new outputs
+    LUCENE_STATIC_CONSTANT(int32_t, DEFAULT_WRITE_BUFFER_SIZE=65536);
+
+    /**
+    * Sets the size of the buffer of outputs created from now on. Larger buffers
+    * mean fewer system calls when writing large files, such as merged segments.
+    */
+    void setWriteBufferSize(int32_t bufferSize);
+    int32_t getWriteBufferSize() const;
+
 	  /**
     * If MMap is available, this can disable use of
 	  * mmap reading.
@@ -132,6 +159,10 @@ CL_CLASS_DEF(util,StringBuffer)
 
 	  std::string toString() const;
 
+	  /** Returns "lucene-" and a hash of the path, so that lock factories
+	  * given to {@link #getDirectory} can prefix lock file names with it */
+	  std::string getLockID();
+
 		static const char* getClassName();
 		const char* getObjectName() const;
 
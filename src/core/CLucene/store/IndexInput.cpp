@@ -119,6 +119,10 @@ CL_NS_USE(util)
     readBytes(b, len);
   }
 
+  IndexInput* IndexInput::slice(const int64_t /*offset*/, const int64_t /*length*/) const {
+    return NULL;
+  }
+
   void IndexInput::readChars( TCHAR* buffer, const int32_t start, const int32_t len) {
     const int32_t end = start + len;
     TCHAR b;
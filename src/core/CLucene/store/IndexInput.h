@@ -125,6 +125,14 @@ CL_NS_DEF(store)
 		/** The number of bytes in the file. */
 		virtual int64_t length() const = 0;
 
+		/** Returns an input that reads <code>length</code> bytes of this file,
+		* starting at <code>offset</code>, as a file of its own. The slice reads the
+		* same data as this input without going through it, so it needs no locking
+		* against this input, but it must be deleted before this input is closed.
+		* @return the slice, or NULL if this kind of input can not be sliced
+		*/
+		virtual IndexInput* slice(const int64_t offset, const int64_t length) const;
+
 		virtual const char* getDirectoryType() const = 0;
 		virtual const char* getObjectName() const = 0;
 	};
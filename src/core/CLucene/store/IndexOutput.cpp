@@ -22,9 +22,10 @@ CL_NS_DEF(store)
 	  _CLDELETE_LARRAY(copyBuffer);
   }
 
-  BufferedIndexOutput::BufferedIndexOutput()
+  BufferedIndexOutput::BufferedIndexOutput(const int32_t bufferSize):
+    bufferSize(bufferSize)
   {
-    buffer = _CL_NEWARRAY(uint8_t, BUFFER_SIZE );
+    buffer = _CL_NEWARRAY(uint8_t, bufferSize );
     bufferStart = 0;
     bufferPosition = 0;
   }
@@ -44,7 +45,7 @@ CL_NS_DEF(store)
 
   void BufferedIndexOutput::writeByte(const uint8_t b) {
   	CND_PRECONDITION(buffer!=NULL,"IndexOutput is closed")
-    if (bufferPosition >= BUFFER_SIZE)
+    if (bufferPosition >= bufferSize)
       flush();
     buffer[bufferPosition++] = b;
   }
@@ -52,24 +53,22 @@ CL_NS_DEF(store)
   void BufferedIndexOutput::writeBytes(const uint8_t* b, const int32_t length) {
 	  if ( length < 0 )
 		  _CLTHROWA(CL_ERR_IllegalArgument, "IO Argument Error. Value must be a positive value.");
-	  int32_t bytesLeft = BUFFER_SIZE - bufferPosition;
+	  int32_t bytesLeft = bufferSize - bufferPosition;
 	  // is there enough space in the buffer?
 	  if (bytesLeft >= length) {
 		  // we add the data to the end of the buffer
 		  memcpy(buffer + bufferPosition, b, length);
 		  bufferPosition += length;
 		  // if the buffer is full, flush it
-		  if (BUFFER_SIZE - bufferPosition == 0)
+		  if (bufferSize - bufferPosition == 0)
 			  flush();
 	  } else {
 		  // is data larger then buffer?
-		  if (length > BUFFER_SIZE) {
-			  // we flush the buffer
-			  if (bufferPosition > 0)
-				  flush();
-			  // and write data at once
-			  flushBuffer(b, length);
-			  bufferStart += length;
+		  if (length > bufferSize) {
+			  // we write the buffer and the data at once
+			  flushBuffers(buffer, bufferPosition, b, length);
+			  bufferStart += bufferPosition + length;
+			  bufferPosition = 0;
 		  } else {
 			  // we fill/flush the buffer (until the input is written)
 			  int64_t pos = 0; // position in the input data
@@ -83,10 +82,10 @@ CL_NS_DEF(store)
 				  pos += pieceLength;
 				  bufferPosition += pieceLength;
 				  // if the buffer is full, flush it
-				  bytesLeft = BUFFER_SIZE - bufferPosition;
+				  bytesLeft = bufferSize - bufferPosition;
 				  if (bytesLeft == 0) {
 					  flush();
-					  bytesLeft = BUFFER_SIZE;
+					  bytesLeft = bufferSize;
 				  }
 			  }
 		  }
@@ -163,6 +162,16 @@ CL_NS_DEF(store)
   }
 
 
+  int32_t BufferedIndexOutput::getBufferSize() const{
+    return bufferSize;
+  }
+
+  void BufferedIndexOutput::flushBuffers(const uint8_t* b1, const int32_t len1, const uint8_t* b2, const int32_t len2) {
+    if (len1 > 0)
+      flushBuffer(b1, len1);
+    flushBuffer(b2, len2);
+  }
+
   int64_t BufferedIndexOutput::getFilePointer() const{
     return bufferStart + bufferPosition;
   }
@@ -104,8 +104,9 @@ private:
 	uint8_t* copyBuffer;
 
 public:
-	/** Copy numBytes bytes from input to ourself. */
-	void copyBytes(CL_NS(store)::IndexInput* input, int64_t numBytes);
+	/** Copy numBytes bytes from input to ourself. Outputs may override this
+	* to copy without going through memory, when they know the input. */
+	virtual void copyBytes(CL_NS(store)::IndexInput* input, int64_t numBytes);
 };
 
 /** Base implementation class for buffered {@link IndexOutput}. */
@@ -114,13 +115,17 @@ public:
 	LUCENE_STATIC_CONSTANT(int32_t, BUFFER_SIZE=16384);
 private:
 	uint8_t* buffer;
+	int32_t bufferSize;
 	int64_t bufferStart;			  // position in file of buffer
 	int32_t bufferPosition;		  // position in buffer
 
 public:
-	BufferedIndexOutput();
+	BufferedIndexOutput(const int32_t bufferSize = BUFFER_SIZE);
 	virtual ~BufferedIndexOutput();
 
+	/** Returns the size of the buffer */
+	int32_t getBufferSize() const;
+
 	/** Writes a single byte.
 	* @see IndexInput#readByte()
 	*/
@@ -160,6 +165,11 @@ protected:
 	* @param len the number of bytes to write
 	*/
 	virtual void flushBuffer(const uint8_t* b, const int32_t len) = 0;
+
+	/** Expert: writes two arrays one after the other at the current position,
+	* the buffer and bytes too large for it. Outputs which can write both with
+	* one call should override this. */
+	virtual void flushBuffers(const uint8_t* b1, const int32_t len1, const uint8_t* b2, const int32_t len2);
 };
 
 CL_NS_END
@@ -21,7 +21,11 @@
 #ifdef _CL_HAVE_DIRECT_H
 	#include <direct.h>
 #endif
+#ifdef _CL_HAVE_SYS_FILE_H
+	#include <sys/file.h>
+#endif
 #include <fcntl.h>
+#include <errno.h>
 
 
 CL_NS_USE(util)
@@ -171,4 +175,124 @@ CL_NS_DEF(store)
     return string("SimpleFSLock@") + lockFile;
    }
 
+
+#ifdef _CL_HAVE_FUNCTION_FLOCK
+   NativeFSLock::NativeFSLock( const char* _lockDir, const char* name, int filemode ):
+     fhandle(-1)
+   {
+      if ( filemode <= 0 )
+        this->filemode = 0644;
+      else
+        this->filemode = filemode;
+
+      this->lockFile = _CL_NEWARRAY(char,CL_MAX_PATH);
+      this->lockDir = STRDUP_AtoA(_lockDir);
+      strcpy(lockFile,_lockDir);
+      strcat(lockFile,PATH_DELIMITERA);
+      strcat(lockFile,name);
+   }
+
+   NativeFSLock::~NativeFSLock()
+   {
+      // the lock goes with its file handle
+      release();
+      _CLDELETE_ARRAY( lockFile );
+      _CLDELETE_LCaARRAY( lockDir );
+   }
+
+  const char* NativeFSLock::getClassName(){
+    return "NativeFSLock";
+  }
+  const char* NativeFSLock::getObjectName() const{
+    return getClassName();
+  }
+
+   bool NativeFSLock::lock(bool wait)
+   {
+      if ( fhandle >= 0 )
+        return false; //already held by this lock
+
+      if ( !Misc::dir_Exists(lockDir) ){
+        if ( _mkdir(lockDir) == -1 && !Misc::dir_Exists(lockDir) ){
+          char* err = _CL_NEWARRAY(char,34+strlen(lockDir)+1); //34: len of "Couldn't create lock directory: "
+          strcpy(err,"Couldn't create lock directory: ");
+          strcat(err,lockDir);
+          _CLTHROWA_DEL(CL_ERR_IO, err );
+        }
+      }
+      int32_t r = _cl_open(lockFile, O_RDWR | O_CREAT | _O_RANDOM, this->filemode);
+      if ( r < 0 )
+        _CLTHROWA(CL_ERR_IO, "Couldn't open lock file");
+
+      // the lock belongs to this file handle, so two locks in one process exclude each other too
+      int ret;
+      do{
+        ret = ::flock(r, wait ? LOCK_EX : LOCK_EX | LOCK_NB);
+      }while ( ret == -1 && errno == EINTR );
+      if ( ret == -1 ){
+        const int err = errno;
+        _close(r);
+        if ( err == EWOULDBLOCK )
+          return false;
+        _CLTHROWA(CL_ERR_IO, "Couldn't lock the lock file");
+      }
+      fhandle = r;
+      return true;
+   }
+
+   bool NativeFSLock::obtain()
+   {
+      return lock(false);
+   }
+
+   bool NativeFSLock::obtain(int64_t lockWaitTimeout)
+   {
+      if ( lockWaitTimeout == LOCK_OBTAIN_WAIT_FOREVER )
+        return lock(true);
+      if ( lockWaitTimeout < 0 )
+        _CLTHROWA(CL_ERR_IllegalArgument,"lockWaitTimeout should be LOCK_OBTAIN_WAIT_FOREVER or a non-negative number");
+
+      // the system can't wait for a limited time, so check often at first, and less often later
+      const int64_t end = Misc::currentTimeMillis() + lockWaitTimeout;
+      int64_t interval = 1;
+      while ( !lock(false) ){
+        const int64_t now = Misc::currentTimeMillis();
+        if ( now >= end )
+          _CLTHROWA(CL_ERR_IO,"Lock obtain timed out");
+        _LUCENE_SLEEP((int)cl_min(interval, end - now));
+        interval = cl_min(interval * 2, LOCK_POLL_INTERVAL);
+      }
+      return true;
+   }
+
+   void NativeFSLock::release()
+   {
+      if ( fhandle < 0 )
+        return;
+      ::flock(fhandle, LOCK_UN);
+      _close(fhandle);
+      fhandle = -1;
+   }
+
+   bool NativeFSLock::isLocked()
+   {
+      if ( fhandle >= 0 )
+        return true;
+
+      int32_t r = _cl_open(lockFile, O_RDWR | _O_RANDOM, this->filemode);
+      if ( r < 0 )
+        return false; //no lock file, nobody has locked it
+      const bool locked = ::flock(r, LOCK_EX | LOCK_NB) == -1;
+      if ( !locked )
+        ::flock(r, LOCK_UN);
+      _close(r);
+      return locked;
+   }
+
+   string NativeFSLock::toString()
+   {
+    return string("NativeFSLock@") + lockFile;
+   }
+#endif
+
 CL_NS_END
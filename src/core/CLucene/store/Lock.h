@@ -25,13 +25,13 @@ CL_NS_DEF(store)
       virtual bool obtain() = 0;
 
       /** Attempts to obtain an exclusive lock within amount
-      *  of time given. Currently polls once per second until
+      *  of time given. By default polls once per second until
       *  lockWaitTimeout is passed.
       * @param lockWaitTimeout length of time to wait in ms
       * @return true if lock was obtained
       * @throws IOException if lock wait times out or obtain() throws an IOException
       */
-      bool obtain(int64_t lockWaitTimeout);
+      virtual bool obtain(int64_t lockWaitTimeout);
 
       // Release exclusive access.
       virtual void release() = 0;
@@ -42,6 +42,11 @@ const char* LockFactory::getLockPrefix()
 	return lockPrefix.c_str();
 }
 
+bool LockFactory::setDefaultLockDir( const char* /*lockDir*/ )
+{
+	return false;
+}
+
 SingleInstanceLockFactory::SingleInstanceLockFactory()
 {
 	locks = _CLNEW LocksType();
@@ -115,7 +120,18 @@ FSLockFactory::~FSLockFactory()
 
 void FSLockFactory::setLockDir( const char* lockDir )
 {
-	this->lockDir = lockDir;
+	if ( lockDir != NULL )
+		this->lockDir = lockDir;
+	else
+		this->lockDir.clear();
+}
+
+bool FSLockFactory::setDefaultLockDir( const char* lockDir )
+{
+	if ( !this->lockDir.empty() )
+		return false;
+	setLockDir( lockDir );
+	return true;
 }
 
 LuceneLock* FSLockFactory::makeLock( const char* lockName )
@@ -156,4 +172,53 @@ void FSLockFactory::clearLock( const char* lockName )
 }
 
 
+NativeFSLockFactory::NativeFSLockFactory( const char* lockDir, int filemode ):
+  FSLockFactory( lockDir, filemode )
+{
+}
+
+NativeFSLockFactory::~NativeFSLockFactory()
+{
+}
+
+LuceneLock* NativeFSLockFactory::makeLock( const char* lockName )
+{
+#ifdef _CL_HAVE_FUNCTION_FLOCK
+	char name[CL_MAX_DIR];
+
+	if ( !lockPrefix.empty() ) {
+		cl_sprintf(name, CL_MAX_DIR, "%s-%s", lockPrefix.c_str(), lockName);
+	} else {
+		cl_strcpy(name,lockName,CL_MAX_DIR);
+	}
+
+	return _CLNEW NativeFSLock( lockDir.c_str(), name, this->filemode );
+#else
+	return FSLockFactory::makeLock( lockName );
+#endif
+}
+
+#ifdef _CL_HAVE_FUNCTION_FLOCK
+void NativeFSLockFactory::clearLock( const char* /*lockName*/ )
+{
+	// removing the file would let a new holder lock a new file while
+	// waiters still wait on the old one
+}
+#else
+void NativeFSLockFactory::clearLock( const char* lockName )
+{
+	FSLockFactory::clearLock( lockName );
+}
+#endif
+
+const char* NativeFSLockFactory::getClassName()
+{
+	return "NativeFSLockFactory";
+}
+const char* NativeFSLockFactory::getObjectName()
+{
+	return getClassName();
+}
+
+
 CL_NS_END
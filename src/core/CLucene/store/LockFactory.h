@@ -28,6 +28,12 @@ public:
 	
 	virtual LuceneLock* makeLock( const char* lockName )=0;
 	virtual void clearLock( const char* lockName )=0;
+
+	/** Expert: called by an FSDirectory which is given this factory, with its path.
+	 * A factory that keeps its lock files in a directory and was not given one
+	 * takes the path. Does nothing by default.
+	 * @return true if the factory now keeps its lock files in the index directory */
+	virtual bool setDefaultLockDir( const char* lockDir );
 };
 
 class CLUCENE_EXPORT SingleInstanceLockFactory: public LockFactory {
@@ -56,7 +62,7 @@ public:
 };
 
 class CLUCENE_EXPORT FSLockFactory: public LockFactory {
-private:
+protected:
   std::string lockDir;
 	int filemode;
 public:
@@ -65,6 +71,8 @@ public:
 	~FSLockFactory();
 		
 	void setLockDir( const char* lockDir );
+	/** Sets the lock directory if none was given */
+	bool setDefaultLockDir( const char* lockDir );
 	
 	LuceneLock* makeLock( const char* lockName );
 	void clearLock( const char* lockName );
@@ -73,5 +81,31 @@ public:
   const char* getObjectName();
 };
 
+/**
+ * Makes locks that are held with the operating system's advisory file
+ * locks (flock). Unlike the locks of {@link FSLockFactory}, they are
+ * released when the process holding them dies, and a writer waiting with
+ * LuceneLock::LOCK_OBTAIN_WAIT_FOREVER is woken as soon as the lock is
+ * released (see IndexWriter::setWriteLockTimeout).
+ *
+ * The lock files are left in place, which is harmless. Where flock is not
+ * available, this makes the same locks as FSLockFactory.
+ */
+class CLUCENE_EXPORT NativeFSLockFactory: public FSLockFactory {
+public:
+  /** Constructs a native FS Lock factory. The default file mode is user writable.
+   * Without a lockDir, an FSDirectory given this factory keeps its locks in the
+   * index directory */
+	NativeFSLockFactory( const char* lockDir=NULL, int filemode=-1 );
+	~NativeFSLockFactory();
+
+	LuceneLock* makeLock( const char* lockName );
+	/** Does nothing, a lock that is not held is not locked whatever files there are */
+	void clearLock( const char* lockName );
+
+  static const char* getClassName();
+  const char* getObjectName();
+};
+
 CL_NS_END
 #endif
@@ -247,6 +247,18 @@ CL_NS_USE(util)
   }
   int64_t MMapIndexInput::length() const{ return _internal->_length; }
 
+  IndexInput* MMapIndexInput::slice(const int64_t offset, const int64_t length) const{
+	  if ( offset < 0 || length < 0 || offset + length > _internal->_length )
+		  _CLTHROWA(CL_ERR_IO, "slice is outside of the file");
+
+	  // a clone that starts later and ends sooner, reading the same mapping
+	  MMapIndexInput* ret = _CLNEW MMapIndexInput(*this);
+	  ret->_internal->data += offset;
+	  ret->_internal->_length = length;
+	  ret->_internal->pos = 0;
+	  return ret;
+  }
+
   MMapIndexInput::~MMapIndexInput(){
   //Func - Destructor
   //Pre  - True
@@ -11,6 +11,7 @@
 #include "LockFactory.h"
 #include "Directory.h"
 #include "FSDirectory.h"
+#include "RAMDirectoryLoader.h"
 #include "CLucene/index/IndexReader.h"
 //#include "CLucene/util/VoidMap.h"
 #include "CLucene/util/Misc.h"
@@ -45,6 +46,7 @@ CL_NS_DEF(store)
 	   lastModified = Misc::currentTimeMillis();
 	   this->directory = _directory;
 	   sizeInBytes = 0;
+	   bufferSize = _directory == NULL ? RAMOutputStream::BUFFER_SIZE : _directory->getBufferSize();
   }
 
   RAMFile::~RAMFile(){
@@ -90,6 +92,24 @@ CL_NS_DEF(store)
 	  return buffer;
   }
 
+  uint8_t* RAMFile::growBuffer( const int32_t index, const int32_t size )
+  {
+	  SCOPED_LOCK_MUTEX(THIS_LOCK);
+	  RAMFileBuffer* rfb = buffers[index];
+	  uint8_t* buffer = newBuffer(size);
+	  memcpy(buffer, rfb->_buffer, rfb->_len);
+	  _CLDELETE_LARRAY(rfb->_buffer);
+	  rfb->_buffer = buffer;
+	  const int32_t added = size - (int32_t)rfb->_len;
+	  rfb->_len = size;
+	  if ( directory != NULL ) {
+		  SCOPED_LOCK_MUTEX(directory->THIS_LOCK);
+		  directory->sizeInBytes += added;
+		  sizeInBytes += added;
+	  }
+	  return buffer;
+  }
+
   uint8_t* RAMFile::getBuffer( const int32_t index )
   {
 	  SCOPED_LOCK_MUTEX(THIS_LOCK);
@@ -130,7 +150,8 @@ CL_NS_DEF(store)
 	  currentBufferIndex(-1),
 	  bufferPosition(0),
 	  bufferStart(0),
-	  bufferLength(0)
+	  bufferLength(0),
+	  bufferSize(f->getBufferSize())
   {
   }
 
@@ -141,7 +162,8 @@ CL_NS_DEF(store)
     currentBufferIndex(-1),
     bufferPosition(0),
     bufferStart(0),
-    bufferLength(0)
+    bufferLength(0),
+    bufferSize(BUFFER_SIZE)
   {
   }
 
@@ -151,7 +173,7 @@ CL_NS_DEF(store)
     int64_t pos = 0;
     int32_t p = 0;
     while (pos < end) {
-      int32_t length = BUFFER_SIZE;
+      int32_t length = bufferSize;
       int64_t nextPos = pos + length;
       if (nextPos > end) {                        // at the last buffer
         length = (int32_t)(end - pos);
@@ -176,11 +198,13 @@ CL_NS_DEF(store)
           // and flush() has not been called yet
 	  setFileLength();
 	  if ( pos < bufferStart || pos >= bufferStart + bufferLength ) {
-		  currentBufferIndex = (int32_t)(pos / BUFFER_SIZE);
+		  currentBufferIndex = (int32_t)(pos / bufferSize);
 		  switchCurrentBuffer();
 	  }
 
-	  bufferPosition = (int32_t)( pos % BUFFER_SIZE );
+	  bufferPosition = (int32_t)( pos % bufferSize );
+	  while ( bufferPosition > bufferLength ) // past the end of a first buffer that is still growing
+		  nextBuffer();
   }
 
   int64_t RAMOutputStream::length() const {
@@ -188,10 +212,8 @@ CL_NS_DEF(store)
   }
 
   void RAMOutputStream::writeByte( const uint8_t b ) {
-	  if ( bufferPosition == bufferLength ) {
-		  currentBufferIndex++;
-		  switchCurrentBuffer();
-	  }
+	  if ( bufferPosition == bufferLength )
+		  nextBuffer();
 	  currentBuffer[bufferPosition++] = b;
   }
 
@@ -199,10 +221,8 @@ CL_NS_DEF(store)
 	  int32_t srcOffset = 0;
 
 	  while ( srcOffset != len ) {
-		  if ( bufferPosition == bufferLength ) {
-			  currentBufferIndex++;
-			  switchCurrentBuffer();
-		  }
+		  if ( bufferPosition == bufferLength )
+			  nextBuffer();
 
 		  int32_t remainInSrcBuffer = len - srcOffset;
 		  int32_t bytesInBuffer = bufferLength - bufferPosition;
@@ -215,11 +235,25 @@ CL_NS_DEF(store)
 	  }
   }
 
+  void RAMOutputStream::nextBuffer() {
+	  if ( currentBufferIndex >= 0 && bufferLength < bufferSize ) {
+		  // only the first buffer can be short: grow it rather than start the next
+		  const int32_t size = bufferLength > bufferSize / 2 ? bufferSize : bufferLength * 2;
+		  currentBuffer = file->growBuffer( currentBufferIndex, size );
+		  bufferLength = size;
+	  } else {
+		  currentBufferIndex++;
+		  switchCurrentBuffer();
+	  }
+  }
+
   void RAMOutputStream::switchCurrentBuffer() {
 
 	  if ( currentBufferIndex == file->numBuffers() ) {
-		  currentBuffer = file->addBuffer( BUFFER_SIZE );
-		  bufferLength = BUFFER_SIZE;
+		  // the first buffer starts small, so that small files don't take a large buffer each
+		  const int32_t size = currentBufferIndex == 0 && bufferSize > BUFFER_SIZE ? BUFFER_SIZE : bufferSize;
+		  currentBuffer = file->addBuffer( size );
+		  bufferLength = size;
 	  } else {
 		  currentBuffer = file->getBuffer( currentBufferIndex );
 		  bufferLength = file->getBufferLen(currentBufferIndex);
@@ -227,7 +261,7 @@ CL_NS_DEF(store)
     assert(bufferLength >=0);//
 
 	  bufferPosition = 0;
-	  bufferStart = (int64_t)BUFFER_SIZE * (int64_t)currentBufferIndex;
+	  bufferStart = (int64_t)bufferSize * (int64_t)currentBufferIndex;
   }
 
 
@@ -255,11 +289,12 @@ CL_NS_DEF(store)
   	currentBufferIndex(-1),
   	bufferPosition(0),
   	bufferStart(0),
-  	bufferLength(0)
+  	bufferLength(0),
+  	bufferSize(f->getBufferSize())
   {
     _length = f->getLength();
 
-    if ( _length/BUFFER_SIZE >= 0x7FFFFFFFL ) {
+    if ( _length/bufferSize >= 0x7FFFFFFFL ) {
     	// TODO: throw exception
     }
   }
@@ -274,6 +309,7 @@ CL_NS_DEF(store)
     bufferPosition = other.bufferPosition;
     bufferStart = other.bufferStart;
     bufferLength = other.bufferLength;
+    bufferSize = other.bufferSize;
   }
 
   RAMInputStream::~RAMInputStream(){
@@ -326,16 +362,29 @@ CL_NS_DEF(store)
 
   }
 
+  int32_t RAMInputStream::readVInt() {
+	  if ( bufferLength - bufferPosition < 5 )
+		  return IndexInput::readVInt();
+
+	  uint8_t b = currentBuffer[bufferPosition++];
+	  int32_t i = b & 0x7F;
+	  for (int32_t shift = 7; (b & 0x80) != 0; shift += 7) {
+		  b = currentBuffer[bufferPosition++];
+		  i |= (b & 0x7F) << shift;
+	  }
+	  return i;
+  }
+
   int64_t RAMInputStream::getFilePointer() const {
 	  return currentBufferIndex < 0 ? 0 : bufferStart + bufferPosition;
   }
 
   void RAMInputStream::seek( const int64_t pos ) {
-	  if ( currentBuffer == NULL || pos < bufferStart || pos >= bufferStart + BUFFER_SIZE ) {
-		  currentBufferIndex = (int32_t)( pos / BUFFER_SIZE );
+	  if ( currentBuffer == NULL || pos < bufferStart || pos >= bufferStart + bufferSize ) {
+		  currentBufferIndex = (int32_t)( pos / bufferSize );
 		  switchCurrentBuffer();
 	  }
-	  bufferPosition = (int32_t)(pos % BUFFER_SIZE);
+	  bufferPosition = (int32_t)(pos % bufferSize);
   }
 
   void RAMInputStream::close() {
@@ -348,9 +397,9 @@ CL_NS_DEF(store)
 	  } else {
 		  currentBuffer = file->getBuffer( currentBufferIndex );
 		  bufferPosition = 0;
-		  bufferStart = (int64_t)BUFFER_SIZE * (int64_t)currentBufferIndex;
+		  bufferStart = (int64_t)bufferSize * (int64_t)currentBufferIndex;
 		  int64_t bufLen = _length - bufferStart;
-		  bufferLength = bufLen > BUFFER_SIZE ? BUFFER_SIZE : static_cast<int32_t>(bufLen);
+		  bufferLength = bufLen > bufferSize ? bufferSize : static_cast<int32_t>(bufLen);
 	  }
     assert (bufferLength >=0);
   }
@@ -370,7 +419,7 @@ CL_NS_DEF(store)
   }
 
   RAMDirectory::RAMDirectory():
-   Directory(),files(_CLNEW FileMap(true,true))
+   Directory(),files(_CLNEW FileMap(true,true)),bufferSize(DEFAULT_BUFFER_SIZE)
   {
     this->sizeInBytes = 0;
 	  setLockFactory( _CLNEW SingleInstanceLockFactory() );
@@ -384,47 +433,26 @@ CL_NS_DEF(store)
 
   void RAMDirectory::_copyFromDir(Directory* dir, bool closeDir)
   {
-  	vector<string> names;
-    dir->list(&names);
-    uint8_t buf[CL_NS(store)::BufferedIndexOutput::BUFFER_SIZE];
-
-    for (size_t i=0;i<names.size();++i ){
-      // make place on ram disk
-      IndexOutput* os = createOutput(names[i].c_str());
-      // read current file
-      IndexInput* is = dir->openInput(names[i].c_str());
-      // and copy to ram disk
-      //todo: this could be a problem when copying from big indexes...
-      int64_t len = is->length();
-      int64_t readCount = 0;
-      while (readCount < len) {
-          int32_t toRead = (int32_t)(readCount + CL_NS(store)::BufferedIndexOutput::BUFFER_SIZE > len ? len - readCount : CL_NS(store)::BufferedIndexOutput::BUFFER_SIZE);
-          is->readBytes(buf, toRead);
-          os->writeBytes(buf, toRead);
-          readCount += toRead;
-      }
-
-      // graceful cleanup
-      is->close();
-      _CLDELETE(is);
-      os->close();
-      _CLDELETE(os);
-    }
+    // read each file straight into the buffers of its RAMFile
+    RAMDirectoryLoader loader(dir, this, 1);
+    loader.load();
     if (closeDir)
        dir->close();
   }
-  RAMDirectory::RAMDirectory(Directory* dir):
-   Directory(),files( _CLNEW FileMap(true,true) )
+  RAMDirectory::RAMDirectory(Directory* dir, int32_t bufferSize):
+   Directory(),files( _CLNEW FileMap(true,true) ),bufferSize(DEFAULT_BUFFER_SIZE)
   {
     this->sizeInBytes = 0;
+    setBufferSize(bufferSize);
 	setLockFactory( _CLNEW SingleInstanceLockFactory() );
     _copyFromDir(dir,false);
   }
 
-   RAMDirectory::RAMDirectory(const char* dir):
-      Directory(),files( _CLNEW FileMap(true,true) )
+   RAMDirectory::RAMDirectory(const char* dir, int32_t bufferSize):
+      Directory(),files( _CLNEW FileMap(true,true) ),bufferSize(DEFAULT_BUFFER_SIZE)
    {
       this->sizeInBytes = 0;
+      setBufferSize(bufferSize);
       setLockFactory( _CLNEW SingleInstanceLockFactory() );
       Directory* fsdir = FSDirectory::getDirectory(dir);
       try{
@@ -435,6 +463,16 @@ CL_NS_DEF(store)
       );
    }
 
+  void RAMDirectory::setBufferSize(int32_t bufferSize) {
+    if ( bufferSize <= 0 )
+      _CLTHROWA(CL_ERR_IllegalArgument, "bufferSize must be greater than 0");
+    this->bufferSize = bufferSize;
+  }
+
+  int32_t RAMDirectory::getBufferSize() const {
+    return bufferSize;
+  }
+
   bool RAMDirectory::fileExists(const char* name) const {
     SCOPED_LOCK_MUTEX(files_mutex);
     return files->exists((char*)name);
@@ -550,12 +588,39 @@ CL_NS_DEF(store)
 		n = STRDUP_AtoA(name);
 	}
 
-    RAMFile* file = _CLNEW RAMFile();
+    RAMFile* file = _CLNEW RAMFile(this);
     (*files)[n] = file;
 
     return _CLNEW RAMOutputStream(file);
   }
 
+  void RAMDirectory::putFile(const char* name, RAMFile* file) {
+    SCOPED_LOCK_MUTEX(files_mutex);
+
+    char* n = NULL;
+    FileMap::const_iterator itr = files->find(const_cast<char*>(name));
+    if ( itr!=files->end() )  {
+      n = itr->first;
+      RAMFile* rf = itr->second;
+      SCOPED_LOCK_MUTEX(this->THIS_LOCK);
+      sizeInBytes -= rf->sizeInBytes;
+      _CLDELETE(rf);
+    } else {
+      n = STRDUP_AtoA(name);
+    }
+
+    // the file keeps the buffer size it was loaded with, which the directory's may have changed from
+    file->directory = this;
+    file->sizeInBytes = 0;
+    for ( int32_t i=0;i<file->numBuffers();i++ )
+      file->sizeInBytes += file->getBufferLen(i);
+    {
+      SCOPED_LOCK_MUTEX(this->THIS_LOCK);
+      sizeInBytes += file->sizeInBytes;
+    }
+    (*files)[n] = file;
+  }
+
   std::string RAMDirectory::toString() const{
 	  return "RAMDirectory";
   }
@@ -19,6 +19,12 @@ CL_NS_DEF(store)
 	* implementation is by default the {@link SingleInstanceLockFactory}
 	* but can be changed with {@link #setLockFactory}.
 	*
+	* Files keep their data in a list of buffers of {@link #getBufferSize} bytes.
+	* The default of 1KB suits small indexes. A directory serving a large index
+	* from memory should use large buffers (e.g. {@link #LARGE_BUFFER_SIZE}), so that
+	* the data is held in few big allocations and readers rarely cross a buffer
+	* boundary. The first buffer of each file starts small and grows as the file is
+	* written, so small files don't take a whole buffer each.
 	*/
 	class CLUCENE_EXPORT RAMDirectory:public Directory{
 	protected:
@@ -39,9 +45,23 @@ CL_NS_DEF(store)
 		* @exception IOException if an error occurs
 		*/
 		void _copyFromDir(Directory* dir, bool closeDir);
+
+		/**
+		* Adds a complete file that is not in any directory yet, replacing
+		* any file of the same name. The directory takes ownership of the file,
+		* which keeps its own buffer size.
+		*/
+		void putFile(const char* name, RAMFile* file);
 		FileMap* files; // unlike the java Hashtable, FileMap is not synchronized, and all access must be protected by a lock
+		int32_t bufferSize;
 	public:
 		int64_t sizeInBytes; //todo
+		friend class RAMDirectoryLoader;
+
+		/** The default size of the buffers files are stored in */
+		LUCENE_STATIC_CONSTANT(int32_t, DEFAULT_BUFFER_SIZE=1024);
+		/** A buffer size suited to holding a large index in memory */
+		LUCENE_STATIC_CONSTANT(int32_t, LARGE_BUFFER_SIZE=1048576);
 
 	  DEFINE_MUTABLE_MUTEX(files_mutex) // mutable: const methods must also be able to synchronize properly
 
@@ -56,14 +76,31 @@ CL_NS_DEF(store)
 	  ///facilities of dir->close
 		virtual ~RAMDirectory();
 
-		RAMDirectory(Directory* dir);
+	  /**
+	   * Creates a new <code>RAMDirectory</code> instance from a different
+	   * <code>Directory</code> implementation.
+	   *
+	   * @param bufferSize the size of the buffers the files are stored in
+	   * @see #setBufferSize
+	   */
+		RAMDirectory(Directory* dir, int32_t bufferSize=DEFAULT_BUFFER_SIZE);
 
 	  /**
 	   * Creates a new <code>RAMDirectory</code> instance from the {@link FSDirectory}.
 	   *
 	   * @param dir a <code>String</code> specifying the full index directory path
+	   * @param bufferSize the size of the buffers the files are stored in
 	   */
-		RAMDirectory(const char* dir);
+		RAMDirectory(const char* dir, int32_t bufferSize=DEFAULT_BUFFER_SIZE);
+
+		/**
+		* Sets the size of the buffers that files created from now on store their
+		* data in. Existing files are not changed.
+		*/
+		void setBufferSize(int32_t bufferSize);
+
+		/** Returns the size of the buffers new files store their data in */
+		int32_t getBufferSize() const;
 
 		/// Returns true iff the named file exists in this directory.
 		bool fileExists(const char* name) const;
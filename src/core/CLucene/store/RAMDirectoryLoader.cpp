@@ -0,0 +1,342 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "RAMDirectoryLoader.h"
+#include "RAMDirectory.h"
+#include "_RAMDirectory.h"
+#include "Directory.h"
+#include "CLucene/index/_IndexFileNames.h"
+#include "CLucene/index/_SegmentInfos.h"
+#include "CLucene/index/_SegmentHeader.h"
+#include "CLucene/index/_MultiSegmentReader.h"
+#include <algorithm>
+#include <set>
+
+CL_NS_USE(index)
+CL_NS_DEF(store)
+
+/** What a loading thread runs */
+class RAMDirectoryLoaderTask{
+public:
+	virtual ~RAMDirectoryLoaderTask(){}
+	virtual void run() = 0;
+};
+
+_LUCENE_THREAD_FUNC(ramDirectoryLoaderThread, arg){
+	((RAMDirectoryLoaderTask*)arg)->run();
+	_LUCENE_THREAD_FUNC_RETURN(0);
+}
+
+struct RAMDirectoryLoader::Internal: LUCENE_BASE, public RAMDirectoryLoaderTask{
+	/** A segment and the files that belong to it */
+	struct Segment{
+		std::string name;
+		std::vector<std::string> files;
+		int64_t bytes;
+		int32_t remaining;
+	};
+	/** Orders segments by size, smallest first */
+	struct SegmentCompare{
+		bool operator()(const Segment* s1, const Segment* s2) const{
+			return s1->bytes < s2->bytes;
+		}
+	};
+
+	Directory* source;
+	RAMDirectory* target;
+	int32_t threadCount;
+	Listener* listener;
+
+	std::vector<Segment*> segments;
+	std::vector<std::string> commitFiles;
+	size_t nextSegment;
+	size_t nextFile;
+	std::set<std::string> loadedSegments;
+
+	int64_t bytesLoaded;
+	int64_t bytesTotal;
+	int32_t running;
+	bool started;
+	bool done;
+	bool failed;
+	CLuceneError error;
+	std::vector<_LUCENE_THREADID_TYPE> threads;
+	DEFINE_MUTABLE_MUTEX(THIS_LOCK)
+
+	Internal(Directory* source, RAMDirectory* target, int32_t threadCount):
+		source(source), target(target), threadCount(threadCount), listener(NULL),
+		nextSegment(0), nextFile(0), bytesLoaded(0), bytesTotal(0), running(0),
+		started(false), done(false), failed(false)
+	{
+	}
+	~Internal(){
+		for ( size_t i=0;i<segments.size();i++ )
+			delete segments[i];
+	}
+
+	/** Groups the files of the source by segment */
+	void plan(){
+		std::vector<std::string> names;
+		source->list(&names);
+
+		std::map<std::string, Segment*> bySegment;
+		for ( size_t i=0;i<names.size();i++ ){
+			const char* name = names[i].c_str();
+			const int64_t length = source->fileLength(name);
+			bytesTotal += length;
+
+			if ( strncmp(name, IndexFileNames::SEGMENTS, strlen(IndexFileNames::SEGMENTS)) == 0 ){
+				commitFiles.push_back(names[i]);
+				continue;
+			}
+			std::string segment = RAMDirectoryLoader::segmentOf(name);
+			Segment*& s = bySegment[segment];
+			if ( s == NULL ){
+				s = new Segment;
+				s->name = segment;
+				s->bytes = 0;
+				s->remaining = 0;
+				segments.push_back(s);
+			}
+			s->files.push_back(names[i]);
+			s->bytes += length;
+			s->remaining++;
+		}
+		std::stable_sort(segments.begin(), segments.end(), SegmentCompare());
+	}
+
+	/** Copies a file into a new RAMFile and adds it to the target */
+	void loadFile(const std::string& name){
+		IndexInput* in = NULL;
+		CLuceneError err;
+		if ( !source->openInput(name.c_str(), in, err, READ_BUFFER_SIZE) )
+			throw err;
+
+		// the file joins the target once it is complete, so readers never see part of it
+		RAMFile* file = _CLNEW RAMFile();
+		try{
+			const int64_t length = in->length();
+			const int32_t bufferSize = target->getBufferSize();
+			int64_t remaining = length;
+			while ( remaining > 0 ){
+				const int32_t size = remaining < bufferSize ? (int32_t)remaining : bufferSize;
+				in->readBytes(file->addBuffer(size), size);
+				remaining -= size;
+
+				SCOPED_LOCK_MUTEX(THIS_LOCK)
+				bytesLoaded += size;
+			}
+			file->setLength(length);
+			file->setBufferSize(bufferSize);
+		}catch(...){
+			in->close();
+			_CLDELETE(in);
+			_CLDELETE(file);
+			throw;
+		}
+		in->close();
+		_CLDELETE(in);
+		target->putFile(name.c_str(), file);
+	}
+
+	void fail(CLuceneError& err){
+		SCOPED_LOCK_MUTEX(THIS_LOCK)
+		if ( !failed ){
+			failed = true;
+			error.set(err.number(), err.twhat());
+		}
+	}
+
+	void notifyFile(const std::string& name){
+		if ( listener == NULL )
+			return;
+		int64_t loaded, total;
+		{
+			SCOPED_LOCK_MUTEX(THIS_LOCK)
+			loaded = bytesLoaded;
+			total = bytesTotal;
+		}
+		listener->fileLoaded(name.c_str(), loaded, total);
+	}
+
+	void run(){
+		for (;;){
+			Segment* segment = NULL;
+			std::string name;
+			{
+				SCOPED_LOCK_MUTEX(THIS_LOCK)
+				if ( failed )
+					break;
+				while ( nextSegment < segments.size() && nextFile >= segments[nextSegment]->files.size() ){
+					nextSegment++;
+					nextFile = 0;
+				}
+				if ( nextSegment >= segments.size() )
+					break;
+				segment = segments[nextSegment];
+				name = segment->files[nextFile++];
+			}
+
+			try{
+				loadFile(name);
+			}catch(CLuceneError& err){
+				fail(err);
+				break;
+			}
+			notifyFile(name);
+
+			bool segmentDone;
+			{
+				SCOPED_LOCK_MUTEX(THIS_LOCK)
+				segmentDone = --segment->remaining == 0;
+				if ( segmentDone )
+					loadedSegments.insert(segment->name);
+			}
+			if ( segmentDone && listener != NULL )
+				listener->segmentLoaded(segment->name.c_str());
+		}
+
+		// the last thread out adds the segments files, once everything else is there
+		bool last;
+		{
+			SCOPED_LOCK_MUTEX(THIS_LOCK)
+			last = --running == 0 && !failed;
+		}
+		if ( last ){
+			for ( size_t i=0;i<commitFiles.size();i++ ){
+				try{
+					loadFile(commitFiles[i]);
+				}catch(CLuceneError& err){
+					fail(err);
+					break;
+				}
+				notifyFile(commitFiles[i]);
+			}
+		}
+		SCOPED_LOCK_MUTEX(THIS_LOCK)
+		if ( running == 0 )
+			done = true;
+	}
+};
+
+RAMDirectoryLoader::Listener::~Listener(){
+}
+void RAMDirectoryLoader::Listener::fileLoaded(const char* /*name*/, int64_t /*bytesLoaded*/, int64_t /*bytesTotal*/){
+}
+void RAMDirectoryLoader::Listener::segmentLoaded(const char* /*segment*/){
+}
+
+RAMDirectoryLoader::RAMDirectoryLoader(Directory* source, RAMDirectory* target, int32_t threads):
+	_internal(NULL)
+{
+#ifdef _CL_DISABLE_MULTITHREADING
+	// threads run one after the other, so the first one loads everything
+	threads = 1;
+#endif
+	_internal = _CLNEW Internal(source, target, threads < 1 ? 1 : threads);
+}
+
+RAMDirectoryLoader::~RAMDirectoryLoader(){
+	try{
+		join();
+	}catch(CLuceneError&){
+		// the error was for join() to report
+	}
+	_CLDELETE(_internal);
+}
+
+void RAMDirectoryLoader::setListener(Listener* listener){
+	_internal->listener = listener;
+}
+
+void RAMDirectoryLoader::start(){
+	if ( _internal->started )
+		_CLTHROWA(CL_ERR_IllegalState, "loader was already started");
+	_internal->started = true;
+	_internal->plan();
+
+	_internal->running = _internal->threadCount;
+	RAMDirectoryLoaderTask* task = _internal;
+	for ( int32_t i=0;i<_internal->threadCount;i++ )
+		_internal->threads.push_back(_LUCENE_THREAD_CREATE(&ramDirectoryLoaderThread, task));
+}
+
+void RAMDirectoryLoader::join(){
+	for ( size_t i=0;i<_internal->threads.size();i++ )
+		_LUCENE_THREAD_JOIN(_internal->threads[i]);
+	_internal->threads.clear();
+
+	if ( _internal->failed )
+		throw CLuceneError(_internal->error);
+}
+
+void RAMDirectoryLoader::load(){
+	start();
+	join();
+}
+
+int64_t RAMDirectoryLoader::getBytesLoaded() const{
+	SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+	return _internal->bytesLoaded;
+}
+
+int64_t RAMDirectoryLoader::getBytesTotal() const{
+	SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+	return _internal->bytesTotal;
+}
+
+bool RAMDirectoryLoader::isSegmentLoaded(const char* segment) const{
+	SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+	return _internal->loadedSegments.find(segment) != _internal->loadedSegments.end();
+}
+
+IndexReader* RAMDirectoryLoader::openLoadedSegments() const{
+	SegmentInfos sourceInfos;
+	sourceInfos.read(_internal->source);
+
+	// the infos are copies which read from the target. They have no version,
+	// so the reader is never current and a reopen reads the copied commit
+	SegmentInfos* infos = _CLNEW SegmentInfos;
+	for ( int32_t i=0;i<sourceInfos.size();i++ ){
+		SegmentInfo* info = sourceInfos.info(i);
+		const std::vector<std::string>& files = info->files();
+		bool loaded = true;
+		for ( size_t j=0;j<files.size() && loaded;j++ )
+			loaded = _internal->target->fileExists(files[j].c_str());
+		if ( !loaded )
+			continue;
+		SegmentInfo* copy = info->clone();
+		copy->dir = _internal->target;
+		infos->add(copy);
+	}
+
+	if ( infos->size() == 0 ){
+		_CLDELETE(infos);
+		return NULL;
+	}
+	if ( infos->size() == 1 )
+		return SegmentReader::get(infos, infos->info(0), false);
+	return _CLNEW MultiSegmentReader(_internal->target, infos, false);
+}
+
+bool RAMDirectoryLoader::isDone() const{
+	SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+	return _internal->done;
+}
+
+std::string RAMDirectoryLoader::segmentOf(const char* fileName){
+	// _3.cfs, _3_1.del and _3_2.s0 all belong to _3
+	const char* end = strchr(fileName, '.');
+	if ( end == NULL )
+		end = fileName + strlen(fileName);
+	const char* gen = fileName[0] == '_' ? strchr(fileName + 1, '_') : NULL;
+	if ( gen != NULL && gen < end )
+		end = gen;
+	return std::string(fileName, end - fileName);
+}
+
+CL_NS_END
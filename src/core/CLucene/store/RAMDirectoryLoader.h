@@ -0,0 +1,117 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_store_RAMDirectoryLoader_
+#define _lucene_store_RAMDirectoryLoader_
+
+CL_CLASS_DEF(store,Directory)
+CL_CLASS_DEF(store,RAMDirectory)
+CL_CLASS_DEF(index,IndexReader)
+
+CL_NS_DEF(store)
+
+/**
+ * Loads the files of a directory, usually an {@link FSDirectory}, into a
+ * {@link RAMDirectory} using several threads. Each file is read sequentially
+ * through a large read buffer straight into the buffers of the RAM file, so
+ * set a large buffer size on the target first (see
+ * {@link RAMDirectory#LARGE_BUFFER_SIZE}).
+ *
+ * The files are loaded one segment after the other, smallest segments first,
+ * and a file only appears in the target once it is completely loaded. The
+ * segments files are loaded last, after everything else, so an IndexReader
+ * opened on the target sees a complete index. A {@link Listener} is told
+ * about the progress and about each segment that is completely loaded.
+ * Until then {@link #openLoadedSegments} opens a reader over the segments
+ * that are already in the target, so an application can start searching
+ * warm segments while the rest are still loading.
+ *
+ * <pre>
+ * RAMDirectory ram;
+ * ram.setBufferSize(RAMDirectory::LARGE_BUFFER_SIZE);
+ * RAMDirectoryLoader loader(fsdir, &ram, 8);
+ * loader.start();
+ * ...
+ * loader.join(); // throws if a file could not be loaded
+ * </pre>
+ */
+class CLUCENE_EXPORT RAMDirectoryLoader: LUCENE_BASE {
+public:
+	/** Receives the progress of a loader. Called from the loading threads. */
+	class CLUCENE_EXPORT Listener{
+	public:
+		virtual ~Listener();
+		/** Called after a file was loaded */
+		virtual void fileLoaded(const char* name, int64_t bytesLoaded, int64_t bytesTotal);
+		/** Called after all files of a segment were loaded */
+		virtual void segmentLoaded(const char* segment);
+	};
+
+	/** Default number of loading threads */
+	LUCENE_STATIC_CONSTANT(int32_t, DEFAULT_THREADS=4);
+	/** Size of the read buffer of the source files */
+	LUCENE_STATIC_CONSTANT(int32_t, READ_BUFFER_SIZE=1048576);
+
+	/**
+	* @param source the directory to copy. It must be safe to open inputs from
+	* several threads, which FSDirectory is.
+	* @param target the directory the files are added to
+	* @param threads the number of files loaded at the same time
+	*/
+	RAMDirectoryLoader(Directory* source, RAMDirectory* target, int32_t threads=DEFAULT_THREADS);
+
+	/** Waits for the loading threads, if any are still running */
+	~RAMDirectoryLoader();
+
+	/** Sets the listener, which is not deleted. Must be called before start() */
+	void setListener(Listener* listener);
+
+	/** Starts loading in the background */
+	void start();
+
+	/**
+	* Waits until all files are loaded.
+	* @throws CLuceneError the first error any of the files failed with
+	*/
+	void join();
+
+	/** Loads all files and returns when done. Same as start() then join() */
+	void load();
+
+	/** Returns the number of bytes copied so far */
+	int64_t getBytesLoaded() const;
+
+	/** Returns the total number of bytes to copy */
+	int64_t getBytesTotal() const;
+
+	/** Returns true once all files named after the segment are in the target.
+	* A segment may also need the shared doc store files of another segment;
+	* {@link #openLoadedSegments} waits for those too. */
+	bool isSegmentLoaded(const char* segment) const;
+
+	/**
+	* Opens a reader over the segments of the source's current commit whose
+	* files are all in the target, or returns NULL if there are none yet. The
+	* target has no segments file until loading is done, so the reader is
+	* read only: do not delete documents or set norms with it, and only
+	* reopen it once {@link #isDone} returns true, which then gives the
+	* complete index. The caller deletes the reader.
+	*/
+	CL_NS(index)::IndexReader* openLoadedSegments() const;
+
+	/** Returns true once all files are loaded, or loading failed */
+	bool isDone() const;
+
+	/** Returns the name of the segment a file belongs to, e.g. _3 for _3_1.del */
+	static std::string segmentOf(const char* fileName);
+
+private:
+	struct Internal;
+	Internal* _internal;
+};
+
+CL_NS_END
+#endif
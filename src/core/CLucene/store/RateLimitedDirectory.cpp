@@ -0,0 +1,128 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "RateLimitedDirectory.h"
+#include "RateLimiter.h"
+#include "IndexInput.h"
+#include "IndexOutput.h"
+
+CL_NS_DEF(store)
+
+/** Pauses each time it passes a buffer on to the output it wraps */
+class RateLimitedIndexOutput: public BufferedIndexOutput {
+	IndexOutput* delegate;
+	RateLimiter* limiter;
+protected:
+	void flushBuffer(const uint8_t* b, const int32_t len){
+		if ( len <= 0 )
+			return;
+		limiter->pause(len);
+		delegate->writeBytes(b, len);
+	}
+public:
+	RateLimitedIndexOutput(IndexOutput* delegate, RateLimiter* limiter):
+		delegate(delegate), limiter(limiter)
+	{
+	}
+	~RateLimitedIndexOutput(){
+		if ( delegate != NULL ){
+			try{
+				close();
+			}catch(CLuceneError& err){
+				//ignore IO errors...
+				if ( err.number() != CL_ERR_IO )
+					throw;
+			}
+		}
+	}
+	void close(){
+		try{
+			BufferedIndexOutput::close();
+		}_CLFINALLY(
+			delegate->close();
+			_CLDELETE(delegate);
+		)
+	}
+	void seek(const int64_t pos){
+		BufferedIndexOutput::seek(pos);
+		delegate->seek(pos);
+	}
+	int64_t length() const{
+		return delegate->length();
+	}
+};
+
+RateLimitedDirectory::RateLimitedDirectory(Directory* dir, RateLimiter* limiter):
+	dir(dir), limiter(limiter)
+{
+}
+RateLimitedDirectory::~RateLimitedDirectory(){
+}
+
+Directory* RateLimitedDirectory::getDirectory() const{
+	return dir;
+}
+RateLimiter* RateLimitedDirectory::getRateLimiter() const{
+	return limiter;
+}
+
+bool RateLimitedDirectory::doDeleteFile(const char* name){
+	return dir->deleteFile(name, false);
+}
+bool RateLimitedDirectory::list(std::vector<std::string>* names) const{
+	return dir->list(names);
+}
+bool RateLimitedDirectory::fileExists(const char* name) const{
+	return dir->fileExists(name);
+}
+int64_t RateLimitedDirectory::fileModified(const char* name) const{
+	return dir->fileModified(name);
+}
+int64_t RateLimitedDirectory::fileLength(const char* name) const{
+	return dir->fileLength(name);
+}
+bool RateLimitedDirectory::openInput(const char* name, IndexInput*& ret, CLuceneError& error, int32_t bufferSize){
+	return dir->openInput(name, ret, error, bufferSize);
+}
+void RateLimitedDirectory::touchFile(const char* name){
+	dir->touchFile(name);
+}
+void RateLimitedDirectory::renameFile(const char* from, const char* to){
+	dir->renameFile(from, to);
+}
+
+IndexOutput* RateLimitedDirectory::createOutput(const char* name){
+	return _CLNEW RateLimitedIndexOutput(dir->createOutput(name), limiter);
+}
+
+void RateLimitedDirectory::sync(const std::vector<std::string>& names){
+	dir->sync(names);
+}
+LuceneLock* RateLimitedDirectory::makeLock(const char* name){
+	return dir->makeLock(name);
+}
+void RateLimitedDirectory::clearLock(const char* name){
+	dir->clearLock(name);
+}
+std::string RateLimitedDirectory::getLockID(){
+	return dir->getLockID();
+}
+
+void RateLimitedDirectory::close(){
+}
+
+std::string RateLimitedDirectory::toString() const{
+	return "RateLimitedDirectory@" + dir->toString();
+}
+const char* RateLimitedDirectory::getClassName(){
+	return "RateLimitedDirectory";
+}
+const char* RateLimitedDirectory::getObjectName() const{
+	return getClassName();
+}
+
+CL_NS_END
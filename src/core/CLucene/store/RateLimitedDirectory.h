@@ -0,0 +1,66 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_store_RateLimitedDirectory_
+#define _lucene_store_RateLimitedDirectory_
+
+#include "Directory.h"
+
+CL_CLASS_DEF(store,RateLimiter)
+
+CL_NS_DEF(store)
+
+/**
+ * A view of another directory whose outputs are written no faster than a
+ * {@link RateLimiter} allows. Everything else goes straight to the other
+ * directory, which is neither owned nor closed by this one.
+ *
+ * IndexWriter writes merged segments through one of these when a merge
+ * rate is set, so that big merges leave disk bandwidth to flushes and searches.
+ */
+class CLUCENE_EXPORT RateLimitedDirectory: public Directory {
+private:
+	Directory* dir;
+	RateLimiter* limiter;
+protected:
+	bool doDeleteFile(const char* name);
+public:
+	/**
+	* @param dir the directory to write to
+	* @param limiter the rate limit, which is not deleted
+	*/
+	RateLimitedDirectory(Directory* dir, RateLimiter* limiter);
+	virtual ~RateLimitedDirectory();
+
+	Directory* getDirectory() const;
+	RateLimiter* getRateLimiter() const;
+
+	bool list(std::vector<std::string>* names) const;
+	bool fileExists(const char* name) const;
+	int64_t fileModified(const char* name) const;
+	int64_t fileLength(const char* name) const;
+	bool openInput(const char* name, IndexInput*& ret, CLuceneError& error, int32_t bufferSize = -1);
+	void touchFile(const char* name);
+	void renameFile(const char* from, const char* to);
+
+	/** Returns an output to the other directory, limited to the rate */
+	IndexOutput* createOutput(const char* name);
+
+	void sync(const std::vector<std::string>& names);
+	LuceneLock* makeLock(const char* name);
+	void clearLock(const char* name);
+	std::string getLockID();
+
+	/** Does nothing, the other directory stays open */
+	void close();
+
+	std::string toString() const;
+	static const char* getClassName();
+	const char* getObjectName() const;
+};
+
+CL_NS_END
+#endif
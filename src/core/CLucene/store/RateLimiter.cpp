@@ -0,0 +1,80 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "RateLimiter.h"
+#include "CLucene/util/Misc.h"
+
+CL_NS_USE(util)
+CL_NS_DEF(store)
+
+RateLimiter::RateLimiter(double mbPerSec):
+	mbPerSec(0), msPerByte(0), nextTime(0), bytes(0), pauseCount(0), pausedMillis(0)
+{
+	setMbPerSec(mbPerSec);
+}
+
+RateLimiter::~RateLimiter(){
+}
+
+void RateLimiter::setMbPerSec(double mbPerSec){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	this->mbPerSec = mbPerSec > 0 ? mbPerSec : 0;
+	this->msPerByte = mbPerSec > 0 ? 1000.0 / (mbPerSec * 1024 * 1024) : 0;
+}
+
+double RateLimiter::getMbPerSec() const{
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	return mbPerSec;
+}
+
+int64_t RateLimiter::pause(int64_t bytes){
+	int64_t wait;
+	{
+		SCOPED_LOCK_MUTEX(THIS_LOCK)
+		this->bytes += bytes;
+		if ( msPerByte == 0 )
+			return 0;
+
+		// each write books the time its bytes take after the writes before it.
+		// Time that nobody wrote in is not saved up for later bursts
+		const double now = (double)Misc::currentTimeMillis();
+		if ( nextTime < now )
+			nextTime = now;
+		nextTime += bytes * msPerByte;
+		wait = (int64_t)(nextTime - now);
+		if ( wait <= 0 )
+			return 0;
+		pauseCount++;
+		pausedMillis += wait;
+	}
+	_LUCENE_SLEEP((int)wait);
+	return wait;
+}
+
+int64_t RateLimiter::getBytes() const{
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	return bytes;
+}
+
+int64_t RateLimiter::getPauseCount() const{
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	return pauseCount;
+}
+
+int64_t RateLimiter::getPausedMillis() const{
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	return pausedMillis;
+}
+
+void RateLimiter::resetStats(){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	bytes = 0;
+	pauseCount = 0;
+	pausedMillis = 0;
+}
+
+CL_NS_END
@@ -0,0 +1,58 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_store_RateLimiter_
+#define _lucene_store_RateLimiter_
+
+#include "CLucene/LuceneThreads.h"
+
+CL_NS_DEF(store)
+
+/**
+ * Limits the rate at which bytes are written, by pausing the writers. One
+ * limiter may be shared by several threads, which then share the rate. The
+ * rate can be changed at any time, and a rate of 0 turns the limit off.
+ *
+ * @see RateLimitedDirectory
+ * @see lucene::index::IndexWriter#setMaxMergeMBPerSec
+ */
+class CLUCENE_EXPORT RateLimiter: LUCENE_BASE {
+private:
+	double mbPerSec;
+	double msPerByte;
+	double nextTime; // when the bytes written so far are paid for, in ms
+	int64_t bytes;
+	int64_t pauseCount;
+	int64_t pausedMillis;
+	DEFINE_MUTABLE_MUTEX(THIS_LOCK)
+public:
+	/** @param mbPerSec the highest rate in MB per second, or 0 for no limit */
+	RateLimiter(double mbPerSec);
+	virtual ~RateLimiter();
+
+	/** Sets the highest rate in MB per second, or 0 for no limit */
+	void setMbPerSec(double mbPerSec);
+	double getMbPerSec() const;
+
+	/**
+	* Pauses the calling thread for as long as it takes to write the bytes at
+	* the configured rate.
+	* @return the milliseconds paused
+	*/
+	int64_t pause(int64_t bytes);
+
+	/** Returns the number of bytes that went through {@link #pause} */
+	int64_t getBytes() const;
+	/** Returns how many times a writer was paused */
+	int64_t getPauseCount() const;
+	/** Returns the total milliseconds writers were paused */
+	int64_t getPausedMillis() const;
+	/** Sets the statistics back to 0 */
+	void resetStats();
+};
+
+CL_NS_END
+#endif
@@ -73,6 +73,35 @@ public:
     const char* getObjectName() const;
   };
 
+#ifdef _CL_HAVE_FUNCTION_FLOCK
+  /** A lock held with an advisory lock on an open lock file. The operating
+  * system releases it when the holder dies, so the lock file stays and
+  * is not a sign of the lock being held. */
+  class NativeFSLock: public LuceneLock {
+  private:
+	  char* lockFile;
+	  char* lockDir;
+	  int filemode;
+	  int32_t fhandle; //the locked file while the lock is held, otherwise -1
+
+	  bool lock(bool wait);
+  public:
+	  NativeFSLock( const char* _lockDir, const char* name, int filemode = -1 );
+	  ~NativeFSLock();
+
+	  bool obtain();
+	  /** Waits in the operating system for the lock when lockWaitTimeout is
+	  * LOCK_OBTAIN_WAIT_FOREVER, otherwise polls with a growing interval */
+	  bool obtain(int64_t lockWaitTimeout);
+	  void release();
+	  bool isLocked();
+	  std::string toString();
+
+    static const char* getClassName();
+    const char* getObjectName() const;
+  };
+#endif
+
   // Utility class for executing code with exclusive access.
   template<typename T>
   class LuceneLockWith {
@@ -30,6 +30,7 @@ public:
   int64_t getFilePointer() const;
   void seek(const int64_t pos);
   int64_t length() const;
+  IndexInput* slice(const int64_t offset, const int64_t length) const;
 
   const char* getObjectName() const{ return MMapIndexInput::getClassName(); }
   static const char* getClassName(){ return "MMapIndexInput"; }
@@ -32,6 +32,7 @@ CL_NS_DEF(store)
 
 		int64_t length;
 		int64_t sizeInBytes;                  // Only maintained if in a directory; updates synchronized on directory
+		int32_t bufferSize;                   // Size of all buffers but the first, which may be smaller while it grows
 
 		// This is publicly modifiable via Directory::touchFile(), so direct access not supported
 		uint64_t lastModified;
@@ -55,10 +56,15 @@ CL_NS_DEF(store)
 		void setLastModified( const uint64_t lastModified );
 		
 		uint8_t* addBuffer( const int32_t size );
+		/** Grows a buffer to size bytes, keeping its contents. Only the file's writer may call this */
+		uint8_t* growBuffer( const int32_t index, const int32_t size );
 		uint8_t* getBuffer( const int32_t index );
 		size_t getBufferLen(const int32_t index) const { return buffers[index]->_len; }
 		int32_t numBuffers() const;
 		uint8_t* newBuffer( const int32_t size );
+		int32_t getBufferSize() const { return bufferSize; }
+		/** Sets the size the buffers of a file which is not in any directory yet were made with */
+		void setBufferSize( const int32_t size ) { bufferSize = size; }
 		
 		int64_t getSizeInBytes() const;
 
@@ -76,8 +82,11 @@ CL_NS_DEF(store)
 		int32_t bufferPosition;
 		int64_t bufferStart;
 		int32_t bufferLength;
+		int32_t bufferSize;
 		
 		void switchCurrentBuffer();
+		/** Makes room for writing past the end of the current buffer */
+		void nextBuffer();
 		void setFileLength();
 				
 	public:
@@ -122,6 +131,7 @@ CL_NS_DEF(store)
 		int32_t bufferPosition;
 		int64_t bufferStart;
 		int32_t bufferLength;
+		int32_t bufferSize;
 		
 		void switchCurrentBuffer();
 		
@@ -141,6 +151,8 @@ CL_NS_DEF(store)
 		
 		uint8_t readByte();
 		void readBytes( uint8_t* dest, const int32_t len );
+		/** Decodes straight from the current buffer when the whole VInt is in it */
+		int32_t readVInt();
 		
 		int64_t getFilePointer() const;
 		
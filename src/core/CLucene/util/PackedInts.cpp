@@ -0,0 +1,85 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "PackedInts.h"
+#include "CLucene/store/IndexInput.h"
+#include "CLucene/store/IndexOutput.h"
+
+CL_NS_USE(store)
+CL_NS_DEF(util)
+
+PackedInts::PackedInts(int32_t valueCount, int32_t bitsPerValue){
+	init(valueCount, bitsPerValue);
+}
+
+PackedInts::PackedInts(IndexInput* input){
+	const int32_t count = input->readVInt();
+	const int32_t bits = input->readVInt();
+	init(count, bits);
+	const size_t used = (size_t)(((uint64_t)valueCount * bitsPerValue + 63) >> 6);
+	for ( size_t i=0;i<used;i++ )
+		blocks[i] = (uint64_t)input->readLong();
+}
+
+void PackedInts::init(int32_t valueCount, int32_t bitsPerValue){
+	if ( valueCount < 0 || bitsPerValue < 0 || bitsPerValue > 64 )
+		_CLTHROWA(CL_ERR_IllegalArgument, "invalid packed ints size");
+	this->valueCount = valueCount;
+	this->bitsPerValue = bitsPerValue;
+	this->mask = bitsPerValue == 64 ? ~(uint64_t)0 : (((uint64_t)1 << bitsPerValue) - 1);
+
+	// one spare block so that get() can always look at the following block
+	this->blockCount = (size_t)(((uint64_t)valueCount * bitsPerValue + 63) >> 6) + 1;
+	this->blocks = _CL_NEWARRAY(uint64_t, blockCount);
+}
+
+PackedInts::~PackedInts(){
+	_CLDELETE_LARRAY(blocks);
+}
+
+int32_t PackedInts::bitsRequired(uint64_t maxValue){
+	int32_t bits = 0;
+	while ( maxValue != 0 ){
+		bits++;
+		maxValue >>= 1;
+	}
+	return bits;
+}
+
+void PackedInts::set(const int32_t index, uint64_t value){
+	value &= mask;
+	const uint64_t bitPos = (uint64_t)index * bitsPerValue;
+	const size_t block = (size_t)(bitPos >> 6);
+	const int32_t shift = (int32_t)(bitPos & 63);
+	blocks[block] = (blocks[block] & ~(mask << shift)) | (value << shift);
+	if ( shift + bitsPerValue > 64 ){
+		const int32_t spill = 64 - shift;
+		blocks[block+1] = (blocks[block+1] & ~(mask >> spill)) | (value >> spill);
+	}
+}
+
+void PackedInts::write(IndexOutput* output) const{
+	output->writeVInt(valueCount);
+	output->writeVInt(bitsPerValue);
+	const size_t used = blockCount - 1;
+	for ( size_t i=0;i<used;i++ )
+		output->writeLong((int64_t)blocks[i]);
+}
+
+int32_t PackedInts::size() const{
+	return valueCount;
+}
+
+int32_t PackedInts::getBitsPerValue() const{
+	return bitsPerValue;
+}
+
+size_t PackedInts::ramBytesUsed() const{
+	return blockCount * sizeof(uint64_t);
+}
+
+CL_NS_END
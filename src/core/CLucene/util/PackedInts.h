@@ -0,0 +1,67 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_util_PackedInts_
+#define _lucene_util_PackedInts_
+
+CL_CLASS_DEF(store,IndexInput)
+CL_CLASS_DEF(store,IndexOutput)
+
+CL_NS_DEF(util)
+
+/** A fixed size array of unsigned integers which are stored with just as many
+  bits as the largest value needs. The values are packed into 64 bit blocks and
+  a value may span two blocks.
+  */
+class CLUCENE_EXPORT PackedInts:LUCENE_BASE {
+	uint64_t* blocks;
+	size_t blockCount;
+	int32_t valueCount;
+	int32_t bitsPerValue;
+	uint64_t mask;
+
+	void init(int32_t valueCount, int32_t bitsPerValue);
+	PackedInts( const PackedInts& copy );
+public:
+	/** Creates an array of valueCount zeros, each using bitsPerValue (0-64) bits */
+	PackedInts(int32_t valueCount, int32_t bitsPerValue);
+
+	/** Reads an array which was written with {@link #write(IndexOutput*)} */
+	PackedInts(CL_NS(store)::IndexInput* input);
+	~PackedInts();
+
+	/** Returns the number of bits needed to store maxValue */
+	static int32_t bitsRequired(uint64_t maxValue);
+
+	/** Returns the value at index */
+	inline uint64_t get(const int32_t index) const{
+		const uint64_t bitPos = (uint64_t)index * bitsPerValue;
+		const size_t block = (size_t)(bitPos >> 6);
+		const int32_t shift = (int32_t)(bitPos & 63);
+		uint64_t value = blocks[block] >> shift;
+		if ( shift + bitsPerValue > 64 )
+			value |= blocks[block+1] << (64 - shift);
+		return value & mask;
+	}
+
+	/** Sets the value at index. Bits of value above bitsPerValue are ignored */
+	void set(const int32_t index, uint64_t value);
+
+	/** Writes the array, which can be read back with {@link #PackedInts(IndexInput*)} */
+	void write(CL_NS(store)::IndexOutput* output) const;
+
+	/** The number of values in the array */
+	int32_t size() const;
+
+	/** The number of bits used per value */
+	int32_t getBitsPerValue() const;
+
+	/** Returns the number of bytes of heap used by the packed values */
+	size_t ramBytesUsed() const;
+};
+
+CL_NS_END
+#endif
@@ -173,6 +173,13 @@ class CLUCENE_INLINE_EXPORT PriorityQueue {
 		void adjustTop(){
 			downHeap();
 		}
+
+		/** Like adjustTop(), but returns the new top element, so that callers
+		* which keep replacing the least element need no separate top() call. */
+		_type updateTop(){
+			downHeap();
+			return heap[1];
+		}
 		    
 
 		/**
@@ -6,40 +6,61 @@
 ------------------------------------------------------------------------------*/
 #include "CLucene/_ApiHeader.h"
 #include "_StringIntern.h"
+#include "CLucene/util/Misc.h"
 CL_NS_DEF(util)
 
 typedef CL_NS(util)::CLHashMap<TCHAR*,int,CL_NS(util)::Compare::TChar,CL_NS(util)::Equals::TChar,CL_NS(util)::Deletor::tcArray, CL_NS(util)::Deletor::DummyInt32 > __wcsintrntype;
 typedef CL_NS(util)::CLHashMap<char*,int,CL_NS(util)::Compare::Char,CL_NS(util)::Equals::Char,CL_NS(util)::Deletor::acArray, CL_NS(util)::Deletor::DummyInt32 > __strintrntype;
-__wcsintrntype StringIntern_stringPool(true);
-__strintrntype StringIntern_stringaPool(true);
 
-bool StringIntern_blanksinitd=false;
-__wcsintrntype::iterator StringIntern_wblank;
+/**
+* The pools are split into shards by the hash of the string, each with its own lock,
+* so that threads interning different field names (or the same one, as long as it is not
+* every thread at once) don't all wait on one global lock.
+*/
+class StringInternShard{
+public:
+	__wcsintrntype stringPool;
+	__strintrntype stringaPool;
+	DEFINE_MUTEX(THIS_LOCK)
 
-//STATIC_DEFINE_MUTEX(StringIntern_THIS_LOCK);
-DEFINE_MUTEX(StringIntern_THIS_LOCK)
+	StringInternShard():
+		stringPool(true), stringaPool(true)
+	{
+	}
+};
+
+static const size_t StringIntern_SHARDS = 16;
+static StringInternShard StringIntern_shards[StringIntern_SHARDS];
+
+static StringInternShard& StringIntern_shardFor(size_t hash){
+	// the pools use the low bits of the hash for their buckets
+	return StringIntern_shards[(hash ^ (hash >> 16)) % StringIntern_SHARDS];
+}
 	  
 
     void CLStringIntern::_shutdown(){
     #ifdef _DEBUG
-		SCOPED_LOCK_MUTEX(StringIntern_THIS_LOCK)
-        if ( StringIntern_stringaPool.size() > 0 ){
-            printf("WARNING: stringaPool still contains intern'd strings (refcounts):\n");
-            __strintrntype::iterator itr = StringIntern_stringaPool.begin();
-            while ( itr != StringIntern_stringaPool.end() ){
-                printf(" %s (%d)\n",(itr->first), (itr->second));
-                ++itr;
-            }
-        }
-        
-        if ( StringIntern_stringPool.size() > 0 ){
-            printf("WARNING: stringPool still contains intern'd strings (refcounts):\n");
-            __wcsintrntype::iterator itr = StringIntern_stringPool.begin();
-            while ( itr != StringIntern_stringPool.end() ){
-                _tprintf(_T(" %s (%d)\n"),(itr->first), (itr->second));
-                ++itr;
-            }
-        }
+		for ( size_t i=0;i<StringIntern_SHARDS;i++ ){
+			StringInternShard& shard = StringIntern_shards[i];
+			SCOPED_LOCK_MUTEX(shard.THIS_LOCK)
+	        if ( shard.stringaPool.size() > 0 ){
+	            printf("WARNING: stringaPool still contains intern'd strings (refcounts):\n");
+	            __strintrntype::iterator itr = shard.stringaPool.begin();
+	            while ( itr != shard.stringaPool.end() ){
+	                printf(" %s (%d)\n",(itr->first), (itr->second));
+	                ++itr;
+	            }
+	        }
+	        
+	        if ( shard.stringPool.size() > 0 ){
+	            printf("WARNING: stringPool still contains intern'd strings (refcounts):\n");
+	            __wcsintrntype::iterator itr = shard.stringPool.begin();
+	            while ( itr != shard.stringPool.end() ){
+	                _tprintf(_T(" %s (%d)\n"),(itr->first), (itr->second));
+	                ++itr;
+	            }
+	        }
+		}
     #endif
     }
 
@@ -49,12 +70,13 @@ DEFINE_MUTEX(StringIntern_THIS_LOCK)
 		if ( str[0] == 0 )
 			return LUCENE_BLANK_STRING;
 
-		SCOPED_LOCK_MUTEX(StringIntern_THIS_LOCK)
+		StringInternShard& shard = StringIntern_shardFor(Misc::thashCode(str));
+		SCOPED_LOCK_MUTEX(shard.THIS_LOCK)
 
-		__wcsintrntype::iterator itr = StringIntern_stringPool.find((TCHAR*)str);
-		if ( itr==StringIntern_stringPool.end() ){
+		__wcsintrntype::iterator itr = shard.stringPool.find((TCHAR*)str);
+		if ( itr==shard.stringPool.end() ){
 			TCHAR* ret = STRDUP_TtoT(str);
-			StringIntern_stringPool[ret]= 1;
+			shard.stringPool[ret]= 1;
 			return ret;
 		}else{
 			(itr->second)++;
@@ -68,12 +90,13 @@ DEFINE_MUTEX(StringIntern_THIS_LOCK)
 		if ( str[0] == 0 )
 			return false; // warning: a possible memory leak, since str may be never freed!
 
-		SCOPED_LOCK_MUTEX(StringIntern_THIS_LOCK)
+		StringInternShard& shard = StringIntern_shardFor(Misc::thashCode(str));
+		SCOPED_LOCK_MUTEX(shard.THIS_LOCK)
 
-		__wcsintrntype::iterator itr = StringIntern_stringPool.find((TCHAR*)str);
-		if ( itr != StringIntern_stringPool.end() ){
+		__wcsintrntype::iterator itr = shard.stringPool.find((TCHAR*)str);
+		if ( itr != shard.stringPool.end() ){
 			if ( (itr->second) == 1 ){
-				StringIntern_stringPool.removeitr(itr);
+				shard.stringPool.removeitr(itr);
 				return true;
 			}else
 				(itr->second)--;
@@ -87,12 +110,13 @@ DEFINE_MUTEX(StringIntern_THIS_LOCK)
 		if ( str[0] == 0 )
 			return _LUCENE_BLANK_ASTRING;
 
-		SCOPED_LOCK_MUTEX(StringIntern_THIS_LOCK)
+		StringInternShard& shard = StringIntern_shardFor(Misc::ahashCode(str));
+		SCOPED_LOCK_MUTEX(shard.THIS_LOCK)
 
-		__strintrntype::iterator itr = StringIntern_stringaPool.find((char*)str);
-		if ( itr==StringIntern_stringaPool.end() ){
+		__strintrntype::iterator itr = shard.stringaPool.find((char*)str);
+		if ( itr==shard.stringaPool.end() ){
 			char* ret = (use_provided) ? const_cast<char*>(str) : STRDUP_AtoA(str);
-			StringIntern_stringaPool[ret] = count;
+			shard.stringaPool[ret] = count;
 			return ret;
 		}else{
 			if (use_provided) _CLDELETE_LCaARRAY((char*)str); // delete the provided string if already exists
@@ -107,12 +131,13 @@ DEFINE_MUTEX(StringIntern_THIS_LOCK)
 		if ( str[0] == 0 )
 			return false; // warning: a possible memory leak, since str may be never freed!
 
-		SCOPED_LOCK_MUTEX(StringIntern_THIS_LOCK)
+		StringInternShard& shard = StringIntern_shardFor(Misc::ahashCode(str));
+		SCOPED_LOCK_MUTEX(shard.THIS_LOCK)
 
-		__strintrntype::iterator itr = StringIntern_stringaPool.find((char*)str);
-		if ( itr!=StringIntern_stringaPool.end() ){
+		__strintrntype::iterator itr = shard.stringaPool.find((char*)str);
+		if ( itr!=shard.stringaPool.end() ){
 			if ( (itr->second) == count ){
-				StringIntern_stringaPool.removeitr(itr);
+				shard.stringaPool.removeitr(itr);
 				return true;
 			}else
 				(itr->second) = (itr->second) - count;
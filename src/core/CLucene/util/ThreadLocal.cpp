@@ -5,6 +5,7 @@
 * the GNU Lesser General Public License, as specified in the COPYING file.
 ------------------------------------------------------------------------------*/
 #include <algorithm>
+#include <vector>
 
 #include "CLucene/_ApiHeader.h"
 #include "CLucene/LuceneThreads.h"
@@ -18,14 +19,20 @@ CL_NS_DEF ( util )
 * The concept of ThreadLocal is that a ThreadLocal class stores specific values for each unique thread.
 * Several thread-end detection techniques are used to delete the thread data if the thread dies before the ThreadLocal class is shut.
 *
-* The class->thread data mapping is stored in the _ThreadLocal class.
+* Each _ThreadLocal is given a slot number when it is created. Each thread keeps its values
+* in a ThreadLocals array indexed by these slots, so a lookup is only an array access.
+* Where pthreads are available the thread's ThreadLocals is kept in a pthread key, so get()
+* takes no locks at all. Otherwise it is found by thread id in threadData.
+*
+* The slot->_ThreadLocal mapping (for deleting values when a thread ends) is in ThreadLocalSlots.
 * The thread->datas mapping is in ThreadData.
 */
 
+class ThreadLocals;
 
 //predefine for the shared code...
 #if defined(_CL_HAVE_WIN32_THREADS)
-	#define INIT_THREAD(ret) ret=true
+	#define INIT_THREAD(threadLocals)
     extern "C"{
 
         //todo: move this to StdHeader and make it usable by other functions...
@@ -40,12 +47,12 @@ CL_NS_DEF ( util )
         }
     }
 #elif defined(_CL_HAVE_PTHREAD)
+    #define _CL_HAVE_THREADLOCAL_KEY
     pthread_key_t pthread_threadlocal_key;
     pthread_once_t pthread_threadlocal_key_once = PTHREAD_ONCE_INIT;
-    #define INIT_THREAD(ret) \
+    #define INIT_THREAD(threadLocals) \
 	pthread_once(&pthread_threadlocal_key_once, pthread_threadlocal_make_key); \
-	if (pthread_getspecific(pthread_threadlocal_key) == NULL) { pthread_setspecific(pthread_threadlocal_key, (void*)1); } \
-	ret = true;
+	pthread_setspecific(pthread_threadlocal_key, threadLocals);
 
     //the function that is called when the thread shutsdown
     void pthread_threadlocal_destructor(void* /*_holder*/){
@@ -57,18 +64,52 @@ CL_NS_DEF ( util )
 		(void) pthread_key_create(&pthread_threadlocal_key, &pthread_threadlocal_destructor);
     }
 #endif
+#ifndef INIT_THREAD
+	#define INIT_THREAD(threadLocals)
+#endif
+
+/**
+* The values that one thread has in each ThreadLocal, indexed by slot.
+* Only the owning thread grows the array, so it can read it without locking. Other
+* threads only clear slots (when a ThreadLocal is destroyed), under values_LOCK.
+*/
+class ThreadLocals
+{
+	std::vector<void*> values;
+public:
+	DEFINE_MUTEX ( values_LOCK )
 
-class _ThreadLocal;
+	void* get ( size_t slot ) const
+	{
+		return slot < values.size() ? values[slot] : NULL;
+	}
+	/** Stores val in the slot and returns the value that was there */
+	void* set ( size_t slot, void* val )
+	{
+		SCOPED_LOCK_MUTEX ( values_LOCK )
+		if ( slot >= values.size() ){
+			if ( val == NULL )
+				return NULL;
+			values.resize ( slot + 1, NULL );
+		}
+		void* old = values[slot];
+		values[slot] = val;
+		return old;
+	}
+	size_t size() const
+	{
+		return values.size();
+	}
+};
 
 /**
-* List that holds the list of ThreadLocals that this thread has data in.
+* The _ThreadLocal which owns each slot, and the slots which are free for reuse.
 */
-class ThreadLocals : private std::set<_ThreadLocal*>
+class ThreadLocalSlots
 {
 public:
-	void UnregisterThread();
-	void add(_ThreadLocal* thread);
-    void remove(_ThreadLocal* thread);
+	std::vector<_ThreadLocal*> owners;
+	std::vector<size_t> freeSlots;
 };
 
 //map of thread<>ThreadLocals
@@ -77,42 +118,50 @@ typedef CL_NS ( util ) ::CLMultiMap<_LUCENE_THREADID_TYPE, ThreadLocals*,
 	CL_NS ( util ) ::Deletor::ConstNullVal<_LUCENE_THREADID_TYPE>,
 	CL_NS ( util ) ::Deletor::Object<ThreadLocals> > ThreadDataType;
 static ThreadDataType*  threadData = NULL; 
+static ThreadLocalSlots* threadLocalSlots = NULL;
 
 #ifndef _CL_DISABLE_MULTITHREADING
-	//the lock for locking ThreadData
+	//the lock for locking ThreadData and ThreadLocalSlots
 	//we don't use STATIC_DEFINE_MUTEX, because then the initialization order will be undefined.
 	static _LUCENE_THREADMUTEX *threadData_LOCK = NULL;
+
+	//slightly un-usual way of initialising mutex, 
+	//because otherwise our initialisation order would be undefined
+	#define LOCK_THREADDATA \
+		if ( threadData_LOCK == NULL ) \
+			threadData_LOCK = _CLNEW _LUCENE_THREADMUTEX; \
+		SCOPED_LOCK_MUTEX ( *threadData_LOCK );
+#else
+	#define LOCK_THREADDATA
+#endif
+
+/** Returns the values of the current thread, or NULL if it has none yet */
+static ThreadLocals* currentThreadLocals()
+{
+#ifdef _CL_HAVE_THREADLOCAL_KEY
+	pthread_once(&pthread_threadlocal_key_once, pthread_threadlocal_make_key);
+	return (ThreadLocals*)pthread_getspecific(pthread_threadlocal_key);
+#else
+	LOCK_THREADDATA
+	if ( threadData == NULL )
+		return NULL;
+	return threadData->get(_LUCENE_CURRTHREADID);
 #endif
+}
 
 
 class _ThreadLocal::Internal
 {
 	public:
-		typedef CL_NS ( util ) ::CLSet<_LUCENE_THREADID_TYPE, void*,
-			CL_NS ( util ) ::CLuceneThreadIdCompare,
-			CL_NS ( util ) ::Deletor::ConstNullVal<_LUCENE_THREADID_TYPE>,
-			CL_NS ( util ) ::Deletor::ConstNullVal<void*> > LocalsType;
-		LocalsType locals;
-		DEFINE_MUTEX ( locals_LOCK )
+		size_t slot;
 		AbstractDeletor* _deletor;
 
-		Internal ( AbstractDeletor* _deletor ) :
-			locals ( false,false )
+		Internal ( AbstractDeletor* _deletor )
 		{
 			this->_deletor = _deletor;
 		}
 		~Internal()
 		{
-			//remove all the thread local data for this object
-			LocalsType::iterator itr = locals.begin();
-			while ( itr != locals.end() )
-			{
-				void* val = itr->second;
-				locals.removeitr ( itr );
-				_deletor->Delete ( val );
-				itr = locals.begin();
-			}
-
 			delete _deletor;
 		}
 };
@@ -120,36 +169,51 @@ class _ThreadLocal::Internal
 _ThreadLocal::_ThreadLocal ( CL_NS ( util ) ::AbstractDeletor* _deletor ) :
 		_internal ( _CLNEW Internal ( _deletor ) )
 {
-
+	LOCK_THREADDATA
+
+	if ( threadLocalSlots == NULL )
+		threadLocalSlots = _CLNEW ThreadLocalSlots;
+
+	if ( threadLocalSlots->freeSlots.empty() ){
+		_internal->slot = threadLocalSlots->owners.size();
+		threadLocalSlots->owners.push_back(this);
+	}else{
+		_internal->slot = threadLocalSlots->freeSlots.back();
+		threadLocalSlots->freeSlots.pop_back();
+		threadLocalSlots->owners[_internal->slot] = this;
+	}
 }
 
 _ThreadLocal::~_ThreadLocal()
 {
-	setNull();
-	UnregisterCurrentThread();
-    RemoveThreadLocal( this );
+	RemoveThreadLocal( this );
+	{
+		LOCK_THREADDATA
+		if ( threadLocalSlots != NULL ){
+			threadLocalSlots->owners[_internal->slot] = NULL;
+			threadLocalSlots->freeSlots.push_back(_internal->slot);
+		}
+	}
 	delete _internal;
 }
 
 
 void* _ThreadLocal::get()
 {
-	SCOPED_LOCK_MUTEX(_internal->locals_LOCK)
-	return _internal->locals.get ( _LUCENE_CURRTHREADID );
+	ThreadLocals* threadLocals = currentThreadLocals();
+	if ( threadLocals == NULL )
+		return NULL;
+	return threadLocals->get ( _internal->slot );
 }
 
 void _ThreadLocal::setNull()
 {
-	//just delete this thread from the locals list
-	_LUCENE_THREADID_TYPE id = _LUCENE_CURRTHREADID;
-	SCOPED_LOCK_MUTEX(_internal->locals_LOCK)
-	Internal::LocalsType::iterator itr = _internal->locals.find ( id );
-	if ( itr != _internal->locals.end() )
-	{
-		void* val = itr->second;
-		_internal->locals.removeitr ( itr );
+	ThreadLocals* threadLocals = currentThreadLocals();
+	if ( threadLocals == NULL )
+		return;
+	void* val = threadLocals->set ( _internal->slot, NULL );
+	if ( val != NULL )
 		_internal->_deletor->Delete ( val );
-	}
 }
 
 void _ThreadLocal::set ( void* t )
@@ -158,48 +222,23 @@ void _ThreadLocal::set ( void* t )
 		setNull();
 		return;
 	}
-	//make sure we have a threadlocal context (for cleanup)
-	bool ret;
-	INIT_THREAD(ret);
-	assert(ret);
-
-	_LUCENE_THREADID_TYPE id = _LUCENE_CURRTHREADID;
 
-	//drop a reference to this ThreadLocal in ThreadData
-	{
-#ifndef _CL_DISABLE_MULTITHREADING
-		//slightly un-usual way of initialising mutex, 
-		//because otherwise our initialisation order would be undefined
-		if ( threadData_LOCK == NULL )
-			threadData_LOCK = _CLNEW _LUCENE_THREADMUTEX;
-		SCOPED_LOCK_MUTEX ( *threadData_LOCK );
-#endif
+	ThreadLocals* threadLocals = currentThreadLocals();
+	if ( threadLocals == NULL ){
+		//first value of this thread: register it so that its data can be cleaned up
+		LOCK_THREADDATA
 
 		if ( threadData == NULL )
 			threadData = _CLNEW ThreadDataType ( false, true );
 
-		ThreadLocals* threadLocals = threadData->get(id);
-		if ( threadLocals == NULL ){
-			threadLocals = _CLNEW ThreadLocals;
-      threadData->insert( std::pair<const _LUCENE_THREADID_TYPE, ThreadLocals*>(id,threadLocals));
-		}
-		threadLocals->add(this);
-	}
-
-	{
-		SCOPED_LOCK_MUTEX(_internal->locals_LOCK)
-		Internal::LocalsType::iterator itr = _internal->locals.find ( id );
-		if ( itr != _internal->locals.end() )
-		{
-			void* val = itr->second;
-			_internal->locals.removeitr ( itr );
-			_internal->_deletor->Delete ( val );
-		}
-	
-		if ( t != NULL )
-			_internal->locals.put ( id, t );
+		threadLocals = _CLNEW ThreadLocals;
+		threadData->insert( std::pair<const _LUCENE_THREADID_TYPE, ThreadLocals*>(_LUCENE_CURRTHREADID,threadLocals));
+		INIT_THREAD(threadLocals);
 	}
 
+	void* val = threadLocals->set ( _internal->slot, t );
+	if ( val != NULL && val != t )
+		_internal->_deletor->Delete ( val );
 }
 
 void _ThreadLocal::UnregisterCurrentThread()
@@ -207,13 +246,21 @@ void _ThreadLocal::UnregisterCurrentThread()
 	if ( threadData == NULL )
 		return;
 	_LUCENE_THREADID_TYPE id = _LUCENE_CURRTHREADID;
-	SCOPED_LOCK_MUTEX ( *threadData_LOCK );
+	LOCK_THREADDATA
 
 	ThreadDataType::iterator itr = threadData->find(id);
 	if ( itr != threadData->end() ){
 		ThreadLocals* threadLocals = itr->second;
-		threadLocals->UnregisterThread();
+		for ( size_t slot = 0; slot < threadLocals->size(); slot++ ){
+			void* val = threadLocals->set ( slot, NULL );
+			_ThreadLocal* owner = threadLocalSlots->owners[slot];
+			if ( val != NULL && owner != NULL )
+				owner->_internal->_deletor->Delete ( val );
+		}
 		threadData->removeitr(itr);
+#ifdef _CL_HAVE_THREADLOCAL_KEY
+		pthread_setspecific(pthread_threadlocal_key, NULL);
+#endif
 	}
 }
 
@@ -222,45 +269,27 @@ void _ThreadLocal::RemoveThreadLocal( _ThreadLocal * tl )
 	if ( threadData == NULL )
 		return;
 
-    SCOPED_LOCK_MUTEX ( *threadData_LOCK );
+	LOCK_THREADDATA
 
-	ThreadDataType::iterator itr = threadData->begin();
-    for( ThreadDataType::iterator itr = threadData->begin(); itr != threadData->end(); itr++ )
-    {
-		ThreadLocals* threadLocals = itr->second;
-        threadLocals->remove( tl );
-        // Remove empty threadLocals
+	for( ThreadDataType::iterator itr = threadData->begin(); itr != threadData->end(); itr++ )
+	{
+		void* val = itr->second->set ( tl->_internal->slot, NULL );
+		if ( val != NULL )
+			tl->_internal->_deletor->Delete ( val );
 	}
 }
 
 void _ThreadLocal::_shutdown()
 {
+#ifdef _CL_HAVE_THREADLOCAL_KEY
+	if ( threadData != NULL )
+		pthread_setspecific(pthread_threadlocal_key, NULL);
+#endif
 #ifndef _CL_DISABLE_MULTITHREADING
 	_CLDELETE(threadData_LOCK);
 #endif
 	_CLDELETE(threadData);
-}
-
-
-
-void ThreadLocals::UnregisterThread()
-{
-	//this should only be accessed from its own thread... if this changes, then this access has to be locked.
-    for( ThreadLocals::iterator iTLocal = begin(); iTLocal != end(); iTLocal++ )
-        (*iTLocal)->setNull();
-    clear();
-}
-void ThreadLocals::add(_ThreadLocal* thread)
-{
-	//this should only be accessed from its own thread... if this changes, then this access has to be locked.
-    if( end() == find( thread ) )
-        insert( thread );
-}
-void ThreadLocals::remove(_ThreadLocal* thread)
-{    
-    ThreadLocals::iterator iTLocal = find( thread );
-    if( iTLocal != end() )
-        erase( iTLocal );
+	_CLDELETE(threadLocalSlots);
 }
 
 CL_NS_END
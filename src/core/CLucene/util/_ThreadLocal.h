@@ -14,13 +14,18 @@ CL_NS_DEF ( util )
 * A class which holds thread specific data. Calls to get() or set() or to the data kept in the _ThreadLocal
 * is invalid after _ThreadLocal has been destroyed.
 */
-class _ThreadLocal
+class CLUCENE_EXPORT _ThreadLocal
 {
 	private:
 		class Internal;
 		Internal* _internal;
 	public:
 		_ThreadLocal ( CL_NS ( util ) ::AbstractDeletor* _deletor );
+
+		/**
+		* Returns the value of the current thread, or NULL. Where pthreads are
+		* available this takes no locks, so it is cheap enough for every term lookup.
+		*/
 		void* get();
 
 		/**
@@ -43,6 +48,9 @@ class _ThreadLocal
 		*/
 		static void UnregisterCurrentThread();
 
+		/**
+		* Deletes the data that tl holds for every thread. Called when tl is destroyed.
+		*/
         static void RemoveThreadLocal( _ThreadLocal * tl );
 
 
@@ -32,6 +32,10 @@
 #cmakedefine _CL_HAVE_FUNCTION_PRINTF  1 
 #cmakedefine _CL_HAVE_FUNCTION_SNPRINTF  1 
 #cmakedefine _CL_HAVE_FUNCTION_MMAP  1 
+#cmakedefine _CL_HAVE_FUNCTION_WRITEV 1
+#cmakedefine _CL_HAVE_FUNCTION_COPY_FILE_RANGE 1
+#cmakedefine _CL_HAVE_FUNCTION_PREAD 1
+#cmakedefine _CL_HAVE_FUNCTION_FLOCK 1
 #cmakedefine _CL_HAVE_FUNCTION_STRLWR 1
 #cmakedefine _CL_HAVE_FUNCTION_STRTOLL 1
 #cmakedefine _CL_HAVE_FUNCTION_STRUPR 1
@@ -68,6 +72,7 @@ ${FUNCTION__CLOSE}
 ${FUNCTION__READ}
 ${FUNCTION__CL_OPEN}
 ${FUNCTION__WRITE}
+${FUNCTION__FSYNC}
 ${FUNCTION__SNPRINTF}
 ${FUNCTION__MKDIR}
 ${FUNCTION__UNLINK}
@@ -34,6 +34,8 @@
 #cmakedefine _CL_HAVE_SYS_TIME_H 1
 #cmakedefine _CL_HAVE_TCHAR_H 1
 #cmakedefine _CL_HAVE_SYS_MMAN_H 1
+#cmakedefine _CL_HAVE_SYS_UIO_H 1
+#cmakedefine _CL_HAVE_SYS_FILE_H 1
 #cmakedefine _CL_HAVE_WINERROR_H 1
 #cmakedefine _CL_HAVE_STDINT_H 1
 
@@ -323,6 +323,56 @@
        _CLDELETE(a);
    }
 
+  void testStandardTokenizer(CuTest *tc){
+      // the sample is repeated so that tokens straddle the tokenizer's read buffer
+      const TCHAR* sample = _T("AT&T mail foo@bar.com, U.S.A. O'Reilly 1.5 -3 192.168.1.1 x.. \x4e2d\x6587 ");
+      const TCHAR* types[] = { _T("<COMPANY>"), _T("<ALPHANUM>"), _T("<EMAIL>"),
+        _T("<ACRONYM>"), _T("<APOSTROPHE>"), _T("<NUM>"), _T("<NUM>"), _T("<HOST>"), _T("<ALPHANUM>"), _T("<ALPHANUM>") };
+      const TCHAR* texts[] = { _T("AT&T"), _T("mail"), _T("foo@bar.com"),
+        _T("U.S.A."), _T("O'Reilly"), _T("1.5"), _T("-3"), _T("192.168.1.1"), _T("x"), _T("\x4e2d\x6587") };
+      const int32_t tokensPerSample = sizeof(types)/sizeof(types[0]);
+      const int32_t sampleLen = _tcslen(sample);
+      const int32_t repeat = (LUCENE_IO_BUFFER_SIZE * 3) / sampleLen;
+
+      StringBuffer text;
+      for ( int32_t i=0;i<repeat;i++ )
+        text.append(sample);
+
+      int32_t firstOffsets[tokensPerSample];
+      for ( int32_t wrap=0;wrap<2;wrap++ ){
+        StringReader reader(text.getBuffer());
+        StandardTokenizer* tokenizer = wrap == 0 ?
+          _CLNEW StandardTokenizer(&reader) :
+          _CLNEW StandardTokenizer(_CLNEW FilteredBufferedReader(&reader, false), true);
+        Token t;
+        for ( int32_t i=0;i<repeat;i++ ){
+          for ( int32_t j=0;j<tokensPerSample;j++ ){
+            CLUCENE_ASSERT(tokenizer->next(&t) != NULL);
+            assertTrue(_tcscmp(t.termBuffer(), texts[j]) == 0);
+            assertTrue(_tcscmp(t.type(), types[j]) == 0);
+            if ( i == 0 )
+              firstOffsets[j] = t.startOffset();
+            assertEquals(firstOffsets[j] + i * sampleLen, t.startOffset());
+            assertEquals(t.startOffset() + (int32_t)_tcslen(texts[j]), t.endOffset());
+          }
+        }
+        CLUCENE_ASSERT(tokenizer->next(&t) == NULL);
+        _CLDELETE(tokenizer);
+      }
+  }
+
+  void testReusableTokenStream(CuTest *tc){
+      // each call must read from the new reader, not from the one the chain was built with
+      StandardAnalyzer a;
+      assertReusableAnalyzesTo(tc,&a, _T("The quick Brown fox"), _T("quick;brown;fox;") );
+      assertReusableAnalyzesTo(tc,&a, _T("Jumps OVER"), _T("jumps;over;") );
+      assertReusableAnalyzesTo(tc,&a, _T("I.B.M. isn't lazy"), _T("ibm;isn't;lazy;") );
+
+      SimpleAnalyzer b;
+      assertReusableAnalyzesTo(tc,&b, _T("foo bar"), _T("foo;bar;") );
+      assertReusableAnalyzesTo(tc,&b, _T("BAZ"), _T("baz;") );
+  }
+
   void testISOLatin1AccentFilter(CuTest *tc){
 	  TCHAR str[200];
 	  _tcscpy(str, _T("Des mot cl\xe9s \xc0 LA CHA\xceNE \xc0 \xc1 \xc2 ") //Des mot cl?s ? LA CHA?NE ? ? ? 
@@ -495,6 +545,8 @@ CuSuite *testanalyzers(void)
     SUITE_ADD_TEST(suite, testStop);
     SUITE_ADD_TEST(suite, testKeywordTokenizer);
     SUITE_ADD_TEST(suite, testStandardAnalyzer);
+    SUITE_ADD_TEST(suite, testStandardTokenizer);
+    SUITE_ADD_TEST(suite, testReusableTokenStream);
     //SUITE_ADD_TEST(suite, testPayloadCopy); // <- TODO: Finish Payload and remove asserts before enabling this test
 
     // Ported from TestPerFieldAnalzyerWrapper.java + 1 test of our own
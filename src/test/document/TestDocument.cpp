@@ -285,6 +285,58 @@ public:
     _TestDocumentWithOptions(tc, Field::STORE_COMPRESS, FieldSelector::LAZY_LOAD);
   }
 
+  void TestReusedFieldReferences(CuTest *tc){
+    RAMDirectory dir;
+    TCHAR idBuffer[20];
+    TCHAR bodyBuffer[40];
+    ValueArray<uint8_t> data(4);
+    {
+      WhitespaceAnalyzer a;
+      IndexWriter w(&dir,&a,true);
+
+      // one document and its fields are reused for every document added
+      Document doc;
+      Field* id = _CLNEW Field(_T("id"), Field::STORE_YES | Field::INDEX_UNTOKENIZED);
+      Field* body = _CLNEW Field(_T("body"), Field::STORE_YES | Field::INDEX_TOKENIZED);
+      Field* bin = _CLNEW Field(_T("bin"), Field::STORE_YES);
+      doc.add(*id);
+      doc.add(*body);
+      doc.add(*bin);
+
+      for (int i=0;i<10;i++){
+        _sntprintf(idBuffer, 20, _T("%d"), i);
+        _sntprintf(bodyBuffer, 40, _T("common word%d"), i);
+        for (int j=0;j<4;j++)
+          data[j] = (uint8_t)(i+j);
+
+        id->setValueReference(idBuffer);
+        body->setValueReference(bodyBuffer);
+        bin->setValueReference(&data);
+        CuAssertTrue(tc, body->stringValue() == bodyBuffer);
+        w.addDocument(&doc);
+      }
+      w.close();
+    }
+
+    IndexReader* reader = IndexReader::open(&dir);
+    CuAssertIntEquals(tc, _T("numDocs"), 10, reader->numDocs());
+    Document doc;
+    reader->document(7, doc);
+    CuAssertStrEquals(tc, _T("id"), _T("7"), doc.get(_T("id")));
+    CuAssertStrEquals(tc, _T("body"), _T("common word7"), doc.get(_T("body")));
+    const ValueArray<uint8_t>* bytes = doc.getField(_T("bin"))->binaryValue();
+    CuAssertIntEquals(tc, _T("bin length"), 4, (int)bytes->length);
+    CuAssertIntEquals(tc, _T("bin value"), 10, (int)bytes->values[3]);
+
+    Term common(_T("body"), _T("common"));
+    CuAssertIntEquals(tc, _T("docFreq"), 10, reader->docFreq(&common));
+    Term word(_T("body"), _T("word3"));
+    CuAssertIntEquals(tc, _T("docFreq"), 1, reader->docFreq(&word));
+
+    reader->close();
+    _CLDELETE(reader);
+    _CL_LDECREF(&dir); //this is in the stack...
+  }
 
 
 CuSuite *testdocument(void)
@@ -297,6 +349,7 @@ CuSuite *testdocument(void)
   SUITE_ADD_TEST(suite, TestLazyBinaryDocument);
 	SUITE_ADD_TEST(suite, TestFieldSelectors);
 	SUITE_ADD_TEST(suite, TestFields);
+	SUITE_ADD_TEST(suite, TestReusedFieldReferences);
 	//SUITE_ADD_TEST(suite, TestDateTools);
     return suite;
 }
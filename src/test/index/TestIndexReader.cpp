@@ -9,6 +9,8 @@
 #include "CLucene/index/_SegmentHeader.h"
 #include "CLucene/index/_MultiSegmentReader.h"
 #include "CLucene/index/MultiReader.h"
+#include "CLucene/index/DocumentCache.h"
+#include "CLucene/document/FieldSelector.h"
 
 typedef IndexReader* (*TestIRModifyIndex)(CuTest* tc, IndexReader* reader, int modify);
 DEFINE_MUTEX(createReaderMutex)
@@ -298,11 +300,168 @@ void testMultiReaderReopen(CuTest *tc){
   //_CLDELETE(index2B);
 }
 
+void testDocumentCache(CuTest *tc){
+  RAMDirectory dir;
+  createIndex(tc, &dir, true);
+
+  DocumentCache* cache = _CLNEW DocumentCache(1024*1024);
+  IndexReader* reader = IndexReader::open(&dir);
+  reader->setDocumentCache(cache);
+  CuAssertTrue(tc, reader->getDocumentCache() == cache);
+
+  Document doc;
+  reader->document(5, doc, NULL);
+  CuAssertStrEquals(tc, _T("doc 5 field1"), _T("a5"), doc.get(_T("field1")));
+  CuAssertIntEquals(tc, _T("misses"), 1, (int)cache->getMissCount());
+  CuAssertIntEquals(tc, _T("hits"), 0, (int)cache->getHitCount());
+
+  doc.clear();
+  reader->document(5, doc, NULL);
+  CuAssertStrEquals(tc, _T("doc 5 field1"), _T("a5"), doc.get(_T("field1")));
+  CuAssertStrEquals(tc, _T("doc 5 field4"), _T("a5 b5"), doc.get(_T("field4")));
+  CuAssertIntEquals(tc, _T("fields"), 4, (int)doc.getFields()->size());
+  CuAssertIntEquals(tc, _T("hits"), 1, (int)cache->getHitCount());
+  CuAssertIntEquals(tc, _T("cached docs"), 1, (int)cache->size());
+
+  // segments carried over by reopen keep their cached documents
+  {
+    WhitespaceAnalyzer analyzer;
+    IndexWriter w(&dir, &analyzer, false);
+    createDocument(doc, 100, 4);
+    w.addDocument(&doc);
+    w.close();
+  }
+  IndexReader* refreshed = reader->reopen();
+  CuAssertTrue(tc, refreshed != reader);
+  reader->close();
+  _CLDELETE(reader);
+  CuAssertTrue(tc, refreshed->getDocumentCache() == cache);
+
+  doc.clear();
+  refreshed->document(5, doc, NULL);
+  CuAssertStrEquals(tc, _T("doc 5 field1"), _T("a5"), doc.get(_T("field1")));
+  CuAssertIntEquals(tc, _T("hits after reopen"), 2, (int)cache->getHitCount());
+
+  doc.clear();
+  refreshed->document(100, doc, NULL);
+  CuAssertStrEquals(tc, _T("doc 100 field1"), _T("a100"), doc.get(_T("field1")));
+  CuAssertIntEquals(tc, _T("cached docs"), 2, (int)cache->size());
+
+  // closing the reader drops its segments from the cache
+  refreshed->close();
+  _CLDELETE(refreshed);
+  CuAssertIntEquals(tc, _T("cached docs after close"), 0, (int)cache->size());
+
+  _CLDECDELETE(cache);
+}
+
+void testTermInfosCache(CuTest *tc){
+  RAMDirectory dir;
+  createIndex(tc, &dir, false);
+  IndexReader* reader = IndexReader::open(&dir);
+  int64_t hits, misses;
+
+  Term* term = _CLNEW Term(_T("field1"), _T("a5"));
+  CuAssertIntEquals(tc, _T("docFreq"), 1, reader->docFreq(term));
+  reader->getTermInfosCacheStats(hits, misses);
+  CuAssertIntEquals(tc, _T("hits"), 0, (int)hits);
+  CuAssertIntEquals(tc, _T("misses"), 1, (int)misses);
+
+  // the postings of the term are found through the cache
+  TermDocs* termDocs = reader->termDocs(term);
+  CuAssertTrue(tc, termDocs->next());
+  CuAssertIntEquals(tc, _T("doc"), 5, termDocs->doc());
+  CuAssertTrue(tc, !termDocs->next());
+  termDocs->close();
+  _CLDELETE(termDocs);
+  CuAssertIntEquals(tc, _T("docFreq again"), 1, reader->docFreq(term));
+  reader->getTermInfosCacheStats(hits, misses);
+  CuAssertIntEquals(tc, _T("hits"), 2, (int)hits);
+  CuAssertIntEquals(tc, _T("misses"), 1, (int)misses);
+
+  // enumerations are still positioned at the term after a cache hit
+  TermEnum* terms = reader->terms(term);
+  CuAssertStrEquals(tc, _T("enum term"), _T("a5"), terms->term(false)->text());
+  terms->close();
+  _CLDELETE(terms);
+
+  // terms which don't exist are not cached
+  Term* missing = _CLNEW Term(_T("field1"), _T("zz"));
+  CuAssertIntEquals(tc, _T("missing docFreq"), 0, reader->docFreq(missing));
+  CuAssertIntEquals(tc, _T("missing docFreq"), 0, reader->docFreq(missing));
+  reader->getTermInfosCacheStats(hits, misses);
+  CuAssertIntEquals(tc, _T("hits"), 2, (int)hits);
+  CuAssertIntEquals(tc, _T("misses"), 3, (int)misses);
+
+  _CLDECDELETE(missing);
+  _CLDECDELETE(term);
+  reader->close();
+  _CLDELETE(reader);
+}
+
+void testDocuments(CuTest *tc){
+  RAMDirectory dir;
+  createIndex(tc, &dir, true);
+  IndexReader* reader = IndexReader::open(&dir);
+
+  const int32_t ids[] = {57, 3, 99, 4, 5, 30, 3, 0};
+  ValueArray<int32_t> docs(8);
+  for (int i = 0; i < 8; i++)
+    docs[i] = ids[i];
+
+  ObjectArray<Document> result;
+  CuAssertTrue(tc, reader->documents(docs, result));
+  CuAssertIntEquals(tc, _T("result length"), 8, (int)result.length);
+  TCHAR expected[20];
+  for (int i = 0; i < 8; i++){
+    _sntprintf(expected, 20, _T("a%d"), ids[i]);
+    CuAssertStrEquals(tc, _T("field1"), expected, result[i]->get(_T("field1")));
+    CuAssertIntEquals(tc, _T("fields"), 4, (int)result[i]->getFields()->size());
+  }
+
+  // the documents are reused, and lazy fields point into the right place
+  Document* first = result[0];
+  MapFieldSelector selector;
+  selector.add(_T("field1"), FieldSelector::LOAD);
+  selector.add(_T("field4"), FieldSelector::LAZY_LOAD);
+  CuAssertTrue(tc, reader->documents(docs, result, &selector));
+  CuAssertTrue(tc, result[0] == first);
+  for (int i = 0; i < 8; i++){
+    _sntprintf(expected, 20, _T("a%d"), ids[i]);
+    CuAssertStrEquals(tc, _T("field1"), expected, result[i]->get(_T("field1")));
+    _sntprintf(expected, 20, _T("a%d b%d"), ids[i], ids[i]);
+    CuAssertStrEquals(tc, _T("lazy field4"), expected, result[i]->get(_T("field4")));
+    CuAssertIntEquals(tc, _T("selected fields"), 2, (int)result[i]->getFields()->size());
+  }
+
+  // numbers outside of the index are rejected
+  const int32_t badIds[2][2] = { {0, reader->maxDoc()}, {-1, 0} };
+  for (int i = 0; i < 2; i++){
+    ValueArray<int32_t> bad(2);
+    bad[0] = badIds[i][0];
+    bad[1] = badIds[i][1];
+    try{
+      reader->documents(bad, result);
+      CuFail(tc, _T("document out of range was loaded"));
+    }catch(CLuceneError& err){
+      if ( err.number() != CL_ERR_IndexOutOfBounds )
+        throw;
+    }
+  }
+
+  result.deleteValues();
+  reader->close();
+  _CLDELETE(reader);
+}
+
 CuSuite *testindexreader(void)
 {
 	CuSuite *suite = CuSuiteNew(_T("CLucene IndexReader Test"));
   SUITE_ADD_TEST(suite, testIndexReaderReopen);
   SUITE_ADD_TEST(suite, testMultiReaderReopen);
+  SUITE_ADD_TEST(suite, testDocumentCache);
+  SUITE_ADD_TEST(suite, testTermInfosCache);
+  SUITE_ADD_TEST(suite, testDocuments);
 
   return suite;
 }
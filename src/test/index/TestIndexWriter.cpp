@@ -7,6 +7,7 @@
 #include "test.h"
 #include <CLucene/search/MatchAllDocsQuery.h>
 #include <stdio.h>
+#include <algorithm>
 
 //checks if a merged index finds phrases correctly
 void testIWmergePhraseSegments(CuTest *tc){
@@ -647,6 +648,150 @@ void testMergeIndex(CuTest* tc) {
   _CLLDELETE( dir );
 }
 
+/** Records the files synced, in order */
+class SyncRecordingDirectory: public RAMDirectory{
+public:
+	std::vector<std::string> synced;
+	void sync(const std::vector<std::string>& names){
+		synced.insert(synced.end(), names.begin(), names.end());
+	}
+};
+
+void testSyncOnCommit(CuTest* tc) {
+	SyncRecordingDirectory dir;
+	SimpleAnalyzer a;
+	IndexWriter writer(&dir, &a, true);
+	writer.setUseCompoundFile(false);
+	Document doc;
+	doc.add(*_CLNEW Field(_T("field0"), _T("value0"), Field::STORE_YES | Field::INDEX_TOKENIZED));
+	writer.addDocument(&doc);
+	writer.close();
+
+	// the files of the segment are synced before the segments file that refers to them
+	std::vector<std::string> names;
+	dir.list(&names);
+	std::vector<std::string>::iterator commit = dir.synced.end();
+	for ( size_t i=0;i<names.size();i++ ){
+		if ( names[i].compare(0, 9, "segments_") == 0 )
+			commit = std::find(dir.synced.begin(), dir.synced.end(), names[i]);
+	}
+	CLUCENE_ASSERT(commit != dir.synced.end());
+	for ( size_t i=0;i<names.size();i++ ){
+		if ( names[i].compare(0, 8, "segments") == 0 )
+			continue;
+		std::vector<std::string>::iterator file = std::find(dir.synced.begin(), dir.synced.end(), names[i]);
+		CLUCENE_ASSERT(file != dir.synced.end());
+		CLUCENE_ASSERT(file < commit);
+	}
+
+	// an FSDirectory syncs the files written since the last sync
+	char fsdir[CL_MAX_PATH];
+	_snprintf(fsdir, CL_MAX_PATH, "%s/%s", cl_tempDir, "test.sync");
+	Directory* fs = FSDirectory::getDirectory(fsdir);
+	IndexWriter fswriter(fs, &a, true);
+	for ( int32_t i=0;i<20;i++ )
+		fswriter.addDocument(&doc);
+	fswriter.close();
+	names.clear();
+	fs->list(&names);
+	fs->sync(names);
+	IndexReader* reader = IndexReader::open(fs);
+	CuAssertIntEquals(tc, _T("docs"), 20, reader->numDocs());
+	reader->close();
+	_CLLDELETE(reader);
+	fs->close();
+	_CLDECDELETE(fs);
+}
+
+void testMergeRateLimit(CuTest* tc) {
+	RAMDirectory dir;
+	SimpleAnalyzer a;
+	IndexWriter writer(&dir, &a, true);
+	writer.setMaxBufferedDocs(10);
+	writer.setMergeFactor(2);
+	CLUCENE_ASSERT(writer.getMaxMergeMBPerSec() == 0);
+	RateLimiter* limiter = writer.getMergeRateLimiter();
+	CLUCENE_ASSERT(limiter != NULL);
+	writer.setMaxMergeMBPerSec(2);
+	CLUCENE_ASSERT(writer.getMaxMergeMBPerSec() == 2);
+
+	TCHAR buf[256];
+	for ( int32_t i=0;i<200;i++ ){
+		Document doc;
+		_sntprintf(buf, 256, _T("doc%d some words to make the merged segments bigger %d %d %d"), i, i*3, i*7, i*11);
+		doc.add(*_CLNEW Field(_T("contents"), buf, Field::STORE_YES | Field::INDEX_TOKENIZED));
+		writer.addDocument(&doc);
+	}
+	writer.optimize();
+
+	// only merges went through the limiter, and they were slowed down
+	CLUCENE_ASSERT(limiter->getBytes() > 0);
+	CLUCENE_ASSERT(limiter->getPauseCount() > 0);
+	CLUCENE_ASSERT(limiter->getPausedMillis() > 0);
+
+	// turning the limit off keeps the statistics but stops pausing
+	writer.setMaxMergeMBPerSec(0);
+	CLUCENE_ASSERT(writer.getMergeRateLimiter() == limiter);
+	const int64_t pauses = limiter->getPauseCount();
+	CuAssertIntEquals(tc, _T("no pause"), 0, (int32_t)limiter->pause(10*1024*1024));
+	CLUCENE_ASSERT(limiter->getPauseCount() == pauses);
+	writer.close();
+
+	IndexReader* reader = IndexReader::open(&dir);
+	CuAssertIntEquals(tc, _T("docs"), 200, reader->numDocs());
+	reader->close();
+	_CLLDELETE(reader);
+}
+
+/** Sets the merge rate of a writer when the first file is created after it is armed */
+class MergeRateDirectory: public RAMDirectory{
+public:
+	IndexWriter* writer;
+	bool armed;
+	MergeRateDirectory(): writer(NULL), armed(false){}
+	IndexOutput* createOutput(const char* name){
+		if ( armed ){
+			armed = false;
+			writer->setMaxMergeMBPerSec(2);
+		}
+		return RAMDirectory::createOutput(name);
+	}
+};
+
+// a rate set while a merge runs applies to it, though it started unlimited
+void testMergeRateLimitWhileMerging(CuTest* tc) {
+	MergeRateDirectory dir;
+	SimpleAnalyzer a;
+	IndexWriter writer(&dir, &a, true);
+	writer.setMaxBufferedDocs(10);
+	writer.setMergeFactor(100);
+	TCHAR buf[256];
+	for ( int32_t i=0;i<200;i++ ){
+		Document doc;
+		_sntprintf(buf, 256, _T("doc%d some words to make the merged segments bigger %d %d %d"), i, i*3, i*7, i*11);
+		doc.add(*_CLNEW Field(_T("contents"), buf, Field::STORE_YES | Field::INDEX_TOKENIZED));
+		writer.addDocument(&doc);
+	}
+	writer.flush();
+	RateLimiter* limiter = writer.getMergeRateLimiter();
+	CLUCENE_ASSERT(limiter->getBytes() == 0);
+
+	// the only files optimize creates are those of the merge
+	dir.writer = &writer;
+	dir.armed = true;
+	writer.optimize();
+	CLUCENE_ASSERT(!dir.armed);
+	CLUCENE_ASSERT(writer.getMaxMergeMBPerSec() == 2);
+	CLUCENE_ASSERT(limiter->getBytes() > 0);
+	CLUCENE_ASSERT(limiter->getPauseCount() > 0);
+	writer.close();
+
+	IndexReader* reader = IndexReader::open(&dir);
+	CuAssertIntEquals(tc, _T("docs"), 200, reader->numDocs());
+	reader->close();
+	_CLLDELETE(reader);
+}
+
 CuSuite *testindexwriter(void)
 {
     CuSuite *suite = CuSuiteNew(_T("CLucene IndexWriter Test"));
@@ -664,6 +809,9 @@ CuSuite *testindexwriter(void)
     SUITE_ADD_TEST(suite, testExceptionFromTokenStream);
     SUITE_ADD_TEST(suite, testDeleteDocument);
     SUITE_ADD_TEST(suite, testMergeIndex);
+    SUITE_ADD_TEST(suite, testSyncOnCommit);
+    SUITE_ADD_TEST(suite, testMergeRateLimit);
+    SUITE_ADD_TEST(suite, testMergeRateLimitWhileMerging);
 
     return suite;
 }
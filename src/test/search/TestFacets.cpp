@@ -0,0 +1,150 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "test.h"
+#include "CLucene/search/FacetCollector.h"
+#include "CLucene/search/MatchAllDocsQuery.h"
+
+// category is a hierarchical single valued field, tags a multi valued field
+// and color a doc values field. The index is written in several segments.
+static const TCHAR* facets_data[][5] = {
+	// contents    category                    tags                color
+	{ _T("x"),     _T("books/fiction"),        _T("new sale"),     _T("red") },
+	{ _T("x y"),   _T("books/science"),        _T("new"),          _T("blue") },
+	{ _T("y"),     _T("books/fiction/crime"),  NULL,               _T("red") },
+	{ _T("x"),     _T("music/rock"),           _T("sale"),         _T("green") },
+	{ _T("x y"),   _T("music"),                _T("new sale used"),_T("red") },
+	{ _T("y"),     _T("books/fiction"),        _T("used"),         NULL },
+	{ _T("x"),     _T("movies"),               _T("new"),          _T("blue") },
+	{ _T("x"),     _T("books/science"),        NULL,               _T("red") },
+	{ _T("y"),     _T("music/rock"),           _T("sale new"),     NULL },
+	{ _T("x y"),   _T("books"),                _T("new"),          _T("blue") }
+};
+
+static void facets_createIndex(Directory* dir){
+	WhitespaceAnalyzer analyzer;
+	IndexWriter writer(dir, &analyzer, true);
+	writer.setMaxBufferedDocs(3);
+	for ( size_t i=0;i<sizeof(facets_data)/sizeof(facets_data[0]);i++ ){
+		Document doc;
+		doc.add(*_CLNEW Field(_T("contents"), facets_data[i][0], Field::STORE_NO | Field::INDEX_TOKENIZED));
+		doc.add(*_CLNEW Field(_T("category"), facets_data[i][1], Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+		if ( facets_data[i][2] != NULL ){
+			TCHAR tags[64];
+			_tcscpy(tags, facets_data[i][2]);
+			TCHAR* end = tags;
+			for ( TCHAR* tag = tags; tag != NULL && *tag; tag = end ){
+				end = _tcschr(tag, ' ');
+				if ( end != NULL )
+					*end++ = 0;
+				doc.add(*_CLNEW Field(_T("tags"), tag, Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+			}
+		}
+		if ( facets_data[i][3] != NULL )
+			doc.add(*_CLNEW Field(_T("color"), facets_data[i][3], Field::STORE_NO | Field::INDEX_NO | Field::DOCVALUES_STRING));
+		writer.addDocument(&doc);
+	}
+	writer.close();
+}
+
+// checks the top values, given as "value:count value:count"
+static void facets_assertTop(CuTest* tc, FacetCollector& facets, const TCHAR* field, int32_t n,
+		const TCHAR* parent, const TCHAR* expected, int32_t distinct){
+	FacetResult* result = facets.getTopValues(field, n, parent);
+	StringBuffer buf;
+	for ( int32_t i=0;i<result->valuesLength;i++ ){
+		if ( i > 0 )
+			buf.appendChar(' ');
+		buf.append(result->values[i].value);
+		buf.appendChar(':');
+		buf.appendInt(result->values[i].count);
+	}
+	CuAssertStrEquals(tc, field, expected, buf.getBuffer());
+	CuAssertIntEquals(tc, _T("distinct values"), distinct, result->distinctValues);
+	_CLDELETE(result);
+}
+
+void testFacetCounts(CuTest *tc){
+	RAMDirectory dir;
+	facets_createIndex(&dir);
+	IndexReader* reader = IndexReader::open(&dir);
+	CLUCENE_ASSERT(!reader->isOptimized());
+	IndexSearcher searcher(reader);
+
+	FacetCollector facets(reader);
+	facets.addField(_T("category"), false, '/');
+	facets.addField(_T("tags"), true);
+	facets.addField(_T("color"));
+
+	Term* t = _CLNEW Term(_T("contents"), _T("x"));
+	TermQuery query(t);
+	_CLDECDELETE(t);
+	searcher._search(&query, NULL, &facets);
+
+	CuAssertIntEquals(tc, _T("total hits"), 7, facets.getTotalHits());
+	facets_assertTop(tc, facets, _T("category"), 10, NULL, _T("books:4 music:2 movies:1"), 3);
+	facets_assertTop(tc, facets, _T("category"), 10, _T("books"), _T("books/science:2 books/fiction:1"), 2);
+	facets_assertTop(tc, facets, _T("category"), 10, _T("books/fiction"), _T(""), 0);
+	facets_assertTop(tc, facets, _T("category"), 10, _T("music"), _T("music/rock:1"), 1);
+	facets_assertTop(tc, facets, _T("tags"), 10, NULL, _T("new:5 sale:3 used:1"), 3);
+	facets_assertTop(tc, facets, _T("color"), 2, NULL, _T("blue:3 red:3"), 3);
+	CuAssertIntEquals(tc, _T("count"), 1, facets.getCount(_T("category"), _T("books/fiction")));
+	CuAssertIntEquals(tc, _T("count"), 0, facets.getCount(_T("tags"), _T("none")));
+
+	// the loaded segment data is reused after a reset
+	facets.reset();
+	MatchAllDocsQuery all;
+	searcher._search(&all, NULL, &facets);
+
+	CuAssertIntEquals(tc, _T("total hits"), 10, facets.getTotalHits());
+	facets_assertTop(tc, facets, _T("category"), 1, NULL, _T("books:6"), 3);
+	facets_assertTop(tc, facets, _T("category"), 10, _T("books"), _T("books/fiction:3 books/science:2"), 2);
+	facets_assertTop(tc, facets, _T("category"), 10, _T("books/fiction"), _T("books/fiction/crime:1"), 1);
+	facets_assertTop(tc, facets, _T("tags"), 10, NULL, _T("new:6 sale:4 used:2"), 3);
+	facets_assertTop(tc, facets, _T("color"), 10, NULL, _T("red:4 blue:3 green:1"), 3);
+	facets_assertTop(tc, facets, _T("category"), 10, _T("none"), _T(""), 0);
+
+	searcher.close();
+	reader->close();
+	_CLDELETE(reader);
+}
+
+// without a reset, the counts of a second search add up with the first,
+// also for documents both searches hit
+void testFacetCollectTwice(CuTest *tc){
+	RAMDirectory dir;
+	facets_createIndex(&dir);
+	IndexReader* reader = IndexReader::open(&dir);
+	IndexSearcher searcher(reader);
+
+	FacetCollector facets(reader);
+	facets.addField(_T("category"), false, '/');
+	facets.addField(_T("tags"), true);
+
+	Term* t = _CLNEW Term(_T("contents"), _T("x"));
+	TermQuery query(t);
+	_CLDECDELETE(t);
+	searcher._search(&query, NULL, &facets);
+	searcher._search(&query, NULL, &facets);
+
+	CuAssertIntEquals(tc, _T("total hits"), 14, facets.getTotalHits());
+	facets_assertTop(tc, facets, _T("category"), 10, NULL, _T("books:8 music:4 movies:2"), 3);
+	facets_assertTop(tc, facets, _T("category"), 10, _T("books"), _T("books/science:4 books/fiction:2"), 2);
+	facets_assertTop(tc, facets, _T("category"), 10, _T("music"), _T("music/rock:2"), 1);
+	facets_assertTop(tc, facets, _T("tags"), 10, NULL, _T("new:10 sale:6 used:2"), 3);
+
+	searcher.close();
+	reader->close();
+	_CLDELETE(reader);
+}
+
+CuSuite *testfacets(void)
+{
+	CuSuite *suite = CuSuiteNew(_T("CLucene Facets Test"));
+	SUITE_ADD_TEST(suite, testFacetCounts);
+	SUITE_ADD_TEST(suite, testFacetCollectTwice);
+	return suite;
+}
@@ -0,0 +1,193 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "test.h"
+#include "CLucene/search/FunctionQuery.h"
+#include "CLucene/search/ValueSource.h"
+#include <math.h>
+
+static const TCHAR* function_data[][3] = {
+	// price        rating       contents
+	{ _T("30"),     _T("4.5"),   _T("x x x") },
+	{ _T("10"),     _T("2.0"),   _T("x") },
+	{ _T("20"),     _T("3.5"),   _T("x y") },
+	{ _T("50"),     _T("1.0"),   _T("y z") },
+	{ _T("40"),     _T("5.0"),   _T("x x") },
+	{ _T("5"),      _T("0.5"),   _T("x") },
+	{ _T("60"),     _T("2.5"),   _T("x z") },
+	{ _T("15"),     _T("4.0"),   _T("y") },
+	{ _T("25"),     _T("3.0"),   _T("x") },
+	{ NULL,         NULL,        _T("x y") } // alone in the last segment
+};
+static const int32_t function_numDocs = sizeof(function_data)/sizeof(function_data[0]);
+
+static void function_createIndex(Directory* dir){
+	WhitespaceAnalyzer analyzer;
+	IndexWriter writer(dir, &analyzer, true);
+	writer.setMaxBufferedDocs(3);
+	for ( int32_t i=0;i<function_numDocs;i++ ){
+		Document doc;
+		if ( function_data[i][0] != NULL ){
+			doc.add(*_CLNEW Field(_T("price"), function_data[i][0], Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+			doc.add(*_CLNEW Field(_T("rating"), function_data[i][1], Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+		}
+		doc.add(*_CLNEW Field(_T("contents"), function_data[i][2], Field::STORE_NO | Field::INDEX_TOKENIZED));
+		writer.addDocument(&doc);
+	}
+	writer.close();
+}
+
+static float_t function_price(int32_t doc){
+	return function_data[doc][0] == NULL ? 0 : (float_t)_ttoi(function_data[doc][0]);
+}
+static float_t function_rating(int32_t doc){
+	return function_data[doc][1] == NULL ? 0 : (float_t)_tcstod(function_data[doc][1], NULL);
+}
+
+static bool function_close(float_t a, float_t b){
+	return fabs(a - b) <= 0.0001f * (fabs(a) + fabs(b) + 1);
+}
+
+/** Records the score of every matching document */
+class FunctionScoreCollector: public HitCollector{
+public:
+	float_t scores[function_numDocs];
+	FunctionScoreCollector(){
+		for ( int32_t i=0;i<function_numDocs;i++ )
+			scores[i] = -1;
+	}
+	void collect(const int32_t doc, const float_t score){
+		if ( score > 0.0f ) // ignore zeroed buckets, as the searcher does
+			scores[doc] = score;
+	}
+};
+
+// checks that the scores of query are expected(doc) and agree with explain
+static void function_check(CuTest* tc, IndexSearcher* searcher, Query* query,
+		float_t (*expected)(int32_t, const float_t*), const float_t* termScores){
+	FunctionScoreCollector collector;
+	searcher->_search(query, NULL, &collector);
+	for ( int32_t i=0;i<function_numDocs;i++ ){
+		const float_t want = expected(i, termScores);
+		if ( want <= 0 ){
+			CLUCENE_ASSERT(collector.scores[i] == -1);
+			continue;
+		}
+		CLUCENE_ASSERT(function_close(want, collector.scores[i]));
+
+		Explanation expl;
+		searcher->explain(query, i, &expl);
+		CLUCENE_ASSERT(function_close(collector.scores[i], expl.getDetail(0)->getValue()));
+	}
+}
+
+static float_t function_expectPrice(int32_t doc, const float_t*){
+	return function_price(doc);
+}
+static float_t function_expectLinear(int32_t doc, const float_t*){
+	return 2 * function_price(doc) + 5; // documents without a price get 0
+}
+static float_t function_expectReciprocal(int32_t doc, const float_t*){
+	return 10 / (function_rating(doc) + 1);
+}
+static float_t function_expectLogProduct(int32_t doc, const float_t* termScores){
+	return termScores[doc] < 0 ? 0 : termScores[doc] * (float_t)log10(1 + function_price(doc));
+}
+static float_t function_expectSum(int32_t doc, const float_t* termScores){
+	return termScores[doc] < 0 ? 0 : termScores[doc] + function_rating(doc);
+}
+static float_t function_expectBoostedSum(int32_t doc, const float_t* termScores){
+	return 2 * function_expectSum(doc, termScores);
+}
+
+void testFunctionQueryScores(CuTest *tc){
+	RAMDirectory dir;
+	function_createIndex(&dir);
+	IndexReader* reader = IndexReader::open(&dir);
+	IndexSearcher searcher(reader);
+
+	// the value is the score
+	FunctionQuery byPrice(_CLNEW FieldValueSource(_T("price"), SortField::INT));
+	function_check(tc, &searcher, &byPrice, function_expectPrice, NULL);
+
+	TopDocs* top = searcher._search(&byPrice, NULL, 3);
+	CuAssertIntEquals(tc, _T("hits"), function_numDocs-1, top->totalHits);
+	CuAssertIntEquals(tc, _T("1st"), 6, top->scoreDocs[0].doc);
+	CuAssertIntEquals(tc, _T("2nd"), 3, top->scoreDocs[1].doc);
+	CuAssertIntEquals(tc, _T("3rd"), 4, top->scoreDocs[2].doc);
+	_CLDELETE(top);
+
+	FunctionQuery linear(_CLNEW LinearFloatFunction(_CLNEW FieldValueSource(_T("price"), SortField::INT), 2, 5));
+	function_check(tc, &searcher, &linear, function_expectLinear, NULL);
+
+	FunctionQuery reciprocal(_CLNEW ReciprocalFloatFunction(_CLNEW FieldValueSource(_T("rating"), SortField::FLOAT), 1, 10, 1));
+	function_check(tc, &searcher, &reciprocal, function_expectReciprocal, NULL);
+
+	searcher.close();
+	reader->close();
+	_CLDELETE(reader);
+}
+
+void testCustomScoreQuery(CuTest *tc){
+	RAMDirectory dir;
+	function_createIndex(&dir);
+	IndexReader* reader = IndexReader::open(&dir);
+	IndexSearcher searcher(reader);
+
+	Term* t = _CLNEW Term(_T("contents"), _T("x"));
+	TermQuery termQuery(t);
+	FunctionScoreCollector termScores;
+	searcher._search(&termQuery, NULL, &termScores);
+
+	CustomScoreQuery product(_CLNEW TermQuery(t),
+		_CLNEW LogFloatFunction(_CLNEW FieldValueSource(_T("price"), SortField::INT)));
+	function_check(tc, &searcher, &product, function_expectLogProduct, termScores.scores);
+
+	CustomScoreQuery sum(_CLNEW TermQuery(t),
+		_CLNEW FieldValueSource(_T("rating"), SortField::FLOAT), CustomScoreQuery::ADD);
+	function_check(tc, &searcher, &sum, function_expectSum, termScores.scores);
+
+	// the boost applies to the combined score
+	sum.setBoost(2);
+	function_check(tc, &searcher, &sum, function_expectBoostedSum, termScores.scores);
+	_CLDECDELETE(t);
+
+	searcher.close();
+	reader->close();
+	_CLDELETE(reader);
+}
+
+void testFunctionQueryEquals(CuTest *tc){
+	Term* t = _CLNEW Term(_T("contents"), _T("x"));
+	CustomScoreQuery query(_CLNEW TermQuery(t),
+		_CLNEW LinearFloatFunction(_CLNEW FieldValueSource(_T("price"), SortField::INT), 2, 5));
+	_CLDECDELETE(t);
+	CuAssertStrEquals(tc, _T("toString"), _T("custom(contents:x * 2.0*int(price)+5.0)"), query.toString(), true);
+
+	Query* clone = query.clone();
+	CLUCENE_ASSERT(query.equals(clone));
+	CLUCENE_ASSERT(query.hashCode() == clone->hashCode());
+	clone->setBoost(3);
+	CLUCENE_ASSERT(!query.equals(clone));
+	_CLDELETE(clone);
+
+	FunctionQuery a(_CLNEW LogFloatFunction(_CLNEW FieldValueSource(_T("price"), SortField::INT)));
+	FunctionQuery b(_CLNEW LogFloatFunction(_CLNEW FieldValueSource(_T("price"), SortField::FLOAT)));
+	FunctionQuery c(_CLNEW LogFloatFunction(_CLNEW FieldValueSource(_T("price"), SortField::INT)));
+	CLUCENE_ASSERT(!a.equals(&b));
+	CLUCENE_ASSERT(a.equals(&c));
+	CLUCENE_ASSERT(a.hashCode() == c.hashCode());
+	CLUCENE_ASSERT(!a.equals(&query));
+}
+
+CuSuite *testfunctionquery(void)
+{
+	CuSuite *suite = CuSuiteNew(_T("CLucene Function Query Test"));
+	SUITE_ADD_TEST(suite, testFunctionQueryScores);
+	SUITE_ADD_TEST(suite, testCustomScoreQuery);
+	SUITE_ADD_TEST(suite, testFunctionQueryEquals);
+	return suite;
+}
@@ -0,0 +1,145 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "test.h"
+#include "CLucene/search/GroupingCollector.h"
+
+static const TCHAR* grouping_data[][3] = {
+	// family     price        contents
+	{ _T("A"),    _T("30"),    _T("x x x") },
+	{ _T("B"),    _T("10"),    _T("x") },
+	{ _T("A"),    _T("20"),    _T("x y") },
+	{ _T("C"),    _T("50"),    _T("x y z") },
+	{ _T("B"),    _T("40"),    _T("x x") },
+	{ NULL,       _T("5"),     _T("x") },
+	{ _T("D"),    _T("60"),    _T("x z") },
+	{ _T("A"),    _T("15"),    _T("y") },
+	{ _T("C"),    _T("25"),    _T("x") },
+	{ _T("B"),    _T("35"),    _T("x y") },
+	{ _T("D"),    _T("70"),    _T("x x z") },
+	{ _T("A"),    _T("12"),    _T("x") }
+};
+static const int32_t grouping_numDocs = sizeof(grouping_data)/sizeof(grouping_data[0]);
+
+static void grouping_createIndex(Directory* dir){
+	WhitespaceAnalyzer analyzer;
+	IndexWriter writer(dir, &analyzer, true);
+	writer.setMaxBufferedDocs(4);
+	for ( int32_t i=0;i<grouping_numDocs;i++ ){
+		Document doc;
+		if ( grouping_data[i][0] != NULL )
+			doc.add(*_CLNEW Field(_T("family"), grouping_data[i][0], Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+		doc.add(*_CLNEW Field(_T("price"), grouping_data[i][1], Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+		doc.add(*_CLNEW Field(_T("contents"), grouping_data[i][2], Field::STORE_NO | Field::INDEX_TOKENIZED));
+		writer.addDocument(&doc);
+	}
+	writer.close();
+}
+
+// formats the groups as "value(totalHits):doc,doc;..."
+static void grouping_format(TopGroups* groups, StringBuffer& buf){
+	for ( int32_t i=0;i<groups->groupsLength;i++ ){
+		GroupDocs* group = groups->groups[i];
+		buf.append(group->groupValue == NULL ? _T("-") : group->groupValue);
+		buf.appendChar('(');
+		buf.appendInt(group->totalHits);
+		buf.append(_T("):"));
+		for ( int32_t j=0;j<group->scoreDocsLength;j++ ){
+			if ( j > 0 )
+				buf.appendChar(',');
+			buf.appendInt(group->scoreDocs[j].doc);
+		}
+		buf.appendChar(';');
+	}
+}
+
+static TopGroups* grouping_search(Searcher* searcher, IndexReader* reader, Query* query,
+		const Sort* groupSort, int32_t topNGroups, const Sort* withinGroupSort, int32_t docsPerGroup){
+	FirstPassGroupingCollector first(reader, _T("family"), groupSort, topNGroups);
+	searcher->_search(query, NULL, &first);
+	SecondPassGroupingCollector second(&first, withinGroupSort, docsPerGroup);
+	searcher->_search(query, NULL, &second);
+	return second.getTopGroups();
+}
+
+void testGroupingSorted(CuTest *tc){
+	RAMDirectory dir;
+	grouping_createIndex(&dir);
+	IndexReader* reader = IndexReader::open(&dir);
+	IndexSearcher searcher(reader);
+	Term* t = _CLNEW Term(_T("contents"), _T("x"));
+	TermQuery query(t);
+	_CLDECDELETE(t);
+	Sort byPrice(_T("price"));
+
+	// groups ranked by their cheapest document
+	TopGroups* groups = grouping_search(&searcher, reader, &query, &byPrice, 3, &byPrice, 2);
+	StringBuffer buf;
+	grouping_format(groups, buf);
+	CuAssertStrEquals(tc, _T("top groups"), _T("-(1):5;B(3):1,9;A(3):11,2;"), buf.getBuffer());
+	CuAssertIntEquals(tc, _T("total hits"), 11, groups->totalHits);
+	_CLDELETE(groups);
+
+	// more groups requested than there are
+	Sort byPriceReverse(_T("price"), true);
+	groups = grouping_search(&searcher, reader, &query, &byPriceReverse, 10, &byPrice, 1);
+	buf.clear();
+	grouping_format(groups, buf);
+	CuAssertStrEquals(tc, _T("all groups"), _T("D(2):6;C(2):8;B(3):1;A(3):11;-(1):5;"), buf.getBuffer());
+	_CLDELETE(groups);
+
+	searcher.close();
+	reader->close();
+	_CLDELETE(reader);
+}
+
+void testGroupingRelevance(CuTest *tc){
+	RAMDirectory dir;
+	grouping_createIndex(&dir);
+	IndexReader* reader = IndexReader::open(&dir);
+	IndexSearcher searcher(reader);
+	Term* t = _CLNEW Term(_T("contents"), _T("x"));
+	TermQuery query(t);
+	_CLDECDELETE(t);
+
+	TopGroups* groups = grouping_search(&searcher, reader, &query, NULL, 4, NULL, 10);
+	CuAssertIntEquals(tc, _T("groups"), 4, groups->groupsLength);
+	float_t lastMaxScore = 0;
+	for ( int32_t i=0;i<groups->groupsLength;i++ ){
+		GroupDocs* group = groups->groups[i];
+		// all hits of the group fit
+		int32_t expected = 0;
+		for ( int32_t j=0;j<grouping_numDocs;j++ ){
+			const TCHAR* family = grouping_data[j][0];
+			const bool sameGroup = family == NULL || group->groupValue == NULL ?
+				family == group->groupValue : _tcscmp(family, group->groupValue) == 0;
+			if ( sameGroup && _tcschr(grouping_data[j][2], 'x') != NULL )
+				expected++;
+		}
+		CuAssertIntEquals(tc, _T("group hits"), expected, group->totalHits);
+		CuAssertIntEquals(tc, _T("group docs"), expected, group->scoreDocsLength);
+
+		// groups by descending best score, docs by descending score
+		CLUCENE_ASSERT(group->scoreDocs[0].score == group->maxScore);
+		CLUCENE_ASSERT(i == 0 || group->maxScore <= lastMaxScore);
+		lastMaxScore = group->maxScore;
+		for ( int32_t j=1;j<group->scoreDocsLength;j++ )
+			CLUCENE_ASSERT(group->scoreDocs[j].score <= group->scoreDocs[j-1].score);
+	}
+	_CLDELETE(groups);
+
+	searcher.close();
+	reader->close();
+	_CLDELETE(reader);
+}
+
+CuSuite *testgrouping(void)
+{
+	CuSuite *suite = CuSuiteNew(_T("CLucene Grouping Test"));
+	SUITE_ADD_TEST(suite, testGroupingSorted);
+	SUITE_ADD_TEST(suite, testGroupingRelevance);
+	return suite;
+}
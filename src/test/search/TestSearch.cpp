@@ -394,6 +394,49 @@ void testSrchManyHits(CuTest* /*tc*/) {
 	searcher.close();
 }
 
+void testSrchTopDocs(CuTest *tc) {
+  SimpleAnalyzer analyzer;
+	RAMDirectory ram;
+	IndexWriter writer( &ram, &analyzer, true);
+	for (int j = 0; j < 50; j++) {
+		Document* d = _CLNEW Document();
+		d->add(*_CLNEW Field(_T("contents"), j%3==0 ? _T("a a b") : _T("a b c"),Field::STORE_YES | Field::INDEX_TOKENIZED));
+		writer.addDocument(d);
+		_CLDELETE(d);
+	}
+	writer.close();
+
+	IndexSearcher searcher(&ram);
+	Term* t = _CLNEW Term(_T("contents"), _T("a"));
+	TermQuery query(t);
+	_CLDECDELETE(t);
+
+	//the pooled hit queue is reused by each search and sized by maxDoc, not nDocs
+	for ( int32_t n = 1; n <= 1000; n *= 10 ){
+		TopDocs* docs = searcher._search(&query, NULL, n);
+		CuAssertIntEquals(tc, _T("totalHits"), 50, docs->totalHits);
+		CuAssertIntEquals(tc, _T("scoreDocsLength"), n < 50 ? n : 50, docs->scoreDocsLength);
+		for ( int32_t i = 1; i < docs->scoreDocsLength; i++ ){
+			const ScoreDoc& prev = docs->scoreDocs[i-1];
+			const ScoreDoc& cur = docs->scoreDocs[i];
+			CLUCENE_ASSERT( prev.score > cur.score || (prev.score == cur.score && prev.doc < cur.doc) );
+		}
+		if ( n >= 50 )
+			CuAssertIntEquals(tc, _T("last doc"), 49, docs->scoreDocs[49].doc);
+		_CLDELETE(docs);
+	}
+
+	//no matches leaves no sentinels behind
+	t = _CLNEW Term(_T("contents"), _T("z"));
+	TermQuery none(t);
+	_CLDECDELETE(t);
+	TopDocs* docs = searcher._search(&none, NULL, 10);
+	CuAssertIntEquals(tc, _T("totalHits"), 0, docs->totalHits);
+	CuAssertIntEquals(tc, _T("scoreDocsLength"), 0, docs->scoreDocsLength);
+	_CLDELETE(docs);
+	searcher.close();
+}
+
 void testSrchMulti(CuTest *tc) {
   SimpleAnalyzer analyzer;
 	RAMDirectory ram0;
@@ -467,6 +510,7 @@ CuSuite *testsearch(void)
 
 	SUITE_ADD_TEST(suite, testNormEncoding);
 	SUITE_ADD_TEST(suite, testSrchManyHits);
+	SUITE_ADD_TEST(suite, testSrchTopDocs);
 	SUITE_ADD_TEST(suite, testSrchMulti);
 	SUITE_ADD_TEST(suite, testSrchOpenIndex);
 	SUITE_ADD_TEST(suite, testSrchPunctuation);
@@ -5,6 +5,8 @@
 * the GNU Lesser General Public License, as specified in the COPYING file.
 ------------------------------------------------------------------------------*/
 #include "test.h"
+#include "CLucene/search/FieldCache.h"
+#include "CLucene/search/_FieldDocSortedHitQueue.h"
 /**
  * Unit tests for sorting code.
  *
@@ -345,6 +347,395 @@ void testAutoSort(CuTest *tc) {
 	sortMatches (tc, sort_full, sort_queryY, _sort, _T("DJHFB"));
 }
 
+// writes the sort fields as doc values only, spread over several segments
+void sort_addDocValuesDocs (Directory* dir){
+	IndexWriter writer(dir, &sort_analyser, true);
+	writer.setMaxBufferedDocs(3);
+	writer.setUseCompoundFile(false);
+	for (int i=0; i<11; ++i) {
+		Document doc;
+		doc.add (*_CLNEW Field ( _T("tracer"),   data[i][0], Field::STORE_YES));
+		doc.add (*_CLNEW Field ( _T("contents"), data[i][1], Field::INDEX_TOKENIZED));
+		if (data[i][2] != NULL)
+			doc.add (*_CLNEW Field (_T("int"),    data[i][2], Field::STORE_NO | Field::INDEX_NO | Field::DOCVALUES_INT));
+		if (data[i][3] != NULL)
+			doc.add (*_CLNEW Field (_T("float"),  data[i][3], Field::STORE_NO | Field::INDEX_NO | Field::DOCVALUES_FLOAT));
+		if (data[i][4] != NULL)
+			doc.add (*_CLNEW Field (_T("string"), data[i][4], Field::STORE_NO | Field::INDEX_NO | Field::DOCVALUES_STRING));
+		writer.addDocument (&doc);
+	}
+	writer.close ();
+}
+
+// test sorts on fields which are not indexed but have doc values
+void testDocValuesSort(CuTest *tc){
+	RAMDirectory dir;
+	sort_addDocValuesDocs(&dir);
+
+	IndexReader* reader = IndexReader::open(&dir);
+	CLUCENE_ASSERT(!reader->isOptimized());
+	CuAssertIntEquals(tc, _T("int type"), Field::DOCVALUES_INT, reader->getDocValuesType(_T("int")));
+	CuAssertIntEquals(tc, _T("string type"), Field::DOCVALUES_STRING, reader->getDocValuesType(_T("string")));
+	CuAssertIntEquals(tc, _T("no doc values"), 0, reader->getDocValuesType(_T("contents")));
+	{
+		IndexSearcher searcher(reader);
+		SortField* sorts1[3] = { _CLNEW SortField (_T("int"), SortField::INT,false), SortField::FIELD_DOC(), NULL };
+		_sort->setSort (sorts1);
+		sortMatches (tc, &searcher, sort_queryX, _sort, _T("IGAEC"));
+		sortMatches (tc, &searcher, sort_queryY, _sort, _T("DHFJB"));
+
+		SortField* sorts2[3] = { _CLNEW SortField (_T("float"), SortField::FLOAT,false), SortField::FIELD_DOC(), NULL };
+		_sort->setSort (sorts2);
+		sortMatches (tc, &searcher, sort_queryX, _sort, _T("GCIEA"));
+		sortMatches (tc, &searcher, sort_queryY, _sort, _T("DHJFB"));
+
+		SortField* sorts3[3] = { _CLNEW SortField (_T("string"), SortField::STRING,false), SortField::FIELD_DOC(), NULL };
+		_sort->setSort (sorts3);
+		sortMatches (tc, &searcher, sort_queryX, _sort, _T("AIGEC"));
+		sortMatches (tc, &searcher, sort_queryY, _sort, _T("DJHFB"));
+
+		// documents without a value sort first
+		_sort->setSort ( _T("string"));
+		sortMatches (tc, &searcher, sort_queryF, _sort, _T("ZJI"));
+		_sort->setSort ( _T("int"), true);
+		sortMatches (tc, &searcher, sort_queryF, _sort, _T("JZI"));
+		searcher.close();
+	}
+
+	// delete A and merge everything into one compound segment
+	reader->deleteDocument(0);
+	reader->close();
+	_CLDELETE(reader);
+	{
+		IndexWriter writer(&dir, &sort_analyser, false);
+		writer.optimize();
+		writer.close();
+	}
+
+	IndexSearcher searcher(&dir);
+	_sort->setSort (_T("int"));
+	sortMatches (tc, &searcher, sort_queryX, _sort, _T("IGEC"));
+	_sort->setSort (_T("float"));
+	sortMatches (tc, &searcher, sort_queryY, _sort, _T("DHJFB"));
+	_sort->setSort (_T("string"), true);
+	sortMatches (tc, &searcher, sort_queryX, _sort, _T("CEGI"));
+	searcher.close();
+}
+
+// checks the doc values of a sparse field, which only the first document has
+void sort_checkSparseDocValues(CuTest *tc, IndexReader* reader){
+	CuAssertIntEquals(tc, _T("int type"), Field::DOCVALUES_INT, reader->getDocValuesType(_T("int")));
+	CuAssertIntEquals(tc, _T("float type"), Field::DOCVALUES_FLOAT, reader->getDocValuesType(_T("float")));
+	CuAssertIntEquals(tc, _T("string type"), Field::DOCVALUES_STRING, reader->getDocValuesType(_T("string")));
+
+	const int32_t* ints = FieldCache::DEFAULT()->getInts(reader, _T("int"))->intArray;
+	const float_t* floats = FieldCache::DEFAULT()->getFloats(reader, _T("float"))->floatArray;
+	TCHAR** strings = FieldCache::DEFAULT()->getStrings(reader, _T("string"))->stringArray;
+	CuAssertIntEquals(tc, _T("int value"), 5, ints[0]);
+	CLUCENE_ASSERT(floats[0] == 2.5f);
+	CuAssertStrEquals(tc, _T("string value"), _T("x"), strings[0]);
+	for ( int32_t i=1;i<reader->maxDoc();i++ ){
+		CuAssertIntEquals(tc, _T("no int value"), 0, ints[i]);
+		CLUCENE_ASSERT(floats[i] == 0);
+		CLUCENE_ASSERT(strings[i] == NULL);
+	}
+}
+
+// segments whose field infos list a doc values field without having a column for it
+void testSparseDocValues(CuTest *tc){
+	RAMDirectory dir;
+	{
+		IndexWriter writer(&dir, &sort_analyser, true);
+		writer.setMaxBufferedDocs(100);
+		for (int i=0; i<4; ++i) {
+			Document doc;
+			doc.add (*_CLNEW Field ( _T("contents"), _T("x"), Field::INDEX_TOKENIZED));
+			if (i == 0){
+				doc.add (*_CLNEW Field (_T("int"),    _T("5"),   Field::STORE_NO | Field::INDEX_NO | Field::DOCVALUES_INT));
+				doc.add (*_CLNEW Field (_T("float"),  _T("2.5"), Field::STORE_NO | Field::INDEX_NO | Field::DOCVALUES_FLOAT));
+				doc.add (*_CLNEW Field (_T("string"), _T("x"),   Field::STORE_NO | Field::INDEX_NO | Field::DOCVALUES_STRING));
+			}
+			writer.addDocument (&doc);
+			if (i == 0 || i == 2)
+				writer.flush();
+		}
+		writer.close ();
+	}
+
+	IndexReader* reader = IndexReader::open(&dir);
+	CLUCENE_ASSERT(reader->getSequentialSubReaders()->length == 3);
+	sort_checkSparseDocValues(tc, reader);
+	reader->close();
+	_CLDELETE(reader);
+
+	// the merged segment keeps the column
+	{
+		IndexWriter writer(&dir, &sort_analyser, false);
+		writer.optimize();
+		writer.close();
+	}
+	reader = IndexReader::open(&dir);
+	CLUCENE_ASSERT(reader->isOptimized());
+	sort_checkSparseDocValues(tc, reader);
+	reader->close();
+	_CLDELETE(reader);
+}
+
+// test the packed ords and shared term text of the string caches
+void testStringIndex(CuTest *tc){
+	IndexReader* reader = ((IndexSearcher*)sort_full)->getReader();
+	FieldCache::StringIndex* index = FieldCache::DEFAULT()->getStringIndex(reader, _T("string"))->stringIndex;
+	CuAssertIntEquals(tc, _T("count"), 11, index->count);
+	CuAssertIntEquals(tc, _T("no term"), 0, index->getOrd(10));
+	CuAssertIntEquals(tc, _T("ord of a"), 1, index->getOrd(3));
+	CuAssertIntEquals(tc, _T("ord of j"), 10, index->getOrd(2));
+	CLUCENE_ASSERT(index->getTerm(0) == NULL);
+	TCHAR* term = index->getTerm(index->getOrd(0));
+	CuAssertStrEquals(tc, _T("term of doc 0"), _T("c"), term);
+	_CLDELETE_CARRAY(term);
+	CLUCENE_ASSERT(index->ramBytesUsed() > 0);
+
+	// documents with the same term share its text
+	FieldCacheAuto* strings = FieldCache::DEFAULT()->getStrings(reader, _T("int"));
+	CuAssertStrEquals(tc, _T("string of doc 0"), _T("5"), strings->stringArray[0]);
+	CLUCENE_ASSERT(strings->stringArray[0] == strings->stringArray[1]);
+	CLUCENE_ASSERT(strings->stringArray[10] == NULL);
+
+#ifdef _UCS2
+	// terms outside of ascii survive the UTF-8 term block
+	TCHAR values[3][20];
+	lucene_utf8towcs(values[0], "z\xc3\xa9ro", 20);
+	lucene_utf8towcs(values[1], "caf\xc3\xa9", 20);
+	lucene_utf8towcs(values[2], "\xc3\xbc" "ber", 20);
+	RAMDirectory dir;
+	{
+		IndexWriter writer(&dir, &sort_analyser, true);
+		for ( int i=0;i<3;i++ ){
+			Document doc;
+			doc.add (*_CLNEW Field (_T("string"), values[i], Field::INDEX_UNTOKENIZED));
+			writer.addDocument (&doc);
+		}
+		writer.close();
+	}
+	IndexReader* reader2 = IndexReader::open(&dir);
+	index = FieldCache::DEFAULT()->getStringIndex(reader2, _T("string"))->stringIndex;
+	CuAssertIntEquals(tc, _T("count"), 4, index->count);
+	term = index->getTerm(index->getOrd(0));
+	CuAssertStrEquals(tc, _T("term of doc 0"), values[0], term);
+	_CLDELETE_CARRAY(term);
+	term = index->getTerm(3);
+	CuAssertStrEquals(tc, _T("last term"), values[2], term);
+	_CLDELETE_CARRAY(term);
+	reader2->close();
+	_CLDELETE(reader2);
+#endif
+}
+
+// make sure the top n documents of a sorted search match the expected list
+void sortTopMatches (CuTest *tc, Searcher* searcher, Query* query, Sort* sort, int32_t n, const TCHAR* expectedResult, int32_t totalHits=10){
+	TopFieldDocs* docs = static_cast<Searchable*>(searcher)->_search (query, NULL, n, sort);
+	StringBuffer buff(10);
+	for (int32_t i=0; i<docs->scoreDocsLength; ++i) {
+		Document doc;
+		searcher->doc(docs->fieldDocs[i]->scoreDoc.doc, &doc);
+		buff.append (doc.get(_T("tracer")));
+	}
+	CuAssertStrEquals (tc, _T("tracer value"), expectedResult, buff.getBuffer());
+	CuAssertIntEquals (tc, _T("total hits"), totalHits, docs->totalHits);
+	_CLDELETE(docs);
+}
+
+// test sorts where the queue fills up and later hits have to compete with its bottom
+void testTopSort(CuTest *tc){
+	SortField* sorts1[2] = { _CLNEW SortField (_T("int"), SortField::INT, false), NULL };
+	_sort->setSort (sorts1);
+	sortTopMatches (tc, sort_full, sort_queryA, _sort, 3, _T("IDH"));
+	sortTopMatches (tc, sort_full, sort_queryA, _sort, 9, _T("IDHFGJABE"));
+
+	SortField* sorts2[2] = { _CLNEW SortField (_T("int"), SortField::INT, true), NULL };
+	_sort->setSort (sorts2);
+	sortTopMatches (tc, sort_full, sort_queryA, _sort, 4, _T("CABE"));
+
+	SortField* sorts3[2] = { _CLNEW SortField (_T("float"), SortField::FLOAT, false), NULL };
+	_sort->setSort (sorts3);
+	sortTopMatches (tc, sort_full, sort_queryA, _sort, 5, _T("GDHJC"));
+
+	SortField* sorts4[2] = { _CLNEW SortField (_T("string"), SortField::STRING, false), NULL };
+	_sort->setSort (sorts4);
+	sortTopMatches (tc, sort_full, sort_queryA, _sort, 3, _T("DJA"));
+
+	SortField* sorts5[2] = { _CLNEW SortField (_T("string"), SortField::STRING, true), NULL };
+	_sort->setSort (sorts5);
+	sortTopMatches (tc, sort_full, sort_queryA, _sort, 3, _T("CBE"));
+
+	// automatic type and several fields go through the general queue
+	_sort->setSort (_T("int"));
+	sortTopMatches (tc, sort_full, sort_queryA, _sort, 3, _T("IDH"));
+	SortField* sorts6[3] = { _CLNEW SortField (_T("int"), SortField::INT, true), SortField::FIELD_DOC(), NULL };
+	_sort->setSort (sorts6);
+	sortTopMatches (tc, sort_full, sort_queryA, _sort, 4, _T("CABE"));
+}
+
+void sort_addIndexSortDoc (CuTest *tc, IndexWriter* writer, const TCHAR* tracer, const TCHAR* value, bool accepted,
+	int config=Field::STORE_NO | Field::INDEX_NO | Field::DOCVALUES_INT){
+	Document doc;
+	doc.add (*_CLNEW Field (_T("tracer"),   tracer, Field::STORE_YES));
+	doc.add (*_CLNEW Field (_T("contents"), _T("x"), Field::INDEX_UNTOKENIZED));
+	if (value != NULL)
+		doc.add (*_CLNEW Field (_T("int"), value, config));
+	try{
+		writer->addDocument (&doc);
+		CuAssertTrue (tc, accepted, _T("document should have been rejected"));
+	}catch(CLuceneError& err){
+		CuAssertTrue (tc, !accepted, _T("document should have been accepted"));
+		CuAssertIntEquals (tc, _T("error"), CL_ERR_IllegalArgument, err.number());
+	}
+}
+
+// test an index sort on the writer and early terminated searches over it
+void testIndexSort(CuTest *tc){
+	RAMDirectory dir;
+	{
+		IndexWriter writer(&dir, &sort_analyser, true);
+		writer.setMaxBufferedDocs(3);
+		writer.setIndexSort(_T("int"));
+		CuAssertStrEquals (tc, _T("index sort"), _T("int"), writer.getIndexSortField());
+		sort_addIndexSortDoc (tc, &writer, _T("A"), NULL, true);	// no value sorts as 0
+		const TCHAR* tracers[] = { _T("B"), _T("C"), _T("D"), _T("E"), _T("F"), _T("G"), _T("H"), _T("I"), _T("J") };
+		const TCHAR* values[] = { _T("1"), _T("1"), _T("2"), _T("3"), _T("5"), _T("8"), _T("13"), _T("21"), _T("34") };
+		for (int i=0; i<9; ++i)
+			sort_addIndexSortDoc (tc, &writer, tracers[i], values[i], true);
+		sort_addIndexSortDoc (tc, &writer, _T("X"), _T("33"), false);
+		sort_addIndexSortDoc (tc, &writer, _T("X"), NULL, false);
+		sort_addIndexSortDoc (tc, &writer, _T("X"), _T("40"), false, Field::STORE_NO | Field::INDEX_UNTOKENIZED);
+		sort_addIndexSortDoc (tc, &writer, _T("K"), _T("34"), true);
+		writer.close();
+	}
+
+	IndexSearcher searcher(&dir);
+	CuAssertIntEquals (tc, _T("docs"), 11, searcher.maxDoc());
+	CuAssertIntEquals (tc, _T("order"), FieldCacheAuto::ORDER_ASCENDING,
+		FieldCache::DEFAULT()->getInts(searcher.getReader(), _T("int"))->order);
+	Term* term = _CLNEW Term(_T("contents"), _T("x"));
+	TermQuery query(term);
+	_CLDECDELETE(term);
+
+	SortField* sorts1[2] = { _CLNEW SortField (_T("int"), SortField::INT, false), NULL };
+	_sort->setSort (sorts1);
+	sortTopMatches (tc, &searcher, &query, _sort, 4, _T("ABCD"), 11);
+	searcher.setEarlyTermination(true);
+	sortTopMatches (tc, &searcher, &query, _sort, 4, _T("ABCD"), 4);
+	sortTopMatches (tc, &searcher, &query, _sort, 20, _T("ABCDEFGHIJK"), 11);
+
+	// the reverse order has to collect all hits
+	SortField* sorts2[2] = { _CLNEW SortField (_T("int"), SortField::INT, true), NULL };
+	_sort->setSort (sorts2);
+	sortTopMatches (tc, &searcher, &query, _sort, 3, _T("JKI"), 11);
+	searcher.close();
+}
+
+// returns the tracers of the top n hits, sorted by score if sort is NULL
+void sort_topTracers (Searcher* searcher, Query* query, Sort* sort, int32_t n, StringBuffer& buff){
+	TopDocs* docs = sort == NULL
+		? static_cast<Searchable*>(searcher)->_search (query, NULL, n)
+		: static_cast<Searchable*>(searcher)->_search (query, NULL, n, sort);
+	for (int32_t i=0; i<docs->scoreDocsLength; ++i) {
+		Document doc;
+		searcher->doc(docs->scoreDocs[i].doc, &doc);
+		buff.append (doc.get(_T("tracer")));
+	}
+	_CLDELETE(docs);
+}
+
+// make sure that walking the hits page by page finds the same hits as one search
+void sortPagedMatches (CuTest *tc, Searcher* searcher, Query* query, Sort* sort, int32_t pageSize){
+	StringBuffer expected(10);
+	sort_topTracers (searcher, query, sort, 20, expected);
+
+	StringBuffer buff(10);
+	TopDocs* page = NULL;
+	do{
+		TopDocs* last = page;
+		if ( last == NULL )
+			page = sort == NULL
+				? static_cast<Searchable*>(searcher)->_search (query, NULL, pageSize)
+				: static_cast<Searchable*>(searcher)->_search (query, NULL, pageSize, sort);
+		else if ( sort == NULL )
+			page = searcher->searchAfter (last->scoreDocs[last->scoreDocsLength-1], query, NULL, pageSize);
+		else{
+			TopFieldDocs* fieldDocs = static_cast<TopFieldDocs*>(last);
+			page = searcher->searchAfter (*fieldDocs->fieldDocs[last->scoreDocsLength-1], query, NULL, pageSize, sort);
+		}
+		_CLDELETE(last);
+		CuAssertIntEquals (tc, _T("total hits"), 10, page->totalHits);
+		for (int32_t i=0; i<page->scoreDocsLength; ++i) {
+			Document doc;
+			searcher->doc(page->scoreDocs[i].doc, &doc);
+			buff.append (doc.get(_T("tracer")));
+		}
+	}while ( page->scoreDocsLength == pageSize );
+	_CLDELETE(page);
+	CuAssertStrEquals (tc, _T("tracer values"), expected.getBuffer(), buff.getBuffer());
+}
+
+// test continuing searches after the last hit of a page
+void testSearchAfter(CuTest *tc){
+	sortPagedMatches (tc, sort_full, sort_queryA, NULL, 3);
+	sortPagedMatches (tc, sort_full, sort_queryA, NULL, 1);
+
+	_sort->setSort (_T("int"));
+	sortPagedMatches (tc, sort_full, sort_queryA, _sort, 3);
+	_sort->setSort (_T("string"), true);
+	sortPagedMatches (tc, sort_full, sort_queryA, _sort, 4);
+	SortField* sorts1[3] = { _CLNEW SortField (_T("float"), SortField::FLOAT, false), SortField::FIELD_SCORE(), NULL };
+	_sort->setSort (sorts1);
+	sortPagedMatches (tc, sort_full, sort_queryA, _sort, 2);
+	SortField* sorts2[3] = { SortField::FIELD_SCORE(), SortField::FIELD_DOC(), NULL };
+	_sort->setSort (sorts2);
+	sortPagedMatches (tc, sort_full, sort_queryA, _sort, 3);
+
+	Searcher* searchX = sort_getIndex (true, false);
+	Searcher* searchY = sort_getIndex (false, true);
+	Searchable* searchables[3] = { searchX, searchY, NULL };
+	MultiSearcher multi(searchables);
+	sortPagedMatches (tc, &multi, sort_queryA, NULL, 3);
+	multi.close();
+	_CLDELETE(searchX);
+	_CLDELETE(searchY);
+
+	// Hits continue after the first 100 hits instead of searching again
+	RAMDirectory dir;
+	IndexWriter writer(&dir, &sort_analyser, true);
+	TCHAR contents[40];
+	for (int32_t i=0; i<250; ++i) {
+		Document doc;
+		_sntprintf(contents, 40, _T("a%s%s"), i%3==0 ? _T(" b") : _T(""), i%7==0 ? _T(" c d") : _T(""));
+		doc.add (*_CLNEW Field (_T("contents"), contents, Field::INDEX_TOKENIZED));
+		_sntprintf(contents, 40, _T("%d"), i%10);
+		doc.add (*_CLNEW Field (_T("int"), contents, Field::INDEX_UNTOKENIZED));
+		writer.addDocument (&doc);
+	}
+	writer.close();
+	IndexSearcher searcher(&dir);
+	Term* term = _CLNEW Term(_T("contents"), _T("a"));
+	TermQuery query(term);
+	_CLDECDELETE(term);
+	for (int32_t s=0; s<2; ++s) {
+		_sort->setSort (_T("int"), true);
+		Sort* sort = s == 0 ? NULL : _sort;
+		TopDocs* docs = sort == NULL
+			? searcher._search (&query, NULL, 250)
+			: searcher._search (&query, NULL, 250, sort);
+		Hits* hits = sort == NULL ? searcher.search (&query) : searcher.search (&query, sort);
+		CuAssertIntEquals (tc, _T("hits"), 250, hits->length());
+		for (int32_t i=0; i<250; ++i)
+			CuAssertIntEquals (tc, _T("hit"), docs->scoreDocs[i].doc, hits->id(i));
+		_CLDELETE(hits);
+		_CLDELETE(docs);
+	}
+	searcher.close();
+}
+
 // test sorts in reverse
 void testReverseSort(CuTest *tc){
 	/*SortField* sorts[3] = { _CLNEW SortField (NULL, SortField::INT,true), SortField::FIELD_DOC, NULL };
@@ -540,6 +931,12 @@ CuSuite *testsort(void)
 	SUITE_ADD_TEST(suite, testMultiSort);
 	SUITE_ADD_TEST(suite, testNormalizedScores);
 	SUITE_ADD_TEST(suite, testReverseSort);
+	SUITE_ADD_TEST(suite, testDocValuesSort);
+	SUITE_ADD_TEST(suite, testSparseDocValues);
+	SUITE_ADD_TEST(suite, testStringIndex);
+	SUITE_ADD_TEST(suite, testTopSort);
+	SUITE_ADD_TEST(suite, testIndexSort);
+	SUITE_ADD_TEST(suite, testSearchAfter);
 
     SUITE_ADD_TEST(suite, testSortCleanup);
     return suite;
@@ -0,0 +1,257 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "test.h"
+#include "MockHitCollector.h"
+#include "CLucene/search/QueryTimeout.h"
+#include "CLucene/search/TimeLimitedCollector.h"
+#include "CLucene/search/PrefixQuery.h"
+#include "CLucene/search/_FieldDocSortedHitQueue.h"
+#include "CLucene/search/Scorer.h"
+
+static const int32_t timelimited_numDocs = 200;
+
+static void timelimited_createIndex(Directory* dir){
+	WhitespaceAnalyzer analyzer;
+	IndexWriter writer(dir, &analyzer, true);
+	TCHAR buf[64];
+	for ( int32_t i=0;i<timelimited_numDocs;i++ ){
+		Document doc;
+		// every doc has "all", every other "even", and a term of its own
+		_sntprintf(buf, 64, _T("all %s t%d"), i % 2 == 0 ? _T("even") : _T("odd"), i);
+		doc.add(*_CLNEW Field(_T("contents"), buf, Field::STORE_NO | Field::INDEX_TOKENIZED));
+		_sntprintf(buf, 64, _T("%d"), i);
+		doc.add(*_CLNEW Field(_T("id"), buf, Field::STORE_NO | Field::INDEX_UNTOKENIZED));
+		writer.addDocument(&doc);
+	}
+	writer.close();
+}
+
+/** Cancels a timeout after a number of hits */
+class CancellingCollector: public MockHitCollector{
+	QueryTimeout* timeout;
+	int32_t cancelAfter;
+public:
+	CancellingCollector(QueryTimeout* timeout, int32_t cancelAfter):
+		timeout(timeout), cancelAfter(cancelAfter){}
+	void collect(const int32_t doc, const float_t score){
+		MockHitCollector::collect(doc, score);
+		if ( getCollectCalls() == cancelAfter )
+			timeout->cancel();
+	}
+};
+
+void testTimeLimitedSearch(CuTest *tc){
+	RAMDirectory dir;
+	timelimited_createIndex(&dir);
+	IndexSearcher searcher(&dir);
+	Term* t = _CLNEW Term(_T("contents"), _T("all"));
+	TermQuery query(t);
+	_CLDECDELETE(t);
+
+	{
+		// a deadline that has passed stops the search at the first check
+		QueryTimeout timeout(0, 1);
+		QueryTimeout::Scope scope(&timeout);
+		TopDocs* top = searcher._search(&query, NULL, 10);
+		CLUCENE_ASSERT(top->timedOut);
+		CLUCENE_ASSERT(timeout.isExceeded());
+		CLUCENE_ASSERT(!timeout.isCancelled());
+		CuAssertIntEquals(tc, _T("hits"), 0, top->scoreDocsLength);
+		_CLDELETE(top);
+
+		// a restarted timeout with time to spare does not
+		timeout.restart(1000000);
+		top = searcher._search(&query, NULL, 10);
+		CLUCENE_ASSERT(!top->timedOut);
+		CLUCENE_ASSERT(!timeout.isExceeded());
+		CuAssertIntEquals(tc, _T("total hits"), timelimited_numDocs, top->totalHits);
+		_CLDELETE(top);
+
+		// sorted searches too
+		timeout.cancel();
+		Sort sort(_T("id"));
+		TopFieldDocs* fieldDocs = searcher._search(&query, NULL, 10, &sort);
+		CLUCENE_ASSERT(fieldDocs->timedOut);
+		CuAssertIntEquals(tc, _T("sorted hits"), 0, fieldDocs->scoreDocsLength);
+		_CLDELETE(fieldDocs);
+
+		// a collector keeps the hits from before the cancel
+		timeout.restart(-1);
+		CancellingCollector collector(&timeout, 10);
+		searcher._search(&query, NULL, &collector);
+		CuAssertIntEquals(tc, _T("collected"), 10, collector.getCollectCalls());
+		CLUCENE_ASSERT(timeout.isExceeded());
+		CLUCENE_ASSERT(timeout.isCancelled());
+	}
+
+	// without a timeout, all hits are collected
+	MockHitCollector all;
+	searcher._search(&query, NULL, &all);
+	CuAssertIntEquals(tc, _T("all collected"), timelimited_numDocs, all.getCollectCalls());
+	CLUCENE_ASSERT(QueryTimeout::current() == NULL);
+
+	searcher.close();
+}
+
+void testTimeLimitedRewrite(CuTest *tc){
+	RAMDirectory dir;
+	timelimited_createIndex(&dir);
+	IndexSearcher searcher(&dir);
+	Term* t = _CLNEW Term(_T("contents"), _T("t"));
+	PrefixQuery query(t);
+	_CLDECDELETE(t);
+
+	QueryTimeout timeout(-1, 1);
+	timeout.cancel();
+	QueryTimeout::Scope scope(&timeout);
+	TopDocs* top = searcher._search(&query, NULL, 10);
+	CLUCENE_ASSERT(top->timedOut);
+	CuAssertIntEquals(tc, _T("hits"), 0, top->scoreDocsLength);
+	_CLDELETE(top);
+
+	timeout.restart(-1);
+	top = searcher._search(&query, NULL, 10);
+	CLUCENE_ASSERT(!top->timedOut);
+	CuAssertIntEquals(tc, _T("total hits"), timelimited_numDocs, top->totalHits);
+	_CLDELETE(top);
+
+	searcher.close();
+}
+
+// the boolean scorers check the timeout of the current thread as they advance
+static void timelimited_checkScorer(CuTest* tc, IndexSearcher* searcher, Query* query){
+	Weight* weight = query->weight(searcher);
+	QueryTimeout timeout(-1, 1);
+	QueryTimeout::Scope scope(&timeout);
+	CLUCENE_ASSERT(QueryTimeout::current() == &timeout);
+	Scorer* scorer = weight->scorer(searcher->getReader());
+	timeout.cancel();
+	bool stopped = false;
+	try{
+		while ( scorer->next() )
+			;
+	}catch(CLuceneError& err){
+		CuAssertIntEquals(tc, _T("error number"), CL_ERR_TimeExceeded, err.number());
+		stopped = true;
+	}
+	CLUCENE_ASSERT(stopped);
+	_CLDELETE(scorer);
+	_CLDELETE(weight);
+}
+
+void testTimeLimitedScorers(CuTest *tc){
+	RAMDirectory dir;
+	timelimited_createIndex(&dir);
+	IndexSearcher searcher(&dir);
+	Term* all = _CLNEW Term(_T("contents"), _T("all"));
+	Term* even = _CLNEW Term(_T("contents"), _T("even"));
+	Term* odd = _CLNEW Term(_T("contents"), _T("odd"));
+
+	BooleanQuery conjunction;
+	conjunction.add(_CLNEW TermQuery(all), true, BooleanClause::MUST);
+	conjunction.add(_CLNEW TermQuery(even), true, BooleanClause::MUST);
+	timelimited_checkScorer(tc, &searcher, &conjunction);
+
+	BooleanQuery disjunction;
+	disjunction.add(_CLNEW TermQuery(even), true, BooleanClause::SHOULD);
+	disjunction.add(_CLNEW TermQuery(odd), true, BooleanClause::SHOULD);
+	timelimited_checkScorer(tc, &searcher, &disjunction);
+	CLUCENE_ASSERT(QueryTimeout::current() == NULL);
+
+	_CLDECDELETE(all);
+	_CLDECDELETE(even);
+	_CLDECDELETE(odd);
+	searcher.close();
+}
+
+struct TimeLimitedThreadData{
+	IndexSearcher* searcher;
+	Query* query;
+	bool cancelled;
+	bool failed;
+};
+
+// searches the shared searcher repeatedly, bounded by a token of its own
+_LUCENE_THREAD_FUNC(timeLimitedSearchThread, _data){
+	TimeLimitedThreadData* data = (TimeLimitedThreadData*)_data;
+	QueryTimeout timeout(-1, 1);
+	QueryTimeout::Scope scope(&timeout);
+	for ( int32_t i=0;i<50 && !data->failed;i++ ){
+		timeout.restart(-1);
+		if ( data->cancelled )
+			timeout.cancel();
+		TopDocs* top = data->searcher->_search(data->query, NULL, 10);
+		if ( top->timedOut != data->cancelled )
+			data->failed = true;
+		if ( !data->cancelled && top->totalHits != timelimited_numDocs )
+			data->failed = true;
+		_CLDELETE(top);
+	}
+	_LUCENE_THREAD_FUNC_RETURN(0);
+}
+
+// threads searching one searcher are each bounded by their own token only
+void testTimeLimitedThreads(CuTest *tc){
+	RAMDirectory dir;
+	timelimited_createIndex(&dir);
+	IndexSearcher searcher(&dir);
+	Term* t = _CLNEW Term(_T("contents"), _T("all"));
+	TermQuery query(t);
+	_CLDECDELETE(t);
+
+	const int32_t threadsCount = 4;
+	_LUCENE_THREADID_TYPE threads[threadsCount];
+	TimeLimitedThreadData data[threadsCount];
+	for ( int32_t i=0;i<threadsCount;i++ ){
+		data[i].searcher = &searcher;
+		data[i].query = &query;
+		data[i].cancelled = i % 2 == 0;
+		data[i].failed = false;
+		threads[i] = _LUCENE_THREAD_CREATE(&timeLimitedSearchThread, &data[i]);
+	}
+	for ( int32_t i=0;i<threadsCount;i++ )
+		_LUCENE_THREAD_JOIN(threads[i]);
+	for ( int32_t i=0;i<threadsCount;i++ )
+		CLUCENE_ASSERT(!data[i].failed);
+	CLUCENE_ASSERT(QueryTimeout::current() == NULL);
+
+	searcher.close();
+}
+
+void testCountLimitedCollector(CuTest *tc){
+	RAMDirectory dir;
+	timelimited_createIndex(&dir);
+	IndexSearcher searcher(&dir);
+	Term* t = _CLNEW Term(_T("contents"), _T("even"));
+	TermQuery query(t);
+	_CLDECDELETE(t);
+
+	MockHitCollector counter;
+	CountLimitedCollector limited(&counter, 5);
+	searcher._search(&query, NULL, &limited);
+	CuAssertIntEquals(tc, _T("collected"), 5, counter.getCollectCalls());
+	CLUCENE_ASSERT(limited.isTerminated());
+
+	MockHitCollector counter2;
+	CountLimitedCollector unlimited(&counter2, timelimited_numDocs);
+	searcher._search(&query, NULL, &unlimited);
+	CuAssertIntEquals(tc, _T("collected all"), timelimited_numDocs / 2, counter2.getCollectCalls());
+	CLUCENE_ASSERT(!unlimited.isTerminated());
+
+	searcher.close();
+}
+
+CuSuite *testtimelimited(void)
+{
+	CuSuite *suite = CuSuiteNew(_T("CLucene Time Limited Search Test"));
+	SUITE_ADD_TEST(suite, testTimeLimitedSearch);
+	SUITE_ADD_TEST(suite, testTimeLimitedRewrite);
+	SUITE_ADD_TEST(suite, testTimeLimitedScorers);
+	SUITE_ADD_TEST(suite, testTimeLimitedThreads);
+	SUITE_ADD_TEST(suite, testCountLimitedCollector);
+	return suite;
+}
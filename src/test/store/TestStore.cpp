@@ -7,7 +7,10 @@
 #include "test.h"
 #include "CLucene/store/Directory.h"
 #include "CLucene/store/IndexInput.h"
+#include "CLucene/store/LockFactory.h"
+#include "CLucene/store/_RAMDirectory.h"
 #include <stdlib.h>
+#include <set>
 
 
 void StoreTest(CuTest *tc,int32_t count, int mode){
@@ -22,7 +25,11 @@ void StoreTest(CuTest *tc,int32_t count, int mode){
 	Directory* store = NULL;
 	if ( mode == 1 )
 	  store = _CLNEW RAMDirectory();
-	else{
+	else if ( mode == 4 ){
+	  // odd sized buffers, so that files cross buffer boundaries anywhere
+	  store = _CLNEW RAMDirectory();
+	  ((RAMDirectory*)store)->setBufferSize(3000);
+	}else{
 	  store = (Directory*)FSDirectory::getDirectory(fsdir);
 	  ((FSDirectory*)store)->setUseMMap(mode == 3);
 	}
@@ -45,7 +52,7 @@ void StoreTest(CuTest *tc,int32_t count, int mode){
 	}
 	CuMessageA(tc, "%d total milliseconds to create\n", (int32_t)(Misc::currentTimeMillis() - start));
 
-	if (mode != 1){
+	if (mode != 1 && mode != 4){
 		store->close();
 		_CLDECDELETE(store);
 		store = (Directory*)FSDirectory::getDirectory(fsdir);
@@ -109,6 +116,442 @@ void fstest(CuTest *tc){
 void mmaptest(CuTest *tc){
 	StoreTest(tc,100,3);
 }
+void ramlargebuffertest(CuTest *tc){
+	StoreTest(tc,1000,4);
+}
+
+/** Makes putFile, which the loader uses, public */
+class PutFileRAMDirectory: public RAMDirectory{
+public:
+	using RAMDirectory::putFile;
+};
+
+void rambufferstest(CuTest *tc){
+	PutFileRAMDirectory dir;
+	dir.setBufferSize(RAMDirectory::LARGE_BUFFER_SIZE);
+
+	// small files don't take a whole buffer
+	IndexOutput* out = dir.createOutput("small");
+	out->writeInt(42);
+	out->close();
+	_CLDELETE(out);
+	CLUCENE_ASSERT(dir.sizeInBytes <= 1024);
+
+	// the first buffer grows, then the file continues in full buffers
+	const int32_t count = 600000;
+	out = dir.createOutput("large");
+	out->writeInt(0);
+	for ( int32_t i=0;i<count;i++ )
+		out->writeVInt(i * 7);
+	out->seek(0); // rewrite the header
+	out->writeInt(count);
+	out->close();
+	_CLDELETE(out);
+	const int64_t length = dir.fileLength("large");
+	CLUCENE_ASSERT(length > RAMDirectory::LARGE_BUFFER_SIZE);
+	CLUCENE_ASSERT(dir.sizeInBytes >= length);
+
+	IndexInput* in = static_cast<Directory&>(dir).openInput("large");
+	CuAssertIntEquals(tc, _T("header"), count, in->readInt());
+	for ( int32_t i=0;i<count;i++ ){
+		if ( in->readVInt() != i * 7 )
+			CuFail(tc, _T("wrong vint"));
+	}
+	CuAssertIntEquals(tc, _T("at end"), (int32_t)length, (int32_t)in->getFilePointer());
+
+	// seeks into the second buffer and back
+	IndexInput* clone = in->clone();
+	clone->seek(0);
+	CuAssertIntEquals(tc, _T("clone header"), count, clone->readInt());
+	in->seek(4);
+	CuAssertIntEquals(tc, _T("first vint"), 0, in->readVInt());
+	CuAssertIntEquals(tc, _T("second vint"), 7, in->readVInt());
+	clone->close();
+	_CLDELETE(clone);
+	in->close();
+	_CLDELETE(in);
+
+	// a file put into the directory keeps the buffer size it was built with
+	const int32_t putBufferSize = 100;
+	RAMFile* file = _CLNEW RAMFile();
+	for ( int32_t i=0;i<10;i++ ){
+		uint8_t* buffer = file->addBuffer(putBufferSize);
+		for ( int32_t j=0;j<putBufferSize;j++ )
+			buffer[j] = (uint8_t)i;
+	}
+	file->setLength(10 * putBufferSize);
+	file->setBufferSize(putBufferSize);
+	dir.putFile("put", file);
+	in = static_cast<Directory&>(dir).openInput("put");
+	in->seek(5 * putBufferSize + 1);
+	CuAssertIntEquals(tc, _T("byte of the sixth buffer"), 5, in->readByte());
+	in->close();
+	_CLDELETE(in);
+
+	dir.deleteFile("put");
+	dir.deleteFile("large");
+	dir.deleteFile("small");
+	CuAssertIntEquals(tc, _T("size after delete"), 0, (int32_t)dir.sizeInBytes);
+}
+
+void fscopytest(CuTest *tc){
+	char fsdir[CL_MAX_PATH];
+	_snprintf(fsdir, CL_MAX_PATH, "%s/%s", cl_tempDir, "test.fscopy");
+	FSDirectory* dir = FSDirectory::getDirectory(fsdir);
+	dir->setWriteBufferSize(1000);
+	CuAssertIntEquals(tc, _T("buffer size"), 1000, dir->getWriteBufferSize());
+
+	// writes larger than the buffer go out together with what is buffered
+	const int32_t length = 300000;
+	uint8_t* data = _CL_NEWARRAY(uint8_t, length);
+	for ( int32_t i=0;i<length;i++ )
+		data[i] = (uint8_t)(i * 31 + (i >> 8));
+	IndexOutput* out = dir->createOutput("source");
+	int32_t pos = 0;
+	while ( pos < length ){
+		const int32_t len = cl_min(length - pos, pos % 2 == 0 ? 10 : 5000);
+		out->writeBytes(data + pos, len);
+		pos += len;
+	}
+	out->close();
+	_CLDELETE(out);
+	CuAssertIntEquals(tc, _T("source length"), length, (int32_t)dir->fileLength("source"));
+
+	// copies from a file, after some buffered bytes, from the middle of the input
+	IndexInput* in = static_cast<Directory*>(dir)->openInput("source");
+	out = dir->createOutput("copy");
+	out->writeInt(42);
+	in->seek(100);
+	out->copyBytes(in, length - 200);
+	CuAssertIntEquals(tc, _T("input position"), length - 100, (int32_t)in->getFilePointer());
+	out->writeInt(43);
+	out->close();
+	_CLDELETE(out);
+	in->close();
+	_CLDELETE(in);
+
+	in = static_cast<Directory*>(dir)->openInput("copy");
+	CuAssertIntEquals(tc, _T("copy length"), length - 200 + 8, (int32_t)in->length());
+	CuAssertIntEquals(tc, _T("header"), 42, in->readInt());
+	uint8_t* copy = _CL_NEWARRAY(uint8_t, length - 200);
+	in->readBytes(copy, length - 200);
+	CLUCENE_ASSERT(memcmp(copy, data + 100, length - 200) == 0);
+	CuAssertIntEquals(tc, _T("trailer"), 43, in->readInt());
+	in->close();
+	_CLDELETE(in);
+
+	_CLDELETE_LARRAY(copy);
+	_CLDELETE_LARRAY(data);
+	dir->deleteFile("source");
+	dir->deleteFile("copy");
+	dir->close();
+	_CLDECDELETE(dir);
+}
+
+void fsclonetest(CuTest *tc){
+	char fsdir[CL_MAX_PATH];
+	_snprintf(fsdir, CL_MAX_PATH, "%s/%s", cl_tempDir, "test.fsclone");
+	FSDirectory* dir = FSDirectory::getDirectory(fsdir);
+	dir->setUseMMap(false);
+	const int32_t bufferSize = 1024;
+	const int32_t length = bufferSize * 3;
+	IndexOutput* out = dir->createOutput("clone");
+	for ( int32_t i=0;i<length;i++ )
+		out->writeByte((uint8_t)(i % 251));
+	out->close();
+	_CLDELETE(out);
+
+	// a clone continues where its source is, after the source's buffer, even
+	// though another clone read from elsewhere in the shared file in between
+	IndexInput* in = static_cast<Directory*>(dir)->openInput("clone", bufferSize);
+	in->readByte();
+	IndexInput* other = in->clone();
+	other->seek(length - 10);
+	other->readByte();
+	IndexInput* clone = in->clone();
+	for ( int32_t i=1;i<length;i++ ){
+		if ( clone->readByte() != (uint8_t)(i % 251) ){
+			CuFail(tc, _T("clone read at the wrong position"));
+			break;
+		}
+	}
+	other->close();
+	_CLDELETE(other);
+	clone->close();
+	_CLDELETE(clone);
+	in->close();
+	_CLDELETE(in);
+
+	dir->deleteFile("clone");
+	dir->close();
+	_CLDECDELETE(dir);
+}
+
+void SliceTest(CuTest *tc, bool useMMap){
+	char fsdir[CL_MAX_PATH];
+	_snprintf(fsdir, CL_MAX_PATH, "%s/%s", cl_tempDir, "test.slice");
+	FSDirectory* dir = FSDirectory::getDirectory(fsdir);
+	dir->setUseMMap(useMMap);
+
+	const int32_t count = 20000;
+	IndexOutput* out = dir->createOutput("sliced");
+	for ( int32_t i=0;i<count;i++ )
+		out->writeInt(i);
+	out->close();
+	_CLDELETE(out);
+
+	IndexInput* in = static_cast<Directory*>(dir)->openInput("sliced");
+	in->seek(8);
+
+	// ints 1000 to 2999, read on their own
+	IndexInput* slice = in->slice(4000, 8000);
+	CLUCENE_ASSERT(slice != NULL);
+	CuAssertIntEquals(tc, _T("slice length"), 8000, (int32_t)slice->length());
+	CuAssertIntEquals(tc, _T("slice start"), 0, (int32_t)slice->getFilePointer());
+	for ( int32_t i=1000;i<3000;i++ ){
+		if ( slice->readInt() != i )
+			CuFail(tc, _T("wrong int in slice"));
+	}
+	CuAssertIntEquals(tc, _T("input untouched"), 2, in->readInt());
+
+	// seeks are relative to the slice, and clones and slices of slices keep the offset
+	slice->seek(400);
+	CuAssertIntEquals(tc, _T("seek in slice"), 1100, slice->readInt());
+	IndexInput* clone = slice->clone();
+	CuAssertIntEquals(tc, _T("clone of slice"), 1101, clone->readInt());
+	IndexInput* inner = slice->slice(4, 8);
+	CuAssertIntEquals(tc, _T("slice of slice"), 1001, inner->readInt());
+	CuAssertIntEquals(tc, _T("slice of slice end"), 1002, inner->readInt());
+	try{
+		inner->readByte();
+		if ( !useMMap ) // mmap inputs do not check their bounds
+			CuFail(tc, _T("read past the end of a slice"));
+	}catch(CLuceneError& err){
+		if ( err.number() != CL_ERR_IO )
+			throw;
+	}
+
+	try{
+		in->slice(count * 4 - 4, 8);
+		CuFail(tc, _T("slice past the end of the file"));
+	}catch(CLuceneError& err){
+		if ( err.number() != CL_ERR_IO )
+			throw;
+	}
+
+	inner->close();
+	_CLDELETE(inner);
+	clone->close();
+	_CLDELETE(clone);
+	slice->close();
+	_CLDELETE(slice);
+	in->close();
+	_CLDELETE(in);
+
+	dir->deleteFile("sliced");
+	dir->close();
+	_CLDECDELETE(dir);
+}
+void fsslicetest(CuTest *tc){
+	SliceTest(tc, false);
+}
+void mmapslicetest(CuTest *tc){
+	SliceTest(tc, true);
+}
+
+_LUCENE_THREAD_FUNC(nativeLockReleaser, _lock){
+	_LUCENE_SLEEP(50);
+	((LuceneLock*)_lock)->release();
+	_LUCENE_THREAD_FUNC_RETURN(0);
+}
+
+void nativelocktest(CuTest *tc){
+	char lockdir[CL_MAX_PATH];
+	_snprintf(lockdir, CL_MAX_PATH, "%s/%s", cl_tempDir, "test.nativelock");
+	NativeFSLockFactory factory(lockdir);
+	LuceneLock* lock1 = factory.makeLock("write.lock");
+	LuceneLock* lock2 = factory.makeLock("write.lock");
+
+	// two locks of one process exclude each other
+	CLUCENE_ASSERT(lock1->obtain());
+	CLUCENE_ASSERT(!lock1->obtain());
+	CLUCENE_ASSERT(!lock2->obtain());
+	CLUCENE_ASSERT(lock2->isLocked());
+	try{
+		lock2->obtain(20);
+		CuFail(tc, _T("obtained a held lock"));
+	}catch(CLuceneError& err){
+		if ( err.number() != CL_ERR_IO )
+			throw;
+	}
+
+	// a waiter gets the lock once it is released
+	_LUCENE_THREADID_TYPE thread = _LUCENE_THREAD_CREATE(&nativeLockReleaser, lock1);
+	CLUCENE_ASSERT(lock2->obtain(LuceneLock::LOCK_OBTAIN_WAIT_FOREVER));
+	_LUCENE_THREAD_JOIN(thread);
+	CLUCENE_ASSERT(!lock1->obtain());
+
+	// deleting a lock releases it, and the lock file left behind does not lock
+	_CLDELETE(lock2);
+	CLUCENE_ASSERT(!lock1->isLocked());
+	factory.clearLock("write.lock");
+	CLUCENE_ASSERT(lock1->obtain());
+	CLUCENE_ASSERT(lock1->isLocked());
+	lock1->release();
+	CLUCENE_ASSERT(!lock1->isLocked());
+	_CLDELETE(lock1);
+
+	// an index writer holds its write lock natively
+	char fsdir[CL_MAX_PATH];
+	_snprintf(fsdir, CL_MAX_PATH, "%s/%s", cl_tempDir, "test.nativelockindex");
+	FSDirectory* dir = FSDirectory::getDirectory(fsdir, _CLNEW NativeFSLockFactory(fsdir));
+	WhitespaceAnalyzer analyzer;
+	IndexWriter* writer = _CLNEW IndexWriter(dir, &analyzer, true);
+	LuceneLock* writeLock = dir->makeLock(IndexWriter::WRITE_LOCK_NAME);
+	CLUCENE_ASSERT(writeLock->isLocked());
+	CLUCENE_ASSERT(!writeLock->obtain());
+	writer->close();
+	_CLDELETE(writer);
+	CLUCENE_ASSERT(writeLock->obtain());
+	writeLock->release();
+	_CLDELETE(writeLock);
+	dir->close();
+	_CLDECDELETE(dir);
+
+	// without a lock directory, the locks are kept in the index directory
+	_snprintf(fsdir, CL_MAX_PATH, "%s/%s", cl_tempDir, "test.nativelockdefault");
+	dir = FSDirectory::getDirectory(fsdir, _CLNEW NativeFSLockFactory());
+	writer = _CLNEW IndexWriter(dir, &analyzer, true);
+	CLUCENE_ASSERT(dir->fileExists(IndexWriter::WRITE_LOCK_NAME));
+	writeLock = dir->makeLock(IndexWriter::WRITE_LOCK_NAME);
+	CLUCENE_ASSERT(writeLock->isLocked());
+	writer->close();
+	_CLDELETE(writer);
+	CLUCENE_ASSERT(!writeLock->isLocked());
+	_CLDELETE(writeLock);
+	dir->close();
+	_CLDECDELETE(dir);
+}
+
+/** Counts what a loader reports */
+class RAMLoaderListener: public RAMDirectoryLoader::Listener{
+public:
+	DEFINE_MUTEX(THIS_LOCK)
+	int32_t files;
+	int64_t lastLoaded;
+	std::vector<std::string> segments;
+	RAMLoaderListener(): files(0), lastLoaded(0){}
+	void fileLoaded(const char* /*name*/, int64_t bytesLoaded, int64_t bytesTotal){
+		SCOPED_LOCK_MUTEX(THIS_LOCK)
+		files++;
+		if ( bytesLoaded > lastLoaded )
+			lastLoaded = bytesLoaded;
+		if ( bytesLoaded > bytesTotal )
+			lastLoaded = -1;
+	}
+	void segmentLoaded(const char* segment){
+		SCOPED_LOCK_MUTEX(THIS_LOCK)
+		segments.push_back(segment);
+	}
+};
+
+void ramloadertest(CuTest *tc){
+	CLUCENE_ASSERT(RAMDirectoryLoader::segmentOf("_3.cfs").compare("_3") == 0);
+	CLUCENE_ASSERT(RAMDirectoryLoader::segmentOf("_3_1.del").compare("_3") == 0);
+	CLUCENE_ASSERT(RAMDirectoryLoader::segmentOf("_a_2.s0").compare("_a") == 0);
+
+	char fsdir[CL_MAX_PATH];
+	_snprintf(fsdir, CL_MAX_PATH, "%s/%s", cl_tempDir, "test.ramloader");
+	Directory* dir = FSDirectory::getDirectory(fsdir);
+
+	// several segments, one of them with deletions
+	const int32_t numDocs = 100;
+	WhitespaceAnalyzer analyzer;
+	IndexWriter writer(dir, &analyzer, true);
+	writer.setUseCompoundFile(false);
+	writer.setMaxBufferedDocs(10);
+	writer.setMergeFactor(100);
+	TCHAR buf[64];
+	for ( int32_t i=0;i<numDocs;i++ ){
+		Document doc;
+		_sntprintf(buf, 64, _T("all doc%d"), i);
+		doc.add(*_CLNEW Field(_T("contents"), buf, Field::STORE_YES | Field::INDEX_TOKENIZED));
+		writer.addDocument(&doc);
+	}
+	writer.close();
+	IndexReader* reader = IndexReader::open(dir);
+	reader->deleteDocument(5);
+	reader->close();
+	_CLDELETE(reader);
+
+	std::vector<std::string> names;
+	dir->list(&names);
+	std::set<std::string> expectedSegments;
+	for ( size_t i=0;i<names.size();i++ ){
+		if ( names[i].compare(0, 8, "segments") != 0 )
+			expectedSegments.insert(RAMDirectoryLoader::segmentOf(names[i].c_str()));
+	}
+	CLUCENE_ASSERT(expectedSegments.size() >= 10);
+
+	RAMDirectory ram;
+	ram.setBufferSize(RAMDirectory::LARGE_BUFFER_SIZE);
+	RAMLoaderListener listener;
+	RAMDirectoryLoader loader(dir, &ram, 4);
+	loader.setListener(&listener);
+	CLUCENE_ASSERT(loader.openLoadedSegments() == NULL);
+	loader.load();
+
+	CLUCENE_ASSERT(loader.isDone());
+	CuAssertIntEquals(tc, _T("files"), (int32_t)names.size(), listener.files);
+	CuAssertIntEquals(tc, _T("segments"), (int32_t)expectedSegments.size(), (int32_t)listener.segments.size());
+	CLUCENE_ASSERT(loader.getBytesLoaded() == loader.getBytesTotal());
+	CLUCENE_ASSERT(listener.lastLoaded == loader.getBytesTotal());
+	for ( size_t i=0;i<names.size();i++ ){
+		CLUCENE_ASSERT(ram.fileLength(names[i].c_str()) == dir->fileLength(names[i].c_str()));
+		if ( names[i].compare(0, 8, "segments") != 0 )
+			CLUCENE_ASSERT(loader.isSegmentLoaded(RAMDirectoryLoader::segmentOf(names[i].c_str()).c_str()));
+	}
+	CLUCENE_ASSERT(ram.sizeInBytes >= loader.getBytesTotal());
+
+	reader = IndexReader::open(&ram);
+	CuAssertIntEquals(tc, _T("docs"), numDocs - 1, reader->numDocs());
+	reader->close();
+	_CLDELETE(reader);
+
+	// a reader over the loaded segments, which reopens to the loaded commit
+	reader = loader.openLoadedSegments();
+	CuAssertIntEquals(tc, _T("loaded docs"), numDocs - 1, reader->numDocs());
+	CLUCENE_ASSERT(!reader->isCurrent());
+	IndexReader* reopened = reader->reopen();
+	CLUCENE_ASSERT(reopened != reader);
+	CuAssertIntEquals(tc, _T("reopened docs"), numDocs - 1, reopened->numDocs());
+	CLUCENE_ASSERT(reopened->isCurrent());
+	reopened->close();
+	_CLDELETE(reopened);
+	reader->close();
+	_CLDELETE(reader);
+
+	// a segment with a file missing from the target is left out
+	for ( size_t i=0;i<names.size();i++ ){
+		if ( names[i].find(".del") != std::string::npos )
+			ram.deleteFile(names[i].c_str());
+	}
+	reader = loader.openLoadedSegments();
+	CuAssertIntEquals(tc, _T("docs without the deletions"), numDocs - 10, reader->numDocs());
+	reader->close();
+	_CLDELETE(reader);
+
+	// loading into a directory that already has the files replaces them
+	RAMDirectoryLoader reload(dir, &ram, 2);
+	reload.load();
+	reader = IndexReader::open(&ram);
+	CuAssertIntEquals(tc, _T("docs after reload"), numDocs - 1, reader->numDocs());
+	reader->close();
+	_CLDELETE(reader);
+
+	dir->close();
+	_CLDECDELETE(dir);
+}
 
 CuSuite *teststore(void)
 {
@@ -117,6 +560,14 @@ CuSuite *teststore(void)
     SUITE_ADD_TEST(suite, ramtest);
     SUITE_ADD_TEST(suite, fstest);
     SUITE_ADD_TEST(suite, mmaptest);
+    SUITE_ADD_TEST(suite, ramlargebuffertest);
+    SUITE_ADD_TEST(suite, rambufferstest);
+    SUITE_ADD_TEST(suite, ramloadertest);
+    SUITE_ADD_TEST(suite, fscopytest);
+    SUITE_ADD_TEST(suite, fsclonetest);
+    SUITE_ADD_TEST(suite, fsslicetest);
+    SUITE_ADD_TEST(suite, mmapslicetest);
+    SUITE_ADD_TEST(suite, nativelocktest);
 
     return suite;
 }
@@ -61,6 +61,10 @@ CuSuite *testConstantScoreQueries(void);
 CuSuite *testsearch(void);
 CuSuite *testtermvector(void);
 CuSuite *testsort(void);
+CuSuite *testfacets(void);
+CuSuite *testgrouping(void);
+CuSuite *testfunctionquery(void);
+CuSuite *testtimelimited(void);
 CuSuite *testduplicates(void);
 CuSuite *testRangeFilter(void);
 CuSuite *testdatefilter(void);
@@ -74,6 +78,7 @@ CuSuite *testNumberTools(void);
 CuSuite *testDateTools(void);
 CuSuite *testBoolean(void);
 CuSuite *testBitSet(void);
+CuSuite *testthreadlocal(void);
 CuSuite *testExtractTerms(void);
 CuSuite *testSpanQueries(void);
 CuSuite *testStringBuffer(void);
@@ -33,12 +33,17 @@ unittest tests[] = {
     {"csrqueries", testConstantScoreQueries},
     {"termvector",testtermvector},
     {"sort",testsort},
+    {"facets",testfacets},
+    {"grouping",testgrouping},
+    {"functionquery",testfunctionquery},
+    {"timelimited",testtimelimited},
     {"duplicates", testduplicates},
     {"datefilter", testdatefilter},
     {"wildcard", testwildcard},
     {"store", teststore},
     {"utf8", testutf8},
     {"bitset", testBitSet},
+    {"threadlocal", testthreadlocal},
     {"extractterms",testExtractTerms},
     {"spanqueries",testSpanQueries},
     {"stringbuffer", testStringBuffer},
@@ -0,0 +1,139 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "test.h"
+#include "CLucene/util/_ThreadLocal.h"
+
+DEFINE_MUTEX(threadlocal_LOCK);
+static int32_t threadlocal_live = 0;
+
+/** Counts the values alive, so that the tests can see when they are deleted */
+class ThreadLocalValue{
+public:
+	int32_t value;
+	ThreadLocalValue(int32_t value): value(value){
+		SCOPED_LOCK_MUTEX(threadlocal_LOCK);
+		threadlocal_live++;
+	}
+	~ThreadLocalValue(){
+		SCOPED_LOCK_MUTEX(threadlocal_LOCK);
+		threadlocal_live--;
+	}
+};
+typedef CL_NS(util)::ThreadLocal<ThreadLocalValue*, CL_NS(util)::Deletor::Object<ThreadLocalValue> > ThreadLocalType;
+
+static int32_t threadlocal_liveCount(){
+	SCOPED_LOCK_MUTEX(threadlocal_LOCK);
+	return threadlocal_live;
+}
+
+struct ThreadLocalData{
+	ThreadLocalType* tl;
+	ThreadLocalType* other;
+	int32_t value;
+	bool ok;
+};
+
+_LUCENE_THREAD_FUNC(threadLocalWorker, _data){
+	ThreadLocalData* data = (ThreadLocalData*)_data;
+	data->ok = data->tl->get() == NULL;
+
+	data->tl->set(_CLNEW ThreadLocalValue(-1));
+	data->tl->setNull();
+	data->ok = data->ok && data->tl->get() == NULL;
+
+	for ( int32_t i=0;i<1000;i++ ){
+		data->tl->set(_CLNEW ThreadLocalValue(data->value));
+		data->other->set(_CLNEW ThreadLocalValue(-data->value));
+		data->ok = data->ok && data->tl->get()->value == data->value &&
+			data->other->get()->value == -data->value;
+	}
+	//the values are deleted when the thread ends
+	_LUCENE_THREAD_FUNC_RETURN(0);
+}
+
+void testThreadLocalThreads(CuTest *tc){
+	const int32_t threadsCount = 8;
+	_LUCENE_THREADID_TYPE threads[threadsCount];
+	ThreadLocalData data[threadsCount];
+	ThreadLocalType tl;
+	ThreadLocalType other;
+
+	tl.set(_CLNEW ThreadLocalValue(100));
+	int32_t i;
+	for ( i=0;i<threadsCount;i++ ){
+		data[i].tl = &tl;
+		data[i].other = &other;
+		data[i].value = i + 1;
+		data[i].ok = false;
+		threads[i] = _LUCENE_THREAD_CREATE(&threadLocalWorker, &data[i]);
+	}
+	for ( i=0;i<threadsCount;i++ ){
+		_LUCENE_THREAD_JOIN(threads[i]);
+		CLUCENE_ASSERT(data[i].ok);
+	}
+
+	//only the value of this thread is left, and the threads did not touch it
+	CuAssertIntEquals(tc, _T("live values"), 1, threadlocal_liveCount());
+	CuAssertIntEquals(tc, _T("value"), 100, tl.get()->value);
+	CLUCENE_ASSERT(other.get() == NULL);
+
+	tl.setNull();
+	CuAssertIntEquals(tc, _T("live values after setNull"), 0, threadlocal_liveCount());
+}
+
+_LUCENE_THREAD_FUNC(threadLocalHolder, _data){
+	ThreadLocalData* data = (ThreadLocalData*)_data;
+	data->tl->set(_CLNEW ThreadLocalValue(data->value));
+	data->ok = true;
+	//keeps the value until the thread is unregistered
+	_LUCENE_THREAD_FUNC_RETURN(0);
+}
+
+void testThreadLocalDestroy(CuTest *tc){
+	ThreadLocalType* tl = _CLNEW ThreadLocalType;
+	tl->set(_CLNEW ThreadLocalValue(1));
+	tl->set(tl->get()); //setting the same value again keeps it
+	CuAssertIntEquals(tc, _T("value"), 1, tl->get()->value);
+	tl->set(_CLNEW ThreadLocalValue(2));
+	CuAssertIntEquals(tc, _T("replaced value deleted"), 1, threadlocal_liveCount());
+
+	//destroying a ThreadLocal deletes its value
+	_CLDELETE(tl);
+	CuAssertIntEquals(tc, _T("live values after delete"), 0, threadlocal_liveCount());
+
+	//a new ThreadLocal may reuse the slot, but starts out empty
+	ThreadLocalType reused;
+	CLUCENE_ASSERT(reused.get() == NULL);
+	reused.set(_CLNEW ThreadLocalValue(3));
+
+	//unregistering this thread deletes its values
+	_ThreadLocal::UnregisterCurrentThread();
+	CuAssertIntEquals(tc, _T("live values after unregister"), 0, threadlocal_liveCount());
+	CLUCENE_ASSERT(reused.get() == NULL);
+	reused.set(_CLNEW ThreadLocalValue(4));
+	CuAssertIntEquals(tc, _T("value after unregister"), 4, reused.get()->value);
+	reused.setNull();
+
+	//values of threads which have ended are deleted with the thread
+	ThreadLocalData data;
+	data.tl = &reused;
+	data.other = NULL;
+	data.value = 5;
+	data.ok = false;
+	_LUCENE_THREADID_TYPE thread = _LUCENE_THREAD_CREATE(&threadLocalHolder, &data);
+	_LUCENE_THREAD_JOIN(thread);
+	CLUCENE_ASSERT(data.ok);
+	CuAssertIntEquals(tc, _T("live values after thread end"), 0, threadlocal_liveCount());
+}
+
+CuSuite *testthreadlocal(void)
+{
+	CuSuite *suite = CuSuiteNew(_T("CLucene ThreadLocal Test"));
+	SUITE_ADD_TEST(suite, testThreadLocalThreads);
+	SUITE_ADD_TEST(suite, testThreadLocalDestroy);
+	return suite;
+}